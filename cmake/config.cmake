@@ -43,6 +43,27 @@ else()
   endif()
 endif()
 
+if( SC_USE_LZ4 )
+  find_path( LZ4_INCLUDE_DIR NAMES lz4.h )
+  find_library( LZ4_LIBRARY NAMES lz4 )
+  if( LZ4_INCLUDE_DIR AND LZ4_LIBRARY )
+    set(CMAKE_REQUIRED_INCLUDES ${LZ4_INCLUDE_DIR})
+    set(CMAKE_REQUIRED_LIBRARIES ${LZ4_LIBRARY})
+
+    check_c_source_compiles(
+      "#include <lz4.h>
+      int main(){
+        char src[16] = { 0 }, dst[64];
+        return LZ4_compress_default (src, dst, 16, 64) <= 0;
+      }"
+      SC_HAVE_LZ4
+    )
+
+    set(CMAKE_REQUIRED_INCLUDES)
+    set(CMAKE_REQUIRED_LIBRARIES)
+  endif()
+endif()
+
 find_package(Threads)
 
 if( SC_USE_INTERNAL_JSON )
@@ -183,6 +204,20 @@ check_include_file(sys/ioctl.h SC_HAVE_SYS_IOCTL_H)
 check_include_file(sys/select.h SC_HAVE_SYS_SELECT_H)
 check_include_file(sys/stat.h SC_HAVE_SYS_STAT_H)
 check_include_file(fcntl.h SC_HAVE_FCNTL_H)
+check_include_file(sys/mman.h SC_HAVE_SYS_MMAN_H)
+
+# POSIX shared memory may require the realtime library
+if(SC_HAVE_SYS_MMAN_H)
+  check_symbol_exists(shm_open sys/mman.h SC_HAVE_SHM_OPEN)
+  if(NOT SC_HAVE_SHM_OPEN)
+    set(CMAKE_REQUIRED_LIBRARIES rt)
+    check_symbol_exists(shm_open sys/mman.h SC_NEED_RT)
+    set(CMAKE_REQUIRED_LIBRARIES)
+    if(SC_NEED_RT)
+      set(SC_HAVE_SHM_OPEN 1)
+    endif()
+  endif()
+endif()
 
 if(CMAKE_SYSTEM_NAME STREQUAL "Linux")
   check_include_file(linux/videodev2.h SC_HAVE_LINUX_VIDEODEV2_H)
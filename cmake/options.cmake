@@ -7,6 +7,7 @@ option( SC_ENABLE_FILE_CHECKS "activate tests that use file i/o functions" ON)
 
 option( SC_USE_INTERNAL_ZLIB "build ZLIB" OFF )
 option( SC_USE_INTERNAL_JSON "build Jansson" OFF )
+option( SC_USE_LZ4 "use LZ4 for the fast sc_io codec if found" ON )
 
 option( SC_BUILD_SHARED_LIBS "build shared libsc" OFF )
 option( SC_BUILD_EXAMPLES "build libsc examples" ON )
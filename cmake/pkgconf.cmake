@@ -5,6 +5,9 @@ if(SC_ENABLE_MPI)
 elseif(SC_HAVE_ZLIB)
   string(APPEND pc_req_private " zlib")
 endif()
+if(SC_HAVE_LZ4)
+  string(APPEND pc_req_private " liblz4")
+endif()
 
 include(cmake/utils.cmake)
 convert_yn(SC_ENABLE_MPI mpi_pc)
@@ -200,6 +200,23 @@ if (a == adler32_combine (a, b, len)) {;}
   [$1_HAVE_ZLIB=])
 ])
 
+dnl SC_CHECK_LZ4(PREFIX)
+dnl Check whether LZ4_compress_default is found, possibly in -llz4.
+dnl We AC_DEFINE HAVE_LZ4 to 1 depending on whether it is found.
+dnl We set the shell variable PREFIX_HAVE_LZ4 to yes if found.
+dnl
+AC_DEFUN([SC_CHECK_LZ4],
+[
+  SC_SEARCH_LIBS([LZ4_compress_default], [[#include <lz4.h>]],
+[[
+char src[16] = { 0 }, dst[64];
+if (LZ4_compress_default (src, dst, 16, 64) <= 0) {;}
+]], [lz4],
+  [AC_DEFINE([HAVE_LZ4], [1], [Define to 1 if LZ4_compress_default links])
+   $1_HAVE_LZ4="yes"],
+  [$1_HAVE_LZ4=])
+])
+
 dnl SC_CHECK_JSON(PREFIX)
 dnl Check whether json_integer, json_real are found (in -ljansson).
 dnl We AC_DEFINE HAVE_JSON to 1 depending on whether it is found.
@@ -393,6 +410,7 @@ AC_DEFINE([USING_AUTOCONF], 1, [Define to 1 if using autoconf build])
 AC_CHECK_PROG([$1_HAVE_DOT], [dot], [YES], [NO])
 SC_CHECK_MATH([$1])
 SC_CHECK_ZLIB([$1])
+SC_CHECK_LZ4([$1])
 SC_CHECK_JSON([$1])
 dnl SC_CHECK_LIB([lua53 lua5.3 lua52 lua5.2 lua51 lua5.1 lua5 lua],
 dnl              [lua_createtable], [LUA], [$1])
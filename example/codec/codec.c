@@ -0,0 +1,414 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+/*
+ * Benchmark the throughput of the sc_io codecs in MB/s.
+ * Each process compresses and decompresses a smooth field of doubles,
+ * which resembles simulation output, and we report statistics over
+ * all processes and repetitions.  For comparison, we also time
+ * the base 64 encoding of sc_io_encode.  We show the scaling of chunked
+ * compression and of VTK output with the number of threads.  We
+ * compare the base 64 throughput in GB/s of the SIMD and scalar code.
+ * Finally, we compare the decoders of the deflate stream produced by
+ * the zlib codec: sc_puff, sc_inflate, which replaces sc_puff in builds
+ * without zlib, and zlib itself if configured.
+ */
+
+#include <sc_inflate.h>
+#include <sc_io.h>
+#include <sc_puff.h>
+#include <sc_options.h>
+#include <sc_statistics.h>
+#ifdef SC_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+enum
+{
+  CODEC_NONE_ENCODE,
+  CODEC_NONE_DECODE,
+  CODEC_ZLIB_ENCODE,
+  CODEC_ZLIB_DECODE,
+  CODEC_LZ_ENCODE,
+  CODEC_LZ_DECODE,
+  CODEC_BASE64_ENCODE,
+  CODEC_BASE64_DECODE,
+  CODEC_NUM_STATS
+};
+
+typedef struct sc_codec
+{
+  int                 mpirank;
+  int                 megabytes;
+  int                 level;
+  int                 repetitions;
+  int                 max_threads;
+  sc_statinfo_t       stats[CODEC_NUM_STATS];
+}
+sc_codec_t;
+
+/** Accumulate the throughput in MB/s of one timed operation. */
+static void
+accumulate_rate (sc_statinfo_t * stats, size_t bytes, double elapsed)
+{
+  sc_stats_accumulate (stats, bytes / (elapsed > 0. ? elapsed : 1e-9) /
+                       (1 << 20));
+}
+
+static void
+run_codec (sc_codec_t * c, sc_array_t * field, int codec,
+           sc_statinfo_t * stats)
+{
+  int                 r;
+  int                 retval;
+  size_t              bytes = field->elem_count * field->elem_size;
+  double              elapsed;
+  sc_array_t          encoded, decoded;
+
+  sc_array_init (&encoded, 1);
+  sc_array_init (&decoded, sizeof (double));
+  for (r = 0; r < c->repetitions; ++r) {
+    elapsed = -sc_MPI_Wtime ();
+    if (codec < SC_IO_CODEC_LAST) {
+      sc_io_encode_raw (field, &encoded, (sc_io_codec_t) codec, c->level);
+    }
+    else {
+      sc_io_encode_zlib (field, &encoded, c->level, '=');
+    }
+    elapsed += sc_MPI_Wtime ();
+    accumulate_rate (stats, bytes, elapsed);
+
+    elapsed = -sc_MPI_Wtime ();
+    if (codec < SC_IO_CODEC_LAST) {
+      retval = sc_io_decode_raw (&encoded, &decoded, 0, NULL);
+    }
+    else {
+      retval = sc_io_decode (&encoded, &decoded, 0, NULL);
+    }
+    elapsed += sc_MPI_Wtime ();
+    accumulate_rate (stats + 1, bytes, elapsed);
+
+    SC_CHECK_ABORT (retval == 0 && decoded.elem_count == field->elem_count
+                    && !memcmp (decoded.array, field->array, bytes),
+                    "Codec mismatch");
+  }
+  SC_GLOBAL_PRODUCTIONF ("%s compresses %llu bytes to %llu\n",
+                         stats->variable, (unsigned long long) bytes,
+                         (unsigned long long) encoded.elem_count);
+
+  sc_array_reset (&encoded);
+  sc_array_reset (&decoded);
+}
+
+/** Report the best throughput for 1, 2, 4, ... threads. */
+static void
+run_scaling (sc_codec_t * c, sc_array_t * field)
+{
+  int                 r, t;
+  int                 mpiret;
+  size_t              bytes = field->elem_count * field->elem_size;
+  double              elapsed, best[3], global[3];
+  sc_array_t          encoded;
+  FILE               *vtkfile;
+
+  sc_array_init (&encoded, 1);
+  vtkfile = tmpfile ();
+  SC_CHECK_ABORT (vtkfile != NULL, "Open temporary file");
+  for (t = 1; t <= c->max_threads; t *= 2) {
+    sc_io_compress_threads = t;
+    best[0] = best[1] = best[2] = 0.;
+    for (r = 0; r < c->repetitions; ++r) {
+      elapsed = -sc_MPI_Wtime ();
+      sc_io_encode_raw (field, &encoded, SC_IO_CODEC_ZLIB, c->level);
+      elapsed += sc_MPI_Wtime ();
+      best[0] = SC_MAX (best[0], bytes / elapsed / (1 << 20));
+
+      elapsed = -sc_MPI_Wtime ();
+      sc_io_encode_raw (field, &encoded, SC_IO_CODEC_LZ, c->level);
+      elapsed += sc_MPI_Wtime ();
+      best[1] = SC_MAX (best[1], bytes / elapsed / (1 << 20));
+
+      if (sc_have_zlib ()) {
+        SC_CHECK_ABORT (!fseek (vtkfile, 0, SEEK_SET), "Rewind");
+        elapsed = -sc_MPI_Wtime ();
+        SC_CHECK_ABORT (!sc_vtk_write_compressed (vtkfile, field->array,
+                                                  bytes), "VTK write");
+        elapsed += sc_MPI_Wtime ();
+        best[2] = SC_MAX (best[2], bytes / elapsed / (1 << 20));
+      }
+    }
+
+    /* the slowest process determines the wall clock */
+    mpiret = sc_MPI_Allreduce (best, global, 3, sc_MPI_DOUBLE, sc_MPI_MIN,
+                               sc_MPI_COMM_WORLD);
+    SC_CHECK_MPI (mpiret);
+    SC_GLOBAL_PRODUCTIONF ("Threads %2d MB/s zlib %8.1f LZ %8.1f"
+                           " VTK %8.1f\n", t, global[0], global[1],
+                           global[2]);
+  }
+  sc_io_compress_threads = 1;
+  sc_fflush_fsync_fclose (vtkfile);
+  sc_array_reset (&encoded);
+}
+
+/** Report the best base 64 throughput of the scalar and the SIMD code.
+ * Level 0 of sc_io_encode stores the data, so base 64 dominates its time.
+ */
+static void
+run_base64 (sc_codec_t * c, sc_array_t * field)
+{
+  int                 r, v;
+  int                 mpiret;
+  size_t              bytes = field->elem_count * field->elem_size;
+  double              elapsed, best[2][3], global[2][3];
+  sc_array_t          encoded, decoded;
+  FILE               *vtkfile;
+
+  sc_array_init (&encoded, 1);
+  sc_array_init (&decoded, sizeof (double));
+  vtkfile = tmpfile ();
+  SC_CHECK_ABORT (vtkfile != NULL, "Open temporary file");
+  for (v = 0; v < 2; ++v) {
+    sc_io_base64_simd = v;
+    best[v][0] = best[v][1] = best[v][2] = 0.;
+    for (r = 0; r < c->repetitions; ++r) {
+      elapsed = -sc_MPI_Wtime ();
+      sc_io_encode_zlib (field, &encoded, 0, '=');
+      elapsed += sc_MPI_Wtime ();
+      best[v][0] = SC_MAX (best[v][0], bytes / elapsed / (1 << 30));
+
+      elapsed = -sc_MPI_Wtime ();
+      SC_CHECK_ABORT (!sc_io_decode (&encoded, &decoded, 0, NULL),
+                      "Base 64 decode");
+      elapsed += sc_MPI_Wtime ();
+      best[v][1] = SC_MAX (best[v][1], bytes / elapsed / (1 << 30));
+
+      SC_CHECK_ABORT (!fseek (vtkfile, 0, SEEK_SET), "Rewind");
+      elapsed = -sc_MPI_Wtime ();
+      SC_CHECK_ABORT (!sc_vtk_write_binary (vtkfile, field->array, bytes),
+                      "VTK write");
+      elapsed += sc_MPI_Wtime ();
+      best[v][2] = SC_MAX (best[v][2], bytes / elapsed / (1 << 30));
+    }
+  }
+  sc_io_base64_simd = 1;
+
+  mpiret = sc_MPI_Allreduce (best, global, 6, sc_MPI_DOUBLE, sc_MPI_MIN,
+                             sc_MPI_COMM_WORLD);
+  SC_CHECK_MPI (mpiret);
+  for (v = 0; v < 2; ++v) {
+    SC_GLOBAL_PRODUCTIONF ("Base64 %s GB/s encode %6.2f decode %6.2f"
+                           " VTK %6.2f\n", v ? "SIMD  " : "libb64",
+                           global[v][0], global[v][1], global[v][2]);
+  }
+  sc_fflush_fsync_fclose (vtkfile);
+  sc_array_reset (&encoded);
+  sc_array_reset (&decoded);
+}
+
+/** Report the best throughput of decoding one deflate stream.
+ * The zlib codec output consists of our header, the zlib header of two
+ * bytes, the deflate stream and the four bytes of the adler32 checksum.
+ */
+static void
+run_inflate (sc_codec_t * c, sc_array_t * field)
+{
+  int                 r, v;
+  int                 mpiret;
+  int                 retval;
+  size_t              bytes = field->elem_count * field->elem_size;
+  size_t              srclen, skip = 9 + 2;
+  unsigned long       plen, slen;
+  double              elapsed, best[3], global[3];
+  sc_array_t          encoded, decoded;
+#ifdef SC_HAVE_ZLIB
+  z_stream            strm;
+#endif
+
+  sc_array_init (&encoded, 1);
+  sc_array_init_count (&decoded, 1, bytes);
+  sc_io_encode_raw (field, &encoded, SC_IO_CODEC_ZLIB, c->level);
+  best[0] = best[1] = best[2] = 0.;
+  for (r = 0; r < c->repetitions; ++r) {
+    for (v = 0; v < 3; ++v) {
+      memset (decoded.array, 0, bytes);
+      srclen = encoded.elem_count - skip - 4;
+      elapsed = -sc_MPI_Wtime ();
+      if (v == 0) {
+        plen = (unsigned long) bytes;
+        slen = (unsigned long) srclen;
+        retval = sc_puff ((unsigned char *) decoded.array, &plen,
+                          (unsigned char *) encoded.array + skip, &slen);
+      }
+      else if (v == 1) {
+        retval = sc_inflate (decoded.array, bytes, encoded.array + skip,
+                             &srclen);
+      }
+      else {
+#ifdef SC_HAVE_ZLIB
+        memset (&strm, 0, sizeof (z_stream));
+        retval = inflateInit2 (&strm, -15) != Z_OK;
+        strm.next_in = (Bytef *) encoded.array + skip;
+        strm.avail_in = (uInt) srclen;
+        strm.next_out = (Bytef *) decoded.array;
+        strm.avail_out = (uInt) bytes;
+        retval = retval || inflate (&strm, Z_FINISH) != Z_STREAM_END;
+        inflateEnd (&strm);
+#else
+        break;
+#endif
+      }
+      elapsed += sc_MPI_Wtime ();
+      SC_CHECK_ABORT (retval == 0 && !memcmp (decoded.array, field->array,
+                                              bytes), "Inflate mismatch");
+      best[v] = SC_MAX (best[v], bytes / elapsed / (1 << 20));
+    }
+  }
+
+  mpiret = sc_MPI_Allreduce (best, global, 3, sc_MPI_DOUBLE, sc_MPI_MIN,
+                             sc_MPI_COMM_WORLD);
+  SC_CHECK_MPI (mpiret);
+  SC_GLOBAL_PRODUCTIONF ("Inflate MB/s sc_puff %8.1f sc_inflate %8.1f"
+                         " zlib %8.1f\n", global[0], global[1], global[2]);
+  sc_array_reset (&encoded);
+  sc_array_reset (&decoded);
+}
+
+static void
+run_codecs (sc_codec_t * c)
+{
+  int                 codec;
+  size_t              iz, count;
+  sc_array_t         *field;
+
+  sc_stats_init (c->stats + CODEC_NONE_ENCODE, "None encode");
+  sc_stats_init (c->stats + CODEC_NONE_DECODE, "None decode");
+  sc_stats_init (c->stats + CODEC_ZLIB_ENCODE, "Zlib encode");
+  sc_stats_init (c->stats + CODEC_ZLIB_DECODE, "Zlib decode");
+  sc_stats_init (c->stats + CODEC_LZ_ENCODE, "LZ encode");
+  sc_stats_init (c->stats + CODEC_LZ_DECODE, "LZ decode");
+  sc_stats_init (c->stats + CODEC_BASE64_ENCODE, "Base64 encode");
+  sc_stats_init (c->stats + CODEC_BASE64_DECODE, "Base64 decode");
+  SC_GLOBAL_PRODUCTIONF ("Is zlib configured %d LZ4 configured %d\n",
+                         sc_have_zlib (), sc_have_lz4 ());
+
+  /* a smooth field with a repeating rounding pattern */
+  count = ((size_t) c->megabytes << 20) / sizeof (double);
+  field = sc_array_new_count (sizeof (double), count);
+  for (iz = 0; iz < count; ++iz) {
+    *(double *) sc_array_index (field, iz) =
+      floor (1e3 * sin (1e-4 * iz + c->mpirank)) / 1e3;
+  }
+
+  for (codec = 0; codec <= SC_IO_CODEC_LAST; ++codec) {
+    run_codec (c, field, codec, c->stats + 2 * codec);
+  }
+
+  sc_stats_compute (sc_MPI_COMM_WORLD, CODEC_NUM_STATS, c->stats);
+  sc_stats_print (sc_package_id, SC_LP_STATISTICS,
+                  CODEC_NUM_STATS, c->stats, 1, 1);
+  run_scaling (c, field);
+  run_base64 (c, field);
+  run_inflate (c, field);
+
+  sc_array_destroy (field);
+}
+
+int
+main (int argc, char **argv)
+{
+  sc_codec_t          codec, *c = &codec;
+  int                 fail = 0;
+  int                 mpiret;
+  int                 help;
+  int                 first_arg;
+  sc_options_t       *opt;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_DEFAULT);
+
+  mpiret = sc_MPI_Comm_rank (sc_MPI_COMM_WORLD, &c->mpirank);
+  SC_CHECK_MPI (mpiret);
+
+  opt = sc_options_new (argv[0]);
+  sc_options_add_int (opt, 'm', "megabytes", &c->megabytes, 64,
+                      "Size of the data per process in MiB");
+  sc_options_add_int (opt, 'l', "level", &c->level, -1,
+                      "Compression level of zlib (-1 for default)");
+  sc_options_add_int (opt, 'r', "repetitions", &c->repetitions, 3,
+                      "Number of repetitions");
+  sc_options_add_int (opt, 't', "threads", &c->max_threads, 32,
+                      "Maximum number of compression threads");
+  sc_options_add_switch (opt, 'h', "help", &help, "Show help information");
+
+  /* process command line options */
+  first_arg = sc_options_parse (sc_package_id, SC_LP_INFO, opt, argc, argv);
+  if (!fail && first_arg < 0) {
+    SC_GLOBAL_LERROR ("Error in option parsing\n");
+    fail = 1;
+  }
+  if (!fail && first_arg < argc) {
+    SC_GLOBAL_LERROR ("This program takes no arguments, just options\n");
+    fail = 1;
+  }
+  if (!fail && (c->megabytes < 1 || c->megabytes > 1 << 20)) {
+    SC_GLOBAL_LERROR ("Parameter m must be positive and reasonable\n");
+    fail = 1;
+  }
+  if (!fail && (c->level < -1 || c->level > 9)) {
+    SC_GLOBAL_LERROR ("Parameter l must be between -1 and 9\n");
+    fail = 1;
+  }
+  if (!fail && c->repetitions < 1) {
+    SC_GLOBAL_LERROR ("Parameter r must be positive\n");
+    fail = 1;
+  }
+  if (!fail && c->max_threads < 1) {
+    SC_GLOBAL_LERROR ("Parameter t must be positive\n");
+    fail = 1;
+  }
+
+  /* execute main program action */
+  if (fail) {
+    sc_options_print_usage (sc_package_id, SC_LP_ERROR, opt, NULL);
+  }
+  else {
+    if (help) {
+      sc_options_print_usage (sc_package_id, SC_LP_PRODUCTION, opt, NULL);
+    }
+    else {
+      sc_options_print_summary (sc_package_id, SC_LP_PRODUCTION, opt);
+      run_codecs (c);
+    }
+  }
+
+  sc_options_destroy (opt);
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return fail ? EXIT_FAILURE : EXIT_SUCCESS;
+}
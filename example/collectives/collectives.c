@@ -0,0 +1,319 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+/*
+ * Benchmark flat against node-aware collectives.
+ * The node-aware variants pay off with many processes per node,
+ * so this program is best run with 64 or more processes per node.
+ */
+
+#include <sc_allgather.h>
+#include <sc_notify.h>
+#include <sc_options.h>
+#include <sc_reduce.h>
+#include <sc_statistics.h>
+
+enum
+{
+  COLL_ALLGATHER,
+  COLL_ALLGATHER_NODE,
+  COLL_ALLREDUCE,
+  COLL_ALLREDUCE_NODE,
+  COLL_NOTIFY_PEX,
+  COLL_NOTIFY_NODE,
+  COLL_NUM_STATS
+};
+
+typedef struct sc_collectives
+{
+  int                 mpirank;
+  int                 mpisize;
+  int                 ppn;
+  int                 count;
+  int                 repetitions;
+  int                 num_receivers;
+  sc_MPI_Comm         flatcomm;
+  sc_MPI_Comm         nodecomm;
+  sc_statinfo_t       stats[COLL_NUM_STATS];
+}
+sc_collectives_t;
+
+static void
+run_allgather (sc_collectives_t * c, sc_MPI_Comm mpicomm, int node,
+               sc_statinfo_t * stats)
+{
+  int                 mpiret;
+  int                 i, r;
+  double             *send, *recv;
+  double              elapsed;
+
+  send = SC_ALLOC (double, c->count);
+  recv = SC_ALLOC (double, (size_t) c->count * c->mpisize);
+  for (i = 0; i < c->count; ++i) {
+    send[i] = c->mpirank + i / (double) c->count;
+  }
+
+  for (r = 0; r < c->repetitions; ++r) {
+    mpiret = sc_MPI_Barrier (mpicomm);
+    SC_CHECK_MPI (mpiret);
+    elapsed = -sc_MPI_Wtime ();
+    if (node) {
+      mpiret = sc_allgather_node (send, c->count, sc_MPI_DOUBLE,
+                                  recv, c->count, sc_MPI_DOUBLE, mpicomm);
+    }
+    else {
+      mpiret = sc_allgather (send, c->count, sc_MPI_DOUBLE,
+                             recv, c->count, sc_MPI_DOUBLE, mpicomm);
+    }
+    SC_CHECK_MPI (mpiret);
+    elapsed += sc_MPI_Wtime ();
+    sc_stats_accumulate (stats, elapsed);
+  }
+  for (i = 0; i < c->mpisize; ++i) {
+    SC_CHECK_ABORT (recv[i * c->count] == (double) i, "Allgather mismatch");
+  }
+
+  SC_FREE (send);
+  SC_FREE (recv);
+}
+
+static void
+run_allreduce (sc_collectives_t * c, sc_MPI_Comm mpicomm, int node,
+               sc_statinfo_t * stats)
+{
+  int                 mpiret;
+  int                 i, r;
+  long               *send, *recv;
+  double              elapsed;
+
+  send = SC_ALLOC (long, c->count);
+  recv = SC_ALLOC (long, c->count);
+  for (i = 0; i < c->count; ++i) {
+    send[i] = (long) c->mpirank + i;
+  }
+
+  for (r = 0; r < c->repetitions; ++r) {
+    mpiret = sc_MPI_Barrier (mpicomm);
+    SC_CHECK_MPI (mpiret);
+    elapsed = -sc_MPI_Wtime ();
+    if (node) {
+      mpiret = sc_allreduce_node (send, recv, c->count, sc_MPI_LONG,
+                                  sc_MPI_SUM, mpicomm);
+    }
+    else {
+      mpiret = sc_allreduce (send, recv, c->count, sc_MPI_LONG,
+                             sc_MPI_SUM, mpicomm);
+    }
+    SC_CHECK_MPI (mpiret);
+    elapsed += sc_MPI_Wtime ();
+    sc_stats_accumulate (stats, elapsed);
+  }
+  SC_CHECK_ABORT (c->count == 0 ||
+                  recv[0] == ((long) c->mpisize - 1) * c->mpisize / 2,
+                  "Allreduce mismatch");
+
+  SC_FREE (send);
+  SC_FREE (recv);
+}
+
+static void
+run_notify (sc_collectives_t * c, sc_MPI_Comm mpicomm,
+            sc_notify_type_t type, sc_statinfo_t * stats)
+{
+  int                 i, r;
+  int                 mpiret;
+  int                 num_receivers;
+  double              elapsed;
+  sc_array_t         *receivers, *senders, *payload;
+  sc_notify_t        *notify;
+
+  notify = sc_notify_new (mpicomm);
+  sc_notify_set_type (notify, type);
+  receivers = sc_array_new (sizeof (int));
+  senders = sc_array_new (sizeof (int));
+  payload = sc_array_new (sizeof (int));
+
+  num_receivers = SC_MIN (c->num_receivers, c->mpisize);
+  for (r = 0; r < c->repetitions; ++r) {
+    /* a sparse pattern that reaches across nodes */
+    sc_array_resize (receivers, (size_t) num_receivers);
+    sc_array_resize (payload, (size_t) num_receivers);
+    for (i = 0; i < num_receivers; ++i) {
+      *(int *) sc_array_index_int (receivers, i) =
+        (c->mpirank + 1 + i * (c->mpisize / num_receivers)) % c->mpisize;
+      *(int *) sc_array_index_int (payload, i) = c->mpirank;
+    }
+    sc_array_sort (receivers, sc_int_compare);
+
+    mpiret = sc_MPI_Barrier (mpicomm);
+    SC_CHECK_MPI (mpiret);
+    elapsed = -sc_MPI_Wtime ();
+    sc_notify_payload (receivers, senders, payload, NULL, 1, notify);
+    elapsed += sc_MPI_Wtime ();
+    sc_stats_accumulate (stats, elapsed);
+
+    SC_CHECK_ABORT (senders->elem_count == payload->elem_count,
+                    "Notify mismatch");
+    for (i = 0; i < (int) senders->elem_count; ++i) {
+      SC_CHECK_ABORT (*(int *) sc_array_index_int (senders, i) ==
+                      *(int *) sc_array_index_int (payload, i),
+                      "Notify payload mismatch");
+    }
+  }
+
+  sc_array_destroy (receivers);
+  sc_array_destroy (senders);
+  sc_array_destroy (payload);
+  sc_notify_destroy (notify);
+}
+
+static void
+run_collectives (sc_collectives_t * c)
+{
+  int                 mpiret;
+  sc_MPI_Comm         intranode, internode;
+
+  sc_stats_init (c->stats + COLL_ALLGATHER, "Allgather flat");
+  sc_stats_init (c->stats + COLL_ALLGATHER_NODE, "Allgather node");
+  sc_stats_init (c->stats + COLL_ALLREDUCE, "Allreduce flat");
+  sc_stats_init (c->stats + COLL_ALLREDUCE_NODE, "Allreduce node");
+  sc_stats_init (c->stats + COLL_NOTIFY_PEX, "Notify pex");
+  sc_stats_init (c->stats + COLL_NOTIFY_NODE, "Notify node");
+
+  /* the flat variants run on a communicator without node information */
+  mpiret = sc_MPI_Comm_dup (sc_MPI_COMM_WORLD, &c->flatcomm);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_dup (sc_MPI_COMM_WORLD, &c->nodecomm);
+  SC_CHECK_MPI (mpiret);
+  sc_mpi_comm_attach_node_comms (c->nodecomm, c->ppn);
+  sc_mpi_comm_get_node_comms (c->nodecomm, &intranode, &internode);
+  if (intranode == sc_MPI_COMM_NULL) {
+    SC_GLOBAL_PRODUCTION ("No node communicators: node variants are flat\n");
+  }
+  else {
+    int                 intrasize;
+
+    mpiret = sc_MPI_Comm_size (intranode, &intrasize);
+    SC_CHECK_MPI (mpiret);
+    SC_GLOBAL_PRODUCTIONF ("Running with %d processes per node\n",
+                           intrasize);
+  }
+
+  run_allgather (c, c->flatcomm, 0, c->stats + COLL_ALLGATHER);
+  run_allgather (c, c->nodecomm, 1, c->stats + COLL_ALLGATHER_NODE);
+  run_allreduce (c, c->flatcomm, 0, c->stats + COLL_ALLREDUCE);
+  run_allreduce (c, c->nodecomm, 1, c->stats + COLL_ALLREDUCE_NODE);
+  run_notify (c, c->flatcomm, SC_NOTIFY_PEX, c->stats + COLL_NOTIFY_PEX);
+  run_notify (c, c->nodecomm, SC_NOTIFY_NODE, c->stats + COLL_NOTIFY_NODE);
+
+  sc_stats_compute (sc_MPI_COMM_WORLD, COLL_NUM_STATS, c->stats);
+  sc_stats_print (sc_package_id, SC_LP_STATISTICS,
+                  COLL_NUM_STATS, c->stats, 1, 1);
+
+  sc_mpi_comm_detach_node_comms (c->nodecomm);
+  mpiret = sc_MPI_Comm_free (&c->nodecomm);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_free (&c->flatcomm);
+  SC_CHECK_MPI (mpiret);
+}
+
+int
+main (int argc, char **argv)
+{
+  sc_collectives_t    coll, *c = &coll;
+  int                 fail = 0;
+  int                 mpiret;
+  int                 help;
+  int                 first_arg;
+  sc_options_t       *opt;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_DEFAULT);
+
+  mpiret = sc_MPI_Comm_size (sc_MPI_COMM_WORLD, &c->mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (sc_MPI_COMM_WORLD, &c->mpirank);
+  SC_CHECK_MPI (mpiret);
+
+  opt = sc_options_new (argv[0]);
+  sc_options_add_int (opt, 'p', "ppn", &c->ppn, 0,
+                      "Processes per node (0 for shared memory detection)");
+  sc_options_add_int (opt, 'c', "count", &c->count, 1,
+                      "Number of items per process");
+  sc_options_add_int (opt, 'n', "receivers", &c->num_receivers, 8,
+                      "Number of notify receivers per process");
+  sc_options_add_int (opt, 'r', "repetitions", &c->repetitions, 10,
+                      "Number of repetitions");
+  sc_options_add_switch (opt, 'h', "help", &help, "Show help information");
+
+  /* process command line options */
+  first_arg = sc_options_parse (sc_package_id, SC_LP_INFO, opt, argc, argv);
+  if (!fail && first_arg < 0) {
+    SC_GLOBAL_LERROR ("Error in option parsing\n");
+    fail = 1;
+  }
+  if (!fail && first_arg < argc) {
+    SC_GLOBAL_LERROR ("This program takes no arguments, just options\n");
+    fail = 1;
+  }
+  if (!fail && (c->ppn < 0 || (c->ppn > 0 && c->mpisize % c->ppn))) {
+    SC_GLOBAL_LERROR ("Parameter p must be zero or divide the size\n");
+    fail = 1;
+  }
+  if (!fail && c->count < 1) {
+    SC_GLOBAL_LERROR ("Parameter c must be positive\n");
+    fail = 1;
+  }
+  if (!fail && c->num_receivers < 1) {
+    SC_GLOBAL_LERROR ("Parameter n must be positive\n");
+    fail = 1;
+  }
+  if (!fail && c->repetitions < 1) {
+    SC_GLOBAL_LERROR ("Parameter r must be positive\n");
+    fail = 1;
+  }
+
+  /* execute main program action */
+  if (fail) {
+    sc_options_print_usage (sc_package_id, SC_LP_ERROR, opt, NULL);
+  }
+  else {
+    if (help) {
+      sc_options_print_usage (sc_package_id, SC_LP_PRODUCTION, opt, NULL);
+    }
+    else {
+      sc_options_print_summary (sc_package_id, SC_LP_PRODUCTION, opt);
+      run_collectives (c);
+    }
+  }
+
+  sc_options_destroy (opt);
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return fail ? EXIT_FAILURE : EXIT_SUCCESS;
+}
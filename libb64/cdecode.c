@@ -54,6 +54,17 @@ base64_decode_block (const char *code_in, size_t length_in,
 
     while (1) {
   case step_a:
+#ifdef BASE64_SIMD
+      /* CB: decode long runs of valid characters with vector instructions */
+      if (code_in + length_in - codechar >= 16) {
+        size_t              done;
+
+        done = base64_decode_simd (codechar, code_in + length_in - codechar,
+                                   plainchar);
+        codechar += done;
+        plainchar += done / 4 * 3;
+      }
+#endif
       do {
         if (codechar == code_in + length_in) {
           state_in->step = step_a;
@@ -54,6 +54,17 @@ base64_encode_block (const char *plaintext_in, size_t length_in,
 
     while (1) {
   case step_A:
+#ifdef BASE64_SIMD
+      /* CB: encode long runs of whole groups with vector instructions */
+      if (plaintextend - plainchar >= 16) {
+        size_t              done;
+
+        done = base64_encode_simd (plainchar, plaintextend - plainchar,
+                                   codechar);
+        plainchar += done;
+        codechar += done / 3 * 4;
+      }
+#endif
       if (plainchar == plaintextend) {
         state_in->result = result;
         state_in->step = step_A;
@@ -0,0 +1,302 @@
+/*
+ * vectorized kernels for the libb64 block functions by CB
+ */
+
+/*
+csimd.c - SSSE3 and AVX2 kernels for base64 encoding and decoding
+
+The kernels follow the vector algorithms published by Wojciech Mula and
+Daniel Lemire.  They process whole groups of 3 plain bytes or 4 code bytes
+and are called from base64_encode_block and base64_decode_block whenever the
+scalar state machine is at a group boundary.  The scalar code handles the
+remainder, so the output is identical to the one of the scalar code.
+*/
+
+#include "libb64.h"
+
+int                 sc_io_base64_simd = 1;
+
+#ifdef BASE64_SIMD
+
+#include <immintrin.h>
+
+/* instruction sets by increasing capability */
+#define BASE64_LEVEL_SCALAR 0
+#define BASE64_LEVEL_SSSE3  1
+#define BASE64_LEVEL_AVX2   2
+
+/* The level is detected on first use, possibly by several threads at
+   once.  libb64 is compiled without the libsc configuration, so instead of
+   pthread_once the cache is an atomic variable: every thread detects the
+   same level and no thread reads a partially written value. */
+static int
+base64_simd_level (void)
+{
+  static int          level = -1;
+  int                 detect;
+
+  detect = __atomic_load_n (&level, __ATOMIC_ACQUIRE);
+  if (detect < 0) {
+    detect = BASE64_LEVEL_SCALAR;
+    __builtin_cpu_init ();
+    if (__builtin_cpu_supports ("avx2")) {
+      detect = BASE64_LEVEL_AVX2;
+    }
+    else if (__builtin_cpu_supports ("ssse3")) {
+      detect = BASE64_LEVEL_SSSE3;
+    }
+    __atomic_store_n (&level, detect, __ATOMIC_RELEASE);
+  }
+  return sc_io_base64_simd ? detect : BASE64_LEVEL_SCALAR;
+}
+
+/* split 12 bytes into 16 sextets, one per byte */
+__attribute__ ((target ("ssse3")))
+static inline __m128i
+base64_enc_reshuffle (__m128i in)
+{
+  __m128i             t0, t1, t2, t3;
+
+  /* every 32-bit lane holds the bytes b, a, c, b of one group */
+  in = _mm_shuffle_epi8 (in, _mm_set_epi8 (10, 11, 9, 10, 7, 8, 6, 7,
+                                           4, 5, 3, 4, 1, 2, 0, 1));
+  t0 = _mm_and_si128 (in, _mm_set1_epi32 (0x0fc0fc00));
+  t1 = _mm_mulhi_epu16 (t0, _mm_set1_epi32 (0x04000040));
+  t2 = _mm_and_si128 (in, _mm_set1_epi32 (0x003f03f0));
+  t3 = _mm_mullo_epi16 (t2, _mm_set1_epi32 (0x01000010));
+  return _mm_or_si128 (t1, t3);
+}
+
+/* map 16 sextets to their characters by adding a range offset */
+__attribute__ ((target ("ssse3")))
+static inline __m128i
+base64_enc_translate (__m128i in)
+{
+  const __m128i       lut = _mm_setr_epi8 (65, 71, -4, -4, -4, -4, -4, -4,
+                                           -4, -4, -4, -4, -19, -16, 0, 0);
+  __m128i             indices, mask;
+
+  /* index 0 for A-Z, 1 for a-z, 2 to 11 for digits, 12 and 13 for +/ */
+  indices = _mm_subs_epu8 (in, _mm_set1_epi8 (51));
+  mask = _mm_cmpgt_epi8 (in, _mm_set1_epi8 (25));
+  indices = _mm_sub_epi8 (indices, mask);
+  return _mm_add_epi8 (in, _mm_shuffle_epi8 (lut, indices));
+}
+
+__attribute__ ((target ("ssse3")))
+static size_t
+base64_encode_ssse3 (const char *in, size_t length, char *out)
+{
+  size_t              done = 0;
+  __m128i             str;
+
+  /* the last load reads 4 bytes beyond the 12 consumed */
+  while (length - done >= 16) {
+    str = _mm_loadu_si128 ((const __m128i *) (in + done));
+    str = base64_enc_translate (base64_enc_reshuffle (str));
+    _mm_storeu_si128 ((__m128i *) out, str);
+    done += 12;
+    out += 16;
+  }
+  return done;
+}
+
+__attribute__ ((target ("avx2")))
+static inline __m256i
+base64_enc_reshuffle_avx2 (__m256i in)
+{
+  __m256i             t0, t1, t2, t3;
+
+  in = _mm256_shuffle_epi8 (in, _mm256_set_epi8 (10, 11, 9, 10, 7, 8, 6, 7,
+                                                 4, 5, 3, 4, 1, 2, 0, 1,
+                                                 10, 11, 9, 10, 7, 8, 6, 7,
+                                                 4, 5, 3, 4, 1, 2, 0, 1));
+  t0 = _mm256_and_si256 (in, _mm256_set1_epi32 (0x0fc0fc00));
+  t1 = _mm256_mulhi_epu16 (t0, _mm256_set1_epi32 (0x04000040));
+  t2 = _mm256_and_si256 (in, _mm256_set1_epi32 (0x003f03f0));
+  t3 = _mm256_mullo_epi16 (t2, _mm256_set1_epi32 (0x01000010));
+  return _mm256_or_si256 (t1, t3);
+}
+
+__attribute__ ((target ("avx2")))
+static inline __m256i
+base64_enc_translate_avx2 (__m256i in)
+{
+  const __m256i       lut =
+    _mm256_setr_epi8 (65, 71, -4, -4, -4, -4, -4, -4,
+                      -4, -4, -4, -4, -19, -16, 0, 0,
+                      65, 71, -4, -4, -4, -4, -4, -4,
+                      -4, -4, -4, -4, -19, -16, 0, 0);
+  __m256i             indices, mask;
+
+  indices = _mm256_subs_epu8 (in, _mm256_set1_epi8 (51));
+  mask = _mm256_cmpgt_epi8 (in, _mm256_set1_epi8 (25));
+  indices = _mm256_sub_epi8 (indices, mask);
+  return _mm256_add_epi8 (in, _mm256_shuffle_epi8 (lut, indices));
+}
+
+__attribute__ ((target ("avx2")))
+static size_t
+base64_encode_avx2 (const char *in, size_t length, char *out)
+{
+  size_t              done = 0;
+  __m128i             lo, hi;
+  __m256i             str;
+
+  /* each 128-bit lane encodes 12 bytes; the upper load ends at 28 */
+  while (length - done >= 32) {
+    lo = _mm_loadu_si128 ((const __m128i *) (in + done));
+    hi = _mm_loadu_si128 ((const __m128i *) (in + done + 12));
+    str = _mm256_inserti128_si256 (_mm256_castsi128_si256 (lo), hi, 1);
+    str = base64_enc_translate_avx2 (base64_enc_reshuffle_avx2 (str));
+    _mm256_storeu_si256 ((__m256i *) out, str);
+    done += 24;
+    out += 32;
+  }
+  return done + base64_encode_ssse3 (in + done, length - done, out);
+}
+
+/* convert 16 characters to sextets; return zero on an invalid character */
+__attribute__ ((target ("ssse3")))
+static inline int
+base64_dec_translate (__m128i * str)
+{
+  const __m128i       lut_lo =
+    _mm_setr_epi8 (0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                   0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+  const __m128i       lut_hi =
+    _mm_setr_epi8 (0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                   0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+  const __m128i       lut_roll =
+    _mm_setr_epi8 (0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+  const __m128i       mask_2f = _mm_set1_epi8 (0x2f);
+  __m128i             hi_nibbles, lo_nibbles, hi, lo, eq_2f, roll;
+
+  /* a character is valid if its nibble classes do not intersect */
+  hi_nibbles = _mm_and_si128 (_mm_srli_epi32 (*str, 4), mask_2f);
+  lo_nibbles = _mm_and_si128 (*str, mask_2f);
+  hi = _mm_shuffle_epi8 (lut_hi, hi_nibbles);
+  lo = _mm_shuffle_epi8 (lut_lo, lo_nibbles);
+  if (_mm_movemask_epi8 (_mm_cmpeq_epi8 (_mm_and_si128 (lo, hi),
+                                         _mm_setzero_si128 ())) != 0xffff) {
+    return 0;
+  }
+
+  /* the slash shares its high nibble with the plus */
+  eq_2f = _mm_cmpeq_epi8 (*str, mask_2f);
+  roll = _mm_shuffle_epi8 (lut_roll, _mm_add_epi8 (eq_2f, hi_nibbles));
+  *str = _mm_add_epi8 (*str, roll);
+  return 1;
+}
+
+/* pack 16 sextets into 12 bytes at the front of the register */
+__attribute__ ((target ("ssse3")))
+static inline __m128i
+base64_dec_reshuffle (__m128i in)
+{
+  in = _mm_maddubs_epi16 (in, _mm_set1_epi32 (0x01400140));
+  in = _mm_madd_epi16 (in, _mm_set1_epi32 (0x00011000));
+  return _mm_shuffle_epi8 (in, _mm_setr_epi8 (2, 1, 0, 6, 5, 4, 10, 9,
+                                              8, 14, 13, 12, -1, -1, -1, -1));
+}
+
+__attribute__ ((target ("ssse3")))
+static size_t
+base64_decode_ssse3 (const char *in, size_t length, char *out)
+{
+  size_t              done = 0;
+  __m128i             str;
+
+  /* the store writes 4 bytes beyond the 12 produced */
+  while (length - done >= 16) {
+    str = _mm_loadu_si128 ((const __m128i *) (in + done));
+    if (!base64_dec_translate (&str)) {
+      break;
+    }
+    _mm_storeu_si128 ((__m128i *) out, base64_dec_reshuffle (str));
+    done += 16;
+    out += 12;
+  }
+  return done;
+}
+
+__attribute__ ((target ("avx2")))
+static size_t
+base64_decode_avx2 (const char *in, size_t length, char *out)
+{
+  const __m256i       lut_lo =
+    _mm256_setr_epi8 (0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                      0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a,
+                      0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                      0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+  const __m256i       lut_hi =
+    _mm256_setr_epi8 (0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                      0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+                      0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                      0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+  const __m256i       lut_roll =
+    _mm256_setr_epi8 (0, 16, 19, 4, -65, -65, -71, -71,
+                      0, 0, 0, 0, 0, 0, 0, 0,
+                      0, 16, 19, 4, -65, -65, -71, -71,
+                      0, 0, 0, 0, 0, 0, 0, 0);
+  const __m256i       mask_2f = _mm256_set1_epi8 (0x2f);
+  const __m256i       pack =
+    _mm256_setr_epi8 (2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                      2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+  size_t              done = 0;
+  __m256i             str, hi_nibbles, lo_nibbles, hi, lo, eq_2f, roll;
+
+  /* the store writes 8 bytes beyond the 24 produced */
+  while (length - done >= 32) {
+    str = _mm256_loadu_si256 ((const __m256i *) (in + done));
+    hi_nibbles = _mm256_and_si256 (_mm256_srli_epi32 (str, 4), mask_2f);
+    lo_nibbles = _mm256_and_si256 (str, mask_2f);
+    hi = _mm256_shuffle_epi8 (lut_hi, hi_nibbles);
+    lo = _mm256_shuffle_epi8 (lut_lo, lo_nibbles);
+    if (!_mm256_testz_si256 (lo, hi)) {
+      break;
+    }
+    eq_2f = _mm256_cmpeq_epi8 (str, mask_2f);
+    roll = _mm256_shuffle_epi8 (lut_roll, _mm256_add_epi8 (eq_2f, hi_nibbles));
+    str = _mm256_add_epi8 (str, roll);
+    str = _mm256_maddubs_epi16 (str, _mm256_set1_epi32 (0x01400140));
+    str = _mm256_madd_epi16 (str, _mm256_set1_epi32 (0x00011000));
+    str = _mm256_shuffle_epi8 (str, pack);
+    str = _mm256_permutevar8x32_epi32 (str, _mm256_setr_epi32 (0, 1, 2, 4, 5,
+                                                               6, 7, 7));
+    _mm256_storeu_si256 ((__m256i *) out, str);
+    done += 32;
+    out += 24;
+  }
+  return done + base64_decode_ssse3 (in + done, length - done, out);
+}
+
+size_t
+base64_encode_simd (const char *plaintext_in, size_t length_in,
+                    char *code_out)
+{
+  switch (base64_simd_level ()) {
+  case BASE64_LEVEL_AVX2:
+    return base64_encode_avx2 (plaintext_in, length_in, code_out);
+  case BASE64_LEVEL_SSSE3:
+    return base64_encode_ssse3 (plaintext_in, length_in, code_out);
+  default:
+    return 0;
+  }
+}
+
+size_t
+base64_decode_simd (const char *code_in, size_t length_in,
+                    char *plaintext_out)
+{
+  switch (base64_simd_level ()) {
+  case BASE64_LEVEL_AVX2:
+    return base64_decode_avx2 (code_in, length_in, plaintext_out);
+  case BASE64_LEVEL_SSSE3:
+    return base64_decode_ssse3 (code_in, length_in, plaintext_out);
+  default:
+    return 0;
+  }
+}
+
+#endif /* BASE64_SIMD */
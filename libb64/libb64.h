@@ -7,6 +7,59 @@
 
 #include <stdlib.h>
 
+/* CB: vectorized kernels for x86 compilers with function multiversioning */
+#if !defined SC_BASE64_WRAP && defined __GNUC__ && \
+  (defined __x86_64__ || defined __i386__)
+#define BASE64_SIMD
+#endif
+
+#ifdef __cplusplus
+extern              "C"
+{
+#if 0
+}
+#endif
+#endif
+
+/** Boolean to use SIMD instructions if the CPU supports them.
+ * Initialized to 1 and documented in sc_io.h.
+ */
+extern int          sc_io_base64_simd;
+
+#ifdef BASE64_SIMD
+
+/** Encode as many whole groups of 3 bytes as the vector kernels handle.
+ * \param [in] plaintext_in     Data to be base64 encoded.
+ * \param [in] length_in        Length of plaintext_in in bytes.
+ * \param [out] code_out        Receives 4 code bytes per 3 bytes consumed.
+ * \return                      Number of bytes consumed, a multiple of 3.
+ *                              Zero if no SIMD instructions are available.
+ */
+size_t              base64_encode_simd (const char *plaintext_in,
+                                        size_t length_in, char *code_out);
+
+/** Decode as many valid groups of 4 characters as the vector kernels handle.
+ * Stops before the first block that contains a character outside of the
+ * base64 alphabet, which includes padding and white space.
+ * \param [in] code_in          Data in base64 encoding.
+ * \param [in] length_in        Length of code_in in bytes.
+ * \param [out] plaintext_out   Memory of at least length_in bytes.
+ *                              Receives 3 bytes per 4 characters consumed.
+ * \return                      Number of characters consumed.
+ */
+size_t              base64_decode_simd (const char *code_in,
+                                        size_t length_in,
+                                        char *plaintext_out);
+
+#endif /* BASE64_SIMD */
+
+#ifdef __cplusplus
+#if 0
+{
+#endif
+}
+#endif
+
 /*
 cdecode.h - c header for a base64 decoding algorithm
 
@@ -1647,6 +1647,16 @@ sc_have_zlib (void)
 #endif
 }
 
+int
+sc_have_lz4 (void)
+{
+#ifndef SC_HAVE_LZ4
+  return 0;
+#else
+  return 1;
+#endif
+}
+
 int
 sc_have_json (void)
 {
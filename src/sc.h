@@ -949,6 +949,13 @@ int                 sc_version_point (void);
  */
 int                 sc_have_zlib (void);
 
+/** Return a boolean indicating whether LZ4 has been configured.
+ * Without it, the LZ codec of \ref sc_io_encode_raw runs in-tree code.
+ * \return          True if LZ4 has been found on running configure
+ *                  or respectively on calling cmake.
+ */
+int                 sc_have_lz4 (void);
+
 /** Return whether we have found a JSON library at configure time.
  * \return          True if and only if SC_HAVE_JSON is defined.
  */
@@ -159,9 +159,328 @@ sc_allgather (void *sendbuf, int sendcount, sc_MPI_Datatype sendtype,
   mpiret = sc_MPI_Comm_rank (mpicomm, &mpirank);
   SC_CHECK_MPI (mpiret);
 
+  if (mpisize >= SC_ALLGATHERV_NODE_MIN) {
+    sc_MPI_Comm         intranode, internode;
+
+    sc_mpi_comm_get_node_comms (mpicomm, &intranode, &internode);
+    if (intranode != sc_MPI_COMM_NULL && internode != sc_MPI_COMM_NULL) {
+      return sc_allgather_node (sendbuf, sendcount, sendtype,
+                                recvbuf, recvcount, recvtype, mpicomm);
+    }
+  }
+
   memcpy (((char *) recvbuf) + mpirank * datasize, sendbuf, datasize);
   sc_allgather_recursive (mpicomm, (char *) recvbuf, (int) datasize,
                           mpisize, mpirank, mpirank);
 
   return sc_MPI_SUCCESS;
 }
+
+int
+sc_allgather_node (void *sendbuf, int sendcount, sc_MPI_Datatype sendtype,
+                   void *recvbuf, int recvcount, sc_MPI_Datatype recvtype,
+                   sc_MPI_Comm mpicomm)
+{
+  int                 mpiret;
+  int                 mpisize;
+  int                 mpirank;
+  int                 i;
+  int                *sizes, *offsets;
+  size_t              datasize;
+  sc_MPI_Comm         intranode, internode;
+
+  SC_ASSERT (sendcount >= 0 && recvcount >= 0);
+
+  /* *INDENT-OFF* HORRIBLE indent bug */
+  datasize = (size_t) sendcount * sc_mpi_sizeof (sendtype);
+  SC_ASSERT (datasize == (size_t) recvcount * sc_mpi_sizeof (recvtype));
+  /* *INDENT-ON* */
+
+  mpiret = sc_MPI_Comm_size (mpicomm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (mpicomm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+
+  sc_mpi_comm_get_node_comms (mpicomm, &intranode, &internode);
+  if (intranode == sc_MPI_COMM_NULL || internode == sc_MPI_COMM_NULL) {
+    memcpy (((char *) recvbuf) + mpirank * datasize, sendbuf, datasize);
+    sc_allgather_recursive (mpicomm, (char *) recvbuf, (int) datasize,
+                            mpisize, mpirank, mpirank);
+    return sc_MPI_SUCCESS;
+  }
+
+  SC_ASSERT ((size_t) mpisize * datasize <= (size_t) INT_MAX);
+  sizes = SC_ALLOC (int, mpisize);
+  offsets = SC_ALLOC (int, mpisize);
+  for (i = 0; i < mpisize; ++i) {
+    sizes[i] = (int) datasize;
+    offsets[i] = i * (int) datasize;
+  }
+  sc_allgatherv_node (mpicomm, (const char *) sendbuf, (char *) recvbuf,
+                      sizes, offsets);
+  SC_FREE (offsets);
+  SC_FREE (sizes);
+
+  return sc_MPI_SUCCESS;
+}
+
+void
+sc_allgatherv_bruck (sc_MPI_Comm mpicomm, const char *senddata,
+                     char *recvdata, const int *sizes, const int *offsets)
+{
+  int                 mpiret;
+  int                 mpisize;
+  int                 mpirank;
+  int                 i, nblocks;
+  int                 dist, peer;
+  size_t             *rotoffs;
+  char               *rotdata;
+  sc_MPI_Request      request[2];
+
+  mpiret = sc_MPI_Comm_size (mpicomm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (mpicomm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+
+  /* the blocks are stored in the order mpirank, mpirank + 1, ... */
+  rotoffs = SC_ALLOC (size_t, mpisize + 1);
+  rotoffs[0] = 0;
+  for (i = 0; i < mpisize; ++i) {
+    SC_ASSERT (sizes[(mpirank + i) % mpisize] >= 0);
+    rotoffs[i + 1] = rotoffs[i] + (size_t) sizes[(mpirank + i) % mpisize];
+  }
+  rotdata = SC_ALLOC (char, rotoffs[mpisize]);
+  memcpy (rotdata, senddata, rotoffs[1]);
+
+  /* in each round we double the number of contiguous blocks we own */
+  for (dist = 1; dist < mpisize; dist *= 2) {
+    nblocks = SC_MIN (dist, mpisize - dist);
+
+    peer = (mpirank + dist) % mpisize;
+    SC_ASSERT (rotoffs[dist + nblocks] - rotoffs[dist] <= (size_t) INT_MAX);
+    mpiret = sc_MPI_Irecv (rotdata + rotoffs[dist],
+                           (int) (rotoffs[dist + nblocks] - rotoffs[dist]),
+                           sc_MPI_BYTE, peer, SC_TAG_AG_BRUCK, mpicomm,
+                           request + 0);
+    SC_CHECK_MPI (mpiret);
+
+    peer = (mpirank - dist + mpisize) % mpisize;
+    SC_ASSERT (rotoffs[nblocks] <= (size_t) INT_MAX);
+    mpiret = sc_MPI_Isend (rotdata, (int) rotoffs[nblocks], sc_MPI_BYTE,
+                           peer, SC_TAG_AG_BRUCK, mpicomm, request + 1);
+    SC_CHECK_MPI (mpiret);
+
+    mpiret = sc_MPI_Waitall (2, request, sc_MPI_STATUSES_IGNORE);
+    SC_CHECK_MPI (mpiret);
+  }
+
+  /* undo the rotation of the blocks */
+  for (i = 0; i < mpisize; ++i) {
+    peer = (mpirank + i) % mpisize;
+    memcpy (recvdata + offsets[peer], rotdata + rotoffs[i],
+            (size_t) sizes[peer]);
+  }
+
+  SC_FREE (rotdata);
+  SC_FREE (rotoffs);
+}
+
+void
+sc_allgatherv_node (sc_MPI_Comm mpicomm, const char *senddata,
+                    char *recvdata, const int *sizes, const int *offsets)
+{
+  int                 mpiret;
+  int                 mpisize;
+  int                 mpirank;
+  int                 intrasize, intrarank;
+  int                 intersize;
+  int                 i, j, k;
+  int                *members, *allmembers;
+  int                *nodesizes, *nodeoffsets;
+  int                *packoffsets;
+  int                *allsizes;
+  size_t              total;
+  char               *packed, *ordered;
+  sc_MPI_Comm         intranode, internode;
+
+  sc_mpi_comm_get_node_comms (mpicomm, &intranode, &internode);
+  if (intranode == sc_MPI_COMM_NULL || internode == sc_MPI_COMM_NULL) {
+    sc_allgatherv_bruck (mpicomm, senddata, recvdata, sizes, offsets);
+    return;
+  }
+
+  mpiret = sc_MPI_Comm_size (mpicomm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (mpicomm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_size (intranode, &intrasize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (intranode, &intrarank);
+  SC_CHECK_MPI (mpiret);
+
+  /* the ranks in the node are not necessarily contiguous */
+  members = SC_ALLOC (int, intrasize);
+  mpiret = sc_MPI_Allgather (&mpirank, 1, sc_MPI_INT,
+                             members, 1, sc_MPI_INT, intranode);
+  SC_CHECK_MPI (mpiret);
+
+  /* node leader gathers the data of its node */
+  packed = NULL;
+  packoffsets = NULL;
+  allsizes = NULL;
+  if (!intrarank) {
+    allsizes = SC_ALLOC (int, intrasize);
+    packoffsets = SC_ALLOC (int, intrasize + 1);
+    packoffsets[0] = 0;
+    for (j = 0; j < intrasize; ++j) {
+      allsizes[j] = sizes[members[j]];
+      packoffsets[j + 1] = packoffsets[j] + allsizes[j];
+    }
+    packed = SC_ALLOC (char, packoffsets[intrasize]);
+  }
+  mpiret = sc_MPI_Gatherv ((void *) senddata, sizes[mpirank], sc_MPI_BYTE,
+                           packed, allsizes, packoffsets, sc_MPI_BYTE, 0,
+                           intranode);
+  SC_CHECK_MPI (mpiret);
+
+  /* node leaders exchange data and place it in rank order */
+  total = 0;
+  for (i = 0; i < mpisize; ++i) {
+    total += (size_t) sizes[i];
+  }
+  SC_ASSERT (total <= (size_t) INT_MAX);
+  ordered = SC_ALLOC (char, total);
+  if (!intrarank) {
+    char               *allpacked;
+    int                *rankoffsets;
+
+    mpiret = sc_MPI_Comm_size (internode, &intersize);
+    SC_CHECK_MPI (mpiret);
+    SC_ASSERT (intersize * intrasize == mpisize);
+
+    /* all node communicators have the same size */
+    allmembers = SC_ALLOC (int, mpisize);
+    mpiret = sc_MPI_Allgather (members, intrasize, sc_MPI_INT,
+                               allmembers, intrasize, sc_MPI_INT, internode);
+    SC_CHECK_MPI (mpiret);
+
+    nodesizes = SC_ALLOC (int, intersize);
+    nodeoffsets = SC_ALLOC (int, intersize + 1);
+    nodeoffsets[0] = 0;
+    for (k = 0, i = 0; i < intersize; ++i) {
+      nodesizes[i] = 0;
+      for (j = 0; j < intrasize; ++j, ++k) {
+        nodesizes[i] += sizes[allmembers[k]];
+      }
+      nodeoffsets[i + 1] = nodeoffsets[i] + nodesizes[i];
+    }
+    SC_ASSERT ((size_t) nodeoffsets[intersize] == total);
+    allpacked = SC_ALLOC (char, total);
+    if (intersize * SC_ALLGATHERV_BRUCK_MAX >= (int) total) {
+      sc_allgatherv_bruck (internode, packed, allpacked,
+                           nodesizes, nodeoffsets);
+    }
+    else {
+      mpiret = sc_MPI_Allgatherv (packed, packoffsets[intrasize],
+                                  sc_MPI_BYTE, allpacked, nodesizes,
+                                  nodeoffsets, sc_MPI_BYTE, internode);
+      SC_CHECK_MPI (mpiret);
+    }
+
+    /* the ordered buffer is contiguous in rank order */
+    rankoffsets = SC_ALLOC (int, mpisize + 1);
+    rankoffsets[0] = 0;
+    for (i = 0; i < mpisize; ++i) {
+      rankoffsets[i + 1] = rankoffsets[i] + sizes[i];
+    }
+    for (k = 0, i = 0; i < intersize; ++i) {
+      size_t              pos = (size_t) nodeoffsets[i];
+
+      for (j = 0; j < intrasize; ++j, ++k) {
+        memcpy (ordered + rankoffsets[allmembers[k]], allpacked + pos,
+                (size_t) sizes[allmembers[k]]);
+        pos += (size_t) sizes[allmembers[k]];
+      }
+    }
+
+    SC_FREE (rankoffsets);
+    SC_FREE (allpacked);
+    SC_FREE (nodeoffsets);
+    SC_FREE (nodesizes);
+    SC_FREE (allmembers);
+    SC_FREE (packed);
+    SC_FREE (packoffsets);
+    SC_FREE (allsizes);
+  }
+  SC_FREE (members);
+
+  /* node leader broadcasts the result within its node */
+  mpiret = sc_MPI_Bcast (ordered, (int) total, sc_MPI_BYTE, 0, intranode);
+  SC_CHECK_MPI (mpiret);
+  for (k = 0, i = 0; i < mpisize; ++i) {
+    memcpy (recvdata + offsets[i], ordered + k, (size_t) sizes[i]);
+    k += sizes[i];
+  }
+  SC_FREE (ordered);
+}
+
+int
+sc_allgatherv (void *sendbuf, int sendcount, sc_MPI_Datatype sendtype,
+               void *recvbuf, int *recvcounts, int *displs,
+               sc_MPI_Datatype recvtype, sc_MPI_Comm mpicomm)
+{
+  int                 mpiret;
+  int                 mpisize;
+  int                 mpirank;
+  int                 i;
+  int                *sizes, *offsets;
+  size_t              typesize, total;
+  sc_MPI_Comm         intranode, internode;
+
+  SC_ASSERT (sendcount >= 0);
+
+  mpiret = sc_MPI_Comm_size (mpicomm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (mpicomm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+
+  /* *INDENT-OFF* HORRIBLE indent bug */
+  typesize = sc_mpi_sizeof (recvtype);
+  SC_ASSERT ((size_t) sendcount * sc_mpi_sizeof (sendtype) ==
+             (size_t) recvcounts[mpirank] * typesize);
+  /* *INDENT-ON* */
+
+  /* convert counts and displacements into bytes */
+  total = 0;
+  sizes = SC_ALLOC (int, mpisize);
+  offsets = SC_ALLOC (int, mpisize);
+  for (i = 0; i < mpisize; ++i) {
+    SC_ASSERT (recvcounts[i] >= 0 && displs[i] >= 0);
+    SC_ASSERT ((size_t) (displs[i] + recvcounts[i]) * typesize <=
+               (size_t) INT_MAX);
+    sizes[i] = (int) (recvcounts[i] * typesize);
+    offsets[i] = (int) (displs[i] * typesize);
+    total += (size_t) sizes[i];
+  }
+
+  sc_mpi_comm_get_node_comms (mpicomm, &intranode, &internode);
+  if (mpisize >= SC_ALLGATHERV_NODE_MIN &&
+      intranode != sc_MPI_COMM_NULL && internode != sc_MPI_COMM_NULL) {
+    sc_allgatherv_node (mpicomm, (const char *) sendbuf, (char *) recvbuf,
+                        sizes, offsets);
+  }
+  else if (total <= (size_t) mpisize * SC_ALLGATHERV_BRUCK_MAX) {
+    sc_allgatherv_bruck (mpicomm, (const char *) sendbuf, (char *) recvbuf,
+                         sizes, offsets);
+  }
+  else {
+    mpiret = sc_MPI_Allgatherv (sendbuf, sendcount, sendtype, recvbuf,
+                                recvcounts, displs, recvtype, mpicomm);
+    SC_CHECK_MPI (mpiret);
+  }
+
+  SC_FREE (offsets);
+  SC_FREE (sizes);
+
+  return sc_MPI_SUCCESS;
+}
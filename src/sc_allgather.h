@@ -22,11 +22,15 @@
 */
 
 /** \file sc_allgather.h
- * Self-contained implementation of MPI_Allgather.
+ * Self-contained implementation of MPI_Allgather and MPI_Allgatherv.
  *
- * The algorithm uses a binary communication tree.
+ * The allgather algorithm uses a binary communication tree.
  * The recursion terminates at a specified depth by an all-to-all step.
  *
+ * The allgatherv algorithm with varying counts per process chooses between
+ * the Bruck variant of recursive doubling for small messages, a node-aware
+ * scheme for large communicators, and the MPI implementation otherwise.
+ *
  * \ingroup sc_parallelism
  */
 
@@ -40,6 +44,20 @@
 #define SC_ALLGATHER_ALLTOALL_MAX   5
 #endif
 
+#ifndef SC_ALLGATHERV_BRUCK_MAX
+/** The largest average bytes per process that use \ref sc_allgatherv_bruck.
+ * Above this size, \ref sc_allgatherv calls MPI_Allgatherv. */
+#define SC_ALLGATHERV_BRUCK_MAX     2048
+#endif
+
+#ifndef SC_ALLGATHERV_NODE_MIN
+/** The smallest communicator size that uses \ref sc_allgatherv_node
+ * in \ref sc_allgatherv and \ref sc_allgather_node in \ref sc_allgather.
+ * This only applies if node communicators are attached to the communicator,
+ * see \ref sc_mpi_comm_attach_node_comms. */
+#define SC_ALLGATHERV_NODE_MIN      64
+#endif
+
 SC_EXTERN_C_BEGIN;
 
 /** Allgather by direct point-to-point communication.
@@ -72,6 +90,9 @@ void                sc_allgather_recursive (sc_MPI_Comm mpicomm, char *data,
                                             int myoffset, int myrank);
 
 /** Drop-in allgather replacement.
+ * If node communicators are attached to \a mpicomm and its size is at least
+ * \ref SC_ALLGATHERV_NODE_MIN, we call \ref sc_allgather_node.
+ * Otherwise, we call \ref sc_allgather_recursive.
  * \param [in] sendbuf      Send buffer conforming to MPI specification.
  * \param [in] sendcount    Number of data items to send.
  * \param [in] sendtype     Valid MPI Datatype.
@@ -86,6 +107,82 @@ int                 sc_allgather (void *sendbuf, int sendcount,
                                   int recvcount, sc_MPI_Datatype recvtype,
                                   sc_MPI_Comm mpicomm);
 
+/** Node-aware allgather with one network participant per node.
+ * The data is gathered to the first process on each node, exchanged
+ * between these node leaders only, and broadcast within each node.
+ * This function requires that \ref sc_mpi_comm_attach_node_comms has
+ * been called on \a mpicomm; otherwise it calls \ref sc_allgather_recursive.
+ * The parameters are the same as for \ref sc_allgather.
+ * \param [in] sendbuf      Send buffer conforming to MPI specification.
+ * \param [in] sendcount    Number of data items to send.
+ * \param [in] sendtype     Valid MPI Datatype.
+ * \param [out] recvbuf     Receive buffer conforming to MPI specification.
+ * \param [in] recvcount    Number of data items to receive.
+ * \param [in] recvtype     Valid MPI Datatype.
+ * \param [in] mpicomm      Valid MPI communicator.
+ * \return int              sc_MPI_SUCCESS if not aborting on MPI error.
+ */
+int                 sc_allgather_node (void *sendbuf, int sendcount,
+                                       sc_MPI_Datatype sendtype,
+                                       void *recvbuf, int recvcount,
+                                       sc_MPI_Datatype recvtype,
+                                       sc_MPI_Comm mpicomm);
+
+/** Allgather with varying counts by the Bruck algorithm.
+ * It is a variant of recursive doubling that works for any number of
+ * processes and completes in ceil (log_2 (P)) communication rounds.
+ * It is efficient for small messages.
+ * \param [in] mpicomm      Valid MPI communicator.
+ * \param [in] senddata     Contribution of this process.
+ * \param [out] recvdata    Receive buffer.  The data of process p is
+ *                          written to \a recvdata + \a offsets[p].
+ * \param [in] sizes        Array of byte counts, one for each process.
+ * \param [in] offsets      Array of byte offsets, one for each process.
+ */
+void                sc_allgatherv_bruck (sc_MPI_Comm mpicomm,
+                                         const char *senddata,
+                                         char *recvdata, const int *sizes,
+                                         const int *offsets);
+
+/** Allgather with varying counts by a node-aware two-level scheme.
+ * The data is gathered to the first process on each node, exchanged
+ * between these node leaders only, and broadcast within each node.
+ * This function requires that \ref sc_mpi_comm_attach_node_comms has
+ * been called on \a mpicomm; otherwise it calls \ref sc_allgatherv_bruck.
+ * \param [in] mpicomm      Valid MPI communicator.
+ * \param [in] senddata     Contribution of this process.
+ * \param [out] recvdata    Receive buffer.  The data of process p is
+ *                          written to \a recvdata + \a offsets[p].
+ * \param [in] sizes        Array of byte counts, one for each process.
+ * \param [in] offsets      Array of byte offsets, one for each process.
+ */
+void                sc_allgatherv_node (sc_MPI_Comm mpicomm,
+                                        const char *senddata,
+                                        char *recvdata, const int *sizes,
+                                        const int *offsets);
+
+/** Drop-in allgatherv replacement.
+ * If node communicators are attached to \a mpicomm and its size is at least
+ * \ref SC_ALLGATHERV_NODE_MIN, we call \ref sc_allgatherv_node.
+ * Otherwise, if the average message size is at most
+ * \ref SC_ALLGATHERV_BRUCK_MAX bytes, we call \ref sc_allgatherv_bruck.
+ * Otherwise, we call MPI_Allgatherv.
+ * \param [in] sendbuf      Send buffer conforming to MPI specification.
+ * \param [in] sendcount    Number of data items to send.
+ * \param [in] sendtype     Valid MPI Datatype.
+ * \param [out] recvbuf     Receive buffer conforming to MPI specification.
+ * \param [in] recvcounts   Number of data items to receive per process.
+ * \param [in] displs       Displacement in items for each process.
+ * \param [in] recvtype     Valid MPI Datatype.
+ * \param [in] mpicomm      Valid MPI communicator.
+ * \return int              sc_MPI_SUCCESS if not aborting on MPI error.
+ */
+int                 sc_allgatherv (void *sendbuf, int sendcount,
+                                   sc_MPI_Datatype sendtype, void *recvbuf,
+                                   int *recvcounts, int *displs,
+                                   sc_MPI_Datatype recvtype,
+                                   sc_MPI_Comm mpicomm);
+
 SC_EXTERN_C_END;
 
 #endif /* !SC_ALLGATHER_H */
@@ -0,0 +1,445 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+#include <sc_checksum.h>
+#ifdef SC_ENABLE_PTHREAD
+#include <pthread.h>
+#endif
+
+/* vectorized kernels for x86 compilers with function multiversioning */
+#if defined __GNUC__ && (defined __x86_64__ || defined __i386__)
+#define SC_CHECKSUM_X86
+#include <immintrin.h>
+#endif
+
+#define SC_ADLER32_BASE 65521   /**< largest prime below 2^16 */
+#define SC_ADLER32_NMAX 5552    /**< max bytes before 32 bit overflow */
+#define SC_CRC32C_POLY 0x82F63B78U      /**< reflected Castagnoli */
+#define SC_CRC32C_X2N 67        /**< powers for shifts up to 2^64 bytes */
+
+int                 sc_checksum_simd = 1;
+
+/* tables for slice-by-8 and for combining; filled once on first use,
+   which may happen in several threads at the same time */
+#ifdef SC_ENABLE_PTHREAD
+static pthread_once_t sc_crc32c_once = PTHREAD_ONCE_INIT;
+#else
+static int          sc_crc32c_ready = 0;
+#endif
+static uint32_t     sc_crc32c_table[8][256];
+static uint32_t     sc_crc32c_x2n[SC_CRC32C_X2N];
+
+#ifdef SC_CHECKSUM_X86
+
+/* bit flags of the instruction sets found at run time */
+#define SC_CHECKSUM_SSSE3  1
+#define SC_CHECKSUM_SSE42  2
+
+static int          sc_checksum_flags = -1;
+#ifdef SC_ENABLE_PTHREAD
+static pthread_once_t sc_checksum_cpu_once = PTHREAD_ONCE_INIT;
+#endif
+
+static void
+sc_checksum_cpu_detect (void)
+{
+  int                 detect = 0;
+
+  __builtin_cpu_init ();
+  if (__builtin_cpu_supports ("ssse3")) {
+    detect |= SC_CHECKSUM_SSSE3;
+  }
+  if (__builtin_cpu_supports ("sse4.2")) {
+    detect |= SC_CHECKSUM_SSE42;
+  }
+  sc_checksum_flags = detect;
+}
+
+static int
+sc_checksum_cpu (void)
+{
+#ifdef SC_ENABLE_PTHREAD
+  int                 pth;
+
+  pth = pthread_once (&sc_checksum_cpu_once, sc_checksum_cpu_detect);
+  SC_CHECK_ABORT (pth == 0, "pthread_once for checksum CPU detection");
+#else
+  if (sc_checksum_flags < 0) {
+    sc_checksum_cpu_detect ();
+  }
+#endif
+  return sc_checksum_simd ? sc_checksum_flags : 0;
+}
+
+/* sum the four 32 bit lanes of a vector */
+__attribute__ ((target ("ssse3")))
+static uint32_t
+sc_checksum_hsum (__m128i v)
+{
+  v = _mm_add_epi32 (v, _mm_shuffle_epi32 (v, _MM_SHUFFLE (2, 3, 0, 1)));
+  v = _mm_add_epi32 (v, _mm_shuffle_epi32 (v, _MM_SHUFFLE (1, 0, 3, 2)));
+  return (uint32_t) _mm_cvtsi128_si32 (v);
+}
+
+/* Adler-32 of 32 byte blocks: the sum of the bytes is accumulated with
+ * sad, the weighted sum with pmaddubsw by the byte positions 32 to 1,
+ * and the first sum entering the second once per block is deferred */
+__attribute__ ((target ("ssse3")))
+static uint32_t
+sc_adler32_ssse3 (uint32_t adler, const unsigned char *p, size_t blocks)
+{
+  uint32_t            s1 = adler & 0xFFFF;
+  uint32_t            s2 = adler >> 16;
+  size_t              n;
+  const __m128i       tap1 = _mm_setr_epi8 (32, 31, 30, 29, 28, 27, 26, 25,
+                                            24, 23, 22, 21, 20, 19, 18, 17);
+  const __m128i       tap2 = _mm_setr_epi8 (16, 15, 14, 13, 12, 11, 10, 9,
+                                            8, 7, 6, 5, 4, 3, 2, 1);
+  const __m128i       zero = _mm_setzero_si128 ();
+  const __m128i       ones = _mm_set1_epi16 (1);
+
+  while (blocks > 0) {
+    __m128i             vps, vs1, vs2;
+
+    n = SC_MIN (blocks, SC_ADLER32_NMAX / 32);
+    blocks -= n;
+    vps = _mm_set_epi32 (0, 0, 0, (int) (s1 * n));
+    vs2 = _mm_set_epi32 (0, 0, 0, (int) s2);
+    vs1 = _mm_setzero_si128 ();
+    do {
+      const __m128i       b1 = _mm_loadu_si128 ((const __m128i *) p);
+      const __m128i       b2 = _mm_loadu_si128 ((const __m128i *) (p + 16));
+
+      vps = _mm_add_epi32 (vps, vs1);
+      vs1 = _mm_add_epi32 (vs1, _mm_sad_epu8 (b1, zero));
+      vs2 = _mm_add_epi32 (vs2, _mm_madd_epi16
+                           (_mm_maddubs_epi16 (b1, tap1), ones));
+      vs1 = _mm_add_epi32 (vs1, _mm_sad_epu8 (b2, zero));
+      vs2 = _mm_add_epi32 (vs2, _mm_madd_epi16
+                           (_mm_maddubs_epi16 (b2, tap2), ones));
+      p += 32;
+    }
+    while (--n > 0);
+    vs2 = _mm_add_epi32 (vs2, _mm_slli_epi32 (vps, 5));
+    s1 = (s1 + sc_checksum_hsum (vs1)) % SC_ADLER32_BASE;
+    s2 = sc_checksum_hsum (vs2) % SC_ADLER32_BASE;
+  }
+  return s1 | (s2 << 16);
+}
+
+/* CRC-32C by the crc32 instruction, one machine word at a time */
+__attribute__ ((target ("sse4.2")))
+static uint32_t
+sc_crc32c_sse42 (uint32_t crc, const unsigned char *p, size_t len)
+{
+  crc = ~crc;
+  for (; len > 0 && ((size_t) p & 7) != 0; --len) {
+    crc = _mm_crc32_u8 (crc, *p++);
+  }
+#ifdef __x86_64__
+  {
+    uint64_t            c = crc;
+    uint64_t            w;
+
+    for (; len >= 8; len -= 8, p += 8) {
+      memcpy (&w, p, 8);
+      c = _mm_crc32_u64 (c, w);
+    }
+    crc = (uint32_t) c;
+  }
+#else
+  {
+    uint32_t            w;
+
+    for (; len >= 4; len -= 4, p += 4) {
+      memcpy (&w, p, 4);
+      crc = _mm_crc32_u32 (crc, w);
+    }
+  }
+#endif
+  for (; len > 0; --len) {
+    crc = _mm_crc32_u8 (crc, *p++);
+  }
+  return ~crc;
+}
+
+#endif /* SC_CHECKSUM_X86 */
+
+/* portable Adler-32, reducing modulo the base once per NMAX bytes */
+static uint32_t
+sc_adler32_scalar (uint32_t adler, const unsigned char *p, size_t len)
+{
+  int                 k;
+  uint32_t            s1 = adler & 0xFFFF;
+  uint32_t            s2 = adler >> 16;
+  size_t              n;
+
+  while (len > 0) {
+    n = SC_MIN (len, SC_ADLER32_NMAX);
+    len -= n;
+    for (; n >= 16; n -= 16, p += 16) {
+      for (k = 0; k < 16; ++k) {
+        s1 += p[k];
+        s2 += s1;
+      }
+    }
+    for (; n > 0; --n) {
+      s1 += *p++;
+      s2 += s1;
+    }
+    s1 %= SC_ADLER32_BASE;
+    s2 %= SC_ADLER32_BASE;
+  }
+  return s1 | (s2 << 16);
+}
+
+uint32_t
+sc_adler32 (uint32_t adler, const void *data, size_t len)
+{
+  const unsigned char *p = (const unsigned char *) data;
+
+  if (data == NULL) {
+    return 1;
+  }
+#ifdef SC_CHECKSUM_X86
+  if (len >= 64 && (sc_checksum_cpu () & SC_CHECKSUM_SSSE3)) {
+    adler = sc_adler32_ssse3 (adler, p, len / 32);
+    p += len & ~(size_t) 31;
+    len &= 31;
+  }
+#endif
+  return sc_adler32_scalar (adler, p, len);
+}
+
+uint32_t
+sc_adler32_combine (uint32_t adler1, uint32_t adler2, size_t len2)
+{
+  const uint64_t      rem = (uint64_t) (len2 % SC_ADLER32_BASE);
+  const uint64_t      a1 = adler1 & 0xFFFF;
+  uint64_t            s1, s2;
+
+  /* the bytes of the first piece enter the second sum len2 more times */
+  s1 = (a1 + (adler2 & 0xFFFF) + SC_ADLER32_BASE - 1) % SC_ADLER32_BASE;
+  s2 = ((adler1 >> 16) + (adler2 >> 16) + rem * a1 +
+        SC_ADLER32_BASE - rem) % SC_ADLER32_BASE;
+  return (uint32_t) (s1 | (s2 << 16));
+}
+
+/* multiply two polynomials modulo the CRC polynomial, in reflected order */
+static uint32_t
+sc_crc32c_multmodp (uint32_t a, uint32_t b)
+{
+  uint32_t            m = (uint32_t) 1 << 31;
+  uint32_t            p = 0;
+
+  for (;;) {
+    if (a & m) {
+      p ^= b;
+      if ((a & (m - 1)) == 0) {
+        break;
+      }
+    }
+    m >>= 1;
+    b = (b & 1) ? (b >> 1) ^ SC_CRC32C_POLY : b >> 1;
+  }
+  return p;
+}
+
+static void
+sc_crc32c_build (void)
+{
+  int                 k, n;
+  uint32_t            c;
+
+  for (n = 0; n < 256; ++n) {
+    c = (uint32_t) n;
+    for (k = 0; k < 8; ++k) {
+      c = (c & 1) ? (c >> 1) ^ SC_CRC32C_POLY : c >> 1;
+    }
+    sc_crc32c_table[0][n] = c;
+  }
+  for (n = 0; n < 256; ++n) {
+    c = sc_crc32c_table[0][n];
+    for (k = 1; k < 8; ++k) {
+      c = sc_crc32c_table[0][c & 0xFF] ^ (c >> 8);
+      sc_crc32c_table[k][n] = c;
+    }
+  }
+
+  /* x^(2^k) modulo the polynomial, starting from x^1; unlike for the
+     zlib polynomial, the powers do not repeat with a period of 32 */
+  c = (uint32_t) 1 << 30;
+  sc_crc32c_x2n[0] = c;
+  for (k = 1; k < SC_CRC32C_X2N; ++k) {
+    c = sc_crc32c_multmodp (c, c);
+    sc_crc32c_x2n[k] = c;
+  }
+}
+
+static void
+sc_crc32c_init (void)
+{
+#ifdef SC_ENABLE_PTHREAD
+  int                 pth;
+
+  /* no thread reads the tables before they are complete */
+  pth = pthread_once (&sc_crc32c_once, sc_crc32c_build);
+  SC_CHECK_ABORT (pth == 0, "pthread_once for CRC-32C tables");
+#else
+  if (!sc_crc32c_ready) {
+    sc_crc32c_build ();
+    sc_crc32c_ready = 1;
+  }
+#endif
+}
+
+/* portable CRC-32C processing eight bytes per table lookup round */
+static uint32_t
+sc_crc32c_slice8 (uint32_t crc, const unsigned char *p, size_t len)
+{
+  uint32_t            w1, w2;
+  uint32_t            (*t)[256] = sc_crc32c_table;
+
+  crc = ~crc;
+  for (; len > 0 && ((size_t) p & 7) != 0; --len) {
+    crc = t[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+  }
+  for (; len >= 8; len -= 8, p += 8) {
+    w1 = crc ^ ((uint32_t) p[0] | (uint32_t) p[1] << 8 |
+                (uint32_t) p[2] << 16 | (uint32_t) p[3] << 24);
+    w2 = ((uint32_t) p[4] | (uint32_t) p[5] << 8 |
+          (uint32_t) p[6] << 16 | (uint32_t) p[7] << 24);
+    crc = t[7][w1 & 0xFF] ^ t[6][(w1 >> 8) & 0xFF] ^
+      t[5][(w1 >> 16) & 0xFF] ^ t[4][w1 >> 24] ^
+      t[3][w2 & 0xFF] ^ t[2][(w2 >> 8) & 0xFF] ^
+      t[1][(w2 >> 16) & 0xFF] ^ t[0][w2 >> 24];
+  }
+  for (; len > 0; --len) {
+    crc = t[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
+uint32_t
+sc_crc32c (uint32_t crc, const void *data, size_t len)
+{
+  if (data == NULL) {
+    return 0;
+  }
+#ifdef SC_CHECKSUM_X86
+  if (sc_checksum_cpu () & SC_CHECKSUM_SSE42) {
+    return sc_crc32c_sse42 (crc, (const unsigned char *) data, len);
+  }
+#endif
+  sc_crc32c_init ();
+  return sc_crc32c_slice8 (crc, (const unsigned char *) data, len);
+}
+
+/* append len zero bytes to the message underlying crc, without the
+ * pre- and post-conditioning, which cancel when combining */
+static uint32_t
+sc_crc32c_shift (uint32_t crc, uint64_t len)
+{
+  int                 k;
+  uint32_t            p = (uint32_t) 1 << 31;
+
+  sc_crc32c_init ();
+
+  /* multiply x^(8 len) from the powers x^(2^k) */
+  for (k = 3; len > 0; len >>= 1, ++k) {
+    SC_ASSERT (k < SC_CRC32C_X2N);
+    if (len & 1) {
+      p = sc_crc32c_multmodp (sc_crc32c_x2n[k], p);
+    }
+  }
+  return sc_crc32c_multmodp (p, crc);
+}
+
+uint32_t
+sc_crc32c_combine (uint32_t crc1, uint32_t crc2, size_t len2)
+{
+  return sc_crc32c_shift (crc1, (uint64_t) len2) ^ crc2;
+}
+
+/* the byte counts of all pieces after this rank's and of all pieces */
+static void
+sc_checksum_positions (size_t len, sc_MPI_Comm mpicomm,
+                       uint64_t *after, uint64_t *total)
+{
+  int                 mpiret;
+  long long           local, upto, all;
+
+  local = (long long) len;
+  mpiret = sc_MPI_Scan (&local, &upto, 1, sc_MPI_LONG_LONG_INT,
+                        sc_MPI_SUM, mpicomm);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Allreduce (&local, &all, 1, sc_MPI_LONG_LONG_INT,
+                             sc_MPI_SUM, mpicomm);
+  SC_CHECK_MPI (mpiret);
+
+  *after = (uint64_t) (all - upto);
+  *total = (uint64_t) all;
+}
+
+uint32_t
+sc_adler32_allreduce (uint32_t adler, size_t len, sc_MPI_Comm mpicomm)
+{
+  int                 mpiret;
+  uint64_t            after, total, a1;
+  long long           terms[2], sums[2];
+
+  sc_checksum_positions (len, mpicomm, &after, &total);
+
+  /* With a_r and b_r the sums of piece r, the global first sum is
+   * 1 + sum_r (a_r - 1) and the global second sum is
+   * N + sum_r (b_r - len_r + after_r (a_r - 1)), all modulo the base. */
+  a1 = ((adler & 0xFFFF) + SC_ADLER32_BASE - 1) % SC_ADLER32_BASE;
+  terms[0] = (long long) a1;
+  terms[1] = (long long)
+    (((adler >> 16) + SC_ADLER32_BASE - len % SC_ADLER32_BASE +
+      (after % SC_ADLER32_BASE) * a1) % SC_ADLER32_BASE);
+  mpiret = sc_MPI_Allreduce (terms, sums, 2, sc_MPI_LONG_LONG_INT,
+                             sc_MPI_SUM, mpicomm);
+  SC_CHECK_MPI (mpiret);
+
+  return (uint32_t) ((1 + (uint64_t) sums[0]) % SC_ADLER32_BASE) |
+    (uint32_t) (((total + (uint64_t) sums[1]) % SC_ADLER32_BASE) << 16);
+}
+
+uint32_t
+sc_crc32c_allreduce (uint32_t crc, size_t len, sc_MPI_Comm mpicomm)
+{
+  int                 mpiret;
+  uint64_t            after, total;
+  unsigned int        shifted, result;
+
+  sc_checksum_positions (len, mpicomm, &after, &total);
+
+  /* the global checksum is the xor of the pieces' shifted checksums */
+  shifted = (unsigned int) sc_crc32c_shift (crc, after);
+  mpiret = sc_MPI_Allreduce (&shifted, &result, 1, sc_MPI_UNSIGNED,
+                             sc_MPI_BXOR, mpicomm);
+  SC_CHECK_MPI (mpiret);
+
+  return (uint32_t) result;
+}
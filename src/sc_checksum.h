@@ -0,0 +1,118 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+/** \file sc_checksum.h
+ * Adler-32 and CRC-32C checksums that do not depend on zlib.
+ *
+ * The Adler-32 checksum is the one of RFC 1950 and agrees with zlib's
+ * adler32.  The CRC-32C uses the Castagnoli polynomial as in iSCSI and
+ * ext4.  On x86 CPUs the functions use SSSE3 and SSE4.2 instructions,
+ * respectively, if they are available at run time.  Otherwise they fall
+ * back to portable blocked and table-driven code.
+ *
+ * Both checksums can be combined from the checksums of consecutive pieces.
+ * This allows to checksum data in threads or, with the allreduce functions,
+ * to checksum data that is distributed in rank order over an MPI
+ * communicator without gathering it.
+ *
+ * \ingroup sc
+ */
+
+#ifndef SC_CHECKSUM_H
+#define SC_CHECKSUM_H
+
+#include <sc.h>
+
+SC_EXTERN_C_BEGIN;
+
+/** Boolean to use SIMD instructions if the CPU supports them.
+ * Initialized to 1.  Setting it to 0 selects the portable code paths,
+ * which produce the same results and are useful for testing.
+ */
+extern int          sc_checksum_simd;
+
+/** Update an Adler-32 checksum with a piece of data.
+ * \param [in] adler    The checksum of the data so far, 1 initially.
+ * \param [in] data     Data of \a len bytes.
+ *                      If NULL, the function returns the initial value 1.
+ * \param [in] len      Byte count of \a data.
+ * \return              The checksum of the data so far followed by \a data.
+ */
+uint32_t            sc_adler32 (uint32_t adler, const void *data,
+                                size_t len);
+
+/** Combine the Adler-32 checksums of two consecutive pieces of data.
+ * \param [in] adler1   The checksum of the first piece.
+ * \param [in] adler2   The checksum of the second piece.
+ * \param [in] len2     The byte count of the second piece.
+ * \return              The checksum of both pieces concatenated.
+ */
+uint32_t            sc_adler32_combine (uint32_t adler1, uint32_t adler2,
+                                        size_t len2);
+
+/** Update a CRC-32C checksum with a piece of data.
+ * \param [in] crc      The checksum of the data so far, 0 initially.
+ * \param [in] data     Data of \a len bytes.
+ *                      If NULL, the function returns the initial value 0.
+ * \param [in] len      Byte count of \a data.
+ * \return              The checksum of the data so far followed by \a data.
+ */
+uint32_t            sc_crc32c (uint32_t crc, const void *data, size_t len);
+
+/** Combine the CRC-32C checksums of two consecutive pieces of data.
+ * The cost is logarithmic in \a len2.
+ * \param [in] crc1     The checksum of the first piece.
+ * \param [in] crc2     The checksum of the second piece.
+ * \param [in] len2     The byte count of the second piece.
+ * \return              The checksum of both pieces concatenated.
+ */
+uint32_t            sc_crc32c_combine (uint32_t crc1, uint32_t crc2,
+                                       size_t len2);
+
+/** Compute the Adler-32 checksum of data distributed in rank order.
+ * This function is collective and costs three reductions of one or two
+ * numbers each, independent of the size of the data.
+ * \param [in] adler    The checksum of the local piece of data.
+ * \param [in] len      Byte count of the local piece, may be 0.
+ * \param [in] mpicomm  The communicator that holds the data.
+ * \return              The checksum of the concatenation of all pieces
+ *                      by increasing rank, identical on all processes.
+ */
+uint32_t            sc_adler32_allreduce (uint32_t adler, size_t len,
+                                          sc_MPI_Comm mpicomm);
+
+/** Compute the CRC-32C checksum of data distributed in rank order.
+ * This function is collective and costs three reductions of one number
+ * each, independent of the size of the data.
+ * \param [in] crc      The checksum of the local piece of data.
+ * \param [in] len      Byte count of the local piece, may be 0.
+ * \param [in] mpicomm  The communicator that holds the data.
+ * \return              The checksum of the concatenation of all pieces
+ *                      by increasing rank, identical on all processes.
+ */
+uint32_t            sc_crc32c_allreduce (uint32_t crc, size_t len,
+                                         sc_MPI_Comm mpicomm);
+
+SC_EXTERN_C_END;
+
+#endif /* !SC_CHECKSUM_H */
@@ -22,9 +22,7 @@
 */
 
 #include <sc_containers.h>
-#ifdef SC_HAVE_ZLIB
-#include <zlib.h>
-#endif
+#include <sc_checksum.h>
 
 /* array routines */
 
@@ -638,25 +636,8 @@ sc_array_permute (sc_array_t * array, sc_array_t * newindices, int keepperm)
 unsigned int
 sc_array_checksum (sc_array_t * array)
 {
-#ifdef SC_HAVE_ZLIB
-  /* these types have sufficient size for adler32 */
-  unsigned int        crc;
-  size_t              bytes;
-
-  crc = adler32 (0, Z_NULL, 0);
-  if (array->elem_count == 0) {
-    return crc;
-  }
-
-  bytes = array->elem_count * array->elem_size;
-  crc = adler32 (crc, (const Bytef *) array->array, bytes);
-
-  return crc;
-#else
-  SC_ABORT ("Configure did not find a recent enough zlib.  Abort.\n");
-
-  return 0;
-#endif
+  return (unsigned int)
+    sc_adler32 (1, array->array, array->elem_count * array->elem_size);
 }
 
 size_t
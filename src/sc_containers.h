@@ -448,8 +448,9 @@ int                 sc_array_is_permutation (sc_array_t * array);
 void                sc_array_permute (sc_array_t * array,
                                       sc_array_t * newindices, int keepperm);
 
-/** Computes the adler32 checksum of array data (see zlib documentation).
+/** Computes the adler32 checksum of array data (see \ref sc_adler32).
  * This is a faster checksum than crc32, and it works with zeros as data.
+ * It agrees with zlib's adler32 but does not require zlib.
  */
 unsigned int        sc_array_checksum (sc_array_t * array);
 
@@ -0,0 +1,279 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+#include <sc_exchange.h>
+
+#if defined SC_ENABLE_MPI && MPI_VERSION >= 3
+#define SC_EXCHANGE_HAVE_NEIGHBOR
+#endif
+
+sc_exchange_type_t  sc_exchange_type_default = SC_EXCHANGE_NEIGHBOR;
+
+struct sc_exchange_s
+{
+  sc_MPI_Comm         mpicomm;
+  int                 mpirank;
+  sc_exchange_type_t  type;
+  int                 num_receivers, num_senders;
+  int                *receivers, *senders;
+  int                 self_receiver, self_sender;
+  sc_MPI_Request     *requests;
+#ifdef SC_EXCHANGE_HAVE_NEIGHBOR
+  MPI_Comm            neighcomm;
+  int                *sendcounts, *recvcounts;
+  MPI_Aint           *senddispls, *recvdispls;
+  MPI_Datatype       *bytetypes;
+#endif
+};
+
+/** Return the position of a rank in a list or -1 if not found. */
+static int
+sc_exchange_find (const int *ranks, int num_ranks, int rank)
+{
+  int                 i;
+
+  for (i = 0; i < num_ranks; ++i) {
+    if (ranks[i] == rank) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+sc_exchange_t      *
+sc_exchange_new (sc_MPI_Comm mpicomm, sc_array_t * receivers,
+                 sc_array_t * senders, sc_exchange_type_t type)
+{
+  int                 mpiret;
+  sc_exchange_t      *exc;
+
+  SC_ASSERT (receivers != NULL && receivers->elem_size == sizeof (int));
+  SC_ASSERT (senders != NULL && senders->elem_size == sizeof (int));
+  SC_ASSERT (-1 <= type && type < SC_EXCHANGE_NUM_TYPES);
+
+  exc = SC_ALLOC_ZERO (sc_exchange_t, 1);
+  exc->mpicomm = mpicomm;
+  mpiret = sc_MPI_Comm_rank (mpicomm, &exc->mpirank);
+  SC_CHECK_MPI (mpiret);
+
+  /* copy the pattern */
+  exc->num_receivers = (int) receivers->elem_count;
+  exc->num_senders = (int) senders->elem_count;
+  exc->receivers = SC_ALLOC (int, exc->num_receivers);
+  exc->senders = SC_ALLOC (int, exc->num_senders);
+  memcpy (exc->receivers, receivers->array,
+          exc->num_receivers * sizeof (int));
+  memcpy (exc->senders, senders->array, exc->num_senders * sizeof (int));
+  exc->self_receiver = sc_exchange_find (exc->receivers, exc->num_receivers,
+                                         exc->mpirank);
+  exc->self_sender = sc_exchange_find (exc->senders, exc->num_senders,
+                                       exc->mpirank);
+  SC_ASSERT ((exc->self_receiver < 0) == (exc->self_sender < 0));
+  exc->requests =
+    SC_ALLOC (sc_MPI_Request, exc->num_receivers + exc->num_senders);
+
+  if (type == SC_EXCHANGE_DEFAULT) {
+    type = sc_exchange_type_default;
+  }
+#ifdef SC_EXCHANGE_HAVE_NEIGHBOR
+  if (type == SC_EXCHANGE_NEIGHBOR) {
+    int                 i, nw;
+    int                *weights;
+
+    /* unit weights are equivalent to MPI_UNWEIGHTED, which some MPI
+       headers define as a pointer that compilers mistake for an array */
+    nw = SC_MAX (1, SC_MAX (exc->num_senders, exc->num_receivers));
+    weights = SC_ALLOC (int, nw);
+    for (i = 0; i < nw; ++i) {
+      weights[i] = 1;
+    }
+
+    /* the graph keeps the order of senders and receivers */
+    mpiret = MPI_Dist_graph_create_adjacent
+      (mpicomm, exc->num_senders, exc->senders, weights,
+       exc->num_receivers, exc->receivers, weights,
+       MPI_INFO_NULL, 0, &exc->neighcomm);
+    SC_CHECK_MPI (mpiret);
+    SC_FREE (weights);
+    exc->sendcounts = SC_ALLOC (int, exc->num_receivers);
+    exc->senddispls = SC_ALLOC (MPI_Aint, exc->num_receivers);
+    exc->recvcounts = SC_ALLOC (int, exc->num_senders);
+    exc->recvdispls = SC_ALLOC (MPI_Aint, exc->num_senders);
+
+    /* every message is a byte array, sent in and out of place */
+    exc->bytetypes = SC_ALLOC (MPI_Datatype, nw);
+    for (i = 0; i < nw; ++i) {
+      exc->bytetypes[i] = MPI_BYTE;
+    }
+  }
+#else
+  type = SC_EXCHANGE_P2P;
+#endif
+  exc->type = type;
+
+  return exc;
+}
+
+void
+sc_exchange_destroy (sc_exchange_t * exc)
+{
+#ifdef SC_EXCHANGE_HAVE_NEIGHBOR
+  if (exc->type == SC_EXCHANGE_NEIGHBOR) {
+    int                 mpiret;
+
+    mpiret = MPI_Comm_free (&exc->neighcomm);
+    SC_CHECK_MPI (mpiret);
+    SC_FREE (exc->sendcounts);
+    SC_FREE (exc->senddispls);
+    SC_FREE (exc->recvcounts);
+    SC_FREE (exc->recvdispls);
+    SC_FREE (exc->bytetypes);
+  }
+#endif
+  SC_FREE (exc->receivers);
+  SC_FREE (exc->senders);
+  SC_FREE (exc->requests);
+  SC_FREE (exc);
+}
+
+sc_exchange_type_t
+sc_exchange_get_type (sc_exchange_t * exc)
+{
+  return exc->type;
+}
+
+/** Return the byte size of a message buffer. */
+static int
+sc_exchange_bytes (sc_array_t * buffers, int i)
+{
+  sc_array_t         *a = (sc_array_t *) sc_array_index_int (buffers, i);
+  size_t              bytes = a->elem_count * a->elem_size;
+
+  SC_ASSERT (bytes <= (size_t) INT_MAX);
+  return (int) bytes;
+}
+
+/** Return the data of a message buffer. */
+static char        *
+sc_exchange_data (sc_array_t * buffers, int i)
+{
+  return ((sc_array_t *) sc_array_index_int (buffers, i))->array;
+}
+
+static void
+sc_exchange_execute_p2p (sc_exchange_t * exc,
+                         sc_array_t * sendbufs, sc_array_t * recvbufs)
+{
+  int                 i;
+  int                 mpiret;
+  int                 nreq;
+  sc_MPI_Request     *req = exc->requests;
+
+  /* post receives first to avoid unexpected messages */
+  nreq = 0;
+  for (i = 0; i < exc->num_senders; ++i) {
+    if (i != exc->self_sender) {
+      mpiret = sc_MPI_Irecv (sc_exchange_data (recvbufs, i),
+                             sc_exchange_bytes (recvbufs, i), sc_MPI_BYTE,
+                             exc->senders[i], SC_TAG_EXCHANGE,
+                             exc->mpicomm, req + nreq++);
+      SC_CHECK_MPI (mpiret);
+    }
+  }
+  for (i = 0; i < exc->num_receivers; ++i) {
+    if (i != exc->self_receiver) {
+      mpiret = sc_MPI_Isend (sc_exchange_data (sendbufs, i),
+                             sc_exchange_bytes (sendbufs, i), sc_MPI_BYTE,
+                             exc->receivers[i], SC_TAG_EXCHANGE,
+                             exc->mpicomm, req + nreq++);
+      SC_CHECK_MPI (mpiret);
+    }
+  }
+  if (exc->self_receiver >= 0) {
+    SC_ASSERT (sc_exchange_bytes (sendbufs, exc->self_receiver) ==
+               sc_exchange_bytes (recvbufs, exc->self_sender));
+    memcpy (sc_exchange_data (recvbufs, exc->self_sender),
+            sc_exchange_data (sendbufs, exc->self_receiver),
+            sc_exchange_bytes (sendbufs, exc->self_receiver));
+  }
+  mpiret = sc_MPI_Waitall (nreq, req, sc_MPI_STATUSES_IGNORE);
+  SC_CHECK_MPI (mpiret);
+}
+
+#ifdef SC_EXCHANGE_HAVE_NEIGHBOR
+
+/** Express all buffers by their absolute addresses.
+ * Relative to MPI_BOTTOM, buffers anywhere in memory are addressable
+ * without a common base that would have to be agreed on collectively.
+ */
+static void
+sc_exchange_addresses (sc_array_t * buffers, int num, int *counts,
+                       MPI_Aint * displs)
+{
+  int                 i;
+  int                 mpiret;
+
+  for (i = 0; i < num; ++i) {
+    counts[i] = sc_exchange_bytes (buffers, i);
+    if (counts[i] == 0) {
+      /* the data of empty buffers may be NULL */
+      displs[i] = 0;
+    }
+    else {
+      mpiret = MPI_Get_address (sc_exchange_data (buffers, i), &displs[i]);
+      SC_CHECK_MPI (mpiret);
+    }
+  }
+}
+
+#endif
+
+void
+sc_exchange_execute (sc_exchange_t * exc,
+                     sc_array_t * sendbufs, sc_array_t * recvbufs)
+{
+  SC_ASSERT (sendbufs != NULL && sendbufs->elem_size == sizeof (sc_array_t));
+  SC_ASSERT (recvbufs != NULL && recvbufs->elem_size == sizeof (sc_array_t));
+  SC_ASSERT ((int) sendbufs->elem_count == exc->num_receivers);
+  SC_ASSERT ((int) recvbufs->elem_count == exc->num_senders);
+
+#ifdef SC_EXCHANGE_HAVE_NEIGHBOR
+  if (exc->type == SC_EXCHANGE_NEIGHBOR) {
+    int                 mpiret;
+
+    /* the alltoallw variant takes the displacements as MPI_Aint */
+    sc_exchange_addresses (sendbufs, exc->num_receivers,
+                           exc->sendcounts, exc->senddispls);
+    sc_exchange_addresses (recvbufs, exc->num_senders,
+                           exc->recvcounts, exc->recvdispls);
+    mpiret = MPI_Neighbor_alltoallw
+      (MPI_BOTTOM, exc->sendcounts, exc->senddispls, exc->bytetypes,
+       MPI_BOTTOM, exc->recvcounts, exc->recvdispls, exc->bytetypes,
+       exc->neighcomm);
+    SC_CHECK_MPI (mpiret);
+    return;
+  }
+#endif
+
+  sc_exchange_execute_p2p (exc, sendbufs, recvbufs);
+}
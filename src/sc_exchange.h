@@ -0,0 +1,116 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+/** \file sc_exchange.h
+ * Repeated sparse data exchange with a fixed communication pattern.
+ *
+ * Once \ref sc_notify_ext or a related function has determined the ranks
+ * that send to us, applications typically exchange messages with the same
+ * partners many times, for example to update ghost data.  An \ref
+ * sc_exchange_t stores this pattern once and executes the exchange as often
+ * as needed.  It uses an MPI-3 neighborhood collective on a distributed
+ * graph communicator if available and a nonblocking point-to-point exchange
+ * otherwise.
+ *
+ * The messages are sent directly from and received directly into arrays
+ * provided by the caller, which may be views into larger arrays.
+ * No data is packed or copied except for a message to the own rank.
+ *
+ * \ingroup sc_parallelism
+ */
+
+#ifndef SC_EXCHANGE_H
+#define SC_EXCHANGE_H
+
+#include <sc_containers.h>
+
+SC_EXTERN_C_BEGIN;
+
+/** Opaque object that stores a communication pattern. */
+typedef struct sc_exchange_s sc_exchange_t;
+
+/** The implementations of the exchange. */
+typedef enum
+{
+  SC_EXCHANGE_DEFAULT = -1, /**< Choose sc_exchange_type_default. */
+  SC_EXCHANGE_P2P = 0,      /**< Nonblocking point-to-point messages. */
+  SC_EXCHANGE_NEIGHBOR,     /**< MPI-3 neighborhood collective.  Falls back
+                                 to \ref SC_EXCHANGE_P2P without MPI-3. */
+  SC_EXCHANGE_NUM_TYPES     /**< End of list marker. */
+}
+sc_exchange_type_t;
+
+/** The type used by \ref SC_EXCHANGE_DEFAULT; initialized to
+ * \ref SC_EXCHANGE_NEIGHBOR. */
+extern sc_exchange_type_t sc_exchange_type_default;
+
+/** Create an exchange object for a fixed communication pattern.
+ * This function is collective over \a mpicomm.
+ * \param [in] mpicomm      The communicator of the exchange.
+ *                          It must stay valid for the lifetime of the object.
+ * \param [in] receivers    Array of type int with the ranks we send to.
+ *                          The entries must be unique.
+ * \param [in] senders      Array of type int with the ranks we receive from,
+ *                          for example as computed by \ref sc_notify_ext.
+ *                          The entries must be unique.
+ * \param [in] type         The requested implementation.
+ * \return                  Exchange object to be destroyed with
+ *                          \ref sc_exchange_destroy.
+ */
+sc_exchange_t      *sc_exchange_new (sc_MPI_Comm mpicomm,
+                                     sc_array_t * receivers,
+                                     sc_array_t * senders,
+                                     sc_exchange_type_t type);
+
+/** Destroy an exchange object.
+ * \param [in,out] exc      This object is invalid after the call.
+ */
+void                sc_exchange_destroy (sc_exchange_t * exc);
+
+/** Return the implementation actually used.
+ * \param [in] exc          Valid exchange object.
+ * \return                  Either \ref SC_EXCHANGE_P2P or
+ *                          \ref SC_EXCHANGE_NEIGHBOR.
+ */
+sc_exchange_type_t  sc_exchange_get_type (sc_exchange_t * exc);
+
+/** Execute the exchange with the stored pattern.
+ * This function is collective over the communicator of the object.
+ * It may be called any number of times with changing data and sizes.
+ * \param [in] exc          Valid exchange object.
+ * \param [in] sendbufs     Array of \ref sc_array_t, one per receiver in the
+ *                          order given to \ref sc_exchange_new.  The bytes
+ *                          of each entry are sent without copying.  The
+ *                          entries may be views.
+ * \param [in,out] recvbufs Array of \ref sc_array_t, one per sender in the
+ *                          order given to \ref sc_exchange_new.  Each entry
+ *                          must have the byte size of the incoming message.
+ *                          The entries may be views.
+ */
+void                sc_exchange_execute (sc_exchange_t * exc,
+                                         sc_array_t * sendbufs,
+                                         sc_array_t * recvbufs);
+
+SC_EXTERN_C_END;
+
+#endif /* !SC_EXCHANGE_H */
@@ -0,0 +1,539 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+#include <sc_inflate.h>
+
+/* bits of the first level lookup of each table */
+#define SC_INFLATE_LITLEN_BITS 11
+#define SC_INFLATE_DIST_BITS 8
+#define SC_INFLATE_CODELEN_BITS 7
+
+/* every code longer than the first level gets at most one subtable */
+#define SC_INFLATE_LITLEN_SIZE ((1 << SC_INFLATE_LITLEN_BITS) + 288 * 16)
+#define SC_INFLATE_DIST_SIZE ((1 << SC_INFLATE_DIST_BITS) + 32 * 128)
+
+/* a table entry holds the code length in bits 0-7, the number of extra
+   bits or subtable bits in bits 8-11, its kind in bits 12-15, and a
+   literal, a pair of literals, a base value or a subtable offset above */
+#define SC_INFLATE_NBITS(e) ((e) & 0xFF)
+#define SC_INFLATE_EXTRA(e) (((e) >> 8) & 0xF)
+#define SC_INFLATE_KIND(e) (((e) >> 12) & 0xF)
+#define SC_INFLATE_VALUE(e) ((e) >> 16)
+#define SC_INFLATE_ENTRY(kind,extra,value) ((uint32_t) (kind) << 12 | \
+  (uint32_t) (extra) << 8 | (uint32_t) (value) << 16)
+
+/** The kinds of table entries.  Zero marks an unused code. */
+enum
+{
+  SC_INFLATE_INVALID,
+  SC_INFLATE_LITERAL,
+  SC_INFLATE_PAIR,
+  SC_INFLATE_BASE,
+  SC_INFLATE_END,
+  SC_INFLATE_SUBTABLE
+};
+
+/** Base lengths for the symbols 257..285. */
+static const uint16_t sc_inflate_len_base[29] = {
+  3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+  35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+
+/** Extra bits for the symbols 257..285. */
+static const uint8_t sc_inflate_len_extra[29] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+  3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+
+/** Base distances for the symbols 0..29. */
+static const uint16_t sc_inflate_dist_base[30] = {
+  1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+  257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+  8193, 12289, 16385, 24577
+};
+
+/** Extra bits for the distance symbols 0..29. */
+static const uint8_t sc_inflate_dist_extra[30] = {
+  0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+  7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+/** Order of the code length code lengths in a dynamic block header. */
+static const uint8_t sc_inflate_order[19] = {
+  16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+/** Lookup tables and code lengths of the current block. */
+typedef struct sc_inflate_tables
+{
+  uint32_t            litlen[SC_INFLATE_LITLEN_SIZE];
+  uint32_t            dist[SC_INFLATE_DIST_SIZE];
+  uint32_t            codelen[1 << SC_INFLATE_CODELEN_BITS];
+  uint8_t             lens[288 + 32];
+}
+sc_inflate_tables_t;
+
+/** Return the table entry of a literal/length symbol without its length. */
+static uint32_t
+sc_inflate_litlen_symbol (int s)
+{
+  if (s < 256) {
+    return SC_INFLATE_ENTRY (SC_INFLATE_LITERAL, 0, s);
+  }
+  if (s == 256) {
+    return SC_INFLATE_ENTRY (SC_INFLATE_END, 0, 0);
+  }
+  if (s < 286) {
+    return SC_INFLATE_ENTRY (SC_INFLATE_BASE, sc_inflate_len_extra[s - 257],
+                             sc_inflate_len_base[s - 257]);
+  }
+  return SC_INFLATE_ENTRY (SC_INFLATE_INVALID, 0, 0);
+}
+
+/** Return the table entry of a distance symbol without its length. */
+static uint32_t
+sc_inflate_dist_symbol (int s)
+{
+  if (s < 30) {
+    return SC_INFLATE_ENTRY (SC_INFLATE_BASE, sc_inflate_dist_extra[s],
+                             sc_inflate_dist_base[s]);
+  }
+  return SC_INFLATE_ENTRY (SC_INFLATE_INVALID, 0, 0);
+}
+
+/** Build a two-level lookup table for a canonical Huffman code.
+ * Since deflate sends codes starting with their most significant bit,
+ * the table is indexed by the bit-reversed code.  Unused codes of an
+ * incomplete code remain invalid entries.
+ * \param [out] table       Table of at least \a size entries.
+ * \param [in] root         Number of bits of the first level.
+ * \param [in] lens         Code length of each symbol, zero if unused.
+ * \param [in] num          Number of symbols.
+ * \param [in] symbol       Return the entry of a symbol without length.
+ * \return                  0 on success, -1 if the code is oversubscribed
+ *                          or is incomplete with more than one code.
+ */
+static int
+sc_inflate_build (uint32_t *table, int root, int size,
+                  const uint8_t *lens, int num, uint32_t (*symbol) (int))
+{
+  int                 s, len, max, left, used;
+  int                 i, step, sub, offset;
+  int                 count[16], next[16];
+  uint32_t            code, rev, low, base;
+
+  /* check that the code lengths describe a prefix code */
+  memset (count, 0, sizeof (count));
+  for (s = 0; s < num; ++s) {
+    ++count[lens[s]];
+  }
+  left = 1;
+  used = max = 0;
+  for (len = 1; len < 16; ++len) {
+    left = (left << 1) - count[len];
+    used += count[len];
+    if (left < 0) {
+      return -1;
+    }
+    if (count[len] > 0) {
+      max = len;
+    }
+  }
+  if (left > 0 && (used > 1 || count[1] != used)) {
+    return -1;
+  }
+
+  /* first code of each length */
+  code = 0;
+  count[0] = 0;
+  for (len = 1; len < 16; ++len) {
+    code = (code + count[len - 1]) << 1;
+    next[len] = (int) code;
+  }
+  memset (table, 0, ((size_t) 1 << root) * sizeof (uint32_t));
+
+  /* canonical codes of increasing length share their prefixes in order,
+     so we create each subtable when its first code comes up */
+  offset = 1 << root;
+  for (len = 1; len <= max; ++len) {
+    for (s = 0; s < num; ++s) {
+      if (lens[s] != len) {
+        continue;
+      }
+      code = (uint32_t) next[len]++;
+      for (rev = 0, i = 0; i < len; ++i) {
+        rev = (rev << 1) | ((code >> i) & 1);
+      }
+      if (len <= root) {
+        for (i = (int) rev, step = 1 << len; i < 1 << root; i += step) {
+          table[i] = symbol (s) | (uint32_t) len;
+        }
+        --count[len];
+        continue;
+      }
+      low = rev & ((1U << root) - 1);
+      if (SC_INFLATE_KIND (table[low]) != SC_INFLATE_SUBTABLE) {
+        /* the remaining codes determine the size, as in zlib */
+        for (sub = len - root, left = 1 << sub; sub + root < max; ++sub) {
+          left -= count[sub + root];
+          if (left <= 0) {
+            break;
+          }
+          left <<= 1;
+        }
+        if (offset + (1 << sub) > size) {
+          return -1;
+        }
+        table[low] = SC_INFLATE_ENTRY (SC_INFLATE_SUBTABLE, sub, offset) |
+          (uint32_t) root;
+        memset (table + offset, 0, ((size_t) 1 << sub) * sizeof (uint32_t));
+        offset += 1 << sub;
+      }
+      base = SC_INFLATE_VALUE (table[low]);
+      sub = (int) SC_INFLATE_EXTRA (table[low]);
+      for (i = (int) (rev >> root), step = 1 << (len - root);
+           i < 1 << sub; i += step) {
+        table[base + i] = symbol (s) | (uint32_t) (len - root);
+      }
+      --count[len];
+    }
+  }
+  return 0;
+}
+
+/** Combine two short literal codes into one first level entry.
+ * The bits after the first code determine the second code if it is short
+ * enough.  We go backwards to read the original entries.
+ */
+static void
+sc_inflate_pairs (uint32_t *table)
+{
+  int                 i;
+  uint32_t            e1, e2, n1, n2;
+
+  for (i = (1 << SC_INFLATE_LITLEN_BITS) - 1; i >= 0; --i) {
+    e1 = table[i];
+    n1 = SC_INFLATE_NBITS (e1);
+    if (SC_INFLATE_KIND (e1) != SC_INFLATE_LITERAL ||
+        n1 >= SC_INFLATE_LITLEN_BITS) {
+      continue;
+    }
+    e2 = table[i >> n1];
+    n2 = SC_INFLATE_NBITS (e2);
+    if (SC_INFLATE_KIND (e2) == SC_INFLATE_LITERAL &&
+        n1 + n2 <= SC_INFLATE_LITLEN_BITS) {
+      table[i] = SC_INFLATE_ENTRY (SC_INFLATE_PAIR, 0,
+                                   SC_INFLATE_VALUE (e1) |
+                                   SC_INFLATE_VALUE (e2) << 8) | (n1 + n2);
+    }
+  }
+}
+
+/** Return the entry of the code length alphabet. */
+static uint32_t
+sc_inflate_codelen_symbol (int s)
+{
+  return SC_INFLATE_ENTRY (SC_INFLATE_LITERAL, 0, s);
+}
+
+/** Load eight bytes in little endian order, which compilers merge. */
+static inline uint64_t
+sc_inflate_load (const unsigned char *p)
+{
+  return (uint64_t) p[0] | (uint64_t) p[1] << 8 |
+    (uint64_t) p[2] << 16 | (uint64_t) p[3] << 24 |
+    (uint64_t) p[4] << 32 | (uint64_t) p[5] << 40 |
+    (uint64_t) p[6] << 48 | (uint64_t) p[7] << 56;
+}
+
+/* Fill the bit buffer to at least 56 bits.  With enough input, we add a
+   whole word and advance by the number of complete bytes that fit; the
+   partial byte above is loaded again next time.  At the end of input we
+   pad with zeros and count them to detect reading past the end. */
+#define SC_INFLATE_REFILL() do {                                        \
+  if (in_end - in >= 8) {                                               \
+    bitbuf |= sc_inflate_load (in) << bitcnt;                           \
+    in += (63 - bitcnt) >> 3;                                           \
+    bitcnt |= 56;                                                       \
+  }                                                                     \
+  else {                                                                \
+    while (bitcnt <= 56) {                                              \
+      if (in < in_end) {                                                \
+        bitbuf |= (uint64_t) *in++ << bitcnt;                           \
+      }                                                                 \
+      else {                                                            \
+        ++overread;                                                     \
+      }                                                                 \
+      bitcnt += 8;                                                      \
+    }                                                                   \
+  }} while (0)
+
+#define SC_INFLATE_BITS(n) ((unsigned) (bitbuf & ((1U << (n)) - 1)))
+#define SC_INFLATE_DROP(n) do { bitbuf >>= (n); bitcnt -= (n); } while (0)
+
+/** Look up an entry of a two-level table, consuming the first level. */
+#define SC_INFLATE_LOOKUP(e,table,root) do {                            \
+  (e) = (table)[SC_INFLATE_BITS (root)];                                \
+  if (SC_INFLATE_KIND (e) == SC_INFLATE_SUBTABLE) {                     \
+    SC_INFLATE_DROP (root);                                             \
+    (e) = (table)[SC_INFLATE_VALUE (e) +                                \
+                  SC_INFLATE_BITS (SC_INFLATE_EXTRA (e))];              \
+  }                                                                     \
+  SC_INFLATE_DROP (SC_INFLATE_NBITS (e));} while (0)
+
+int
+sc_inflate (char *dest, size_t destlen, const char *src, size_t *srclen)
+{
+  int                 retval, final, type;
+  int                 s, nlen, ndist, ncode, fixed;
+  unsigned            bitcnt, stored;
+  size_t              overread, len, dist;
+  uint32_t            e;
+  uint64_t            bitbuf;
+  const unsigned char *in, *in_end;
+  char               *out, *out_end, *from, *stop;
+  sc_inflate_tables_t *t;
+
+  SC_ASSERT (dest != NULL || destlen == 0);
+  SC_ASSERT (src != NULL && srclen != NULL);
+
+  in = (const unsigned char *) src;
+  in_end = in + *srclen;
+  out = dest;
+  out_end = dest + destlen;
+  bitbuf = 0;
+  bitcnt = 0;
+  overread = 0;
+  fixed = 0;
+  retval = -1;
+  t = SC_ALLOC (sc_inflate_tables_t, 1);
+
+  do {
+    /* the block header */
+    SC_INFLATE_REFILL ();
+    final = (int) SC_INFLATE_BITS (1);
+    type = (int) (SC_INFLATE_BITS (3) >> 1);
+    SC_INFLATE_DROP (3);
+
+    if (type == 0) {
+      /* a stored block begins at the next byte */
+      SC_INFLATE_DROP (bitcnt & 7);
+      stored = SC_INFLATE_BITS (16);
+      if ((stored ^ 0xFFFF) != (unsigned) (bitbuf >> 16 & 0xFFFF)) {
+        goto done;
+      }
+      SC_INFLATE_DROP (32);
+
+      /* return the whole bytes of the bit buffer to the input */
+      if (overread > bitcnt >> 3) {
+        goto done;
+      }
+      in -= (bitcnt >> 3) - overread;
+      bitbuf = 0;
+      bitcnt = 0;
+      overread = 0;
+      if ((size_t) (in_end - in) < stored ||
+          (size_t) (out_end - out) < stored) {
+        goto done;
+      }
+      memcpy (out, in, stored);
+      in += stored;
+      out += stored;
+      continue;
+    }
+    else if (type == 1) {
+      /* the fixed code is the same for all blocks */
+      if (fixed != 1) {
+        memset (t->lens, 8, 144);
+        memset (t->lens + 144, 9, 112);
+        memset (t->lens + 256, 7, 24);
+        memset (t->lens + 280, 8, 8);
+        memset (t->lens + 288, 5, 32);
+        if (sc_inflate_build (t->litlen, SC_INFLATE_LITLEN_BITS,
+                              SC_INFLATE_LITLEN_SIZE, t->lens, 288,
+                              sc_inflate_litlen_symbol) ||
+            sc_inflate_build (t->dist, SC_INFLATE_DIST_BITS,
+                              SC_INFLATE_DIST_SIZE, t->lens + 288, 32,
+                              sc_inflate_dist_symbol)) {
+          goto done;
+        }
+        sc_inflate_pairs (t->litlen);
+        fixed = 1;
+      }
+    }
+    else if (type == 2) {
+      /* the dynamic code is described by a code for the code lengths */
+      fixed = 0;
+      nlen = (int) SC_INFLATE_BITS (5) + 257;
+      ndist = (int) (SC_INFLATE_BITS (10) >> 5) + 1;
+      ncode = (int) (SC_INFLATE_BITS (14) >> 10) + 4;
+      SC_INFLATE_DROP (14);
+      if (nlen > 286 || ndist > 30) {
+        goto done;
+      }
+      memset (t->lens, 0, 19);
+      for (s = 0; s < ncode; ++s) {
+        SC_INFLATE_REFILL ();
+        t->lens[sc_inflate_order[s]] = (uint8_t) SC_INFLATE_BITS (3);
+        SC_INFLATE_DROP (3);
+      }
+      if (sc_inflate_build (t->codelen, SC_INFLATE_CODELEN_BITS,
+                            1 << SC_INFLATE_CODELEN_BITS, t->lens, 19,
+                            sc_inflate_codelen_symbol)) {
+        goto done;
+      }
+
+      /* read the lengths of both codes as one sequence */
+      for (s = 0; s < nlen + ndist;) {
+        SC_INFLATE_REFILL ();
+        e = t->codelen[SC_INFLATE_BITS (SC_INFLATE_CODELEN_BITS)];
+        if (SC_INFLATE_KIND (e) != SC_INFLATE_LITERAL) {
+          goto done;
+        }
+        SC_INFLATE_DROP (SC_INFLATE_NBITS (e));
+        if (SC_INFLATE_VALUE (e) < 16) {
+          t->lens[s++] = (uint8_t) SC_INFLATE_VALUE (e);
+          continue;
+        }
+        if (SC_INFLATE_VALUE (e) == 16) {
+          if (s == 0) {
+            goto done;
+          }
+          len = 3 + SC_INFLATE_BITS (2);
+          SC_INFLATE_DROP (2);
+          stored = t->lens[s - 1];
+        }
+        else if (SC_INFLATE_VALUE (e) == 17) {
+          len = 3 + SC_INFLATE_BITS (3);
+          SC_INFLATE_DROP (3);
+          stored = 0;
+        }
+        else {
+          len = 11 + SC_INFLATE_BITS (7);
+          SC_INFLATE_DROP (7);
+          stored = 0;
+        }
+        if (s + len > (size_t) (nlen + ndist)) {
+          goto done;
+        }
+        memset (t->lens + s, (int) stored, len);
+        s += (int) len;
+      }
+
+      /* the end of block code is required */
+      if (t->lens[256] == 0) {
+        goto done;
+      }
+      memmove (t->lens + 288, t->lens + nlen, ndist);
+      if (sc_inflate_build (t->litlen, SC_INFLATE_LITLEN_BITS,
+                            SC_INFLATE_LITLEN_SIZE, t->lens, nlen,
+                            sc_inflate_litlen_symbol) ||
+          sc_inflate_build (t->dist, SC_INFLATE_DIST_BITS,
+                            SC_INFLATE_DIST_SIZE, t->lens + 288, ndist,
+                            sc_inflate_dist_symbol)) {
+        goto done;
+      }
+      sc_inflate_pairs (t->litlen);
+    }
+    else {
+      goto done;
+    }
+
+    /* decode the symbols of a compressed block */
+    for (;;) {
+      /* a symbol with its distance takes at most 48 bits */
+      SC_INFLATE_REFILL ();
+      SC_INFLATE_LOOKUP (e, t->litlen, SC_INFLATE_LITLEN_BITS);
+      switch (SC_INFLATE_KIND (e)) {
+      case SC_INFLATE_LITERAL:
+        if (out == out_end) {
+          goto done;
+        }
+        *out++ = (char) SC_INFLATE_VALUE (e);
+        continue;
+      case SC_INFLATE_PAIR:
+        if (out_end - out < 2) {
+          goto done;
+        }
+        out[0] = (char) (SC_INFLATE_VALUE (e) & 0xFF);
+        out[1] = (char) (SC_INFLATE_VALUE (e) >> 8);
+        out += 2;
+        continue;
+      case SC_INFLATE_BASE:
+        break;
+      case SC_INFLATE_END:
+        goto block_end;
+      default:
+        goto done;
+      }
+
+      /* a match of length and distance */
+      len = SC_INFLATE_VALUE (e) + SC_INFLATE_BITS (SC_INFLATE_EXTRA (e));
+      SC_INFLATE_DROP (SC_INFLATE_EXTRA (e));
+      SC_INFLATE_LOOKUP (e, t->dist, SC_INFLATE_DIST_BITS);
+      if (SC_INFLATE_KIND (e) != SC_INFLATE_BASE) {
+        goto done;
+      }
+      dist = SC_INFLATE_VALUE (e) + SC_INFLATE_BITS (SC_INFLATE_EXTRA (e));
+      SC_INFLATE_DROP (SC_INFLATE_EXTRA (e));
+      if (dist > (size_t) (out - dest) || len > (size_t) (out_end - out)) {
+        goto done;
+      }
+
+      /* copy a word at a time if the source is at least a word behind */
+      from = out - dist;
+      stop = out + len;
+      if (dist >= 8 && (size_t) (out_end - out) >= len + 8) {
+        do {
+          memcpy (out, from, 8);
+          out += 8;
+          from += 8;
+        }
+        while (out < stop);
+      }
+      else if (dist == 1) {
+        memset (out, *from, len);
+      }
+      else {
+        while (out < stop) {
+          *out++ = *from++;
+        }
+      }
+      out = stop;
+    }
+  block_end:;
+  }
+  while (!final);
+
+  /* the stream ends on the current byte, and we need all the output */
+  if (overread > bitcnt >> 3 || out != out_end) {
+    goto done;
+  }
+  *srclen = (size_t) (in - (const unsigned char *) src) + overread -
+    (bitcnt >> 3);
+  retval = 0;
+
+done:
+  SC_FREE (t);
+  return retval;
+}
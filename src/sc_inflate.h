@@ -0,0 +1,61 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+/** \file sc_inflate.h
+ * Decompress raw deflate data (RFC 1951) without zlib.
+ *
+ * This decoder replaces \ref sc_puff as the fallback of \ref sc_io_decode
+ * in builds without zlib.  It looks up Huffman codes in tables, often two
+ * literals at a time, reads the input a machine word at a time and copies
+ * matches in words where possible.  It is several times faster than
+ * \ref sc_puff, which decodes one bit at a time.
+ *
+ * \ingroup io
+ */
+
+#ifndef SC_INFLATE_H
+#define SC_INFLATE_H
+
+#include <sc.h>
+
+SC_EXTERN_C_BEGIN;
+
+/** Decompress a complete raw deflate stream into a buffer of known size.
+ * The function checks all input and never reads or writes out of bounds,
+ * such that it is safe to call on corrupt or malicious data.
+ * \param [out] dest        Output buffer of at least \a destlen bytes.
+ * \param [in] destlen      Exact byte size of the decompressed data.
+ * \param [in] src          The deflate stream, possibly followed by
+ *                          more data such as a zlib trailer.
+ * \param [in,out] srclen   On input, the bytes available in \a src.
+ *                          On success, the byte length of the stream.
+ * \return                  0 on success, -1 if the data is invalid,
+ *                          truncated, or does not decompress to exactly
+ *                          \a destlen bytes.
+ */
+int                 sc_inflate (char *dest, size_t destlen,
+                                const char *src, size_t *srclen);
+
+SC_EXTERN_C_END;
+
+#endif /* !SC_INFLATE_H */
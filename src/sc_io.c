@@ -22,7 +22,8 @@
 */
 
 #include <sc_io.h>
-#include <sc_puff.h>
+#include <sc_inflate.h>
+#include <sc_checksum.h>
 #include <libb64.h>
 #ifdef SC_HAVE_ZLIB
 #include <zlib.h>
@@ -32,139 +33,190 @@
 #define Z_BEST_COMPRESSION 9
 #endif
 #endif
+#ifdef SC_HAVE_LZ4
+#include <lz4.h>
+#endif
 
 #ifndef SC_ENABLE_MPIIO
 #include <errno.h>
 #endif
 
-sc_io_sink_t       *
-sc_io_sink_new (int iotype, int iomode, int ioencode, ...)
-{
-  sc_io_sink_t       *sink;
-  va_list             ap;
+/* the nonblocking collective file access appeared in MPI 3.1 */
+#if defined SC_ENABLE_MPIIO && \
+    (MPI_VERSION > 3 || (MPI_VERSION == 3 && MPI_SUBVERSION >= 1))
+#define SC_IO_HAVE_IFILE
+#elif !defined SC_ENABLE_MPI && defined SC_ENABLE_PTHREAD
+#define SC_IO_HAVE_THREAD
+#endif
 
-  /* verify preconditions */
-  SC_ASSERT (0 <= iotype && iotype < SC_IO_TYPE_LAST);
-  SC_ASSERT (0 <= iomode && iomode < SC_IO_MODE_LAST);
-  SC_ASSERT (0 <= ioencode && ioencode < SC_IO_ENCODE_LAST);
+#ifdef SC_ENABLE_PTHREAD
+#include <pthread.h>
+#endif
 
-  /* initialize members of sink object */
-  sink = SC_ALLOC_ZERO (sc_io_sink_t, 1);
-  sink->iotype = (sc_io_type_t) iotype;
-  sink->mode = (sc_io_mode_t) iomode;
-  sink->encode = (sc_io_encode_t) ioencode;
+#if defined SC_HAVE_SYS_MMAN_H && defined SC_HAVE_SYS_STAT_H && \
+  defined SC_HAVE_FCNTL_H && defined SC_HAVE_UNISTD_H
+#define SC_IO_HAVE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 
-  /* there is at least one type-dependent argument */
-  va_start (ap, ioencode);
-  if (iotype == SC_IO_TYPE_BUFFER) {
-    /* register the buffer to write to */
-    sink->buffer = va_arg (ap, sc_array_t *);
-    if (sink->mode == SC_IO_MODE_WRITE) {
-      sc_array_resize (sink->buffer, 0);
-    }
-  }
-  else if (iotype == SC_IO_TYPE_FILENAME) {
-    const char         *filename = va_arg (ap, const char *);
+/* byte count for one line of data must be a multiple of 3 */
+#define SC_IO_DBC 57
+#if SC_IO_DBC % 3 != 0
+#error "SC_IO_DBC must be a multiple of 3"
+#endif
 
-    /* open a file on disk by name */
-    sink->file = fopen (filename,
-                        sink->mode == SC_IO_MODE_WRITE ? "wb" : "ab");
-    if (sink->file == NULL) {
-      SC_FREE (sink);
-      return NULL;
-    }
-  }
-  else if (iotype == SC_IO_TYPE_FILEFILE) {
-    /* write to existing (writable) object */
-    sink->file = va_arg (ap, FILE *);
-    if (ferror (sink->file)) {
-      SC_FREE (sink);
-      return NULL;
-    }
-  }
-  else {
-    SC_ABORT_NOT_REACHED ();
-  }
-  va_end (ap);
+/* byte count for one line of base64 encoded data and newline */
+#define SC_IO_LBC (SC_IO_DBC / 3 * 4)
+#define SC_IO_LBD (SC_IO_LBC + 1)   /* after first line break byte */
+#define SC_IO_LBE (SC_IO_LBD + 1)   /* after second line break byte */
+#define SC_IO_LBF (SC_IO_LBE + 1)   /* after line break and NUL byte */
 
-  /* this sink can now be called for writing */
-  return sink;
-}
+#define SC_IO_ENCODE_INFO_LEN 9
 
-int
-sc_io_sink_destroy (sc_io_sink_t * sink)
-{
-  int                 retval;
+/* format characters of the codecs in the order of sc_io_codec_t */
+static const char   sc_io_codec_format[SC_IO_CODEC_LAST] = { 'n', 'z', 'l' };
 
-  /* The error value SC_IO_ERROR_AGAIN is turned into FATAL */
-  retval = sc_io_sink_complete (sink, NULL, NULL);
-  if (sink->iotype == SC_IO_TYPE_FILENAME) {
-    SC_ASSERT (sink->file != NULL);
+/** Write the size and format header of the encoded data.
+ * \return          Pointer to the first byte after the header.
+ */
+static char        *
+sc_io_compress_info (char *dest, size_t input_size, sc_io_codec_t codec)
+{
+  int                 i;
 
-    /* Attempt close even on complete error */
-    retval = fclose (sink->file) || retval;
+  /* save original size in big endian byte order and format */
+  for (i = 0; i < 8; ++i) {
+    dest[i] = (char) ((input_size >> ((7 - i) * 8)) & 0xFF);
   }
-  SC_FREE (sink);
-
-  return retval ? SC_IO_ERROR_FATAL : SC_IO_ERROR_NONE;
+  dest[SC_IO_ENCODE_INFO_LEN - 1] = sc_io_codec_format[codec];
+  return dest + SC_IO_ENCODE_INFO_LEN;
 }
 
-int
-sc_io_sink_destroy_null (sc_io_sink_t ** sink)
+#ifdef SC_HAVE_ZLIB
+
+/* the fixed window of the streaming encodings in bytes */
+#define SC_IO_STREAM_WINDOW ((size_t) 1 << 16)
+
+/* the header of a base 64 stream encodes to this many characters */
+#define SC_IO_STREAM_HEADER (SC_IO_ENCODE_INFO_LEN / 3 * 4)
+
+/** State of the streaming encoding of a sink or a source.
+ * A stream starts with the first data written or read and ends with
+ * \ref sc_io_sink_complete or \ref sc_io_source_complete, respectively.
+ */
+typedef struct sc_io_stream
 {
-  int                 retval = SC_IO_ERROR_NONE;
+  z_stream            zs;               /**< Deflate or inflate state. */
+  int                 active;           /**< A stream has been started. */
+  int                 finished;         /**< Source: stream end was read. */
+  size_t              total;            /**< Uncompressed bytes so far. */
+  size_t              original;         /**< Source: size in the header. */
+  char               *window;           /**< Compressed bytes. */
+  char               *code;             /**< Base 64 characters. */
+  size_t              code_pos;         /**< Source: next unread character. */
+  size_t              code_bytes;       /**< Characters in code. */
+  char               *skip;             /**< Source: output thrown away. */
+  char                line[SC_IO_DBC];  /**< Sink: bytes of partial line. */
+  size_t              line_bytes;       /**< Sink: bytes in line. */
+  long                header_pos;       /**< Sink: file offset of header. */
+  size_t              buffer_pos;       /**< Sink: buffer offset of header. */
+  int                 header_flushed;   /**< Sink: header left the window. */
+  char                header[SC_IO_ENCODE_INFO_LEN];    /**< Size, format. */
+  size_t              header_bytes;     /**< Source: header bytes known. */
+  int                 code_end;         /**< Source: NUL character read. */
+  base64_decodestate  bstate;           /**< Source: base 64 decoder. */
+}
+sc_io_stream_t;
 
-  /* pointer to sink pointer must be set */
-  SC_ASSERT (sink != NULL);
+static sc_io_stream_t *
+sc_io_stream_new (sc_io_encode_t encode, int sink)
+{
+  int                 zrv;
+  sc_io_stream_t     *st;
 
-  /* if sink is still open, close it and NULL the pointer to it */
-  if (*sink != NULL) {
-    retval = sc_io_sink_destroy (*sink);
-    *sink = NULL;
+  st = SC_ALLOC_ZERO (sc_io_stream_t, 1);
+  if (sink) {
+    /* the base 64 encoding matches sc_io_encode */
+    zrv = deflateInit (&st->zs, encode == SC_IO_ENCODE_BASE64 ?
+                       Z_BEST_COMPRESSION : Z_DEFAULT_COMPRESSION);
   }
-
-  /* in any case the sink does no longer exist */
-  SC_ASSERT (*sink == NULL);
-  return retval;
+  else {
+    zrv = inflateInit (&st->zs);
+  }
+  if (zrv != Z_OK) {
+    SC_FREE (st);
+    return NULL;
+  }
+  st->window = SC_ALLOC (char, SC_IO_STREAM_WINDOW);
+  if (encode == SC_IO_ENCODE_BASE64) {
+    st->code = SC_ALLOC (char, SC_IO_STREAM_WINDOW);
+  }
+  return st;
 }
 
-int
-sc_io_sink_write (sc_io_sink_t * sink, const void *data, size_t bytes_avail)
+static void
+sc_io_stream_destroy (sc_io_stream_t * st, int sink)
 {
-  size_t              bytes_out;
+  if (sink) {
+    (void) deflateEnd (&st->zs);
+  }
+  else {
+    (void) inflateEnd (&st->zs);
+  }
+  SC_FREE (st->window);
+  SC_FREE (st->code);
+  SC_FREE (st->skip);
+  SC_FREE (st);
+}
 
-  /* basic output preconditions */
-  SC_ASSERT (sink != NULL);
-  SC_ASSERT (data != NULL || bytes_avail == 0);
+#endif /* SC_HAVE_ZLIB */
 
-  /* do nothing if there is no data requested */
-  if (bytes_avail == 0) {
-    return SC_IO_ERROR_NONE;
+/** Make room for more bytes at the end of the buffer of a sink.
+ * \return          The position to copy the bytes to, or NULL on error.
+ */
+static char        *
+sc_io_sink_buffer_extend (sc_io_sink_t * sink, size_t bytes_avail)
+{
+  size_t              elem_size, new_count;
+  char               *pos;
+
+  /* extend the buffer by an even number of elements if necessary */
+  SC_ASSERT (sink->buffer != NULL);
+  elem_size = sink->buffer->elem_size;
+  new_count = (sink->buffer_bytes + bytes_avail + elem_size - 1) / elem_size;
+  sc_array_resize (sink->buffer, new_count);
+  /* For a view, sufficient size is asserted only in debug mode.
+     Therefore, we add an explicit unconditional check. */
+  if (new_count * elem_size > SC_ARRAY_BYTE_ALLOC (sink->buffer)) {
+    return NULL;
   }
 
-  /* do a regular write */
-  bytes_out = 0;
+  /* the caller fills the new bytes */
+  pos = sink->buffer->array + sink->buffer_bytes;
+  sink->buffer_bytes += bytes_avail;
+  sink->bytes_out += bytes_avail;
+  return pos;
+}
+
+/** Write bytes to the target of a sink without encoding them. */
+static int
+sc_io_sink_write_raw (sc_io_sink_t * sink, const void *data,
+                      size_t bytes_avail)
+{
+  size_t              bytes_out;
 
   /* switch on the type of sink */
+  bytes_out = 0;
   if (sink->iotype == SC_IO_TYPE_BUFFER) {
-    size_t              elem_size, new_count;
+    char               *pos;
 
-    /* extend the buffer by an even number of elements if necessary */
-    SC_ASSERT (sink->buffer != NULL);
-    elem_size = sink->buffer->elem_size;
-    new_count =
-      (sink->buffer_bytes + bytes_avail + elem_size - 1) / elem_size;
-    sc_array_resize (sink->buffer, new_count);
-    /* For a view, sufficient size is asserted only in debug mode.
-       Therefore, we add an explicit unconditional check. */
-    if (new_count * elem_size > SC_ARRAY_BYTE_ALLOC (sink->buffer)) {
+    /* copy new data into the buffer at the proper position */
+    if ((pos = sc_io_sink_buffer_extend (sink, bytes_avail)) == NULL) {
       return SC_IO_ERROR_FATAL;
     }
-
-    /* copy new data into the buffer at the proper position */
-    memcpy (sink->buffer->array + sink->buffer_bytes, data, bytes_avail);
-    sink->buffer_bytes += bytes_avail;
-    bytes_out = bytes_avail;
+    memcpy (pos, data, bytes_avail);
   }
   else if (sink->iotype == SC_IO_TYPE_FILENAME ||
            sink->iotype == SC_IO_TYPE_FILEFILE) {
@@ -176,169 +228,208 @@ sc_io_sink_write (sc_io_sink_t * sink, const void *data, size_t bytes_avail)
     }
   }
 
-  /* update internal state and return on successful operation */
-  sink->bytes_in += bytes_avail;
+  /* update internal state on successful operation */
   sink->bytes_out += bytes_out;
-
-  /* success! */
   return SC_IO_ERROR_NONE;
 }
 
-int
-sc_io_sink_complete (sc_io_sink_t * sink, size_t *bytes_in, size_t *bytes_out)
+#ifdef SC_HAVE_ZLIB
+
+/** Write the buffered base 64 lines to the target. */
+static int
+sc_io_sink_flush_code (sc_io_sink_t * sink)
 {
-  int                 retval;
+  sc_io_stream_t     *st = (sc_io_stream_t *) sink->stream;
 
-  retval = 0;
-  if (sink->iotype == SC_IO_TYPE_BUFFER) {
-    SC_ASSERT (sink->buffer != NULL);
-    if (sink->buffer_bytes % sink->buffer->elem_size != 0) {
-      return SC_IO_ERROR_AGAIN;
+  if (st->code_bytes > 0) {
+    if (sc_io_sink_write_raw (sink, st->code, st->code_bytes)) {
+      return SC_IO_ERROR_FATAL;
     }
+    st->code_bytes = 0;
+    st->header_flushed = 1;
   }
-  else if (sink->iotype == SC_IO_TYPE_FILENAME ||
-           sink->iotype == SC_IO_TYPE_FILEFILE) {
-    SC_ASSERT (sink->file != NULL);
-    retval = fflush (sink->file);
-  }
-  if (retval) {
+  return SC_IO_ERROR_NONE;
+}
+
+/** Encode the partial line of a sink in base 64.
+ * \param [in] final    If true, this is the final line of the stream.
+ */
+static int
+sc_io_sink_encode_line (sc_io_sink_t * sink, int final)
+{
+  char               *opos;
+  sc_io_stream_t     *st = (sc_io_stream_t *) sink->stream;
+  base64_encodestate  bstate;
+
+  if (st->code_bytes + SC_IO_LBF > SC_IO_STREAM_WINDOW &&
+      sc_io_sink_flush_code (sink)) {
     return SC_IO_ERROR_FATAL;
   }
 
-  if (bytes_in != NULL) {
-    *bytes_in = sink->bytes_in;
+  /* lines hold a multiple of 3 bytes and are encoded independently */
+  opos = st->code + st->code_bytes;
+  if (st->line_bytes > 0) {
+    base64_init_encodestate (&bstate);
+    opos += base64_encode_block (st->line, st->line_bytes, opos, &bstate);
+    opos += base64_encode_blockend (opos, &bstate);
+    *opos++ = '=';
+    *opos++ = '\n';
   }
-  if (bytes_out != NULL) {
-    *bytes_out = sink->bytes_out;
+  if (final) {
+    *opos++ = '\0';
   }
-  sink->bytes_in = sink->bytes_out = 0;
-
+  st->code_bytes = (size_t) (opos - st->code);
+  st->line_bytes = 0;
   return SC_IO_ERROR_NONE;
 }
 
-int
-sc_io_sink_align (sc_io_sink_t * sink, size_t bytes_align)
+/** Pass compressed bytes to the target, in base 64 lines if requested. */
+static int
+sc_io_sink_emit (sc_io_sink_t * sink, const char *comp, size_t size)
 {
-  size_t              fill_bytes;
-  char               *fill;
-  int                 retval;
-
-  fill_bytes = (bytes_align - sink->bytes_out % bytes_align) % bytes_align;
-  fill = SC_ALLOC_ZERO (char, fill_bytes);
-  retval = sc_io_sink_write (sink, fill, fill_bytes);
-  SC_FREE (fill);
+  size_t              n;
+  sc_io_stream_t     *st = (sc_io_stream_t *) sink->stream;
 
-  return retval;
+  if (sink->encode == SC_IO_ENCODE_ZLIB) {
+    return sc_io_sink_write_raw (sink, comp, size);
+  }
+  while (size > 0) {
+    n = SC_MIN (size, SC_IO_DBC - st->line_bytes);
+    memcpy (st->line + st->line_bytes, comp, n);
+    st->line_bytes += n;
+    comp += n;
+    size -= n;
+    if (st->line_bytes == SC_IO_DBC && sc_io_sink_encode_line (sink, 0)) {
+      return SC_IO_ERROR_FATAL;
+    }
+  }
+  return SC_IO_ERROR_NONE;
 }
 
-sc_io_source_t     *
-sc_io_source_new (int iotype, int ioencode, ...)
+/** Compress data into a sink with a fixed output window. */
+static int
+sc_io_sink_deflate (sc_io_sink_t * sink, const char *data,
+                    size_t bytes_avail, int flush)
 {
-  sc_io_source_t     *source;
-  va_list             ap;
-
-  /* verify preconditions */
-  SC_ASSERT (0 <= iotype && iotype < SC_IO_TYPE_LAST);
-  SC_ASSERT (0 <= ioencode && ioencode < SC_IO_ENCODE_LAST);
+  int                 zrv;
+  size_t              chunk;
+  sc_io_stream_t     *st = (sc_io_stream_t *) sink->stream;
+
+  /* the first write starts a new stream */
+  if (!st->active) {
+    st->active = 1;
+    st->total = 0;
+    if (sink->encode == SC_IO_ENCODE_BASE64) {
+      /* the size in the header is filled in when the stream ends */
+      st->header_flushed = 0;
+      st->buffer_pos = sink->buffer_bytes;
+      st->header_pos = sink->file != NULL ? ftell (sink->file) : 0;
+      sc_io_compress_info (st->header, 0, SC_IO_CODEC_ZLIB);
+      if (sc_io_sink_emit (sink, st->header, SC_IO_ENCODE_INFO_LEN)) {
+        return SC_IO_ERROR_FATAL;
+      }
+    }
+  }
+  st->total += bytes_avail;
 
-  /* initialize members of source object */
-  source = SC_ALLOC_ZERO (sc_io_source_t, 1);
-  source->iotype = (sc_io_type_t) iotype;
-  source->encode = (sc_io_encode_t) ioencode;
+  /* zlib counts the input in unsigned int */
+  do {
+    chunk = SC_MIN (bytes_avail, (size_t) 1 << 30);
+    st->zs.next_in = (Bytef *) data;
+    st->zs.avail_in = (uInt) chunk;
+    do {
+      st->zs.next_out = (Bytef *) st->window;
+      st->zs.avail_out = (uInt) SC_IO_STREAM_WINDOW;
+      zrv = deflate (&st->zs, chunk == bytes_avail ? flush : Z_NO_FLUSH);
+      if (zrv == Z_STREAM_ERROR ||
+          sc_io_sink_emit (sink, st->window,
+                           SC_IO_STREAM_WINDOW - st->zs.avail_out)) {
+        return SC_IO_ERROR_FATAL;
+      }
+    } while (st->zs.avail_out == 0);
+    SC_ASSERT (st->zs.avail_in == 0);
+    data += chunk;
+    bytes_avail -= chunk;
+  } while (bytes_avail > 0);
+  return SC_IO_ERROR_NONE;
+}
 
-  /* there is at least one type-dependent argument */
-  va_start (ap, ioencode);
-  if (iotype == SC_IO_TYPE_BUFFER) {
-    /* the source is presented in the form of an array */
-    source->buffer = va_arg (ap, sc_array_t *);
-  }
-  else if (iotype == SC_IO_TYPE_FILENAME) {
-    const char         *filename = va_arg (ap, const char *);
+/** Replace the placeholder header of a base 64 stream by the final one. */
+static int
+sc_io_sink_patch_header (sc_io_sink_t * sink, const char *code)
+{
+  long                pos;
+  sc_io_stream_t     *st = (sc_io_stream_t *) sink->stream;
 
-    /* open a file on disk by name */
-    source->file = fopen (filename, "rb");
-    if (source->file == NULL) {
-      SC_FREE (source);
-      return NULL;
-    }
-  }
-  else if (iotype == SC_IO_TYPE_FILEFILE) {
-    /* read from an existing (readable) file object */
-    source->file = va_arg (ap, FILE *);
-    if (ferror (source->file)) {
-      SC_FREE (source);
-      return NULL;
-    }
+  if (!st->header_flushed) {
+    /* the header is still in the window */
+    memcpy (st->code, code, SC_IO_STREAM_HEADER);
+    return SC_IO_ERROR_NONE;
   }
-  else {
-    SC_ABORT_NOT_REACHED ();
+  if (sink->iotype == SC_IO_TYPE_BUFFER) {
+    memcpy (sink->buffer->array + st->buffer_pos, code,
+            SC_IO_STREAM_HEADER);
+    return SC_IO_ERROR_NONE;
   }
-  va_end (ap);
 
-  /* this source can now be called for reading */
-  return source;
+  /* a file must be seekable and not opened for appending */
+  if (st->header_pos < 0 || (pos = ftell (sink->file)) < 0 ||
+      fseek (sink->file, st->header_pos, SEEK_SET) ||
+      fwrite (code, 1, SC_IO_STREAM_HEADER, sink->file) !=
+      SC_IO_STREAM_HEADER ||
+      ftell (sink->file) != st->header_pos + (long) SC_IO_STREAM_HEADER ||
+      fseek (sink->file, pos, SEEK_SET)) {
+    return SC_IO_ERROR_FATAL;
+  }
+  return SC_IO_ERROR_NONE;
 }
 
-int
-sc_io_source_destroy (sc_io_source_t * source)
+/** End the current stream of a sink. */
+static int
+sc_io_sink_finish (sc_io_sink_t * sink)
 {
-  int                 retval;
-
-  /* complete reading */
-  retval = sc_io_source_complete (source, NULL, NULL);
+  char                code[SC_IO_STREAM_HEADER];
+  sc_io_stream_t     *st = (sc_io_stream_t *) sink->stream;
+  base64_encodestate  bstate;
 
-  /* destroy mirror */
-  if (source->mirror != NULL) {
-    retval = sc_io_sink_destroy (source->mirror) || retval;
-    sc_array_destroy (source->mirror_buffer);
+  if (!st->active) {
+    return SC_IO_ERROR_NONE;
   }
-
-  /* The error value SC_IO_ERROR_AGAIN is turned into FATAL */
-  if (source->iotype == SC_IO_TYPE_FILENAME) {
-    SC_ASSERT (source->file != NULL);
-
-    /* Attempt close even on complete error */
-    retval = fclose (source->file) || retval;
+  if (sc_io_sink_deflate (sink, NULL, 0, Z_FINISH)) {
+    return SC_IO_ERROR_FATAL;
   }
-  SC_FREE (source);
-
-  return retval ? SC_IO_ERROR_FATAL : SC_IO_ERROR_NONE;
-}
-
-int
-sc_io_source_destroy_null (sc_io_source_t ** source)
-{
-  int                 retval = SC_IO_ERROR_NONE;
-
-  /* pointer to source pointer must be set */
-  SC_ASSERT (source != NULL);
-
-  /* if source is still open, close it and NULL the pointer to it */
-  if (*source != NULL) {
-    retval = sc_io_source_destroy (*source);
-    *source = NULL;
+  if (sink->encode == SC_IO_ENCODE_BASE64) {
+    /* the header occupies the first characters of the first line */
+    sc_io_compress_info (st->header, st->total, SC_IO_CODEC_ZLIB);
+    base64_init_encodestate (&bstate);
+    (void) base64_encode_block (st->header, SC_IO_ENCODE_INFO_LEN, code,
+                                &bstate);
+    if (sc_io_sink_encode_line (sink, 1) ||
+        sc_io_sink_patch_header (sink, code) ||
+        sc_io_sink_flush_code (sink)) {
+      return SC_IO_ERROR_FATAL;
+    }
   }
-
-  /* in any case the source does no longer exist */
-  SC_ASSERT (*source == NULL);
-  return retval;
+  st->active = 0;
+  return deflateReset (&st->zs) == Z_OK ?
+    SC_IO_ERROR_NONE : SC_IO_ERROR_FATAL;
 }
 
-int
-sc_io_source_read (sc_io_source_t * source, void *data,
-                   size_t bytes_avail, size_t *bytes_out)
+#endif /* SC_HAVE_ZLIB */
+
+/** Read bytes from a source without decoding them.
+ * \return          0 on success, nonzero on error.
+ */
+static int
+sc_io_source_read_raw (sc_io_source_t * source, void *data,
+                       size_t bytes_avail, size_t *bytes_out)
 {
   int                 retval;
   size_t              bbytes_out;
 
-  /* basic input preconditions.  It is legal if data is NULL */
-  SC_ASSERT (source != NULL);
-
-  /* do nothing also if the end of the file has been reached */
-  if (bytes_avail == 0 || source->is_eof) {
-    if (bytes_out != NULL) {
-      *bytes_out = 0;
-    }
+  /* do nothing if the end of the file has been reached */
+  if (source->is_eof) {
+    *bytes_out = 0;
     return SC_IO_ERROR_NONE;
   }
 
@@ -347,7 +438,8 @@ sc_io_source_read (sc_io_source_t * source, void *data,
   bbytes_out = 0;
 
   /* switch on the type of source */
-  if (source->iotype == SC_IO_TYPE_BUFFER) {
+  if (source->iotype == SC_IO_TYPE_BUFFER ||
+      source->iotype == SC_IO_TYPE_MMAP) {
     SC_ASSERT (source->buffer != NULL);
 
     /* access available elements by their byte count */
@@ -391,9 +483,6 @@ sc_io_source_read (sc_io_source_t * source, void *data,
         retval = !(source->is_eof = feof (source->file)) ||
                  ferror (source->file);
       }
-      if (retval == SC_IO_ERROR_NONE && source->mirror != NULL) {
-        retval = sc_io_sink_write (source->mirror, data, bbytes_out);
-      }
     }
     else {
       /* seek now and check for potential end of file next time */
@@ -402,468 +491,1921 @@ sc_io_source_read (sc_io_source_t * source, void *data,
     }
   }
 
-  /* process error conditions */
-  if (retval) {
-    return SC_IO_ERROR_FATAL;
+  *bytes_out = bbytes_out;
+  return retval;
+}
+
+#ifdef SC_HAVE_ZLIB
+
+/** Provide more compressed input to the inflater of a source.
+ * Bytes read beyond the end of a stream are kept for the next one.
+ * \return          0 on success, nonzero on error or premature end of input.
+ */
+static int
+sc_io_source_fill (sc_io_source_t * source)
+{
+  int                 i;
+  char               *nul;
+  size_t              n, used, pos;
+  sc_io_stream_t     *st = (sc_io_stream_t *) source->stream;
+
+  SC_ASSERT (st->zs.avail_in == 0);
+  if (source->encode == SC_IO_ENCODE_ZLIB) {
+    if (sc_io_source_read_raw (source, st->window, SC_IO_STREAM_WINDOW, &n)
+        || n == 0) {
+      return SC_IO_ERROR_FATAL;
+    }
+    st->zs.next_in = (Bytef *) st->window;
+    st->zs.avail_in = (uInt) n;
+    return SC_IO_ERROR_NONE;
   }
-  if (bytes_out == NULL && bbytes_out < bytes_avail) {
+
+  /* the base 64 data ends with a NUL character */
+  if (st->code_end) {
     return SC_IO_ERROR_FATAL;
   }
+  if (st->code_pos == st->code_bytes) {
+    if (sc_io_source_read_raw (source, st->code, SC_IO_STREAM_WINDOW, &n)
+        || n == 0) {
+      return SC_IO_ERROR_FATAL;
+    }
+    st->code_pos = 0;
+    st->code_bytes = n;
+  }
+  n = st->code_bytes - st->code_pos;
+  used = n;
+  if ((nul = (char *) memchr (st->code + st->code_pos, '\0', n)) != NULL) {
+    n = (size_t) (nul - (st->code + st->code_pos));
+    used = n + 1;
+    st->code_end = 1;
+  }
 
-  /* complete and return on successful operation */
-  if (bytes_out != NULL) {
-    *bytes_out = bbytes_out;
+  /* the decoder skips the line breaks */
+  n = base64_decode_block (st->code + st->code_pos, n, st->window,
+                           &st->bstate);
+  st->code_pos += used;
+  source->bytes_in += used;
+
+  /* the stream begins with the size and format header */
+  pos = 0;
+  if (st->header_bytes < SC_IO_ENCODE_INFO_LEN) {
+    pos = SC_MIN (n, SC_IO_ENCODE_INFO_LEN - st->header_bytes);
+    memcpy (st->header + st->header_bytes, st->window, pos);
+    st->header_bytes += pos;
+    if (st->header_bytes == SC_IO_ENCODE_INFO_LEN) {
+      if (st->header[SC_IO_ENCODE_INFO_LEN - 1] !=
+          sc_io_codec_format[SC_IO_CODEC_ZLIB]) {
+        SC_LERROR ("base 64 stream is not in zlib format\n");
+        return SC_IO_ERROR_FATAL;
+      }
+      for (i = 0; i < 8; ++i) {
+        st->original = (st->original << 8) + (unsigned char) st->header[i];
+      }
+    }
   }
-  source->bytes_in += bbytes_out;
-  source->bytes_out += bbytes_out;
+  st->zs.next_in = (Bytef *) st->window + pos;
+  st->zs.avail_in = (uInt) (n - pos);
+  return SC_IO_ERROR_NONE;
+}
 
-  /* success! */
+/** Verify the end of a stream and consume its trailing characters. */
+static int
+sc_io_source_stream_end (sc_io_source_t * source)
+{
+  sc_io_stream_t     *st = (sc_io_stream_t *) source->stream;
+
+  st->finished = 1;
+  if (source->encode == SC_IO_ENCODE_BASE64) {
+    /* only line breaks may follow the zlib data */
+    while (st->zs.avail_in == 0 && !st->code_end) {
+      if (sc_io_source_fill (source)) {
+        return SC_IO_ERROR_FATAL;
+      }
+    }
+    if (st->zs.avail_in > 0 || st->total != st->original) {
+      SC_LERROR ("base 64 stream size mismatch\n");
+      return SC_IO_ERROR_FATAL;
+    }
+  }
   return SC_IO_ERROR_NONE;
 }
 
-int
-sc_io_source_complete (sc_io_source_t * source,
-                       size_t *bytes_in, size_t *bytes_out)
+/** Decompress data from a source with a fixed input window.
+ * \return          0 on success, nonzero on error.
+ */
+static int
+sc_io_source_inflate (sc_io_source_t * source, char *data,
+                      size_t bytes_avail, size_t *bytes_out)
 {
-  int                 retval = SC_IO_ERROR_NONE;
+  int                 zrv;
+  size_t              produced, chunk;
+  uInt                avail_in;
+  sc_io_stream_t     *st = (sc_io_stream_t *) source->stream;
+
+  /* the first read starts a new stream */
+  if (!st->active) {
+    st->active = 1;
+    st->finished = 0;
+    st->total = st->original = 0;
+    st->header_bytes = 0;
+    st->code_end = 0;
+    base64_init_decodestate (&st->bstate);
+  }
+  if (data == NULL && st->skip == NULL) {
+    st->skip = SC_ALLOC (char, SC_IO_STREAM_WINDOW);
+  }
 
-  if (source->iotype == SC_IO_TYPE_BUFFER) {
-    SC_ASSERT (source->buffer != NULL);
-    if (source->buffer_bytes % source->buffer->elem_size != 0) {
-      return SC_IO_ERROR_AGAIN;
+  /* zlib counts the output in unsigned int */
+  produced = 0;
+  while (produced < bytes_avail && !st->finished) {
+    if (st->zs.avail_in == 0) {
+      if (sc_io_source_fill (source)) {
+        return SC_IO_ERROR_FATAL;
+      }
+      continue;
     }
-  }
-  else if (source->iotype == SC_IO_TYPE_FILENAME ||
-           source->iotype == SC_IO_TYPE_FILEFILE) {
-    if (source->mirror != NULL) {
-      retval = sc_io_sink_complete (source->mirror, NULL, NULL);
+    chunk = SC_MIN (bytes_avail - produced, data != NULL ?
+                    (size_t) 1 << 30 : SC_IO_STREAM_WINDOW);
+    st->zs.next_out = (Bytef *) (data != NULL ? data + produced : st->skip);
+    st->zs.avail_out = (uInt) chunk;
+    avail_in = st->zs.avail_in;
+    zrv = inflate (&st->zs, Z_NO_FLUSH);
+    if (source->encode == SC_IO_ENCODE_ZLIB) {
+      source->bytes_in += avail_in - st->zs.avail_in;
+    }
+    produced += chunk - st->zs.avail_out;
+    st->total += chunk - st->zs.avail_out;
+    if (zrv == Z_STREAM_END) {
+      if (sc_io_source_stream_end (source)) {
+        return SC_IO_ERROR_FATAL;
+      }
+    }
+    else if (zrv != Z_OK && zrv != Z_BUF_ERROR) {
+      return SC_IO_ERROR_FATAL;
     }
   }
+  *bytes_out = produced;
+  return SC_IO_ERROR_NONE;
+}
 
-  if (bytes_in != NULL) {
-    *bytes_in = source->bytes_in;
+/** End the current stream of a source if all of its data has been read. */
+static int
+sc_io_source_finish (sc_io_source_t * source)
+{
+  int                 zrv;
+  char                dummy;
+  uInt                avail_in;
+  sc_io_stream_t     *st = (sc_io_stream_t *) source->stream;
+
+  /* process the end of the stream without producing output */
+  while (st->active && !st->finished) {
+    if (st->zs.avail_in == 0) {
+      if (sc_io_source_fill (source)) {
+        return SC_IO_ERROR_FATAL;
+      }
+      continue;
+    }
+    st->zs.next_out = (Bytef *) &dummy;
+    st->zs.avail_out = 0;
+    avail_in = st->zs.avail_in;
+    zrv = inflate (&st->zs, Z_NO_FLUSH);
+    if (source->encode == SC_IO_ENCODE_ZLIB) {
+      source->bytes_in += avail_in - st->zs.avail_in;
+    }
+    if (zrv == Z_STREAM_END) {
+      if (sc_io_source_stream_end (source)) {
+        return SC_IO_ERROR_FATAL;
+      }
+    }
+    else if (zrv == Z_BUF_ERROR) {
+      /* there is output left to read */
+      return SC_IO_ERROR_AGAIN;
+    }
+    else if (zrv != Z_OK) {
+      return SC_IO_ERROR_FATAL;
+    }
   }
-  if (bytes_out != NULL) {
-    *bytes_out = source->bytes_out;
+  if (st->active) {
+    st->active = 0;
+    return inflateReset (&st->zs) == Z_OK ?
+      SC_IO_ERROR_NONE : SC_IO_ERROR_FATAL;
   }
-  source->bytes_in = source->bytes_out = 0;
-
-  return retval;
+  return SC_IO_ERROR_NONE;
 }
 
-int
-sc_io_source_align (sc_io_source_t * source, size_t bytes_align)
+#endif /* SC_HAVE_ZLIB */
+
+sc_io_sink_t       *
+sc_io_sink_new (int iotype, int iomode, int ioencode, ...)
 {
-  size_t              fill_bytes;
+  sc_io_sink_t       *sink;
+  va_list             ap;
 
-  fill_bytes = (bytes_align - source->bytes_out % bytes_align) % bytes_align;
+  /* verify preconditions */
+  SC_ASSERT (0 <= iotype && iotype < SC_IO_TYPE_LAST);
+  SC_ASSERT (0 <= iomode && iomode < SC_IO_MODE_LAST);
+  SC_ASSERT (0 <= ioencode && ioencode < SC_IO_ENCODE_LAST);
+  if (iotype == SC_IO_TYPE_MMAP) {
+    /* a mapped file is only read */
+    return NULL;
+  }
+#ifndef SC_HAVE_ZLIB
+  if (ioencode != SC_IO_ENCODE_NONE) {
+    return NULL;
+  }
+#endif
 
-  return sc_io_source_read (source, NULL, fill_bytes, NULL);
-}
+  /* initialize members of sink object */
+  sink = SC_ALLOC_ZERO (sc_io_sink_t, 1);
+  sink->iotype = (sc_io_type_t) iotype;
+  sink->mode = (sc_io_mode_t) iomode;
+  sink->encode = (sc_io_encode_t) ioencode;
+  sink->combine_size = SC_IO_SINK_BUFFER;
 
-int
-sc_io_source_activate_mirror (sc_io_source_t * source)
-{
-  if (source->iotype == SC_IO_TYPE_BUFFER) {
-    return SC_IO_ERROR_FATAL;
+  /* there is at least one type-dependent argument */
+  va_start (ap, ioencode);
+  if (iotype == SC_IO_TYPE_BUFFER) {
+    /* register the buffer to write to */
+    sink->buffer = va_arg (ap, sc_array_t *);
+    if (sink->mode == SC_IO_MODE_WRITE) {
+      sc_array_resize (sink->buffer, 0);
+    }
   }
-  if (source->mirror != NULL) {
-    return SC_IO_ERROR_FATAL;
+  else if (iotype == SC_IO_TYPE_FILENAME) {
+    const char         *filename = va_arg (ap, const char *);
+
+    /* open a file on disk by name */
+    sink->file = fopen (filename,
+                        sink->mode == SC_IO_MODE_WRITE ? "wb" : "ab");
+    if (sink->file == NULL) {
+      SC_FREE (sink);
+      return NULL;
+    }
   }
+  else if (iotype == SC_IO_TYPE_FILEFILE) {
+    /* write to existing (writable) object */
+    sink->file = va_arg (ap, FILE *);
+    if (ferror (sink->file)) {
+      SC_FREE (sink);
+      return NULL;
+    }
+  }
+  else {
+    SC_ABORT_NOT_REACHED ();
+  }
+  va_end (ap);
 
-  source->mirror_buffer = sc_array_new (sizeof (char));
-  source->mirror = sc_io_sink_new (SC_IO_TYPE_BUFFER, SC_IO_MODE_WRITE,
-                                   SC_IO_ENCODE_NONE, source->mirror_buffer);
+#ifdef SC_HAVE_ZLIB
+  /* prepare the encoding */
+  if (sink->encode != SC_IO_ENCODE_NONE &&
+      (sink->stream = sc_io_stream_new (sink->encode, 1)) == NULL) {
+    if (iotype == SC_IO_TYPE_FILENAME) {
+      (void) fclose (sink->file);
+    }
+    SC_FREE (sink);
+    return NULL;
+  }
+#endif
 
-  return (source->mirror != NULL ? SC_IO_ERROR_NONE : SC_IO_ERROR_FATAL);
+  /* this sink can now be called for writing */
+  return sink;
 }
 
 int
-sc_io_source_read_mirror (sc_io_source_t * source, void *data,
-                          size_t bytes_avail, size_t *bytes_out)
+sc_io_sink_destroy (sc_io_sink_t * sink)
 {
-  sc_io_source_t     *mirror_src;
   int                 retval;
 
-  if (source->mirror_buffer == NULL) {
-    return SC_IO_ERROR_FATAL;
+  /* The error value SC_IO_ERROR_AGAIN is turned into FATAL */
+  retval = sc_io_sink_complete (sink, NULL, NULL);
+  if (sink->iotype == SC_IO_TYPE_FILENAME) {
+    SC_ASSERT (sink->file != NULL);
+
+    /* Attempt close even on complete error */
+    retval = fclose (sink->file) || retval;
+  }
+#ifdef SC_HAVE_ZLIB
+  if (sink->stream != NULL) {
+    sc_io_stream_destroy ((sc_io_stream_t *) sink->stream, 1);
   }
+#endif
+  SC_FREE (sink->combine);
+  SC_FREE (sink);
 
-  mirror_src = sc_io_source_new (SC_IO_TYPE_BUFFER, SC_IO_ENCODE_NONE,
-                                 source->mirror_buffer);
-  retval = (mirror_src != NULL ? SC_IO_ERROR_NONE : SC_IO_ERROR_FATAL);
-  retval = retval || sc_io_source_read (mirror_src, data, bytes_avail,
-                                        bytes_out);
-  if (mirror_src != NULL) {
-    retval = sc_io_source_destroy (mirror_src) || retval;
+  return retval ? SC_IO_ERROR_FATAL : SC_IO_ERROR_NONE;
+}
+
+int
+sc_io_sink_destroy_null (sc_io_sink_t ** sink)
+{
+  int                 retval = SC_IO_ERROR_NONE;
+
+  /* pointer to sink pointer must be set */
+  SC_ASSERT (sink != NULL);
+
+  /* if sink is still open, close it and NULL the pointer to it */
+  if (*sink != NULL) {
+    retval = sc_io_sink_destroy (*sink);
+    *sink = NULL;
   }
 
+  /* in any case the sink does no longer exist */
+  SC_ASSERT (*sink == NULL);
   return retval;
 }
 
+/** Pass bytes on to the target of a sink through its encoding. */
 static int
-file_return (int retval, sc_io_sink_t * sink, sc_io_source_t * source)
+sc_io_sink_put (sc_io_sink_t * sink, const void *data, size_t bytes_avail)
 {
-  if (sink != NULL) {
-    /* preserve error condition */
-    retval = sc_io_sink_destroy (sink) || retval;
-  }
-  if (source != NULL) {
-    /* preserve error condition */
-    retval = sc_io_source_destroy (source) || retval;
+#ifdef SC_HAVE_ZLIB
+  if (sink->encode != SC_IO_ENCODE_NONE) {
+    return sc_io_sink_deflate (sink, (const char *) data, bytes_avail,
+                               Z_NO_FLUSH);
   }
-  return retval;
+#endif
+  return sc_io_sink_write_raw (sink, data, bytes_avail);
 }
 
-int
-sc_io_file_save (const char *filename, sc_array_t * buffer)
+/** Pass on the bytes combined from small writes. */
+static int
+sc_io_sink_flush_combine (sc_io_sink_t * sink)
 {
-  /* sink is always a meaningful pointer and freed before return */
-  sc_io_sink_t       *sink = NULL;
+  size_t              bytes = sink->combine_bytes;
 
-  /* source is always NULL for symmetric error checking code */
-  sc_io_source_t     *source = NULL;
+  if (bytes == 0) {
+    return SC_IO_ERROR_NONE;
+  }
+  sink->combine_bytes = 0;
+  return sc_io_sink_put (sink, sink->combine, bytes);
+}
+
+/** Write one piece of data, combining it with others if it is small. */
+static int
+sc_io_sink_write_piece (sc_io_sink_t * sink, const void *data,
+                        size_t bytes_avail)
+{
+  /* a write of zero bytes may begin an encoded stream */
+  if (bytes_avail > 0 &&
+      bytes_avail <= sink->combine_size - sink->combine_bytes) {
+    if (sink->combine == NULL) {
+      sink->combine = SC_ALLOC (char, sink->combine_size);
+    }
+    memcpy (sink->combine + sink->combine_bytes, data, bytes_avail);
+    sink->combine_bytes += bytes_avail;
+    return SC_IO_ERROR_NONE;
+  }
+  if (sc_io_sink_flush_combine (sink)) {
+    return SC_IO_ERROR_FATAL;
+  }
+  if (bytes_avail > 0 && bytes_avail < sink->combine_size) {
+    return sc_io_sink_write_piece (sink, data, bytes_avail);
+  }
+  return sc_io_sink_put (sink, data, bytes_avail);
+}
+
+int
+sc_io_sink_write (sc_io_sink_t * sink, const void *data, size_t bytes_avail)
+{
+  /* basic output preconditions */
+  SC_ASSERT (sink != NULL);
+  SC_ASSERT (data != NULL || bytes_avail == 0);
+
+  /* do nothing if there is no data requested */
+  if (bytes_avail == 0 && sink->encode == SC_IO_ENCODE_NONE) {
+    return SC_IO_ERROR_NONE;
+  }
+
+  /* write through the combining buffer */
+  if (sc_io_sink_write_piece (sink, data, bytes_avail)) {
+    return SC_IO_ERROR_FATAL;
+  }
+
+  /* update internal state and return on successful operation */
+  sink->bytes_in += bytes_avail;
+
+  /* success! */
+  return SC_IO_ERROR_NONE;
+}
+
+int
+sc_io_sink_writev (sc_io_sink_t * sink, const sc_io_iovec_t * iov,
+                   int iovcnt)
+{
+  int                 i;
+  size_t              total;
+  char               *pos;
+
+  SC_ASSERT (sink != NULL);
+  SC_ASSERT (iov != NULL || iovcnt == 0);
+
+  total = 0;
+  for (i = 0; i < iovcnt; ++i) {
+    SC_ASSERT (iov[i].data != NULL || iov[i].bytes == 0);
+    total += iov[i].bytes;
+  }
+
+  /* extend a buffer once and copy the pieces directly */
+  if (sink->iotype == SC_IO_TYPE_BUFFER &&
+      sink->encode == SC_IO_ENCODE_NONE &&
+      total > sink->combine_size - sink->combine_bytes) {
+    if (sc_io_sink_flush_combine (sink) ||
+        (pos = sc_io_sink_buffer_extend (sink, total)) == NULL) {
+      return SC_IO_ERROR_FATAL;
+    }
+    for (i = 0; i < iovcnt; ++i) {
+      memcpy (pos, iov[i].data, iov[i].bytes);
+      pos += iov[i].bytes;
+    }
+    sink->bytes_in += total;
+    return SC_IO_ERROR_NONE;
+  }
+
+  /* otherwise the pieces are combined as far as possible */
+  for (i = 0; i < iovcnt; ++i) {
+    if (sc_io_sink_write (sink, iov[i].data, iov[i].bytes)) {
+      return SC_IO_ERROR_FATAL;
+    }
+  }
+  return SC_IO_ERROR_NONE;
+}
+
+int
+sc_io_sink_buffer (sc_io_sink_t * sink, size_t bytes)
+{
+  SC_ASSERT (sink != NULL);
+
+  if (sc_io_sink_flush_combine (sink)) {
+    return SC_IO_ERROR_FATAL;
+  }
+  if (bytes != sink->combine_size) {
+    SC_FREE (sink->combine);
+    sink->combine = NULL;
+    sink->combine_size = bytes;
+  }
+  return SC_IO_ERROR_NONE;
+}
+
+int
+sc_io_sink_complete (sc_io_sink_t * sink, size_t *bytes_in, size_t *bytes_out)
+{
+  int                 retval;
+
+  /* pass on the combined data */
+  if (sc_io_sink_flush_combine (sink)) {
+    return SC_IO_ERROR_FATAL;
+  }
+
+#ifdef SC_HAVE_ZLIB
+  /* end the encoded stream */
+  if (sink->stream != NULL && sc_io_sink_finish (sink)) {
+    return SC_IO_ERROR_FATAL;
+  }
+#endif
+
+  retval = 0;
+  if (sink->iotype == SC_IO_TYPE_BUFFER) {
+    SC_ASSERT (sink->buffer != NULL);
+    if (sink->buffer_bytes % sink->buffer->elem_size != 0) {
+      return SC_IO_ERROR_AGAIN;
+    }
+  }
+  else if (sink->iotype == SC_IO_TYPE_FILENAME ||
+           sink->iotype == SC_IO_TYPE_FILEFILE) {
+    SC_ASSERT (sink->file != NULL);
+    retval = fflush (sink->file);
+  }
+  if (retval) {
+    return SC_IO_ERROR_FATAL;
+  }
+
+  if (bytes_in != NULL) {
+    *bytes_in = sink->bytes_in;
+  }
+  if (bytes_out != NULL) {
+    *bytes_out = sink->bytes_out;
+  }
+  sink->bytes_in = sink->bytes_out = 0;
+
+  return SC_IO_ERROR_NONE;
+}
+
+int
+sc_io_sink_align (sc_io_sink_t * sink, size_t bytes_align)
+{
+  size_t              fill_bytes;
+  char               *fill;
+  int                 retval;
+
+  fill_bytes = (bytes_align - sink->bytes_in % bytes_align) % bytes_align;
+  fill = SC_ALLOC_ZERO (char, fill_bytes);
+  retval = sc_io_sink_write (sink, fill, fill_bytes);
+  SC_FREE (fill);
+
+  return retval;
+}
+
+sc_io_source_t     *
+sc_io_source_new (int iotype, int ioencode, ...)
+{
+  sc_io_source_t     *source;
+  va_list             ap;
+
+  /* verify preconditions */
+  SC_ASSERT (0 <= iotype && iotype < SC_IO_TYPE_LAST);
+  SC_ASSERT (0 <= ioencode && ioencode < SC_IO_ENCODE_LAST);
+#ifndef SC_HAVE_ZLIB
+  if (ioencode != SC_IO_ENCODE_NONE) {
+    return NULL;
+  }
+#endif
+
+  /* initialize members of source object */
+  source = SC_ALLOC_ZERO (sc_io_source_t, 1);
+  source->iotype = (sc_io_type_t) iotype;
+  source->encode = (sc_io_encode_t) ioencode;
+
+  /* there is at least one type-dependent argument */
+  va_start (ap, ioencode);
+  if (iotype == SC_IO_TYPE_BUFFER) {
+    /* the source is presented in the form of an array */
+    source->buffer = va_arg (ap, sc_array_t *);
+  }
+  else if (iotype == SC_IO_TYPE_FILENAME) {
+    const char         *filename = va_arg (ap, const char *);
+
+    /* open a file on disk by name */
+    source->file = fopen (filename, "rb");
+    if (source->file == NULL) {
+      SC_FREE (source);
+      return NULL;
+    }
+  }
+  else if (iotype == SC_IO_TYPE_FILEFILE) {
+    /* read from an existing (readable) file object */
+    source->file = va_arg (ap, FILE *);
+    if (ferror (source->file)) {
+      SC_FREE (source);
+      return NULL;
+    }
+  }
+  else if (iotype == SC_IO_TYPE_MMAP) {
+    const char         *filename = va_arg (ap, const char *);
+
+    /* read from a view of the file mapped into memory */
+    source->buffer = SC_ALLOC (sc_array_t, 1);
+    if (sc_io_file_map (filename, source->buffer)) {
+      va_end (ap);
+      SC_FREE (source->buffer);
+      SC_FREE (source);
+      return NULL;
+    }
+  }
+  else {
+    SC_ABORT_NOT_REACHED ();
+  }
+  va_end (ap);
+
+#ifdef SC_HAVE_ZLIB
+  /* prepare the encoding */
+  if (source->encode != SC_IO_ENCODE_NONE &&
+      (source->stream = sc_io_stream_new (source->encode, 0)) == NULL) {
+    if (iotype == SC_IO_TYPE_FILENAME) {
+      (void) fclose (source->file);
+    }
+    else if (iotype == SC_IO_TYPE_MMAP) {
+      (void) sc_io_file_unmap (source->buffer);
+      SC_FREE (source->buffer);
+    }
+    SC_FREE (source);
+    return NULL;
+  }
+#endif
+
+  /* this source can now be called for reading */
+  return source;
+}
+
+int
+sc_io_source_destroy (sc_io_source_t * source)
+{
+  int                 retval;
+
+  /* complete reading */
+  retval = sc_io_source_complete (source, NULL, NULL);
+
+  /* destroy mirror */
+  if (source->mirror != NULL) {
+    retval = sc_io_sink_destroy (source->mirror) || retval;
+    sc_array_destroy (source->mirror_buffer);
+  }
+
+  /* The error value SC_IO_ERROR_AGAIN is turned into FATAL */
+  if (source->iotype == SC_IO_TYPE_FILENAME) {
+    SC_ASSERT (source->file != NULL);
+
+    /* Attempt close even on complete error */
+    retval = fclose (source->file) || retval;
+  }
+  else if (source->iotype == SC_IO_TYPE_MMAP) {
+    retval = sc_io_file_unmap (source->buffer) || retval;
+    SC_FREE (source->buffer);
+  }
+#ifdef SC_HAVE_ZLIB
+  if (source->stream != NULL) {
+    sc_io_stream_destroy ((sc_io_stream_t *) source->stream, 0);
+  }
+#endif
+  SC_FREE (source);
+
+  return retval ? SC_IO_ERROR_FATAL : SC_IO_ERROR_NONE;
+}
+
+int
+sc_io_source_destroy_null (sc_io_source_t ** source)
+{
+  int                 retval = SC_IO_ERROR_NONE;
+
+  /* pointer to source pointer must be set */
+  SC_ASSERT (source != NULL);
+
+  /* if source is still open, close it and NULL the pointer to it */
+  if (*source != NULL) {
+    retval = sc_io_source_destroy (*source);
+    *source = NULL;
+  }
+
+  /* in any case the source does no longer exist */
+  SC_ASSERT (*source == NULL);
+  return retval;
+}
+
+int
+sc_io_source_read (sc_io_source_t * source, void *data,
+                   size_t bytes_avail, size_t *bytes_out)
+{
+  int                 retval;
+  size_t              bbytes_out;
+
+  /* basic input preconditions.  It is legal if data is NULL */
+  SC_ASSERT (source != NULL);
+
+  /* do nothing also if the end of the file has been reached */
+  if (bytes_avail == 0 ||
+      (source->encode == SC_IO_ENCODE_NONE && source->is_eof)) {
+    if (bytes_out != NULL) {
+      *bytes_out = 0;
+    }
+    return SC_IO_ERROR_NONE;
+  }
+
+  /* read directly or through the encoding */
+#ifdef SC_HAVE_ZLIB
+  if (source->encode != SC_IO_ENCODE_NONE) {
+    retval = sc_io_source_inflate (source, (char *) data, bytes_avail,
+                                   &bbytes_out);
+  }
+  else
+#endif
+  {
+    retval = sc_io_source_read_raw (source, data, bytes_avail, &bbytes_out);
+    source->bytes_in += bbytes_out;
+  }
+  if (retval == SC_IO_ERROR_NONE && data != NULL && source->mirror != NULL) {
+    retval = sc_io_sink_write (source->mirror, data, bbytes_out);
+  }
+
+  /* process error conditions */
+  if (retval) {
+    return SC_IO_ERROR_FATAL;
+  }
+  if (bytes_out == NULL && bbytes_out < bytes_avail) {
+    return SC_IO_ERROR_FATAL;
+  }
+
+  /* complete and return on successful operation */
+  if (bytes_out != NULL) {
+    *bytes_out = bbytes_out;
+  }
+  source->bytes_out += bbytes_out;
+
+  /* success! */
+  return SC_IO_ERROR_NONE;
+}
+
+int
+sc_io_source_complete (sc_io_source_t * source,
+                       size_t *bytes_in, size_t *bytes_out)
+{
+  int                 retval = SC_IO_ERROR_NONE;
+
+#ifdef SC_HAVE_ZLIB
+  /* end the encoded stream if it has been read entirely */
+  if (source->stream != NULL &&
+      (retval = sc_io_source_finish (source)) != SC_IO_ERROR_NONE) {
+    return retval;
+  }
+#endif
+
+  if (source->iotype == SC_IO_TYPE_BUFFER ||
+      source->iotype == SC_IO_TYPE_MMAP) {
+    SC_ASSERT (source->buffer != NULL);
+    if (source->encode == SC_IO_ENCODE_NONE &&
+        source->buffer_bytes % source->buffer->elem_size != 0) {
+      return SC_IO_ERROR_AGAIN;
+    }
+  }
+  if (source->iotype != SC_IO_TYPE_BUFFER && source->mirror != NULL) {
+    retval = sc_io_sink_complete (source->mirror, NULL, NULL);
+  }
+
+  if (bytes_in != NULL) {
+    *bytes_in = source->bytes_in;
+  }
+  if (bytes_out != NULL) {
+    *bytes_out = source->bytes_out;
+  }
+  source->bytes_in = source->bytes_out = 0;
+
+  return retval;
+}
+
+int
+sc_io_source_align (sc_io_source_t * source, size_t bytes_align)
+{
+  size_t              fill_bytes;
+
+  fill_bytes = (bytes_align - source->bytes_out % bytes_align) % bytes_align;
+
+  return sc_io_source_read (source, NULL, fill_bytes, NULL);
+}
+
+int
+sc_io_source_activate_mirror (sc_io_source_t * source)
+{
+  if (source->iotype == SC_IO_TYPE_BUFFER) {
+    return SC_IO_ERROR_FATAL;
+  }
+  if (source->mirror != NULL) {
+    return SC_IO_ERROR_FATAL;
+  }
+
+  source->mirror_buffer = sc_array_new (sizeof (char));
+  source->mirror = sc_io_sink_new (SC_IO_TYPE_BUFFER, SC_IO_MODE_WRITE,
+                                   SC_IO_ENCODE_NONE, source->mirror_buffer);
+  if (source->mirror == NULL) {
+    return SC_IO_ERROR_FATAL;
+  }
+
+  /* the mirror buffer may be read before the source is completed */
+  return sc_io_sink_buffer (source->mirror, 0);
+}
+
+int
+sc_io_source_read_mirror (sc_io_source_t * source, void *data,
+                          size_t bytes_avail, size_t *bytes_out)
+{
+  sc_io_source_t     *mirror_src;
+  int                 retval;
+
+  if (source->mirror_buffer == NULL) {
+    return SC_IO_ERROR_FATAL;
+  }
+
+  mirror_src = sc_io_source_new (SC_IO_TYPE_BUFFER, SC_IO_ENCODE_NONE,
+                                 source->mirror_buffer);
+  retval = (mirror_src != NULL ? SC_IO_ERROR_NONE : SC_IO_ERROR_FATAL);
+  retval = retval || sc_io_source_read (mirror_src, data, bytes_avail,
+                                        bytes_out);
+  if (mirror_src != NULL) {
+    retval = sc_io_source_destroy (mirror_src) || retval;
+  }
+
+  return retval;
+}
+
+static int
+file_return (int retval, sc_io_sink_t * sink, sc_io_source_t * source)
+{
+  if (sink != NULL) {
+    /* preserve error condition */
+    retval = sc_io_sink_destroy (sink) || retval;
+  }
+  if (source != NULL) {
+    /* preserve error condition */
+    retval = sc_io_source_destroy (source) || retval;
+  }
+  return retval;
+}
+
+int
+sc_io_file_save (const char *filename, sc_array_t * buffer)
+{
+  /* sink is always a meaningful pointer and freed before return */
+  sc_io_sink_t       *sink = NULL;
+
+  /* source is always NULL for symmetric error checking code */
+  sc_io_source_t     *source = NULL;
+
+  SC_ASSERT (filename != NULL);
+  SC_ASSERT (buffer != NULL);
+  SC_ASSERT (buffer->elem_size == 1);
+
+  /* open a file to write to */
+  if ((sink = sc_io_sink_new (SC_IO_TYPE_FILENAME, SC_IO_MODE_WRITE,
+                              SC_IO_ENCODE_NONE, filename)) == NULL) {
+    SC_LERRORF ("sc_io_file_save: error opening %s\n", filename);
+    return file_return (-1, sink, source);
+  }
+
+  /* write all data in one call */
+  if (sc_io_sink_write (sink, buffer->array, buffer->elem_count)) {
+    SC_LERRORF ("sc_io_file_save: error writing to %s\n", filename);
+    return file_return (-1, sink, source);
+  }
+
+  /* close file and free metadata */
+  if (sc_io_sink_destroy_null (&sink)) {
+    SC_LERRORF ("sc_io_file_save: error closing %s\n", filename);
+    return file_return (-1, sink, source);
+  }
+
+  /* return success by the same convention */
+  return file_return (0, sink, source);
+}
+
+int
+sc_io_file_load (const char *filename, sc_array_t * buffer)
+{
+  /* sink is always NULL for symmetric error checking code */
+  sc_io_sink_t       *sink = NULL;
+
+  /* source is always a meaningful pointer and freed before return */
+  sc_io_source_t     *source = NULL;
+
+  /* fixed window size for reading a usually small file */
+  const size_t        bwins = 1 << 14;
+  size_t              bpos, bout;
+
+  SC_ASSERT (filename != NULL);
+  SC_ASSERT (buffer != NULL);
+  SC_ASSERT (buffer->elem_size == 1);
+  SC_ASSERT (SC_ARRAY_IS_OWNER (buffer));
+
+  /* open a file to read from */
+  if ((source = sc_io_source_new
+       (SC_IO_TYPE_FILENAME, SC_IO_ENCODE_NONE, filename)) == NULL) {
+    SC_LERRORF ("sc_io_file_load: error opening %s\n", filename);
+    return file_return (-1, sink, source);
+  }
+
+  /* perform reading in a loop */
+  bpos = 0;
+  for (;;) {
+    /* make room in read buffer */
+    sc_array_resize (buffer, bpos + bwins);
+
+    /* read next fixed size batch of data */
+    if (sc_io_source_read (source, sc_array_index (buffer, bpos),
+                           bwins, &bout)) {
+      SC_LERRORF ("sc_io_file_load: error reading from %s\n", filename);
+      return file_return (-1, sink, source);
+    }
+
+    /* examine buffer status after reading */
+    if (bout < bwins) {
+      /* we have reached end of file: finalize buffer */
+      sc_array_resize (buffer, bpos += bout);
+      break;
+    }
+
+    /* update read buffer size */
+    bpos += bwins;
+  }
+  SC_ASSERT (bpos == buffer->elem_count);
+
+  /* close file and free metadata */
+  if (sc_io_source_destroy_null (&source)) {
+    SC_LERRORF ("Error closing file after reading: %s\n", filename);
+    return file_return (-1, sink, source);
+  }
+
+  /* return success by the same convention */
+  return file_return (0, sink, source);
+}
+
+int
+sc_io_file_map (const char *filename, sc_array_t * view)
+{
+#ifdef SC_IO_HAVE_MMAP
+  int                 fd;
+  void               *base;
+  size_t              size;
+  struct stat         st;
+
+  SC_ASSERT (filename != NULL);
+  SC_ASSERT (view != NULL);
+
+  /* open the file and determine its size */
+  if ((fd = open (filename, O_RDONLY)) < 0) {
+    SC_LERRORF ("sc_io_file_map: error opening %s\n", filename);
+    return -1;
+  }
+  if (fstat (fd, &st) || !S_ISREG (st.st_mode)) {
+    SC_LERRORF ("sc_io_file_map: no regular file %s\n", filename);
+    (void) close (fd);
+    return -1;
+  }
+  size = (size_t) st.st_size;
+
+  /* an empty file cannot be mapped */
+  base = NULL;
+  if (size > 0) {
+    base = mmap (NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (base == MAP_FAILED) {
+      SC_LERRORF ("sc_io_file_map: error mapping %s\n", filename);
+      (void) close (fd);
+      return -1;
+    }
+#ifdef MADV_SEQUENTIAL
+    /* the data is usually consumed front to back */
+    (void) madvise (base, size, MADV_SEQUENTIAL);
+#endif
+  }
+
+  /* the mapping stays valid after closing the file */
+  if (close (fd)) {
+    SC_LERRORF ("sc_io_file_map: error closing %s\n", filename);
+    if (base != NULL) {
+      (void) munmap (base, size);
+    }
+    return -1;
+  }
+  sc_array_init_data (view, base, 1, size);
+  return 0;
+#else
+  sc_array_t          buffer;
+
+  SC_ASSERT (filename != NULL);
+  SC_ASSERT (view != NULL);
+
+  /* without mmap we read the file and take over its memory */
+  sc_array_init (&buffer, 1);
+  if (sc_io_file_load (filename, &buffer)) {
+    sc_array_reset (&buffer);
+    return -1;
+  }
+  sc_array_init_data (view, buffer.array, 1, buffer.elem_count);
+  return 0;
+#endif
+}
+
+int
+sc_io_file_unmap (sc_array_t * view)
+{
+  SC_ASSERT (view != NULL);
+  SC_ASSERT (view->elem_size == 1);
+  SC_ASSERT (!SC_ARRAY_IS_OWNER (view));
+
+#ifdef SC_IO_HAVE_MMAP
+  if (view->elem_count > 0 && munmap (view->array, view->elem_count)) {
+    SC_LERROR ("sc_io_file_unmap: error unmapping\n");
+    sc_array_init_data (view, NULL, 1, 0);
+    return -1;
+  }
+#else
+  SC_FREE (view->array);
+#endif
+  sc_array_init_data (view, NULL, 1, 0);
+  return 0;
+}
+
+/* see RFC 1950 and RFC 1951 for the uncompressed zlib format */
+#ifndef SC_HAVE_ZLIB
+#define SC_IO_NONCOMP_BLOCK 65531       /**< +5 byte header = 64k */
+
+static size_t
+sc_io_noncompress_bound (size_t length)
+{
+  size_t              num_blocks =
+    (length + (SC_IO_NONCOMP_BLOCK - 1)) / SC_IO_NONCOMP_BLOCK;
+
+  return 2 + 5 * SC_MAX (num_blocks, 1) + length + 4;
+}
+
+static void
+sc_io_noncompress (char *dest, size_t dest_size,
+                   const char *src, size_t src_size)
+{
+  uint16_t            bsize, nsize;
+  uint32_t            adler;
+
+  /* write zlib format header */
+  SC_ASSERT (dest_size >= 2);
+  dest[0] = (7 << 4) + 8;
+  dest[1] = 1;
+  dest += 2;
+  dest_size -= 2;
+
+  /* prepare checksum */
+  adler = sc_adler32 (0, NULL, 0);
+
+  /* write individual non-compressed blocks */
+  do {
+    /* write block header */
+    SC_ASSERT (dest_size >= 5);
+    if (src_size > SC_IO_NONCOMP_BLOCK) {
+      /* not the final block */
+      bsize = SC_IO_NONCOMP_BLOCK;
+      dest[0] = 0;
+    }
+    else {
+      /* last block */
+      bsize = src_size;
+      dest[0] = 1;
+    }
+    nsize = ~bsize;
+    dest[1] = (char) (bsize & 0xFF);
+    dest[2] = (char) (bsize >> 8);
+    dest[3] = (char) (nsize & 0xFF);
+    dest[4] = (char) (nsize >> 8);
+    dest += 5;
+    dest_size -= 5;
 
-  SC_ASSERT (filename != NULL);
-  SC_ASSERT (buffer != NULL);
-  SC_ASSERT (buffer->elem_size == 1);
+    /* copy data */
+    SC_ASSERT (dest_size >= bsize);
+    SC_ASSERT (src_size >= bsize);
+    memcpy (dest, src, bsize);
+    dest += bsize;
+    dest_size -= bsize;
 
-  /* open a file to write to */
-  if ((sink = sc_io_sink_new (SC_IO_TYPE_FILENAME, SC_IO_MODE_WRITE,
-                              SC_IO_ENCODE_NONE, filename)) == NULL) {
-    SC_LERRORF ("sc_io_file_save: error opening %s\n", filename);
-    return file_return (-1, sink, source);
+    /* extend adler32 checksum */
+    adler = sc_adler32 (adler, src, bsize);
+    src += bsize;
+    src_size -= bsize;
   }
+  while (src_size > 0);
 
-  /* write all data in one call */
-  if (sc_io_sink_write (sink, buffer->array, buffer->elem_count)) {
-    SC_LERRORF ("sc_io_file_save: error writing to %s\n", filename);
-    return file_return (-1, sink, source);
+  /* write adler32 checksum */
+  SC_ASSERT (src_size == 0);
+  SC_ASSERT (dest_size == 4);
+  dest[0] = (char) (adler >> 24);
+  dest[1] = (char) ((adler >> 16) & 0xFF);
+  dest[2] = (char) ((adler >> 8) & 0xFF);
+  dest[3] = (char) (adler & 0xFF);
+}
+
+static int
+sc_io_nonuncompress (char *dest, size_t dest_size,
+                     const char *src, size_t src_size, void *re)
+{
+  uint32_t            adler;
+  unsigned char       uca, ucb;
+  size_t              sourcelen;
+
+  /* in the future we will add runtime error reporting */
+  SC_ASSERT (re == NULL);
+
+  /* check zlib format header */
+  if (src_size < 2) {
+    SC_LERROR ("uncompress header short\n");
+    return -1;
+  }
+  uca = (unsigned char) src[0];
+  if ((uca & 0x8F) != 8) {
+    SC_LERROR ("uncompress method unsupported\n");
+    return -1;
+  }
+  ucb = (unsigned char) src[1];
+  if (((((unsigned) uca) << 8) + ucb) % 31) {
+    SC_LERROR ("uncompress header not conforming\n");
+    return -1;
+  }
+  if (ucb & 0x20) {
+    SC_LERROR ("uncompress cannot handle dictionary\n");
+    return -1;
   }
+  src += 2;
+  src_size -= 2;
 
-  /* close file and free metadata */
-  if (sc_io_sink_destroy_null (&sink)) {
-    SC_LERRORF ("sc_io_file_save: error closing %s\n", filename);
-    return file_return (-1, sink, source);
+  /* prepare checksum */
+  adler = sc_adler32 (0, NULL, 0);
+
+  /* decompress all deflate blocks with the builtin fallback */
+  if (src_size < 5) {
+    SC_LERROR ("uncompress block header short\n");
+    return -1;
   }
+  sourcelen = src_size - 4;
+  if (sc_inflate (dest, dest_size, src, &sourcelen)) {
+    SC_LERROR ("uncompress by inflate failed\n");
+    return -1;
+  }
+  if (sourcelen != src_size - 4) {
+    SC_LERROR ("uncompress content error\n");
+    return -1;
+  }
+  src += sourcelen;
 
-  /* return success by the same convention */
-  return file_return (0, sink, source);
+  /* extend adler32 checksum */
+  adler = sc_adler32 (adler, dest, dest_size);
+
+  /* verify adler32 checksum */
+  if (src[0] != (char) (adler >> 24) ||
+      src[1] != (char) ((adler >> 16) & 0xFF) ||
+      src[2] != (char) ((adler >> 8) & 0xFF) ||
+      src[3] != (char) (adler & 0xFF)) {
+    SC_LERROR ("uncompress checksum error\n");
+    return -1;
+  }
+
+  /* task accomplished */
+  return 0;
 }
 
-int
-sc_io_file_load (const char *filename, sc_array_t * buffer)
+#endif /* !SC_HAVE_ZLIB */
+
+/* the LZ codec compresses independent chunks of fixed size */
+#define SC_IO_LZ_CHUNK ((size_t) 1 << 20)
+#define SC_IO_LZ_HEADER 4       /**< big-endian compressed chunk size */
+
+/* see the LZ4 block format description for these parameters */
+#ifndef SC_HAVE_LZ4
+#define SC_IO_LZ_HASHLOG 14
+#define SC_IO_LZ_MINMATCH 4
+#define SC_IO_LZ_LASTLITERALS 5 /**< a block ends in this many literals */
+#define SC_IO_LZ_MFLIMIT 12     /**< no match starts closer to the end */
+#define SC_IO_LZ_MAXOFFSET 65535
+#endif
+
+/** Return the maximum LZ4 block size for a chunk of input data. */
+static size_t
+sc_io_lz_bound (size_t length)
 {
-  /* sink is always NULL for symmetric error checking code */
-  sc_io_sink_t       *sink = NULL;
+  SC_ASSERT (length <= SC_IO_LZ_CHUNK);
+#ifdef SC_HAVE_LZ4
+  return (size_t) LZ4_compressBound ((int) length);
+#else
+  return length + length / 255 + 16;
+#endif
+}
 
-  /* source is always a meaningful pointer and freed before return */
-  sc_io_source_t     *source = NULL;
+#ifndef SC_HAVE_LZ4
 
-  /* fixed window size for reading a usually small file */
-  const size_t        bwins = 1 << 14;
-  size_t              bpos, bout;
+static uint32_t
+sc_io_lz_read32 (const unsigned char *p)
+{
+  uint32_t            v;
 
-  SC_ASSERT (filename != NULL);
-  SC_ASSERT (buffer != NULL);
-  SC_ASSERT (buffer->elem_size == 1);
-  SC_ASSERT (SC_ARRAY_IS_OWNER (buffer));
+  memcpy (&v, p, 4);
+  return v;
+}
 
-  /* open a file to read from */
-  if ((source = sc_io_source_new
-       (SC_IO_TYPE_FILENAME, SC_IO_ENCODE_NONE, filename)) == NULL) {
-    SC_LERRORF ("sc_io_file_load: error opening %s\n", filename);
-    return file_return (-1, sink, source);
+static uint32_t
+sc_io_lz_hash (uint32_t v)
+{
+  return (v * 2654435761U) >> (32 - SC_IO_LZ_HASHLOG);
+}
+
+/** Write the extra bytes of a literal or match length of 15 or more. */
+static unsigned char *
+sc_io_lz_length (unsigned char *op, size_t length)
+{
+  SC_ASSERT (length >= 15);
+  for (length -= 15; length >= 255; length -= 255) {
+    *op++ = 255;
   }
+  *op++ = (unsigned char) length;
+  return op;
+}
 
-  /* perform reading in a loop */
-  bpos = 0;
-  for (;;) {
-    /* make room in read buffer */
-    sc_array_resize (buffer, bpos + bwins);
+/** Write one LZ4 sequence of literals and a match of nonzero length,
+ * or the final sequence of literals only if the match length is zero. */
+static unsigned char *
+sc_io_lz_sequence (unsigned char *op, const unsigned char *literals,
+                   size_t num_literals, size_t offset, size_t match_length)
+{
+  unsigned char      *token = op++;
 
-    /* read next fixed size batch of data */
-    if (sc_io_source_read (source, sc_array_index (buffer, bpos),
-                           bwins, &bout)) {
-      SC_LERRORF ("sc_io_file_load: error reading from %s\n", filename);
-      return file_return (-1, sink, source);
+  *token = (unsigned char) (SC_MIN (num_literals, 15) << 4);
+  if (num_literals >= 15) {
+    op = sc_io_lz_length (op, num_literals);
+  }
+  memcpy (op, literals, num_literals);
+  op += num_literals;
+  if (match_length > 0) {
+    SC_ASSERT (match_length >= SC_IO_LZ_MINMATCH);
+    SC_ASSERT (0 < offset && offset <= SC_IO_LZ_MAXOFFSET);
+    *op++ = (unsigned char) (offset & 0xFF);
+    *op++ = (unsigned char) (offset >> 8);
+    match_length -= SC_IO_LZ_MINMATCH;
+    *token |= (unsigned char) SC_MIN (match_length, 15);
+    if (match_length >= 15) {
+      op = sc_io_lz_length (op, match_length);
     }
+  }
+  return op;
+}
 
-    /* examine buffer status after reading */
-    if (bout < bwins) {
-      /* we have reached end of file: finalize buffer */
-      sc_array_resize (buffer, bpos += bout);
+/** Compress one chunk into an LZ4 block by greedy hashed matching.
+ * The output is decodable by any conforming LZ4 decoder.
+ * \return          Compressed size, at most \ref sc_io_lz_bound.
+ */
+static size_t
+sc_io_lz_compress_block (unsigned char *dest, const unsigned char *src,
+                         size_t src_size, uint32_t *table)
+{
+  uint32_t            seq, h;
+  size_t              ml;
+  const unsigned char *ip = src, *anchor = src, *ref;
+  const unsigned char *iend = src + src_size;
+  unsigned char      *op = dest;
+
+  if (src_size > SC_IO_LZ_MFLIMIT) {
+    const unsigned char *mflimit = iend - SC_IO_LZ_MFLIMIT;
+    const unsigned char *matchlimit = iend - SC_IO_LZ_LASTLITERALS;
+
+    memset (table, 0, sizeof (uint32_t) << SC_IO_LZ_HASHLOG);
+    while (ip < mflimit) {
+      seq = sc_io_lz_read32 (ip);
+      h = sc_io_lz_hash (seq);
+      ref = src + table[h];
+      table[h] = (uint32_t) (ip - src);
+      if (ref >= ip || ip - ref > SC_IO_LZ_MAXOFFSET ||
+          sc_io_lz_read32 (ref) != seq) {
+        /* skip faster through data that does not compress */
+        ip += 1 + ((size_t) (ip - anchor) >> 6);
+        continue;
+      }
+
+      /* extend the match in both directions */
+      while (ip > anchor && ref > src && ip[-1] == ref[-1]) {
+        --ip;
+        --ref;
+      }
+      for (ml = SC_IO_LZ_MINMATCH;
+           ip + ml < matchlimit && ip[ml] == ref[ml]; ++ml) {
+      }
+      op = sc_io_lz_sequence (op, anchor, (size_t) (ip - anchor),
+                              (size_t) (ip - ref), ml);
+      ip += ml;
+      anchor = ip;
+    }
+  }
+
+  /* the block ends with the remaining literals */
+  op = sc_io_lz_sequence (op, anchor, (size_t) (iend - anchor), 0, 0);
+  SC_ASSERT ((size_t) (op - dest) <= sc_io_lz_bound (src_size));
+  return (size_t) (op - dest);
+}
+
+/** Decompress one LZ4 block with bounds checks on every access.
+ * \return          0 if the block decodes to exactly \a dest_size bytes.
+ */
+static int
+sc_io_lz_uncompress_block (unsigned char *dest, size_t dest_size,
+                           const unsigned char *src, size_t src_size)
+{
+  unsigned            token, b;
+  size_t              num_literals, offset, ml;
+  const unsigned char *ip = src, *iend = src + src_size;
+  unsigned char      *op = dest, *oend = dest + dest_size;
+
+  for (;;) {
+    /* copy literals */
+    if (ip >= iend) {
+      return -1;
+    }
+    token = *ip++;
+    num_literals = token >> 4;
+    if (num_literals == 15) {
+      do {
+        if (ip >= iend) {
+          return -1;
+        }
+        b = *ip++;
+        num_literals += b;
+      }
+      while (b == 255);
+    }
+    if ((size_t) (iend - ip) < num_literals ||
+        (size_t) (oend - op) < num_literals) {
+      return -1;
+    }
+    memcpy (op, ip, num_literals);
+    ip += num_literals;
+    op += num_literals;
+    if (ip == iend) {
+      /* the final sequence has no match */
       break;
     }
 
-    /* update read buffer size */
-    bpos += bwins;
+    /* copy match, which may overlap its own output */
+    if (iend - ip < 2) {
+      return -1;
+    }
+    offset = ip[0] + ((size_t) ip[1] << 8);
+    ip += 2;
+    if (offset == 0 || offset > (size_t) (op - dest)) {
+      return -1;
+    }
+    ml = token & 15;
+    if (ml == 15) {
+      do {
+        if (ip >= iend) {
+          return -1;
+        }
+        b = *ip++;
+        ml += b;
+      }
+      while (b == 255);
+    }
+    ml += SC_IO_LZ_MINMATCH;
+    if ((size_t) (oend - op) < ml) {
+      return -1;
+    }
+    if (offset >= ml) {
+      memcpy (op, op - offset, ml);
+      op += ml;
+    }
+    else {
+      for (; ml > 0; --ml, ++op) {
+        *op = op[-(ptrdiff_t) offset];
+      }
+    }
   }
-  SC_ASSERT (bpos == buffer->elem_count);
+  return op == oend ? 0 : -1;
+}
 
-  /* close file and free metadata */
-  if (sc_io_source_destroy_null (&source)) {
-    SC_LERRORF ("Error closing file after reading: %s\n", filename);
-    return file_return (-1, sink, source);
+#endif /* !SC_HAVE_LZ4 */
+
+/** Compress data chunk by chunk, each preceded by its compressed size.
+ * \return          The number of bytes written to \a dest.
+ */
+static size_t
+sc_io_lz_compress (char *dest, const char *src, size_t src_size)
+{
+  int                 i;
+  size_t              chunk, csize, total;
+#ifdef SC_HAVE_LZ4
+  int                 lrv;
+#else
+  uint32_t           *table;
+
+  table = SC_ALLOC (uint32_t, 1 << SC_IO_LZ_HASHLOG);
+#endif
+
+  total = 0;
+  while (src_size > 0) {
+    chunk = SC_MIN (src_size, SC_IO_LZ_CHUNK);
+#ifdef SC_HAVE_LZ4
+    lrv = LZ4_compress_default (src, dest + SC_IO_LZ_HEADER, (int) chunk,
+                                (int) sc_io_lz_bound (chunk));
+    SC_CHECK_ABORT (lrv > 0, "Error on LZ4 compression");
+    csize = (size_t) lrv;
+#else
+    csize = sc_io_lz_compress_block
+      ((unsigned char *) dest + SC_IO_LZ_HEADER,
+       (const unsigned char *) src, chunk, table);
+#endif
+    for (i = 0; i < SC_IO_LZ_HEADER; ++i) {
+      dest[i] = (char) ((csize >> ((SC_IO_LZ_HEADER - 1 - i) * 8)) & 0xFF);
+    }
+    dest += SC_IO_LZ_HEADER + csize;
+    total += SC_IO_LZ_HEADER + csize;
+    src += chunk;
+    src_size -= chunk;
   }
 
-  /* return success by the same convention */
-  return file_return (0, sink, source);
+#ifndef SC_HAVE_LZ4
+  SC_FREE (table);
+#endif
+  return total;
 }
 
-/* byte count for one line of data must be a multiple of 3 */
-#define SC_IO_DBC 57
-#if SC_IO_DBC % 3 != 0
-#error "SC_IO_DBC must be a multiple of 3"
+static int
+sc_io_lz_uncompress (char *dest, size_t dest_size,
+                     const char *src, size_t src_size)
+{
+  int                 i;
+  size_t              chunk, csize;
+
+  while (dest_size > 0) {
+    /* read the size of the next compressed chunk */
+    chunk = SC_MIN (dest_size, SC_IO_LZ_CHUNK);
+    if (src_size < SC_IO_LZ_HEADER) {
+      SC_LERROR ("uncompress LZ chunk header short\n");
+      return -1;
+    }
+    csize = 0;
+    for (i = 0; i < SC_IO_LZ_HEADER; ++i) {
+      csize = (csize << 8) + (unsigned char) src[i];
+    }
+    src += SC_IO_LZ_HEADER;
+    src_size -= SC_IO_LZ_HEADER;
+    if (csize > src_size || csize > sc_io_lz_bound (chunk)) {
+      SC_LERROR ("uncompress LZ chunk header invalid\n");
+      return -1;
+    }
+
+    /* decompress the chunk */
+#ifdef SC_HAVE_LZ4
+    if (LZ4_decompress_safe (src, dest, (int) csize, (int) chunk) !=
+        (int) chunk) {
+#else
+    if (sc_io_lz_uncompress_block ((unsigned char *) dest, chunk,
+                                   (const unsigned char *) src, csize)) {
 #endif
+      SC_LERROR ("uncompress LZ chunk content error\n");
+      return -1;
+    }
+    src += csize;
+    src_size -= csize;
+    dest += chunk;
+    dest_size -= chunk;
+  }
+  if (src_size != 0) {
+    SC_LERROR ("uncompress LZ content error\n");
+    return -1;
+  }
+  return 0;
+}
 
-/* byte count for one line of base64 encoded data and newline */
-#define SC_IO_LBC (SC_IO_DBC / 3 * 4)
-#define SC_IO_LBD (SC_IO_LBC + 1)   /* after first line break byte */
-#define SC_IO_LBE (SC_IO_LBD + 1)   /* after second line break byte */
-#define SC_IO_LBF (SC_IO_LBE + 1)   /* after line break and NUL byte */
+int                 sc_io_compress_threads = 1;
 
-/* see RFC 1950 and RFC 1951 for the uncompressed zlib format */
-#ifndef SC_HAVE_ZLIB
-#define SC_IO_NONCOMP_BLOCK 65531       /**< +5 byte header = 64k */
-#define SC_IO_ADLER32_PRIME 65521       /**< defined by RFC 1950 */
+/* like pigz, we deflate chunks of this size concurrently */
+#define SC_IO_DEFLATE_CHUNK ((size_t) 1 << 17)
+#define SC_IO_DEFLATE_WINDOW ((size_t) 1 << 15)
 
-static void
-sc_io_adler32_init (uint32_t *adler)
+/** The compression applied to each chunk by \ref sc_io_chunks_run. */
+typedef enum
+{
+  SC_IO_CHUNK_DEFLATE,  /**< Raw deflate primed with the preceding window. */
+  SC_IO_CHUNK_ZLIB,     /**< Independent zlib streams as for VTK. */
+  SC_IO_CHUNK_LZ        /**< Independent LZ4 blocks. */
+}
+sc_io_chunk_type_t;
+
+/** A range of input chunks to be compressed concurrently.
+ * The chunks are numbered from the beginning of the input, such that
+ * a chunk may refer to the data before it.  Chunk i is written to
+ * \a dest + (i - \a first) * \a slot_size.
+ */
+typedef struct sc_io_chunks
+{
+  sc_io_chunk_type_t  type;             /**< Compression of each chunk. */
+  int                 level;            /**< Compression level of zlib. */
+  int                 num_threads;      /**< Number of threads to use. */
+  const char         *src;              /**< All input data. */
+  size_t              src_size;         /**< Byte size of all input. */
+  size_t              chunk_size;       /**< All chunks but the last. */
+  size_t              first;            /**< First chunk to compress. */
+  size_t              num_chunks;       /**< Number of chunks to compress. */
+  size_t              slot_size;        /**< Output space of a chunk. */
+  char               *dest;             /**< Output of all chunks. */
+  size_t             *csizes;           /**< Compressed size per chunk. */
+  unsigned long      *checks;           /**< Deflate: adler32 per chunk. */
+}
+sc_io_chunks_t;
+
+/** The state of one thread of \ref sc_io_chunks_run. */
+typedef struct sc_io_chunks_worker
+{
+  sc_io_chunks_t     *ch;               /**< Shared description of work. */
+  int                 id;               /**< Number of this thread. */
+  uint32_t           *table;            /**< In-tree LZ hash table. */
+#ifdef SC_ENABLE_PTHREAD
+  int                 joinable;         /**< Boolean for a running thread. */
+  pthread_t           thread;           /**< Executes the compression. */
+#endif
+}
+sc_io_chunks_worker_t;
+
+#ifdef SC_HAVE_ZLIB
+
+/** Deflate one chunk such that the chunks concatenate to one stream.
+ * All but the last chunk end on a byte boundary by a sync flush.
+ * The last chunk ends the stream.  As pigz does, we use the preceding
+ * input as dictionary to lose hardly any compression.
+ */
+static size_t
+sc_io_deflate_chunk (sc_io_chunks_t * ch, size_t i, char *dest)
 {
-  SC_ASSERT (adler != NULL);
-  *adler = 1;
+  int                 zrv, last;
+  size_t              start, length, dictlen;
+  z_stream            strm;
+
+  start = i * ch->chunk_size;
+  length = SC_MIN (ch->chunk_size, ch->src_size - start);
+  last = (start + length == ch->src_size);
+
+  memset (&strm, 0, sizeof (z_stream));
+  zrv = deflateInit2 (&strm, ch->level, Z_DEFLATED, -15, 8,
+                      Z_DEFAULT_STRATEGY);
+  SC_CHECK_ABORT (zrv == Z_OK, "Error on deflate initialization");
+  if (start > 0) {
+    dictlen = SC_MIN (start, SC_IO_DEFLATE_WINDOW);
+    zrv = deflateSetDictionary (&strm, (const Bytef *) ch->src + start -
+                                dictlen, (uInt) dictlen);
+    SC_CHECK_ABORT (zrv == Z_OK, "Error on deflate dictionary");
+  }
+  strm.next_in = (Bytef *) ch->src + start;
+  strm.avail_in = (uInt) length;
+  strm.next_out = (Bytef *) dest;
+  strm.avail_out = (uInt) ch->slot_size;
+  zrv = deflate (&strm, last ? Z_FINISH : Z_SYNC_FLUSH);
+  SC_CHECK_ABORT (zrv == (last ? Z_STREAM_END : Z_OK) &&
+                  strm.avail_in == 0 && strm.avail_out > 0,
+                  "Error on deflate compression");
+  deflateEnd (&strm);
+
+  ch->checks[i - ch->first] =
+    adler32 (adler32 (0L, Z_NULL, 0), (const Bytef *) ch->src + start,
+             (uInt) length);
+  return ch->slot_size - strm.avail_out;
 }
 
+#endif /* SC_HAVE_ZLIB */
+
+/** Compress one chunk into its slot. */
 static void
-sc_io_adler32_update (uint32_t *adler, const char *buffer, size_t length)
+sc_io_chunk_compress (sc_io_chunks_worker_t * w, size_t i)
 {
-  size_t              iz;
-  int16_t             cn;
-  uint32_t            s1, s2;
-
-  SC_ASSERT (adler != NULL);
-  s1 = (*adler) & 0xFFFFU;
-  s2 = (*adler) >> 16;
+  sc_io_chunks_t     *ch = w->ch;
+  const char         *src = ch->src + i * ch->chunk_size;
+  size_t              length;
+  char               *dest;
+#ifdef SC_HAVE_ZLIB
+  int                 zrv;
+  uLong               zlen;
+#endif
+#ifdef SC_HAVE_LZ4
+  int                 lrv;
+#endif
 
-  cn = 0;
-  for (iz = 0; iz < length; ++iz) {
-    unsigned char       uc = (unsigned char) buffer[iz];
-    if (cn == 5000) {
-      s1 = s1 % SC_IO_ADLER32_PRIME;
-      s2 = s2 % SC_IO_ADLER32_PRIME;
-      cn = 0;
-    }
-    s1 += uc;
-    s2 += s1;
-    ++cn;
+  SC_ASSERT (ch->first <= i && i < ch->first + ch->num_chunks);
+  length = SC_MIN (ch->chunk_size, ch->src_size - i * ch->chunk_size);
+  dest = ch->dest + (i - ch->first) * ch->slot_size;
+  switch (ch->type) {
+#ifdef SC_HAVE_ZLIB
+  case SC_IO_CHUNK_DEFLATE:
+    ch->csizes[i - ch->first] = sc_io_deflate_chunk (ch, i, dest);
+    break;
+  case SC_IO_CHUNK_ZLIB:
+    zlen = (uLong) ch->slot_size;
+    zrv = compress2 ((Bytef *) dest, &zlen, (const Bytef *) src,
+                     (uLong) length, ch->level);
+    SC_CHECK_ABORT (zrv == Z_OK, "Error on zlib compression");
+    ch->csizes[i - ch->first] = (size_t) zlen;
+    break;
+#endif
+  case SC_IO_CHUNK_LZ:
+#ifdef SC_HAVE_LZ4
+    lrv = LZ4_compress_default (src, dest, (int) length,
+                                (int) ch->slot_size);
+    SC_CHECK_ABORT (lrv > 0, "Error on LZ4 compression");
+    ch->csizes[i - ch->first] = (size_t) lrv;
+#else
+    ch->csizes[i - ch->first] = sc_io_lz_compress_block
+      ((unsigned char *) dest, (const unsigned char *) src, length,
+       w->table);
+#endif
+    break;
+  default:
+    SC_ABORT_NOT_REACHED ();
   }
-  *adler = s2 % SC_IO_ADLER32_PRIME;
-  *adler = (*adler << 16) + (s1 % SC_IO_ADLER32_PRIME);
 }
 
-static size_t
-sc_io_noncompress_bound (size_t length)
+/** Compress the chunks assigned to one thread in round robin order. */
+static void        *
+sc_io_chunks_work (void *v)
 {
-  size_t              num_blocks =
-    (length + (SC_IO_NONCOMP_BLOCK - 1)) / SC_IO_NONCOMP_BLOCK;
+  sc_io_chunks_worker_t *w = (sc_io_chunks_worker_t *) v;
+  sc_io_chunks_t     *ch = w->ch;
+  size_t              i;
 
-  return 2 + 5 * SC_MAX (num_blocks, 1) + length + 4;
+  for (i = ch->first + w->id; i < ch->first + ch->num_chunks;
+       i += ch->num_threads) {
+    sc_io_chunk_compress (w, i);
+  }
+  return NULL;
 }
 
+/** Compress a range of chunks with the configured number of threads.
+ * If a thread cannot be created, the calling thread does its work.
+ */
 static void
-sc_io_noncompress (char *dest, size_t dest_size,
-                   const char *src, size_t src_size)
+sc_io_chunks_run (sc_io_chunks_t * ch)
 {
-  uint16_t            bsize, nsize;
-  uint32_t            adler;
-
-  /* write zlib format header */
-  SC_ASSERT (dest_size >= 2);
-  dest[0] = (7 << 4) + 8;
-  dest[1] = 1;
-  dest += 2;
-  dest_size -= 2;
+  int                 t;
+  sc_io_chunks_worker_t *workers;
+
+  SC_ASSERT (ch->num_threads >= 1);
+  workers = SC_ALLOC_ZERO (sc_io_chunks_worker_t, ch->num_threads);
+  for (t = 0; t < ch->num_threads; ++t) {
+    workers[t].ch = ch;
+    workers[t].id = t;
+#ifndef SC_HAVE_LZ4
+    if (ch->type == SC_IO_CHUNK_LZ) {
+      workers[t].table = SC_ALLOC (uint32_t, 1 << SC_IO_LZ_HASHLOG);
+    }
+#endif
+  }
+#ifdef SC_ENABLE_PTHREAD
+  for (t = 1; t < ch->num_threads; ++t) {
+    workers[t].joinable = !pthread_create (&workers[t].thread, NULL,
+                                           sc_io_chunks_work, workers + t);
+  }
+#endif
+  sc_io_chunks_work (workers);
+  for (t = 1; t < ch->num_threads; ++t) {
+#ifdef SC_ENABLE_PTHREAD
+    if (workers[t].joinable) {
+      pthread_join (workers[t].thread, NULL);
+      continue;
+    }
+#endif
+    sc_io_chunks_work (workers + t);
+  }
+  for (t = 0; t < ch->num_threads; ++t) {
+    SC_FREE (workers[t].table);
+  }
+  SC_FREE (workers);
+}
 
-  /* prepare checksum */
-  sc_io_adler32_init (&adler);
+/** Compress data in chunks with multiple threads if that is useful.
+ * The zlib output is a single stream that any zlib decoder reads.
+ * \return          True if the data has been compressed.
+ */
+static int
+sc_io_compress_threaded (sc_array_t *data, sc_array_t *compressed,
+                         sc_io_codec_t codec, int level)
+{
+  int                 i;
+  size_t              input_size, iz, total;
+  char               *opos;
+  sc_io_chunks_t      ch;
+#ifdef SC_HAVE_ZLIB
+  unsigned            header;
+  uLong               adler;
+#endif
 
-  /* write individual non-compressed blocks */
-  do {
-    /* write block header */
-    SC_ASSERT (dest_size >= 5);
-    if (src_size > SC_IO_NONCOMP_BLOCK) {
-      /* not the final block */
-      bsize = SC_IO_NONCOMP_BLOCK;
-      dest[0] = 0;
+  memset (&ch, 0, sizeof (sc_io_chunks_t));
+  if (codec == SC_IO_CODEC_LZ) {
+    ch.type = SC_IO_CHUNK_LZ;
+    ch.chunk_size = SC_IO_LZ_CHUNK;
+    ch.slot_size = sc_io_lz_bound (SC_IO_LZ_CHUNK);
+  }
+#ifdef SC_HAVE_ZLIB
+  else if (codec == SC_IO_CODEC_ZLIB) {
+    /* allow for the sync flush at the end of a chunk */
+    ch.type = SC_IO_CHUNK_DEFLATE;
+    ch.chunk_size = SC_IO_DEFLATE_CHUNK;
+    ch.slot_size = (size_t) compressBound ((uLong) ch.chunk_size) + 16;
+  }
+#endif
+  else {
+    return 0;
+  }
+  input_size = data->elem_count * data->elem_size;
+  ch.num_chunks = (input_size + ch.chunk_size - 1) / ch.chunk_size;
+  if (sc_io_compress_threads <= 1 || ch.num_chunks <= 1) {
+    return 0;
+  }
+  ch.num_threads = (int) SC_MIN ((size_t) sc_io_compress_threads,
+                                 ch.num_chunks);
+  ch.level = level;
+  ch.src = data->array;
+  ch.src_size = input_size;
+  ch.dest = SC_ALLOC (char, ch.num_chunks * ch.slot_size);
+  ch.csizes = SC_ALLOC (size_t, ch.num_chunks);
+  ch.checks = SC_ALLOC (unsigned long, ch.num_chunks);
+  sc_io_chunks_run (&ch);
+
+  /* concatenate the compressed chunks */
+  total = 0;
+  for (iz = 0; iz < ch.num_chunks; ++iz) {
+    total += ch.csizes[iz];
+  }
+  total += (codec == SC_IO_CODEC_LZ ? ch.num_chunks * SC_IO_LZ_HEADER : 6);
+  sc_array_resize (compressed, SC_IO_ENCODE_INFO_LEN + total);
+  opos = sc_io_compress_info (compressed->array, input_size, codec);
+#ifdef SC_HAVE_ZLIB
+  if (codec == SC_IO_CODEC_ZLIB) {
+    /* the zlib header encodes the compression level as zlib does */
+    if (level == Z_DEFAULT_COMPRESSION) {
+      level = 6;
     }
+    header = (0x78 << 8) | ((level < 2 ? 0 : level < 6 ? 1 :
+                             level == 6 ? 2 : 3) << 6);
+    header += 31 - (header % 31);
+    *opos++ = (char) (header >> 8);
+    *opos++ = (char) (header & 0xFF);
+  }
+  adler = adler32 (0L, Z_NULL, 0);
+#endif
+  for (iz = 0; iz < ch.num_chunks; ++iz) {
+    if (codec == SC_IO_CODEC_LZ) {
+      for (i = 0; i < SC_IO_LZ_HEADER; ++i) {
+        *opos++ = (char)
+          ((ch.csizes[iz] >> ((SC_IO_LZ_HEADER - 1 - i) * 8)) & 0xFF);
+      }
+    }
+#ifdef SC_HAVE_ZLIB
     else {
-      /* last block */
-      bsize = src_size;
-      dest[0] = 1;
+      adler = adler32_combine (adler, ch.checks[iz], (z_off_t)
+                               SC_MIN (ch.chunk_size,
+                                       input_size - iz * ch.chunk_size));
     }
-    nsize = ~bsize;
-    dest[1] = (char) (bsize & 0xFF);
-    dest[2] = (char) (bsize >> 8);
-    dest[3] = (char) (nsize & 0xFF);
-    dest[4] = (char) (nsize >> 8);
-    dest += 5;
-    dest_size -= 5;
+#endif
+    memcpy (opos, ch.dest + iz * ch.slot_size, ch.csizes[iz]);
+    opos += ch.csizes[iz];
+  }
+#ifdef SC_HAVE_ZLIB
+  if (codec == SC_IO_CODEC_ZLIB) {
+    /* the zlib trailer is the big-endian adler32 checksum */
+    for (i = 0; i < 4; ++i) {
+      *opos++ = (char) ((adler >> ((3 - i) * 8)) & 0xFF);
+    }
+  }
+#endif
+  SC_ASSERT (opos == compressed->array + compressed->elem_count);
 
-    /* copy data */
-    SC_ASSERT (dest_size >= bsize);
-    SC_ASSERT (src_size >= bsize);
-    memcpy (dest, src, bsize);
-    dest += bsize;
-    dest_size -= bsize;
+  SC_FREE (ch.dest);
+  SC_FREE (ch.csizes);
+  SC_FREE (ch.checks);
+  return 1;
+}
 
-    /* extend adler32 checksum */
-    sc_io_adler32_update (&adler, src, bsize);
-    src += bsize;
-    src_size -= bsize;
+/** Compress data into a new array with the size and format header.
+ * \param [in] data         Array of arbitrary element size, all is used.
+ * \param [out] compressed  Initialized array of element size 1 that does
+ *                          not overlap \a data.  It is resized to fit.
+ */
+static void
+sc_io_compress (sc_array_t *data, sc_array_t *compressed,
+                sc_io_codec_t codec, int level)
+{
+  size_t              input_size, bound;
+  char               *opos;
+#ifdef SC_HAVE_ZLIB
+  int                 zrv;
+  uLong               zlen;
+#endif
+
+  SC_ASSERT (data != NULL);
+  SC_ASSERT (compressed != NULL && compressed->elem_size == 1);
+  SC_ASSERT (SC_ARRAY_IS_OWNER (compressed));
+  SC_ASSERT (0 <= codec && codec < SC_IO_CODEC_LAST);
+  if (sc_io_compress_threaded (data, compressed, codec, level)) {
+    return;
   }
-  while (src_size > 0);
 
-  /* write adler32 checksum */
-  SC_ASSERT (src_size == 0);
-  SC_ASSERT (dest_size == 4);
-  dest[0] = (char) (adler >> 24);
-  dest[1] = (char) ((adler >> 16) & 0xFF);
-  dest[2] = (char) ((adler >> 8) & 0xFF);
-  dest[3] = (char) (adler & 0xFF);
+  /* allocate for the worst case */
+  input_size = data->elem_count * data->elem_size;
+  switch (codec) {
+  case SC_IO_CODEC_ZLIB:
+#ifndef SC_HAVE_ZLIB
+    bound = sc_io_noncompress_bound (input_size);
+#else
+    bound = (size_t) compressBound ((uLong) input_size);
+#endif
+    break;
+  case SC_IO_CODEC_LZ:
+    /* the bound is linear in the chunk size plus a constant */
+    bound = input_size + input_size / 255 +
+      (input_size + SC_IO_LZ_CHUNK - 1) / SC_IO_LZ_CHUNK *
+      (SC_IO_LZ_HEADER + 16);
+    break;
+  default:
+    bound = input_size;
+  }
+  sc_array_resize (compressed, SC_IO_ENCODE_INFO_LEN + bound);
+
+  opos = sc_io_compress_info (compressed->array, input_size, codec);
+
+  /* compress input */
+  switch (codec) {
+  case SC_IO_CODEC_ZLIB:
+#ifndef SC_HAVE_ZLIB
+    sc_io_noncompress (opos, bound, data->array, input_size);
+#else
+    zlen = (uLong) bound;
+    zrv = compress2 ((Bytef *) opos, &zlen, (Bytef *) data->array,
+                     (uLong) input_size, level);
+    SC_CHECK_ABORT (zrv == Z_OK, "Error on zlib compression");
+    bound = (size_t) zlen;
+#endif /* SC_HAVE_ZLIB */
+    break;
+  case SC_IO_CODEC_LZ:
+    bound = sc_io_lz_compress (opos, data->array, input_size);
+    break;
+  default:
+    if (input_size > 0) {
+      memcpy (opos, data->array, input_size);
+    }
+  }
+  sc_array_resize (compressed, SC_IO_ENCODE_INFO_LEN + bound);
 }
 
+/** Decompress data with the size and format header into an array.
+ * \param [in] src          Compressed data including the header.
+ * \param [in,out] out      Array to be resized to the original data.
+ * \return                  0 on success, -1 on error.
+ */
 static int
-sc_io_nonuncompress (char *dest, size_t dest_size,
-                     const char *src, size_t src_size, void *re)
+sc_io_uncompress (const char *src, size_t src_size, sc_array_t *out,
+                  size_t max_original_size, void *re)
 {
-  int                 final_block;
-  uint32_t            adler;
-  unsigned char       uca, ucb;
-#ifndef SC_PUFF_INCLUDED
-  uint16_t            bsize, nsize;
-#else
-  unsigned long       destlen, sourcelen;
+  int                 i;
+  char                format_char;
+  size_t              original_size, current_size;
+  int                 zrv;
+#ifdef SC_HAVE_ZLIB
+  uLong               uncompsize;
 #endif
 
   /* in the future we will add runtime error reporting */
   SC_ASSERT (re == NULL);
+  SC_ASSERT (out != NULL);
 
-  /* check zlib format header */
-  if (src_size < 2) {
-    SC_LERROR ("uncompress header short\n");
+  /* examine the header */
+  if (src_size < SC_IO_ENCODE_INFO_LEN) {
+    SC_LERRORF ("encoded data shorter than %d bytes\n",
+                SC_IO_ENCODE_INFO_LEN);
     return -1;
   }
-  uca = (unsigned char) src[0];
-  if ((uca & 0x8F) != 8) {
-    SC_LERROR ("uncompress method unsupported\n");
+  format_char = src[SC_IO_ENCODE_INFO_LEN - 1];
+  if (memchr (sc_io_codec_format, format_char, SC_IO_CODEC_LAST) == NULL) {
+    SC_LERROR ("encoded format character mismatch\n");
     return -1;
   }
-  ucb = (unsigned char) src[1];
-  if (((((unsigned) uca) << 8) + ucb) % 31) {
-    SC_LERROR ("uncompress header not conforming\n");
+
+  /* determine length of uncompressed data */
+  original_size = 0;
+  for (i = 0; i < 8; ++i) {
+    /* enforce big endian byte order for original size */
+    unsigned char       uc = (unsigned char) src[i];
+    original_size |= ((size_t) uc) << ((7 - i) * 8);
+  }
+  if (original_size % out->elem_size != 0) {
+    SC_LERROR ("encoded size not commensurable with output array\n");
     return -1;
   }
-  if (ucb & 0x20) {
-    SC_LERROR ("uncompress cannot handle dictionary\n");
+  if (max_original_size > 0 && original_size > max_original_size) {
+    SC_LERRORF ("encoded size %llu larger than specified maximum %llu\n",
+                (unsigned long long) original_size,
+                (unsigned long long) max_original_size);
     return -1;
   }
-  src += 2;
-  src_size -= 2;
-
-  /* prepare checksum */
-  sc_io_adler32_init (&adler);
-
-  /* go through zlib blocks */
-  do {
-    /* verify minimum required size */
-    if (src_size < 5) {
-      SC_LERROR ("uncompress block header short\n");
-      return -1;
-    }
-#ifdef SC_PUFF_INCLUDED
-
-    /* use the builtin puff fallback to decompress deflate data */
-    destlen = (unsigned long) dest_size;
-    sourcelen = (unsigned long) src_size - 4;
-    if (sc_puff ((unsigned char *) dest, &destlen,
-                 (const unsigned char *) src, &sourcelen)) {
-      SC_LERROR ("uncompress by puff failed\n");
-      return -1;
-    }
-    if (destlen != (unsigned long) dest_size ||
-        sourcelen != (unsigned long) src_size - 4) {
-      SC_LERROR ("uncompress by puff mismatch\n");
-      return -1;
-    }
-
-    /* extend adler32 checksum */
-    sc_io_adler32_update (&adler, dest, dest_size);
-    src += sourcelen;
-    src_size = 4;
-    dest += destlen;
-    dest_size = 0;
-    final_block = 1;
-#else
+  if (!SC_ARRAY_IS_OWNER (out) &&
+      original_size > (current_size = out->elem_count * out->elem_size)) {
+    SC_LERRORF ("encoded size %llu larger than byte size of view %llu\n",
+                (unsigned long long) original_size,
+                (unsigned long long) current_size);
+    return -1;
+  }
+  sc_array_resize (out, original_size / out->elem_size);
+  src += SC_IO_ENCODE_INFO_LEN;
+  src_size -= SC_IO_ENCODE_INFO_LEN;
 
-    /* examine block header */
-    uca = (unsigned char) src[0];
-    if (uca > 1) {
-      SC_LERROR ("uncompress block header unsupported\n");
-      return -1;
-    }
-    final_block = (uca == 1);
-    uca = (unsigned char) src[1];
-    ucb = (unsigned char) src[2];
-    bsize = (ucb << 8) + uca;
-    uca = (unsigned char) src[3];
-    ucb = (unsigned char) src[4];
-    nsize = (ucb << 8) + uca;
-    if ((final_block && bsize < dest_size) || bsize + nsize != 65535) {
-      SC_LERROR ("uncompress block header invalid\n");
+  /* decompress with the codec of the format character */
+  if (format_char == sc_io_codec_format[SC_IO_CODEC_LZ]) {
+    return sc_io_lz_uncompress (out->array, original_size, src, src_size);
+  }
+  if (format_char == sc_io_codec_format[SC_IO_CODEC_NONE]) {
+    if (src_size != original_size) {
+      SC_LERROR ("uncompressed content size mismatch\n");
       return -1;
     }
-    src += 5;
-    src_size -= 5;
-
-    /* copy data */
-    if (bsize > dest_size || bsize > src_size) {
-      SC_LERROR ("uncompress content overflow\n");
-      return -1;
+    if (original_size > 0) {
+      memcpy (out->array, src, original_size);
     }
-    memcpy (dest, src, bsize);
-    src += bsize;
-    src_size -= bsize;
-
-    /* extend adler32 checksum */
-    sc_io_adler32_update (&adler, dest, bsize);
-    dest += bsize;
-    dest_size -= bsize;
-#endif
+    return 0;
   }
-  while (!final_block);
-  if (src_size != 4 || dest_size != 0) {
-    SC_LERROR ("uncompress content error\n");
+#ifndef SC_HAVE_ZLIB
+  zrv = sc_io_nonuncompress (out->array, original_size, src, src_size, re);
+  if (zrv) {
+    SC_LERROR ("Please consider configuring the build"
+               " such that zlib is found.\n");
     return -1;
   }
-
-  /* verify adler32 checksum */
-  if (src[0] != (char) (adler >> 24) ||
-      src[1] != (char) ((adler >> 16) & 0xFF) ||
-      src[2] != (char) ((adler >> 8) & 0xFF) ||
-      src[3] != (char) (adler & 0xFF)) {
-    SC_LERROR ("uncompress checksum error\n");
+#else
+  uncompsize = (uLong) original_size;
+  zrv = uncompress ((Bytef *) out->array, &uncompsize,
+                    (const Bytef *) src, (uLong) src_size);
+  if (zrv != Z_OK) {
+    SC_LERROR ("zlib uncompress error\n");
     return -1;
   }
-
-  /* task accomplished */
+  if (uncompsize != (uLong) original_size) {
+    SC_LERROR ("zlib uncompress short\n");
+    return -1;
+  }
+#endif /* SC_HAVE_ZLIB */
   return 0;
 }
 
-#endif /* !SC_HAVE_ZLIB */
-
-#define SC_IO_ENCODE_INFO_LEN 9
-
 void
 sc_io_encode (sc_array_t *data, sc_array_t *out)
 {
@@ -874,23 +2416,14 @@ void
 sc_io_encode_zlib (sc_array_t *data, sc_array_t *out,
                    int zlib_compression_level, int line_break_character)
 {
-  int                 i;
   size_t              input_size;
-#ifndef SC_HAVE_ZLIB
-  size_t              input_compress_bound;
-#else
-  int                 zrv;
-  uLong               input_compress_bound;
-#endif
   char               *ipos, *opos;
-  char                base_out[2 * SC_IO_LBC];
   size_t              base64_lines;
   size_t              encoded_size;
   size_t              zlin, irem;
 #ifdef SC_ENABLE_DEBUG
   size_t              ocnt;
 #endif
-  unsigned char       original_size[SC_IO_ENCODE_INFO_LEN];
   sc_array_t          compressed;
   base64_encodestate  bstate;
 
@@ -911,39 +2444,17 @@ sc_io_encode_zlib (sc_array_t *data, sc_array_t *out,
              (zlib_compression_level >= 0 && zlib_compression_level <= 9));
 #endif
 
-  /* save original size to output */
-  input_size = data->elem_count * data->elem_size;
-  for (i = 0; i < 8; ++i) {
-    /* enforce big endian byte order for original size */
-    original_size[i] = (input_size >> ((7 - i) * 8)) & 0xFF;
-  }
-  original_size[SC_IO_ENCODE_INFO_LEN - 1] = 'z';
-
-  /* zlib compress input */
-#ifndef SC_HAVE_ZLIB
-  input_compress_bound = sc_io_noncompress_bound (input_size);
-#else
-  input_compress_bound = compressBound ((uLong) input_size);
-#endif /* SC_HAVE_ZLIB */
-  sc_array_init_count (&compressed, 1,
-                       SC_IO_ENCODE_INFO_LEN + input_compress_bound);
-  memcpy (compressed.array, original_size, SC_IO_ENCODE_INFO_LEN);
-#ifndef SC_HAVE_ZLIB
-  sc_io_noncompress (compressed.array + SC_IO_ENCODE_INFO_LEN,
-                     input_compress_bound, data->array, input_size);
-#else
-  zrv = compress2 ((Bytef *) compressed.array + SC_IO_ENCODE_INFO_LEN,
-                   &input_compress_bound, (Bytef *) data->array,
-                   (uLong) input_size, zlib_compression_level);
-  SC_CHECK_ABORT (zrv == Z_OK, "Error on zlib compression");
-#endif /* SC_HAVE_ZLIB */
+  /* zlib compress input after the size and format header */
+  sc_array_init (&compressed, 1);
+  sc_io_compress (data, &compressed, SC_IO_CODEC_ZLIB,
+                  zlib_compression_level);
 
   /* prepare output array */
   if (out == NULL) {
     out = data;
   }
   SC_ASSERT (out->elem_size == 1);
-  input_size = (size_t) (SC_IO_ENCODE_INFO_LEN + input_compress_bound);
+  input_size = compressed.elem_count;
   base64_lines = (input_size + SC_IO_DBC - 1) / SC_IO_DBC;
   encoded_size = 4 * ((input_size + 2) / 3) + 2 * base64_lines + 1;
   sc_array_resize (out, encoded_size);
@@ -960,16 +2471,17 @@ sc_io_encode_zlib (sc_array_t *data, sc_array_t *out,
   opos[0] = '\0';
   for (zlin = 0; zlin < base64_lines; ++zlin) {
     size_t              lein = SC_MIN (irem, SC_IO_DBC);
-    size_t              lout =
-      base64_encode_block (ipos, lein, base_out, &bstate);
+    size_t              lout;
 
+    /* the encoder writes the exact code length directly to the output */
     SC_ASSERT (lein > 0);
+    SC_ASSERT (ocnt + 4 * ((lein + 2) / 3) <= encoded_size);
+    lout = base64_encode_block (ipos, lein, opos, &bstate);
     if (zlin < base64_lines - 1) {
       /* not the final line */
       SC_ASSERT (irem > SC_IO_DBC);
       SC_ASSERT (lout == SC_IO_LBC);
       SC_ASSERT (ocnt + SC_IO_LBF <= encoded_size);
-      memcpy (opos, base_out, SC_IO_LBC);
       opos[SC_IO_LBC] = (char) line_break_character;
       opos[SC_IO_LBD] = '\n';
       opos[SC_IO_LBE] = '\0';
@@ -985,15 +2497,13 @@ sc_io_encode_zlib (sc_array_t *data, sc_array_t *out,
       SC_ASSERT (irem <= SC_IO_DBC);
       SC_ASSERT (lout <= SC_IO_LBC);
       SC_ASSERT (ocnt + lout <= encoded_size);
-      memcpy (opos, base_out, lout);
       opos += lout;
 #ifdef SC_ENABLE_DEBUG
       ocnt += lout;
 #endif
-      lout = base64_encode_blockend (base_out, &bstate);
+      lout = base64_encode_blockend (opos, &bstate);
       SC_ASSERT (lout <= 4);
       SC_ASSERT (ocnt + lout <= encoded_size);
-      memcpy (opos, base_out, lout);
       opos += lout;
 #ifdef SC_ENABLE_DEBUG
       ocnt += lout;
@@ -1079,20 +2589,14 @@ int
 sc_io_decode (sc_array_t *data, sc_array_t *out,
               size_t max_original_size, void *re)
 {
-  int                 i;
-  int                 zrv;
   int                 retval = -1;
   char               *ipos, *opos;
   char                base_out[SC_IO_LBC];
   size_t              compressed_size;
   size_t              base64_lines;
   size_t              encoded_size;
-  size_t              current_size;
-  size_t              zlin, irem;
-  size_t              ocnt;
-#ifdef SC_HAVE_ZLIB
-  uLong               uncompsize;
-#endif
+  size_t              zlin, irem;
+  size_t              ocnt;
   sc_array_t          compressed;
   base64_decodestate  bstate;
 
@@ -1162,75 +2666,95 @@ sc_io_decode (sc_array_t *data, sc_array_t *out,
   SC_ASSERT (irem == 0);
   SC_ASSERT (ocnt <= compressed_size);
   SC_ASSERT (ipos + 1 == data->array + encoded_size);
-  if (ocnt < SC_IO_ENCODE_INFO_LEN) {
-    SC_LERRORF ("base 64 decodes to less than %d bytes\n",
-                SC_IO_ENCODE_INFO_LEN);
-    goto decode_error;
-  }
-  if (compressed.array[SC_IO_ENCODE_INFO_LEN - 1] != 'z') {
-    SC_LERROR ("encoded format character mismatch\n");
-    goto decode_error;
-  }
 
-  /* determine length of uncompressed data */
-  encoded_size = 0;
-  for (i = 0; i < 8; ++i) {
-    /* enforce big endian byte order for original size */
-    unsigned char       uc = (unsigned char) compressed.array[i];
-    encoded_size |= ((size_t) uc) << ((7 - i) * 8);
-  }
-  if (out == NULL) {
-    /* allow for in-place operation */
-    out = data;
-  }
-  if (encoded_size % out->elem_size != 0) {
-    SC_LERROR ("encoded size not commensurable with output array\n");
-    goto decode_error;
-  }
-  if (max_original_size > 0 && encoded_size > max_original_size) {
-    SC_LERRORF ("encoded size %llu larger than specified maximum %llu\n",
-                (unsigned long long) encoded_size,
-                (unsigned long long) max_original_size);
-    goto decode_error;
+  /* decompress decoded data, allowing for in-place operation */
+  retval = sc_io_uncompress (compressed.array, ocnt,
+                             out != NULL ? out : data, max_original_size,
+                             re);
+decode_error:
+  sc_array_reset (&compressed);
+  return retval;
+}
+
+void
+sc_io_encode_raw (sc_array_t *data, sc_array_t *out,
+                  sc_io_codec_t codec, int level)
+{
+  sc_array_t          compressed;
+
+  SC_ASSERT (data != NULL);
+  SC_ASSERT (0 <= codec && codec < SC_IO_CODEC_LAST);
+  SC_ASSERT (-1 <= level && level <= 9);
+  if (out != NULL) {
+    /* data is placed in output array */
+    sc_io_compress (data, out, codec, level);
+    return;
   }
-  if (!SC_ARRAY_IS_OWNER (out) &&
-      encoded_size > (current_size = out->elem_count * out->elem_size)) {
-    SC_LERRORF ("encoded size %llu larger than byte size of view %llu\n",
-                (unsigned long long) encoded_size,
-                (unsigned long long) current_size);
-    goto decode_error;
+
+  /* in-place operation on byte array */
+  SC_ASSERT (SC_ARRAY_IS_OWNER (data));
+  SC_ASSERT (data->elem_size == 1);
+  sc_array_init (&compressed, 1);
+  sc_io_compress (data, &compressed, codec, level);
+  sc_array_copy (data, &compressed);
+  sc_array_reset (&compressed);
+}
+
+int
+sc_io_decode_raw_info (sc_array_t *data, size_t *original_size,
+                       char *format_char, void *re)
+{
+  int                 i;
+  size_t              osize;
+
+  /* in the future we will add runtime error reporting */
+  SC_ASSERT (re == NULL);
+
+  SC_ASSERT (data != NULL);
+  if (data->elem_count * data->elem_size < SC_IO_ENCODE_INFO_LEN) {
+    SC_LERRORF ("sc_io_decode_raw_info requires >= %d bytes of input\n",
+                SC_IO_ENCODE_INFO_LEN);
+    return -1;
   }
-  sc_array_resize (out, encoded_size / out->elem_size);
 
-  /* decompress decoded data */
-#ifndef SC_HAVE_ZLIB
-  zrv = sc_io_nonuncompress (out->array, encoded_size,
-                             compressed.array + SC_IO_ENCODE_INFO_LEN,
-                             ocnt - SC_IO_ENCODE_INFO_LEN, re);
-  if (zrv) {
-    SC_LERROR ("Please consider configuring the build"
-               " such that zlib is found.\n");
-    goto decode_error;
+  /* decode original length of data */
+  if (original_size != NULL) {
+    osize = 0;
+    for (i = 0; i < 8; ++i) {
+      /* read original byte order in big endian */
+      unsigned char       uc = (unsigned char) data->array[i];
+      osize |= ((size_t) uc) << ((7 - i) * 8);
+    }
+    *original_size = osize;
   }
-#else
-  uncompsize = (uLong) encoded_size;
-  zrv = uncompress ((Bytef *) out->array, &uncompsize,
-                    (Bytef *) (compressed.array + SC_IO_ENCODE_INFO_LEN),
-                    ocnt - SC_IO_ENCODE_INFO_LEN);
-  if (zrv != Z_OK) {
-    SC_LERROR ("zlib uncompress error\n");
-    goto decode_error;
+
+  /* return format character */
+  if (format_char != NULL) {
+    *format_char = data->array[SC_IO_ENCODE_INFO_LEN - 1];
   }
-  if (uncompsize != (uLong) encoded_size) {
-    SC_LERROR ("zlib uncompress short\n");
-    goto decode_error;
+  return 0;
+}
+
+int
+sc_io_decode_raw (sc_array_t *data, sc_array_t *out,
+                  size_t max_original_size, void *re)
+{
+  int                 retval;
+  sc_array_t          input;
+
+  SC_ASSERT (data != NULL);
+  if (out != NULL) {
+    return sc_io_uncompress (data->array, data->elem_count * data->elem_size,
+                             out, max_original_size, re);
   }
-#endif /* SC_HAVE_ZLIB */
 
-  /* exit cleanly */
-  retval = 0;
-decode_error:
-  sc_array_reset (&compressed);
+  /* in-place operation reads from a copy of the input */
+  SC_ASSERT (data->elem_size == 1);
+  sc_array_init (&input, 1);
+  sc_array_copy (&input, data);
+  retval = sc_io_uncompress (input.array, input.elem_count,
+                             data, max_original_size, re);
+  sc_array_reset (&input);
   return retval;
 }
 
@@ -1297,15 +2821,16 @@ sc_vtk_write_compressed (FILE * vtkfile, char *numeric_data,
 #ifdef SC_HAVE_ZLIB
   int                 retval, fseek1, fseek2;
   size_t              iz;
-  size_t              blocksize, lastsize;
+  size_t              blocksize, lastsize, batchsize;
   size_t              theblock, numregularblocks, numfullblocks;
   size_t              header_entries, header_size;
   size_t              code_length, base_length;
   long                header_pos, final_pos;
-  char               *comp_data, *base_data;
+  char               *comp_data, *comp_block, *base_data;
   uint32_t           *compression_header;
   uLongf              comp_length;
   base64_encodestate  encode_state;
+  sc_io_chunks_t      ch;
 
   /* compute block sizes */
   blocksize = (size_t) (1 << 15);       /* 32768 */
@@ -1339,36 +2864,55 @@ sc_vtk_write_compressed (FILE * vtkfile, char *numeric_data,
   header_pos = ftell (vtkfile);
   (void) fwrite (base_data, 1, base_length, vtkfile);
 
-  /* write the regular data blocks */
-  base64_init_encodestate (&encode_state);
-  for (theblock = 0; theblock < numregularblocks; ++theblock) {
-    comp_length = code_length;
-    retval = compress2 ((Bytef *) comp_data, &comp_length,
-                        (const Bytef *) (numeric_data + theblock * blocksize),
-                        (uLong) blocksize, Z_BEST_COMPRESSION);
-    SC_IO_CHECK_ZLIB (retval);
-    compression_header[3 + theblock] = comp_length;
-    base_length = base64_encode_block (comp_data, comp_length,
-                                       base_data, &encode_state);
-    SC_ASSERT (base_length < code_length);
-    base_data[base_length] = '\0';
-    (void) fwrite (base_data, 1, base_length, vtkfile);
+  /* prepare to compress batches of blocks with multiple threads */
+  memset (&ch, 0, sizeof (sc_io_chunks_t));
+  ch.type = SC_IO_CHUNK_ZLIB;
+  ch.level = Z_BEST_COMPRESSION;
+  ch.num_threads = (int) SC_MIN ((size_t) SC_MAX (sc_io_compress_threads, 1),
+                                 numfullblocks);
+  ch.src = numeric_data;
+  ch.src_size = byte_length;
+  ch.chunk_size = blocksize;
+  ch.slot_size = code_length;
+  batchsize = 16 * (size_t) ch.num_threads;
+  if (ch.num_threads > 1) {
+    ch.dest = SC_ALLOC (char, batchsize * ch.slot_size);
+    ch.csizes = SC_ALLOC (size_t, batchsize);
   }
 
-  /* write odd-sized last block if necessary */
-  if (lastsize > 0) {
-    comp_length = code_length;
-    retval = compress2 ((Bytef *) comp_data, &comp_length,
-                        (const Bytef *) (numeric_data + theblock * blocksize),
-                        (uLong) lastsize, Z_BEST_COMPRESSION);
-    SC_IO_CHECK_ZLIB (retval);
+  /* write the data blocks, of which the last may be odd-sized */
+  base64_init_encodestate (&encode_state);
+  for (theblock = 0; theblock < numfullblocks; ++theblock) {
+    if (ch.num_threads > 1) {
+      if (theblock == ch.first + ch.num_chunks) {
+        /* compress the next batch of blocks concurrently */
+        ch.first = theblock;
+        ch.num_chunks = SC_MIN (batchsize, numfullblocks - theblock);
+        sc_io_chunks_run (&ch);
+      }
+      comp_block = ch.dest + (theblock - ch.first) * ch.slot_size;
+      comp_length = (uLongf) ch.csizes[theblock - ch.first];
+    }
+    else {
+      comp_block = comp_data;
+      comp_length = code_length;
+      retval = compress2 ((Bytef *) comp_data, &comp_length,
+                          (const Bytef *) (numeric_data +
+                                           theblock * blocksize),
+                          (uLong) (theblock < numregularblocks ?
+                                   blocksize : lastsize),
+                          Z_BEST_COMPRESSION);
+      SC_IO_CHECK_ZLIB (retval);
+    }
     compression_header[3 + theblock] = comp_length;
-    base_length = base64_encode_block (comp_data, comp_length,
+    base_length = base64_encode_block (comp_block, comp_length,
                                        base_data, &encode_state);
     SC_ASSERT (base_length < code_length);
     base_data[base_length] = '\0';
     (void) fwrite (base_data, 1, base_length, vtkfile);
   }
+  SC_FREE (ch.dest);
+  SC_FREE (ch.csizes);
 
   /* write base64 end block */
   base_length = base64_encode_blockend (base_data, &encode_state);
@@ -1677,6 +3221,92 @@ sc_io_open (sc_MPI_Comm mpicomm, const char *filename,
 #endif /* !SC_ENABLE_MPIIO */
 }
 
+#ifdef SC_ENABLE_MPIIO
+
+/** Set an integer hint unless the info object already has the key. */
+static void
+sc_io_info_set_default (MPI_Info info, const char *key, long long value)
+{
+  int                 mpiret;
+  int                 nkeys, i;
+  char                existing[MPI_MAX_INFO_KEY + 1];
+  char                str[BUFSIZ];
+
+  mpiret = MPI_Info_get_nkeys (info, &nkeys);
+  SC_CHECK_MPI (mpiret);
+  for (i = 0; i < nkeys; ++i) {
+    mpiret = MPI_Info_get_nthkey (info, i, existing);
+    SC_CHECK_MPI (mpiret);
+    if (!strcmp (existing, key)) {
+      /* the caller's choice has precedence */
+      return;
+    }
+  }
+
+  snprintf (str, BUFSIZ, "%lld", value);
+  mpiret = MPI_Info_set (info, key, str);
+  SC_CHECK_MPI (mpiret);
+}
+
+#endif /* SC_ENABLE_MPIIO */
+
+int
+sc_io_open_striped (sc_MPI_Comm mpicomm, const char *filename,
+                    sc_io_open_mode_t amode, sc_MPI_Info mpiinfo,
+                    const sc_io_stripe_t * stripe, sc_MPI_File * mpifile)
+{
+#ifdef SC_ENABLE_MPIIO
+  int                 mpiret, errcode;
+  int                 mpisize, cb_nodes;
+  MPI_Info            info;
+
+  if (stripe == NULL || (stripe->striping_unit == 0 &&
+                         stripe->striping_factor <= 0 &&
+                         stripe->cb_nodes <= 0)) {
+    /* there are no hints to add */
+    return sc_io_open (mpicomm, filename, amode, mpiinfo, mpifile);
+  }
+
+  /* the info object of the caller is not modified */
+  if (mpiinfo == MPI_INFO_NULL) {
+    mpiret = MPI_Info_create (&info);
+  }
+  else {
+    mpiret = MPI_Info_dup (mpiinfo, &info);
+  }
+  SC_CHECK_MPI (mpiret);
+
+  if (stripe->striping_unit > 0) {
+    sc_io_info_set_default (info, "striping_unit",
+                            (long long) stripe->striping_unit);
+  }
+  if (stripe->striping_factor > 0) {
+    sc_io_info_set_default (info, "striping_factor",
+                            (long long) stripe->striping_factor);
+  }
+
+  /* one aggregator per stripe avoids contention on the storage targets */
+  cb_nodes = (stripe->cb_nodes > 0) ? stripe->cb_nodes :
+    stripe->striping_factor;
+  if (cb_nodes > 0) {
+    mpiret = sc_MPI_Comm_size (mpicomm, &mpisize);
+    SC_CHECK_MPI (mpiret);
+    sc_io_info_set_default (info, "cb_nodes",
+                            (long long) SC_MIN (cb_nodes, mpisize));
+  }
+
+  errcode = sc_io_open (mpicomm, filename, amode, info, mpifile);
+
+  mpiret = MPI_Info_free (&info);
+  SC_CHECK_MPI (mpiret);
+
+  return errcode;
+#else
+  /* without MPI I/O there is no striping to configure */
+  return sc_io_open (mpicomm, filename, amode, mpiinfo, mpifile);
+#endif
+}
+
 void
 sc_io_read (sc_MPI_File mpifile, void *ptr, size_t zcount,
             sc_MPI_Datatype t, const char *errmsg)
@@ -2249,6 +3879,275 @@ sc_io_write_at_all (sc_MPI_File mpifile, sc_MPI_Offset offset,
 #endif
 }
 
+struct sc_io_request
+{
+  int                 count;            /**< Number of requested items. */
+  sc_MPI_Datatype     t;                /**< The MPI type of the items. */
+  int                 errcode;          /**< Error class on completion. */
+  int                 ocount;           /**< Items read or written. */
+#ifdef SC_IO_HAVE_IFILE
+  MPI_Request         mpireq;           /**< Nonblocking MPI I/O. */
+#endif
+#ifdef SC_IO_HAVE_THREAD
+  int                 write;            /**< Boolean to write, not read. */
+  sc_MPI_File         mpifile;          /**< File accessed by the thread. */
+  sc_MPI_Offset       offset;           /**< Offset of the access. */
+  void               *ptr;              /**< Data read or written. */
+  int                 joinable;         /**< Boolean for a running thread. */
+  int                 done;             /**< Protected by the mutex. */
+  pthread_mutex_t     mutex;            /**< Protects the done flag. */
+  pthread_t           thread;           /**< Executes the file access. */
+#endif
+};
+
+#ifdef SC_IO_HAVE_IFILE
+
+/** Record the result of a completed nonblocking MPI I/O operation. */
+static void
+sc_io_request_status (sc_io_request_t * request, int mpiret,
+                      sc_MPI_Status * mpistatus)
+{
+  int                 retval;
+
+  if (mpiret == sc_MPI_SUCCESS && request->count > 0) {
+    /* working around 0 count not working for some implementations */
+    mpiret = sc_MPI_Get_count (mpistatus, request->t, &request->ocount);
+    SC_CHECK_MPI (mpiret);
+  }
+  retval = sc_io_error_class (mpiret, &request->errcode);
+  SC_CHECK_MPI (retval);
+}
+
+#endif
+
+#ifdef SC_IO_HAVE_THREAD
+
+/** Execute the file access of a request in a background thread. */
+static void        *
+sc_io_request_run (void *v)
+{
+  sc_io_request_t    *request = (sc_io_request_t *) v;
+
+  if (request->write) {
+    request->errcode =
+      sc_io_write_at_all (request->mpifile, request->offset, request->ptr,
+                          request->count, request->t, &request->ocount);
+  }
+  else {
+    request->errcode =
+      sc_io_read_at_all (request->mpifile, request->offset, request->ptr,
+                         request->count, request->t, &request->ocount);
+  }
+
+  pthread_mutex_lock (&request->mutex);
+  request->done = 1;
+  pthread_mutex_unlock (&request->mutex);
+  return NULL;
+}
+
+#endif
+
+/** Start a nonblocking collective read or write. */
+static int
+sc_io_istart_at_all (sc_MPI_File mpifile, sc_MPI_Offset offset, void *ptr,
+                     int count, sc_MPI_Datatype t, int write,
+                     sc_io_request_t ** request)
+{
+  int                 errcode;
+  sc_io_request_t    *req;
+#ifdef SC_IO_HAVE_IFILE
+  int                 mpiret, retval;
+#endif
+
+  SC_ASSERT (request != NULL);
+  *request = NULL;
+
+  req = SC_ALLOC_ZERO (sc_io_request_t, 1);
+  req->count = count;
+  req->t = t;
+
+#ifdef SC_IO_HAVE_IFILE
+  if (write) {
+    mpiret = MPI_File_iwrite_at_all (mpifile, offset, ptr, count, t,
+                                     &req->mpireq);
+  }
+  else {
+    mpiret = MPI_File_iread_at_all (mpifile, offset, ptr, count, t,
+                                    &req->mpireq);
+  }
+  retval = sc_io_error_class (mpiret, &errcode);
+  SC_CHECK_MPI (retval);
+  if (errcode != sc_MPI_SUCCESS) {
+    SC_FREE (req);
+    return errcode;
+  }
+#elif defined SC_IO_HAVE_THREAD
+  req->write = write;
+  req->mpifile = mpifile;
+  req->offset = offset;
+  req->ptr = ptr;
+  pthread_mutex_init (&req->mutex, NULL);
+  req->joinable =
+    !pthread_create (&req->thread, NULL, sc_io_request_run, req);
+  if (!req->joinable) {
+    /* without a thread we access the file right away */
+    sc_io_request_run (req);
+  }
+  errcode = sc_MPI_SUCCESS;
+#else
+  /* the operation completes before returning */
+  if (write) {
+    req->errcode = sc_io_write_at_all (mpifile, offset, ptr, count, t,
+                                       &req->ocount);
+  }
+  else {
+    req->errcode = sc_io_read_at_all (mpifile, offset, ptr, count, t,
+                                      &req->ocount);
+  }
+  errcode = sc_MPI_SUCCESS;
+#endif
+
+  *request = req;
+  return errcode;
+}
+
+int
+sc_io_iread_at_all (sc_MPI_File mpifile, sc_MPI_Offset offset, void *ptr,
+                    int count, sc_MPI_Datatype t, sc_io_request_t ** request)
+{
+  return sc_io_istart_at_all (mpifile, offset, ptr, count, t, 0, request);
+}
+
+int
+sc_io_iwrite_at_all (sc_MPI_File mpifile, sc_MPI_Offset offset,
+                     const void *ptr, int count, sc_MPI_Datatype t,
+                     sc_io_request_t ** request)
+{
+  return sc_io_istart_at_all (mpifile, offset, (void *) ptr, count, t, 1,
+                              request);
+}
+
+/** Free a completed request and return its results. */
+static int
+sc_io_request_finish (sc_io_request_t ** request, int *ocount)
+{
+  int                 errcode;
+  sc_io_request_t    *req = *request;
+
+#ifdef SC_IO_HAVE_THREAD
+  if (req->joinable) {
+    pthread_join (req->thread, NULL);
+  }
+  pthread_mutex_destroy (&req->mutex);
+#endif
+  *ocount = req->ocount;
+  errcode = req->errcode;
+  SC_FREE (req);
+  *request = NULL;
+
+  return errcode;
+}
+
+int
+sc_io_test (sc_io_request_t ** request, int *flag, int *ocount)
+{
+#ifdef SC_IO_HAVE_IFILE
+  int                 mpiret;
+  sc_MPI_Status       mpistatus;
+#endif
+
+  SC_ASSERT (request != NULL && *request != NULL);
+  SC_ASSERT (flag != NULL);
+  SC_ASSERT (ocount != NULL);
+  *flag = 0;
+  *ocount = 0;
+
+#ifdef SC_IO_HAVE_IFILE
+  mpiret = MPI_Test (&(*request)->mpireq, flag, &mpistatus);
+  if (mpiret == sc_MPI_SUCCESS && !*flag) {
+    return sc_MPI_SUCCESS;
+  }
+  /* an erroneous request is complete as well */
+  *flag = 1;
+  sc_io_request_status (*request, mpiret, &mpistatus);
+#elif defined SC_IO_HAVE_THREAD
+  pthread_mutex_lock (&(*request)->mutex);
+  *flag = (*request)->done;
+  pthread_mutex_unlock (&(*request)->mutex);
+  if (!*flag) {
+    return sc_MPI_SUCCESS;
+  }
+#else
+  *flag = 1;
+#endif
+
+  return sc_io_request_finish (request, ocount);
+}
+
+int
+sc_io_wait (sc_io_request_t ** request, int *ocount)
+{
+#ifdef SC_IO_HAVE_IFILE
+  int                 mpiret;
+  sc_MPI_Status       mpistatus;
+#endif
+
+  SC_ASSERT (request != NULL && *request != NULL);
+  SC_ASSERT (ocount != NULL);
+  *ocount = 0;
+
+#ifdef SC_IO_HAVE_IFILE
+  mpiret = MPI_Wait (&(*request)->mpireq, &mpistatus);
+  sc_io_request_status (*request, mpiret, &mpistatus);
+#endif
+
+  /* without MPI I/O, finishing joins the thread if there is one */
+  return sc_io_request_finish (request, ocount);
+}
+
+int
+sc_io_get_size (sc_MPI_File mpifile, sc_MPI_Offset * size)
+{
+  int                 mpiret;
+  int                 eclass;
+#ifndef SC_ENABLE_MPIIO
+  long                pos, result[2];
+#endif
+
+  SC_ASSERT (size != NULL);
+
+#ifdef SC_ENABLE_MPIIO
+  mpiret = MPI_File_get_size (mpifile, size);
+  mpiret = sc_io_error_class (mpiret, &eclass);
+  SC_CHECK_MPI (mpiret);
+#else
+
+  /* WARNING: This code with activated MPI (SC_ENABLE_MPI) is deprecated. */
+
+  /* the error value and the size are determined on process 0 */
+  result[0] = 0;
+  result[1] = 0;
+  if (mpifile->file != NULL) {
+    SC_ASSERT (mpifile->mpirank == 0);
+
+    errno = 0;
+    if ((pos = ftell (mpifile->file)) == -1 ||
+        fseek (mpifile->file, 0, SEEK_END) ||
+        (result[1] = ftell (mpifile->file)) == -1 ||
+        fseek (mpifile->file, pos, SEEK_SET)) {
+      result[0] = errno;
+    }
+  }
+  mpiret = sc_MPI_Bcast (result, 2, sc_MPI_LONG, 0, mpifile->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_io_error_class ((int) result[0], &eclass);
+  SC_CHECK_MPI (mpiret);
+  *size = (sc_MPI_Offset) result[1];
+#endif
+
+  return eclass;
+}
+
 int
 sc_io_close (sc_MPI_File * mpifile)
 {
@@ -43,6 +43,9 @@
  *    They losslessly transform a block of arbitrary data into a compressed
  *    and base64-encoded format and back that is unambiguously defined and
  *    human-friendly.
+ *  - To compress large binary data at high throughput, we provide the
+ *    functions \ref sc_io_encode_raw, \ref sc_io_decode_raw_info and
+ *    \ref sc_io_decode_raw with a choice of codec \ref sc_io_codec_t.
  *
  * \ingroup io
  */
@@ -86,20 +89,61 @@ typedef enum
 }
 sc_io_mode_t;
 
-/** Enum to specify encoding for \ref sc_io_sink and \ref sc_io_source. */
+/** Enum to specify encoding for \ref sc_io_sink and \ref sc_io_source.
+ * The encodings other than \ref SC_IO_ENCODE_NONE compress or decompress
+ * the data incrementally with a fixed window of memory, which allows to
+ * process data of any size.  Each call to \ref sc_io_sink_complete ends
+ * an encoded stream, and the next write begins a new one.  Without a
+ * write, no stream is written; to encode empty data, write zero bytes.
+ * A source reads one stream until its end and begins the next one after
+ * \ref sc_io_source_complete.  These encodings require zlib; without it,
+ * \ref sc_io_sink_new and \ref sc_io_source_new return NULL.
+ */
 typedef enum
 {
   SC_IO_ENCODE_NONE,    /**< No encoding */
+  SC_IO_ENCODE_ZLIB,    /**< A zlib stream as defined by RFC 1950. */
+  SC_IO_ENCODE_BASE64,  /**< The format of \ref sc_io_encode, which is
+                             zlib compression of maximum level with a size
+                             header in base 64 lines ending in a NUL byte.
+                             The output matches \ref sc_io_encode.  The
+                             size header is written when the stream ends.
+                             Unless the output fits into one window, a
+                             file sink must then be seekable and must not
+                             be opened for appending. */
   SC_IO_ENCODE_LAST     /**< Invalid entry to close list */
 }
 sc_io_encode_t;
 
+/** Codecs for \ref sc_io_encode_raw.
+ * Each codec is identified in the encoded data by its format character,
+ * which is returned by \ref sc_io_decode_info and \ref sc_io_decode_raw_info.
+ * Every codec is always available; configuring external libraries
+ * only makes them faster or compress better.
+ */
+typedef enum
+{
+  SC_IO_CODEC_NONE,     /**< Copy the data unchanged, format 'n'. */
+  SC_IO_CODEC_ZLIB,     /**< The zlib format of RFC 1950, format 'z'.
+                             Without zlib we write uncompressed blocks. */
+  SC_IO_CODEC_LZ,       /**< The LZ4 block format in chunks, format 'l'.
+                             We use liblz4 if configured, else an in-tree
+                             compressor.  It is much faster than zlib. */
+  SC_IO_CODEC_LAST      /**< Invalid entry to close list */
+}
+sc_io_codec_t;
+
+/** Default byte size of the buffer that combines small sink writes. */
+#define SC_IO_SINK_BUFFER (1 << 14)
+
 /** The type of I/O operation \ref sc_io_sink and \ref sc_io_source. */
 typedef enum
 {
   SC_IO_TYPE_BUFFER,    /**< Write to a buffer */
   SC_IO_TYPE_FILENAME,  /**< Write to a file to be opened */
   SC_IO_TYPE_FILEFILE,  /**< Write to an already opened file */
+  SC_IO_TYPE_MMAP,      /**< Read from a file mapped into memory by
+                             \ref sc_io_file_map; sources only */
   SC_IO_TYPE_LAST       /**< Invalid entry to close list */
 }
 sc_io_type_t;
@@ -118,9 +162,21 @@ typedef struct sc_io_sink
   size_t              bytes_in;        /**< input bytes count */
   size_t              bytes_out;       /**< written bytes count */
   int                 is_eof;          /**< Have we reached the end of file? */
+  void               *stream;          /**< internal state of the encoding */
+  char               *combine;         /**< buffer combining small writes */
+  size_t              combine_size;    /**< byte size of the buffer */
+  size_t              combine_bytes;   /**< bytes waiting in the buffer */
 }
 sc_io_sink_t;
 
+/** One piece of data for \ref sc_io_sink_writev. */
+typedef struct sc_io_iovec
+{
+  const void         *data;            /**< data of the piece */
+  size_t              bytes;           /**< byte size of the piece */
+}
+sc_io_iovec_t;
+
 /** A generic data source. */
 typedef struct sc_io_source
 {
@@ -138,6 +194,7 @@ typedef struct sc_io_source
                                             data */
   sc_array_t         *mirror_buffer;   /**< if activated, the buffer for the
                                             mirror */
+  void               *stream;          /**< internal state of the encoding */
 }
 sc_io_source_t;
 
@@ -153,6 +210,23 @@ typedef enum
 }
 sc_io_open_mode_t;
 
+/** Striping hints for \ref sc_io_open_striped.
+ * A value of 0 leaves the respective choice to the MPI implementation and
+ * the file system.
+ */
+typedef struct sc_io_stripe
+{
+  size_t              striping_unit;   /**< byte size of one stripe */
+  int                 striping_factor; /**< number of stripes, i.e. of storage
+                                            targets that the file is spread
+                                            over */
+  int                 cb_nodes;        /**< number of processes that aggregate
+                                            collective I/O; 0 means one per
+                                            stripe if \b striping_factor is
+                                            positive */
+}
+sc_io_stripe_t;
+
 /** Create a generic data sink.
  * \param [in] iotype           Type must be a value from \ref sc_io_type_t.
  *                              Depending on iotype, varargs must follow:
@@ -160,9 +234,11 @@ sc_io_open_mode_t;
  *                              FILENAME: const char * (name of file to open).
  *                              FILEFILE: FILE * (file open for writing).
  *                              These buffers are only borrowed by the sink.
+ *                              MMAP is not supported and returns NULL.
  * \param [in] iomode           Mode must be a value from \ref sc_io_mode_t.
  *                              For type FILEFILE, data is always appended.
  * \param [in] ioencode         Must be a value from \ref sc_io_encode_t.
+ *                              The data written is encoded accordingly.
  * \return                      Newly allocated sink, or NULL on error.
  */
 sc_io_sink_t       *sc_io_sink_new (int iotype, int iomode,
@@ -191,7 +267,11 @@ int                 sc_io_sink_destroy (sc_io_sink_t * sink);
 int                 sc_io_sink_destroy_null (sc_io_sink_t ** sink);
 
 /** Write data to a sink.  Data may be buffered and sunk in a later call.
+ * Writes smaller than the buffer size set by \ref sc_io_sink_buffer
+ * are combined and passed on together.
  * The internal counters sink->bytes_in and sink->bytes_out are updated.
+ * With an encoding, bytes_out counts the encoded bytes written so far,
+ * and a write of zero bytes begins a stream if none is active.
  * \param [in,out] sink         The sink object to write to.
  * \param [in] data             Data passed into sink must be non-NULL.
  * \param [in] bytes_avail      Number of data bytes passed in.
@@ -200,6 +280,28 @@ int                 sc_io_sink_destroy_null (sc_io_sink_t ** sink);
 int                 sc_io_sink_write (sc_io_sink_t * sink,
                                       const void *data, size_t bytes_avail);
 
+/** Write several pieces of data to a sink in order.
+ * The result is the same as calling \ref sc_io_sink_write for each piece,
+ * but a BUFFER sink is extended only once for all pieces.
+ * \param [in,out] sink         The sink object to write to.
+ * \param [in] iov              Array of \a iovcnt pieces.  The data of
+ *                              each piece must be non-NULL.
+ * \param [in] iovcnt           Number of pieces, may be zero.
+ * \return                      0 on success, nonzero on error.
+ */
+int                 sc_io_sink_writev (sc_io_sink_t * sink,
+                                       const sc_io_iovec_t * iov, int iovcnt);
+
+/** Set the size of the buffer that combines small writes.
+ * The data buffered so far is passed on first.
+ * A new sink has a buffer of SC_IO_SINK_BUFFER bytes.
+ * \param [in,out] sink         The sink object to configure.
+ * \param [in] bytes            New byte size of the buffer.
+ *                              Zero passes on each write immediately.
+ * \return                      0 on success, nonzero on error.
+ */
+int                 sc_io_sink_buffer (sc_io_sink_t * sink, size_t bytes);
+
 /** Flush all buffered output data to sink.
  * This function may return SC_IO_ERROR_AGAIN if another write is required.
  * Currently this may happen if BUFFER requires an integer multiple of bytes.
@@ -208,6 +310,8 @@ int                 sc_io_sink_write (sc_io_sink_t * sink,
  * been created.  In particular, the bytes counters are reset to zero.
  * The internal state of the sink is not changed otherwise.
  * It is legal to continue writing to the sink hereafter.
+ * Any data combined from small writes is passed on first.
+ * With an encoding, the encoded stream is ended first.
  * The sink actions taken depend on its type.
  * BUFFER, FILEFILE: none.
  * FILENAME: call fclose on sink->file.
@@ -222,6 +326,7 @@ int                 sc_io_sink_complete (sc_io_sink_t * sink,
                                          size_t *bytes_in, size_t *bytes_out);
 
 /** Align sink to a byte boundary by writing zeros.
+ * The alignment refers to the data written, before any encoding.
  * \param [in,out] sink         The sink object to align.
  * \param [in] bytes_align      Byte boundary.
  * \return                      0 on success, nonzero on error.
@@ -235,7 +340,9 @@ int                 sc_io_sink_align (sc_io_sink_t * sink,
  *                              BUFFER: sc_array_t * (existing array).
  *                              FILENAME: const char * (name of file to open).
  *                              FILEFILE: FILE * (file open for reading).
+ *                              MMAP: const char * (name of file to map).
  * \param [in] ioencode         Encoding value from \ref sc_io_encode_t.
+ *                              The data read is decoded accordingly.
  * \return                      Newly allocated source, or NULL on error.
  */
 sc_io_source_t     *sc_io_source_new (int iotype, int ioencode, ...);
@@ -290,6 +397,9 @@ int                 sc_io_source_read (sc_io_source_t * source,
  * The internal state of the source is not changed otherwise.
  * It is legal to continue reading from the source hereafter.
  *
+ * With an encoding, this function ends the current stream after its last
+ * byte has been read, and returns SC_IO_ERROR_AGAIN before.
+ *
  * \param [in,out] source       The source object to read from.
  * \param [in,out] bytes_in     If not NULL and true is returned,
  *                              the total size of the data sourced.
@@ -353,6 +463,28 @@ int                 sc_io_file_save (const char *filename,
 int                 sc_io_file_load (const char *filename,
                                      sc_array_t * buffer);
 
+/** Map a file into memory for reading in one call.
+ * Where mmap is available, the file contents are paged in on access
+ * with a hint for sequential reading instead of being copied.
+ * Otherwise, the file is read by \ref sc_io_file_load.
+ * This function performs error checking and always returns cleanly.
+ * \param [in] filename     Name of the regular file to map.
+ * \param [out] view        On success, a read-only view of element size 1
+ *                          over the complete file contents.  It must not
+ *                          be modified or resized and is released by
+ *                          \ref sc_io_file_unmap.  An empty file yields
+ *                          a view of zero elements.
+ * \return                  0 on success, -1 on error.
+ */
+int                 sc_io_file_map (const char *filename, sc_array_t * view);
+
+/** Release a view created by \ref sc_io_file_map.
+ * \param [in,out] view     View as returned by \ref sc_io_file_map.
+ *                          On output, a view of zero elements.
+ * \return                  0 on success, -1 on error.
+ */
+int                 sc_io_file_unmap (sc_array_t * view);
+
 /** Encode a block of arbitrary data with the default sc_io format.
  * The corresponding decoder function is \ref sc_io_decode.
  * This function cannot crash unless out of memory.
@@ -460,13 +592,14 @@ int                 sc_io_decode_info (sc_array_t *data,
  * This function does not require zlib but benefits for speed.
  *
  * This is a two-stage process: we decode the input from base 64 first.
- * Then we extract the 8-byte big-endian original data size, the character
- * 'z', and execute a zlib decompression on the remaining decoded data.
+ * Then we extract the 8-byte big-endian original data size, the format
+ * character, and decompress the remaining decoded data accordingly.
  * This function detects malformed input by erroring out.
  *
- * If we should add another format in the future, the format character
- * may be something else than 'z', as permitted by our specification.
- * To this end, we reserve the characters A-C and d-z indefinitely.
+ * The format character is 'z' for data from \ref sc_io_encode.
+ * We also accept the base 64 encoding of any output of \ref
+ * sc_io_encode_raw, whose format characters are listed in \ref
+ * sc_io_codec_t.  We reserve the characters A-C and d-z indefinitely.
  *
  * Any error condition is indicated by a negative return value.
  * Possible causes for error are:
@@ -514,6 +647,99 @@ int                 sc_io_decode_info (sc_array_t *data,
 int                 sc_io_decode (sc_array_t *data, sc_array_t *out,
                                   size_t max_original_size, void *re);
 
+/** Compress a block of arbitrary data into a binary format.
+ * Unlike \ref sc_io_encode_zlib, the output is not base 64 encoded,
+ * which saves a third of the size and most of the time for large data.
+ *
+ * The output consists of the input data size as an 8-byte big-endian
+ * number, the format character of the codec, and the compressed data.
+ * This header is the same as for \ref sc_io_encode after base 64 decoding.
+ * The codecs are described in \ref sc_io_codec_t.  The LZ codec splits the
+ * input into chunks of 1 MiB and writes each chunk as its compressed size
+ * in 4 big-endian bytes followed by an independent LZ4 block.
+ *
+ * This routine can work in place or write to an output array.
+ * The corresponding decoder function is \ref sc_io_decode_raw.
+ * This function cannot crash unless out of memory.
+ *
+ * \param [in,out] data     If \a out is NULL, we work in place.
+ *                          In this case, the array must on input have
+ *                          an element size of 1 byte, which is preserved.
+ *                          Otherwise, this is a read-only argument
+ *                          that may have arbitrary element size.
+ *                          On input, all data in the array is used.
+ * \param [in,out] out      If not NULL, a valid array of element size 1.
+ *                          It must be resizable (not a view).
+ *                          We resize the array to the output data,
+ *                          which is not NUL-terminated.
+ * \param [in] codec        The compression method to use.
+ * \param [in] level        For \ref SC_IO_CODEC_ZLIB, the zlib compression
+ *                          level between 0 and 9 or -1 for the default.
+ *                          Ignored by the other codecs.
+ */
+void                sc_io_encode_raw (sc_array_t *data, sc_array_t *out,
+                                      sc_io_codec_t codec, int level);
+
+/** Decode length and format of original input from binary encoded data.
+ * This is the counterpart of \ref sc_io_decode_info for the output of
+ * \ref sc_io_encode_raw.  This function cannot crash.
+ *
+ * \param [in] data     Array of arbitrary element size.
+ *                      If it contains less than 9 bytes we error out.
+ * \param [out] original_size   If not NULL and we do not error out,
+ *                      set to the original size as encoded in the data.
+ * \param [out] format_char     If not NULL and we do not error out,
+ *                      set to the character indicating the codec.
+ * \param [in,out] re   Provided for error reporting, presently must be NULL.
+ * \return              0 on success, negative value on error.
+ */
+int                 sc_io_decode_raw_info (sc_array_t *data,
+                                           size_t *original_size,
+                                           char *format_char, void *re);
+
+/** Decompress a block of data produced by \ref sc_io_encode_raw.
+ * We select the codec by the format character stored in the data.
+ * Any codec can be decoded regardless of the configured libraries.
+ * The error conditions are the same as for \ref sc_io_decode.
+ * This function cannot crash unless out of memory.
+ *
+ * \param [in,out] data     If \a out is NULL, we work in place.
+ *                          In that case, the element size must be 1
+ *                          and the array is resized to the output.
+ *                          Otherwise, the array is read-only and its
+ *                          element size is arbitrary.
+ * \param [in,out] out      If not NULL, a valid array (may be a view)
+ *                          that is treated as in \ref sc_io_decode.
+ * \param [in] max_original_size    If nonzero, this is the maximal data
+ *                          size that we will accept after uncompression.
+ *                          If exceeded, return a negative value.
+ * \param [in,out] re   Provided for error reporting, presently must be NULL.
+ * \return                  0 on success, negative on malformed input
+ *                          data or insufficient output space.
+ */
+int                 sc_io_decode_raw (sc_array_t *data, sc_array_t *out,
+                                      size_t max_original_size, void *re);
+
+/** Number of threads used to compress data by \ref sc_io_encode_zlib,
+ * \ref sc_io_encode_raw and \ref sc_vtk_write_compressed.
+ * Initialized to 1.  Larger values take effect if pthreads are configured.
+ * With more than one thread, the input is split into independent chunks
+ * that are compressed concurrently, in the style of pigz, and concatenated.
+ * The zlib output remains a single valid zlib stream, but it is no longer
+ * byte-identical to the single-threaded output.  The VTK output does not
+ * change with the number of threads.  When running several MPI processes
+ * per node, their number times this value should not exceed the cores.
+ */
+extern int          sc_io_compress_threads;
+
+/** Boolean to let base 64 encoding and decoding use SIMD instructions.
+ * This applies to \ref sc_io_encode, \ref sc_io_decode and the VTK writers.
+ * Initialized to 1.  On x86 processors, the AVX2 or SSSE3 code is selected
+ * at run time if the CPU supports it.  Otherwise, or if set to 0, the
+ * portable scalar code is used.  The output is identical in all cases.
+ */
+extern int          sc_io_base64_simd;
+
 /** This function writes numeric binary data in VTK base64 encoding.
  * \param vtkfile        Stream opened for writing.
  * \param numeric_data   A pointer to a numeric data array.
@@ -590,6 +816,30 @@ int                 sc_io_open (sc_MPI_Comm mpicomm,
                                 const char *filename, sc_io_open_mode_t amode,
                                 sc_MPI_Info mpiinfo, sc_MPI_File * mpifile);
 
+/** Open a file as \ref sc_io_open with hints on the striping.
+ *
+ * With MPI I/O, the function adds the ROMIO hints "striping_unit",
+ * "striping_factor" and "cb_nodes" to a copy of \b mpiinfo according to
+ * \b stripe. Hints that \b mpiinfo already contains are not changed.
+ * The number of aggregators is at most the size of \b mpicomm. Most file
+ * systems only apply the striping when the file is created. Without MPI
+ * I/O, the function is equivalent to \ref sc_io_open.
+ *
+ * \param[in] mpicomm   MPI communicator
+ * \param[in] filename  The path to the file that we want to open.
+ * \param[in] amode     An access mode.
+ * \param[in] mpiinfo   The MPI info, may be sc_MPI_INFO_NULL.
+ * \param[in] stripe    The striping hints or NULL for none.
+ * \param[out] mpifile  As for \ref sc_io_open.
+ * \return              As for \ref sc_io_open.
+ */
+int                 sc_io_open_striped (sc_MPI_Comm mpicomm,
+                                        const char *filename,
+                                        sc_io_open_mode_t amode,
+                                        sc_MPI_Info mpiinfo,
+                                        const sc_io_stripe_t * stripe,
+                                        sc_MPI_File * mpifile);
+
 #define sc_mpi_read         sc_io_read   /**< For backwards compatibility. */
 
 /** Read MPI file content into memory.
@@ -645,6 +895,18 @@ int                 sc_io_read_at_all (sc_MPI_File mpifile,
                                        int count, sc_MPI_Datatype t,
                                        int *ocount);
 
+/** Get the byte size of an open MPI file.
+ * This function is collective.
+ *
+ * \param [in] mpifile      MPI file object.
+ * \param [out] size        The size of the file in bytes.
+ * \return                  A sc_MPI_ERR_* as defined in \ref sc_mpi.h.
+ *                          The error code can be passed to
+ *                          \ref sc_MPI_Error_string.
+ */
+int                 sc_io_get_size (sc_MPI_File mpifile,
+                                    sc_MPI_Offset * size);
+
 #define sc_mpi_write        sc_io_write  /**< For backwards compatibility. */
 
 /** Write memory content to an MPI file.
@@ -702,6 +964,92 @@ int                 sc_io_write_at_all (sc_MPI_File mpifile,
                                         const void *ptr, int count,
                                         sc_MPI_Datatype t, int *ocount);
 
+/** Opaque handle of a nonblocking file operation started by
+ * \ref sc_io_iread_at_all or \ref sc_io_iwrite_at_all. */
+typedef struct sc_io_request sc_io_request_t;
+
+/** Start reading MPI file content collectively for an explicit offset.
+ * This is the nonblocking counterpart of \ref sc_io_read_at_all.
+ * With MPI-3.1 I/O it calls MPI_File_iread_at_all.  Without MPI, the read
+ * is executed in a background thread if pthreads are enabled.  Otherwise,
+ * the operation completes within this function.
+ * Until the operation is completed by \ref sc_io_test or \ref sc_io_wait,
+ * the memory at \b ptr must not be accessed and the file must not be
+ * used for other operations.
+ *
+ * \param [in,out] mpifile      MPI file object opened for reading.
+ * \param [in] offset   Starting offset in etype, where the etype is given by
+ *                      the type t.
+ * \param [out] ptr     Data array to read from disk.
+ * \param [in] count    Number of array members.
+ * \param [in] t        The MPI type for each array member.
+ * \param [out] request On success, a request to be completed by
+ *                      \ref sc_io_test or \ref sc_io_wait.
+ *                      NULL otherwise.
+ * \return              A sc_MPI_ERR_* as defined in \ref sc_mpi.h
+ *                      if the operation could not be started.
+ *                      Errors of the operation itself are returned
+ *                      on completion.
+ */
+int                 sc_io_iread_at_all (sc_MPI_File mpifile,
+                                        sc_MPI_Offset offset, void *ptr,
+                                        int count, sc_MPI_Datatype t,
+                                        sc_io_request_t ** request);
+
+/** Start writing MPI file content collectively for an explicit offset.
+ * This is the nonblocking counterpart of \ref sc_io_write_at_all.
+ * The implementation is chosen as described for \ref sc_io_iread_at_all.
+ * Until the operation is completed by \ref sc_io_test or \ref sc_io_wait,
+ * the memory at \b ptr must not be modified and the file must not be
+ * used for other operations.
+ *
+ * \param [in,out] mpifile      MPI file object opened for writing.
+ * \param [in] offset   Starting offset in etype, where the etype is given by
+ *                      the type t.
+ * \param [in] ptr      Data array to write to disk.
+ * \param [in] count    Number of array members.
+ * \param [in] t        The MPI type for each array member.
+ * \param [out] request On success, a request to be completed by
+ *                      \ref sc_io_test or \ref sc_io_wait.
+ *                      NULL otherwise.
+ * \return              A sc_MPI_ERR_* as defined in \ref sc_mpi.h
+ *                      if the operation could not be started.
+ *                      Errors of the operation itself are returned
+ *                      on completion.
+ */
+int                 sc_io_iwrite_at_all (sc_MPI_File mpifile,
+                                         sc_MPI_Offset offset,
+                                         const void *ptr, int count,
+                                         sc_MPI_Datatype t,
+                                         sc_io_request_t ** request);
+
+/** Check whether a nonblocking file operation has completed.
+ * This function is not collective.
+ *
+ * \param [in,out] request  Request of a started operation.  On completion
+ *                          it is freed and set to NULL.
+ * \param [out] flag        True if and only if the operation completed.
+ * \param [out] ocount      On completion, the number of read or written
+ *                          elements.  0 otherwise.
+ * \return              On completion, the sc_MPI_ERR_* of the operation
+ *                      as defined in \ref sc_mpi.h.
+ *                      \ref sc_MPI_SUCCESS otherwise.
+ */
+int                 sc_io_test (sc_io_request_t ** request, int *flag,
+                                int *ocount);
+
+/** Wait for a nonblocking file operation to complete.
+ * This function is not collective.
+ *
+ * \param [in,out] request  Request of a started operation.
+ *                          It is freed and set to NULL.
+ * \param [out] ocount      The number of read or written elements.
+ * \return              The sc_MPI_ERR_* of the operation as defined in
+ *                      \ref sc_mpi.h.  The error code can be passed to
+ *                      \ref sc_MPI_Error_string.
+ */
+int                 sc_io_wait (sc_io_request_t ** request, int *ocount);
+
 /** Close collectively a sc_MPI_File.
  *
  * \param[in] file  MPI file object that is closed.
@@ -117,6 +117,11 @@ typedef enum
   SC_TAG_REDUCE = SC_TAG_NOTIFY_NARY + 32,  /**< Used in MPI reduce replacement. */
   SC_TAG_PSORT_LO,              /**< Internal tag to \ref sc_psort. */
   SC_TAG_PSORT_HI,              /**< Internal tag to \ref sc_psort. */
+  SC_TAG_AG_BRUCK,              /**< Used in MPI allgatherv replacement. */
+  SC_TAG_NOTIFY_NODE,           /**< Internal tag to \ref sc_notify. */
+  SC_TAG_NOTIFY_PLAN,           /**< Internal tag to \ref sc_notify. */
+  SC_TAG_EXCHANGE,              /**< Used in \ref sc_exchange_execute. */
+  SC_TAG_RANGES,                /**< Used in \ref sc_ranges_senders. */
   SC_TAG_LAST                   /**< End marker of tag enumeration. */
 }
 sc_tag_t;
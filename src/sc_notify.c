@@ -44,6 +44,7 @@ do {                                                       \
 
 sc_notify_type_t    sc_notify_type_default = SC_NOTIFY_PEX;
 size_t              sc_notify_eager_threshold_default = 1024;
+size_t              sc_notify_aggregate_threshold_default = 0;
 
 typedef struct sc_notify_nary_s
 {
@@ -59,6 +60,7 @@ sc_notify_nary_t;
 typedef struct sc_notify_ranges_s
 {
   int                 num_ranges;
+  int                 group_size;
   int                 package_id;
 }
 sc_notify_ranges_t;
@@ -70,18 +72,29 @@ typedef struct sc_notify_superset_s
 }
 sc_notify_superset_t;
 
+typedef struct sc_notify_node_s
+{
+  int                 mapped;
+  int                *node_of;
+  int                *local_of;
+}
+sc_notify_node_t;
+
 struct sc_notify_s
 {
   sc_MPI_Comm         mpicomm;
   sc_notify_type_t    type;
   size_t              eager_threshold;
+  size_t              aggregate_threshold;
   sc_statistics_t    *stats;
   sc_flopinfo_t       flop;
+  int                 autotuned;
   union
   {
     sc_notify_nary_t    nary;
     sc_notify_ranges_t  ranges;
     sc_notify_superset_t superset;
+    sc_notify_node_t    node;
   }
   data;
 };
@@ -96,6 +109,7 @@ const char         *sc_notify_type_strings[SC_NOTIFY_NUM_TYPES] = {
   SC_NOTIFY_STR_NBX,
   SC_NOTIFY_STR_RANGES,
   SC_NOTIFY_STR_SUPERSET,
+  SC_NOTIFY_STR_NODE,
 };
 
 sc_notify_t        *
@@ -107,6 +121,7 @@ sc_notify_new (sc_MPI_Comm comm)
   notify->mpicomm = comm;
   notify->type = SC_NOTIFY_DEFAULT;
   notify->eager_threshold = sc_notify_eager_threshold_default;
+  notify->aggregate_threshold = sc_notify_aggregate_threshold_default;
   SC_ASSERT (sc_notify_type_default >= 0
              && sc_notify_type_default < SC_NOTIFY_NUM_TYPES);
   sc_notify_set_type (notify, sc_notify_type_default);
@@ -114,6 +129,8 @@ sc_notify_new (sc_MPI_Comm comm)
   return notify;
 }
 
+static void         sc_notify_node_reset (sc_notify_t * notify);
+
 void
 sc_notify_destroy (sc_notify_t * notify)
 {
@@ -132,6 +149,9 @@ sc_notify_destroy (sc_notify_t * notify)
   case SC_NOTIFY_RANGES:
   case SC_NOTIFY_SUPERSET:
     break;
+  case SC_NOTIFY_NODE:
+    sc_notify_node_reset (notify);
+    break;
   default:
     SC_ABORT_NOT_REACHED ();
   }
@@ -152,6 +172,7 @@ sc_notify_get_type (sc_notify_t * notify)
 
 static void         sc_notify_nary_init (sc_notify_t * notify);
 static void         sc_notify_ranges_init (sc_notify_t * notify);
+static void         sc_notify_node_init (sc_notify_t * notify);
 
 int
 sc_notify_supports_type (sc_notify_type_t type)
@@ -171,6 +192,9 @@ sc_notify_set_type (sc_notify_t * notify, sc_notify_type_t in_type)
     in_type = sc_notify_type_default;
   }
   if (current_type != in_type) {
+    if (current_type == SC_NOTIFY_NODE) {
+      sc_notify_node_reset (notify);
+    }
     notify->type = in_type;
     /* initialize_data */
     switch (in_type) {
@@ -188,6 +212,9 @@ sc_notify_set_type (sc_notify_t * notify, sc_notify_type_t in_type)
     case SC_NOTIFY_NARY:
       sc_notify_nary_init (notify);
       break;
+    case SC_NOTIFY_NODE:
+      sc_notify_node_init (notify);
+      break;
     default:
       SC_ABORT_NOT_REACHED ();
     }
@@ -204,11 +231,23 @@ sc_notify_get_eager_threshold (sc_notify_t * notify)
 }
 
 void
-sc_notify_set_eagher_threshold (sc_notify_t * notify, size_t thresh)
+sc_notify_set_eager_threshold (sc_notify_t * notify, size_t thresh)
 {
   notify->eager_threshold = thresh;
 }
 
+size_t
+sc_notify_get_aggregate_threshold (sc_notify_t * notify)
+{
+  return notify->aggregate_threshold;
+}
+
+void
+sc_notify_set_aggregate_threshold (sc_notify_t * notify, size_t thresh)
+{
+  notify->aggregate_threshold = thresh;
+}
+
 #if 0
 
 static void
@@ -857,10 +896,6 @@ sc_notify_init_input (sc_array_t * input, int *receivers, int num_receivers,
               payload->elem_size);
     }
   }
-
-  if (payload != NULL) {
-    sc_array_reset (payload);
-  }
 }
 
 /** Decode sender list into an array for output.
@@ -900,6 +935,9 @@ sc_notify_reset_output (sc_array_t * output, int *senders, int *num_senders,
   multi = 1 + npay;
 
   found_num_senders = 0;
+  if (payload != NULL) {
+    sc_array_reset (payload);
+  }
   if (output->elem_count > 0) {
     SC_ASSERT (senders != NULL);
 
@@ -913,7 +951,6 @@ sc_notify_reset_output (sc_array_t * output, int *senders, int *num_senders,
       memcpy (senders, pint + 2, found_num_senders * sizeof (int));
     }
     else {
-      sc_array_reset (payload);
       sc_array_resize (payload, found_num_senders);
       for (i = 0; i < found_num_senders; ++i) {
         senders[i] = pint[2 + multi * i];
@@ -1137,7 +1174,7 @@ sc_notify_nary_get_widths (sc_notify_t * notify, int *ntop, int *nint,
   if (nint)
     *nint = notify->data.nary.nint;
   if (nbot)
-    *nint = notify->data.nary.nbot;
+    *nbot = notify->data.nary.nbot;
 }
 
 void
@@ -1154,23 +1191,26 @@ sc_notify_nary_set_widths (sc_notify_t * notify, int ntop, int nint, int nbot)
   notify->data.nary.nbot = nbot;
 }
 
+/** Set communicator data and default widths of an n-ary tree. */
 static void
-sc_notify_nary_init (sc_notify_t * notify)
+sc_notify_nary_setup (sc_notify_nary_t * nary, sc_MPI_Comm comm)
 {
-  sc_MPI_Comm         comm;
-  int                 success, mpisize, mpirank;
+  int                 success;
 
-  notify->data.nary.mpicomm = comm = sc_notify_get_comm (notify);
-
-  success = sc_MPI_Comm_size (comm, &mpisize);
+  nary->mpicomm = comm;
+  success = sc_MPI_Comm_size (comm, &nary->mpisize);
   SC_CHECK_MPI (success);
-  notify->data.nary.mpisize = mpisize;
-  success = sc_MPI_Comm_rank (comm, &mpirank);
+  success = sc_MPI_Comm_rank (comm, &nary->mpirank);
   SC_CHECK_MPI (success);
-  notify->data.nary.mpirank = mpirank;
-  sc_notify_nary_set_widths (notify, sc_notify_nary_ntop_default,
-                             sc_notify_nary_nint_default,
-                             sc_notify_nary_nbot_default);
+  nary->ntop = sc_notify_nary_ntop_default;
+  nary->nint = sc_notify_nary_nint_default;
+  nary->nbot = sc_notify_nary_nbot_default;
+}
+
+static void
+sc_notify_nary_init (sc_notify_t * notify)
+{
+  sc_notify_nary_setup (&notify->data.nary, sc_notify_get_comm (notify));
 }
 
 /** Internally used function to execute the sc_notify recursion.
@@ -1471,14 +1511,14 @@ sc_notify_recursive_nary (const sc_notify_nary_t * nary, int level,
 static void
 sc_notify_payload_nary (sc_array_t * receivers, sc_array_t * senders,
                         sc_array_t * in_payload, sc_array_t * out_payload,
-                        sc_notify_t * notify)
+                        sc_notify_t * notify, const sc_notify_nary_t * tree)
 {
   int                 mpisize, mpirank;
   int                 depth, prod;
   int                 num_receivers, num_senders;
   int                 ntop, nint, nbot;
   sc_array_t          sarray, *array = &sarray;
-  sc_notify_nary_t    snary = notify->data.nary, *nary = &snary;
+  sc_notify_nary_t    snary = *tree, *nary = &snary;
   sc_flopinfo_t       snap;
 
   SC_NOTIFY_FUNC_SNAP (notify, &snap);
@@ -1662,6 +1702,361 @@ sc_notify_payload_pex (sc_array_t * receivers, sc_array_t * senders,
   SC_NOTIFY_FUNC_SHOT (notify, &snap);
 }
 
+/*== SC_NOTIFY_NODE ==*/
+
+static void
+sc_notify_node_init (sc_notify_t * notify)
+{
+  sc_notify_node_t   *node = &notify->data.node;
+
+  node->mapped = 0;
+  node->node_of = NULL;
+  node->local_of = NULL;
+}
+
+static void
+sc_notify_node_reset (sc_notify_t * notify)
+{
+  sc_notify_node_t   *node = &notify->data.node;
+
+  SC_FREE (node->node_of);
+  SC_FREE (node->local_of);
+  sc_notify_node_init (notify);
+}
+
+/** Cache on each node leader the node and node-local rank of every process.
+ * This is collective over the communicator and executed once per notify. */
+static void
+sc_notify_node_map (sc_notify_t * notify,
+                    sc_MPI_Comm intranode, sc_MPI_Comm internode)
+{
+  int                 mpiret;
+  int                 mpisize, mpirank;
+  int                 intrasize, intrarank;
+  int                 intersize;
+  int                 i, j, r;
+  int                *members = NULL;
+  int                *allmembers;
+  sc_notify_node_t   *node = &notify->data.node;
+
+  if (node->mapped) {
+    return;
+  }
+
+  mpiret = sc_MPI_Comm_size (notify->mpicomm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (notify->mpicomm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_size (intranode, &intrasize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (intranode, &intrarank);
+  SC_CHECK_MPI (mpiret);
+
+  /* the leader learns the global ranks of its node in local order */
+  if (intrarank == 0) {
+    members = SC_ALLOC (int, intrasize);
+  }
+  mpiret = sc_MPI_Gather (&mpirank, 1, sc_MPI_INT,
+                          members, 1, sc_MPI_INT, 0, intranode);
+  SC_CHECK_MPI (mpiret);
+
+  if (intrarank == 0) {
+    /* all node communicators have the same size */
+    mpiret = sc_MPI_Comm_size (internode, &intersize);
+    SC_CHECK_MPI (mpiret);
+    SC_ASSERT (intersize * intrasize == mpisize);
+
+    allmembers = SC_ALLOC (int, mpisize);
+    mpiret = sc_MPI_Allgather (members, intrasize, sc_MPI_INT,
+                               allmembers, intrasize, sc_MPI_INT, internode);
+    SC_CHECK_MPI (mpiret);
+
+    node->node_of = SC_ALLOC (int, mpisize);
+    node->local_of = SC_ALLOC (int, mpisize);
+    for (i = 0; i < intersize; ++i) {
+      for (j = 0; j < intrasize; ++j) {
+        r = allmembers[i * intrasize + j];
+        SC_ASSERT (0 <= r && r < mpisize);
+        node->node_of[r] = i;
+        node->local_of[r] = j;
+      }
+    }
+    SC_FREE (allmembers);
+    SC_FREE (members);
+  }
+  node->mapped = 1;
+}
+
+/** Compare two node records by their sender rank. */
+static int
+sc_notify_node_compare (const void *v1, const void *v2)
+{
+  int                 i1, i2;
+
+  memcpy (&i1, (const char *) v1 + sizeof (int), sizeof (int));
+  memcpy (&i2, (const char *) v2 + sizeof (int), sizeof (int));
+
+  return i1 == i2 ? 0 : i1 < i2 ? -1 : +1;
+}
+
+/** Sort records into buckets by a key lookup on their receiver rank.
+ * \param [in] records      Records of size \a rsize, receiver rank first.
+ * \param [in] num_records  Number of records.
+ * \param [in] rsize        Byte size of one record.
+ * \param [in] key          Bucket number for each receiver rank.
+ * \param [in] num_buckets  Number of buckets.
+ * \param [out] counts      Number of records per bucket.
+ * \param [out] offsets     First record per bucket.
+ * \return                  Newly allocated array of sorted records.
+ */
+static char        *
+sc_notify_node_bucket (const char *records, int num_records, size_t rsize,
+                       const int *key, int num_buckets,
+                       int *counts, int *offsets)
+{
+  int                 i, b;
+  int                 torank;
+  int                *cursor;
+  char               *sorted;
+
+  memset (counts, 0, num_buckets * sizeof (int));
+  for (i = 0; i < num_records; ++i) {
+    memcpy (&torank, records + i * rsize, sizeof (int));
+    ++counts[key[torank]];
+  }
+  offsets[0] = 0;
+  for (b = 1; b < num_buckets; ++b) {
+    offsets[b] = offsets[b - 1] + counts[b - 1];
+  }
+  cursor = SC_ALLOC (int, num_buckets);
+  memcpy (cursor, offsets, num_buckets * sizeof (int));
+  sorted = SC_ALLOC (char, num_records * rsize);
+  for (i = 0; i < num_records; ++i) {
+    memcpy (&torank, records + i * rsize, sizeof (int));
+    memcpy (sorted + (cursor[key[torank]]++) * rsize,
+            records + i * rsize, rsize);
+  }
+  SC_FREE (cursor);
+
+  return sorted;
+}
+
+static void
+sc_notify_payload_node (sc_array_t * receivers, sc_array_t * senders,
+                        sc_array_t * in_payload, sc_array_t * out_payload,
+                        sc_notify_t * notify)
+{
+  int                 i;
+  int                 mpiret;
+  int                 mpirank;
+  int                 intrasize, intrarank;
+  int                 intersize, interrank;
+  int                 num_receivers, num_records;
+  int                 num_mine, num_bytes;
+  int                 nreq;
+  int                *ireceivers, *isenders;
+  int                *counts, *offsets;
+  int                *sendcounts, *senddispls;
+  int                *recvcounts, *recvdispls;
+  size_t              psize, rsize;
+  char               *records, *gathered, *sorted, *exchanged;
+  char               *mine, *cp;
+  sc_array_t          view;
+  sc_MPI_Request     *req;
+  sc_MPI_Status       status;
+  sc_MPI_Comm         intranode, internode;
+  sc_notify_node_t   *node = &notify->data.node;
+  sc_flopinfo_t       snap;
+
+  sc_mpi_comm_get_node_comms (notify->mpicomm, &intranode, &internode);
+  if (intranode == sc_MPI_COMM_NULL || internode == sc_MPI_COMM_NULL) {
+    sc_notify_payload_pex (receivers, senders, in_payload, out_payload,
+                           notify);
+    return;
+  }
+
+  SC_NOTIFY_FUNC_SNAP (notify, &snap);
+
+  sc_notify_node_map (notify, intranode, internode);
+  mpiret = sc_MPI_Comm_rank (notify->mpicomm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_size (intranode, &intrasize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (intranode, &intrarank);
+  SC_CHECK_MPI (mpiret);
+
+  /* a record is the receiver rank, the sender rank, and the payload */
+  psize = in_payload != NULL ? in_payload->elem_size : 0;
+  rsize = 2 * sizeof (int) + psize;
+  num_receivers = (int) receivers->elem_count;
+  ireceivers = (int *) receivers->array;
+  records = SC_ALLOC (char, num_receivers * rsize);
+  for (i = 0; i < num_receivers; ++i) {
+    cp = records + i * rsize;
+    memcpy (cp, &ireceivers[i], sizeof (int));
+    memcpy (cp + sizeof (int), &mpirank, sizeof (int));
+    if (psize > 0) {
+      memcpy (cp + 2 * sizeof (int),
+              sc_array_index_int (in_payload, i), psize);
+    }
+  }
+
+  /* collect all records of the node on its leader */
+  counts = offsets = NULL;
+  gathered = NULL;
+  if (intrarank == 0) {
+    counts = SC_ALLOC (int, intrasize);
+    offsets = SC_ALLOC (int, intrasize);
+  }
+  num_bytes = (int) (num_receivers * rsize);
+  mpiret = sc_MPI_Gather (&num_bytes, 1, sc_MPI_INT,
+                          counts, 1, sc_MPI_INT, 0, intranode);
+  SC_CHECK_MPI (mpiret);
+  num_records = 0;
+  if (intrarank == 0) {
+    offsets[0] = 0;
+    for (i = 1; i < intrasize; ++i) {
+      offsets[i] = offsets[i - 1] + counts[i - 1];
+    }
+    num_records = (int) ((offsets[intrasize - 1] +
+                          counts[intrasize - 1]) / rsize);
+    gathered = SC_ALLOC (char, num_records * rsize);
+  }
+  mpiret = sc_MPI_Gatherv (records, num_bytes, sc_MPI_BYTE,
+                           gathered, counts, offsets, sc_MPI_BYTE,
+                           0, intranode);
+  SC_CHECK_MPI (mpiret);
+  SC_FREE (records);
+
+  req = NULL;
+  nreq = 0;
+  if (intrarank == 0) {
+    mpiret = sc_MPI_Comm_size (internode, &intersize);
+    SC_CHECK_MPI (mpiret);
+    mpiret = sc_MPI_Comm_rank (internode, &interrank);
+    SC_CHECK_MPI (mpiret);
+
+    /* exchange records between the node leaders only */
+    sendcounts = SC_ALLOC (int, intersize);
+    senddispls = SC_ALLOC (int, intersize);
+    sorted = sc_notify_node_bucket (gathered, num_records, rsize,
+                                    node->node_of, intersize,
+                                    sendcounts, senddispls);
+    SC_FREE (gathered);
+    recvcounts = SC_ALLOC (int, intersize);
+    recvdispls = SC_ALLOC (int, intersize);
+    mpiret = sc_MPI_Alltoall (sendcounts, 1, sc_MPI_INT,
+                              recvcounts, 1, sc_MPI_INT, internode);
+    SC_CHECK_MPI (mpiret);
+    recvdispls[0] = 0;
+    for (i = 1; i < intersize; ++i) {
+      recvdispls[i] = recvdispls[i - 1] + recvcounts[i - 1];
+    }
+    num_records = recvdispls[intersize - 1] + recvcounts[intersize - 1];
+    exchanged = SC_ALLOC (char, num_records * rsize);
+    /* the requests are reused for the sends within the node */
+    req = SC_ALLOC (sc_MPI_Request, SC_MAX (2 * intersize, intrasize - 1));
+    for (i = 0; i < intersize; ++i) {
+      if (i == interrank) {
+        SC_ASSERT (recvcounts[i] == sendcounts[i]);
+        memcpy (exchanged + recvdispls[i] * rsize,
+                sorted + senddispls[i] * rsize, sendcounts[i] * rsize);
+      }
+      else if (recvcounts[i] > 0) {
+        mpiret = sc_MPI_Irecv (exchanged + recvdispls[i] * rsize,
+                               (int) (recvcounts[i] * rsize), sc_MPI_BYTE,
+                               i, SC_TAG_NOTIFY_NODE, internode, req + nreq);
+        SC_CHECK_MPI (mpiret);
+        ++nreq;
+      }
+    }
+    for (i = 0; i < intersize; ++i) {
+      if (i != interrank && sendcounts[i] > 0) {
+        mpiret = sc_MPI_Isend (sorted + senddispls[i] * rsize,
+                               (int) (sendcounts[i] * rsize), sc_MPI_BYTE,
+                               i, SC_TAG_NOTIFY_NODE, internode, req + nreq);
+        SC_CHECK_MPI (mpiret);
+        ++nreq;
+      }
+    }
+    mpiret = sc_MPI_Waitall (nreq, req, sc_MPI_STATUSES_IGNORE);
+    SC_CHECK_MPI (mpiret);
+    SC_FREE (sorted);
+    SC_FREE (sendcounts);
+    SC_FREE (senddispls);
+    SC_FREE (recvcounts);
+    SC_FREE (recvdispls);
+
+    /* distribute the records within the node */
+    sorted = sc_notify_node_bucket (exchanged, num_records, rsize,
+                                    node->local_of, intrasize,
+                                    counts, offsets);
+    SC_FREE (exchanged);
+    nreq = 0;
+    for (i = 1; i < intrasize; ++i) {
+      mpiret = sc_MPI_Isend (sorted + offsets[i] * rsize,
+                             (int) (counts[i] * rsize), sc_MPI_BYTE,
+                             i, SC_TAG_NOTIFY_NODE, intranode, req + nreq);
+      SC_CHECK_MPI (mpiret);
+      ++nreq;
+    }
+    num_mine = counts[0];
+    mine = SC_ALLOC (char, num_mine * rsize);
+    memcpy (mine, sorted, num_mine * rsize);
+  }
+  else {
+    sorted = NULL;
+    mpiret = sc_MPI_Probe (0, SC_TAG_NOTIFY_NODE, intranode, &status);
+    SC_CHECK_MPI (mpiret);
+    mpiret = sc_MPI_Get_count (&status, sc_MPI_BYTE, &num_bytes);
+    SC_CHECK_MPI (mpiret);
+    SC_ASSERT (num_bytes % rsize == 0);
+    num_mine = (int) (num_bytes / rsize);
+    mine = SC_ALLOC (char, num_bytes);
+    mpiret = sc_MPI_Recv (mine, num_bytes, sc_MPI_BYTE, 0,
+                          SC_TAG_NOTIFY_NODE, intranode,
+                          sc_MPI_STATUS_IGNORE);
+    SC_CHECK_MPI (mpiret);
+  }
+
+  /* order the received records by sender */
+  sc_array_init_data (&view, mine, rsize, (size_t) num_mine);
+  sc_array_sort (&view, sc_notify_node_compare);
+
+  if (!senders) {
+    sc_array_reset (receivers);
+    senders = receivers;
+  }
+  sc_array_resize (senders, (size_t) num_mine);
+  isenders = (int *) senders->array;
+  if (in_payload && out_payload == NULL) {
+    sc_array_reset (in_payload);
+    out_payload = in_payload;
+  }
+  if (out_payload) {
+    sc_array_resize (out_payload, (size_t) num_mine);
+  }
+  for (i = 0; i < num_mine; ++i) {
+    cp = mine + i * rsize;
+    memcpy (&isenders[i], cp + sizeof (int), sizeof (int));
+    if (out_payload) {
+      memcpy (sc_array_index_int (out_payload, i),
+              cp + 2 * sizeof (int), psize);
+    }
+  }
+  SC_FREE (mine);
+
+  if (intrarank == 0) {
+    mpiret = sc_MPI_Waitall (nreq, req, sc_MPI_STATUSES_IGNORE);
+    SC_CHECK_MPI (mpiret);
+    SC_FREE (req);
+    SC_FREE (sorted);
+    SC_FREE (counts);
+    SC_FREE (offsets);
+  }
+  SC_NOTIFY_FUNC_SHOT (notify, &snap);
+}
+
 /*== SC_NOTIFY_PCX ==*/
 
 static int
@@ -2142,6 +2537,7 @@ sc_notify_payloadv_nbx (sc_array_t * receivers, sc_array_t * senders,
 /*== SC_NOTIFY_RANGES ==*/
 
 int                 sc_notify_ranges_num_ranges_default = 25;
+int                 sc_notify_ranges_group_size_default = 32;
 
 int
 sc_notify_ranges_get_num_ranges (sc_notify_t * notify)
@@ -2158,6 +2554,21 @@ sc_notify_ranges_set_num_ranges (sc_notify_t * notify, int num_ranges)
   notify->data.ranges.num_ranges = num_ranges;
 }
 
+int
+sc_notify_ranges_get_group_size (sc_notify_t * notify)
+{
+  SC_ASSERT (notify->type == SC_NOTIFY_RANGES);
+  return notify->data.ranges.group_size;
+}
+
+void
+sc_notify_ranges_set_group_size (sc_notify_t * notify, int group_size)
+{
+  SC_ASSERT (notify->type == SC_NOTIFY_RANGES);
+  SC_ASSERT (group_size > 0);
+  notify->data.ranges.group_size = group_size;
+}
+
 int
 sc_notify_ranges_get_package_id (sc_notify_t * notify)
 {
@@ -2176,6 +2587,7 @@ static void
 sc_notify_ranges_init (sc_notify_t * notify)
 {
   notify->data.ranges.num_ranges = sc_notify_ranges_num_ranges_default;
+  notify->data.ranges.group_size = sc_notify_ranges_group_size_default;
   notify->data.ranges.package_id = sc_package_id;
 }
 
@@ -2187,18 +2599,16 @@ sc_notify_payload_ranges (sc_array_t * receivers, sc_array_t * senders,
 {
   int                *my_ranges;
   int                 max_ranges;
-  int                 maxwin;
+  int                 nwin;
   int                 package_id;
   int                 num_procs;
-  int                 maxpeers;
   sc_MPI_Comm         comm;
   int                 rank, size;
   int                 mpiret;
-  int                *all_ranges;
   int                 num_receivers_ranges = 0, num_senders_ranges = 0;
   int                *procs;
   int                *ireceivers;
-  int                 i;
+  int                 i, j;
   int                 first_peer, last_peer;
   int                *receiver_ranks_ranges;
   int                *sender_ranks_ranges;
@@ -2244,18 +2654,24 @@ sc_notify_payload_ranges (sc_array_t * receivers, sc_array_t * senders,
     last_peer = SC_MAX (peer, last_peer);
     procs[peer] = i + 1;
   }
-  maxpeers = first_peer;
-  maxwin = last_peer;
-  (void) sc_ranges_adaptive (package_id, comm, procs, &maxpeers, &maxwin,
-                             max_ranges, my_ranges, &all_ranges);
-  sc_ranges_decode (size, rank, maxwin, all_ranges,
-                    &num_receivers_ranges, receiver_ranks_ranges,
-                    &num_senders_ranges, sender_ranks_ranges);
+
+  /* everybody's ranges are only known to the leaders of overlapping groups */
+  nwin = sc_ranges_compute (package_id, size, procs, rank,
+                            first_peer, last_peer, max_ranges, my_ranges);
+  for (i = 0; i < nwin; i++) {
+    for (j = my_ranges[2 * i]; j <= my_ranges[2 * i + 1]; j++) {
+      if (j != rank) {
+        receiver_ranks_ranges[num_receivers_ranges++] = j;
+      }
+    }
+  }
+  sc_ranges_senders (package_id, comm, notify->data.ranges.group_size,
+                     nwin, my_ranges, &num_senders_ranges,
+                     sender_ranks_ranges);
 #ifdef SC_ENABLE_DEBUG
   sc_ranges_statistics (package_id, SC_LP_STATISTICS,
-                        comm, num_procs, procs, rank, max_ranges, my_ranges);
+                        comm, size, procs, rank, max_ranges, my_ranges);
 #endif
-  SC_FREE (all_ranges);
   SC_FREE (my_ranges);
   msg_size = sizeof (int);
   if (in_payload) {
@@ -2815,6 +3231,20 @@ sc_notify_payload (sc_array_t * receivers, sc_array_t * senders,
     SC_ASSERT (out_payload == NULL);
   }
 
+  if (in_payload && type != SC_NOTIFY_NARY && notify->aggregate_threshold &&
+      in_payload->elem_size <= notify->aggregate_threshold) {
+    sc_notify_nary_t    tree;
+
+    /* tiny payloads travel packed through an n-ary tree, one message
+       per hop, instead of one message per receiver */
+    sc_notify_nary_setup (&tree, sc_notify_get_comm (notify));
+    sc_notify_payload_nary (receivers, senders, in_payload, out_payload,
+                            notify, &tree);
+    SC_GLOBAL_LDEBUG ("Done sc_notify_payload aggregated\n");
+    SC_NOTIFY_FUNC_SHOT (notify, &snap);
+    return;
+  }
+
   if (in_payload && in_payload->elem_size <= notify->eager_threshold) {
     first_in_payload = in_payload;
     first_out_payload = out_payload;
@@ -2839,7 +3269,7 @@ sc_notify_payload (sc_array_t * receivers, sc_array_t * senders,
     break;
   case SC_NOTIFY_NARY:
     sc_notify_payload_nary (receivers, senders, first_in_payload,
-                            first_out_payload, notify);
+                            first_out_payload, notify, &notify->data.nary);
     break;
   case SC_NOTIFY_PEX:
     sc_notify_payload_pex (receivers, senders, first_in_payload,
@@ -2867,6 +3297,10 @@ sc_notify_payload (sc_array_t * receivers, sc_array_t * senders,
     sc_notify_payload_superset (receivers, senders, first_in_payload,
                                 first_out_payload, sorted, notify);
     break;
+  case SC_NOTIFY_NODE:
+    sc_notify_payload_node (receivers, senders, first_in_payload,
+                            first_out_payload, notify);
+    break;
   default:
     SC_ABORT_NOT_REACHED ();
   }
@@ -2990,6 +3424,7 @@ sc_notify_payloadv (sc_array_t * receivers, sc_array_t * senders,
   case SC_NOTIFY_PEX:
   case SC_NOTIFY_RANGES:
   case SC_NOTIFY_SUPERSET:
+  case SC_NOTIFY_NODE:
     sc_notify_payloadv_wrapper (receivers, senders, in_payload, out_payload,
                                 in_offsets, out_offsets, sorted, notify);
     break;
@@ -3039,3 +3474,613 @@ sc_notify_ext (sc_array_t * receivers, sc_array_t * senders,
   sc_notify_payload (receivers, senders, in_payload, out_payload, 1, notifyc);
   sc_notify_destroy (notifyc);
 }
+
+/*== PERSISTENT PLAN ==*/
+
+struct sc_notify_plan_s
+{
+  sc_notify_t        *notify;
+  int                 valid;
+  long                num_census;
+  long                num_reused;
+  sc_array_t         *receivers;
+  sc_array_t         *senders;
+  sc_array_t         *requests;
+  sc_array_t         *counts;
+};
+
+sc_notify_plan_t   *
+sc_notify_plan_new (sc_notify_t * notify)
+{
+  sc_notify_plan_t   *plan;
+
+  SC_ASSERT (notify != NULL);
+
+  plan = SC_ALLOC_ZERO (sc_notify_plan_t, 1);
+  plan->notify = notify;
+  plan->receivers = sc_array_new (sizeof (int));
+  plan->senders = sc_array_new (sizeof (int));
+  plan->requests = sc_array_new (sizeof (sc_MPI_Request));
+  plan->counts = sc_array_new (sizeof (int));
+  return plan;
+}
+
+void
+sc_notify_plan_destroy (sc_notify_plan_t * plan)
+{
+  sc_array_destroy (plan->receivers);
+  sc_array_destroy (plan->senders);
+  sc_array_destroy (plan->requests);
+  sc_array_destroy (plan->counts);
+  SC_FREE (plan);
+}
+
+void
+sc_notify_plan_invalidate (sc_notify_plan_t * plan)
+{
+  plan->valid = 0;
+}
+
+long
+sc_notify_plan_num_census (sc_notify_plan_t * plan)
+{
+  return plan->num_census;
+}
+
+long
+sc_notify_plan_num_reused (sc_notify_plan_t * plan)
+{
+  return plan->num_reused;
+}
+
+/** Collectively decide whether any process has changed its receivers. */
+static int
+sc_notify_plan_changed (sc_notify_plan_t * plan, sc_array_t * receivers)
+{
+  int                 mpiret;
+  int                 changed, anychanged;
+
+  changed = !plan->valid ||
+    receivers->elem_count != plan->receivers->elem_count ||
+    memcmp (receivers->array, plan->receivers->array,
+            receivers->elem_count * sizeof (int));
+  changed = changed ? 1 : 0;
+  mpiret = sc_MPI_Allreduce (&changed, &anychanged, 1, sc_MPI_INT,
+                             sc_MPI_MAX, sc_notify_get_comm (plan->notify));
+  SC_CHECK_MPI (mpiret);
+
+  return anychanged;
+}
+
+/** Return the position of this process in the cached senders or -1. */
+static int
+sc_notify_plan_self (sc_notify_plan_t * plan, int mpirank)
+{
+  int                 j;
+  int                 num_senders = (int) plan->senders->elem_count;
+  int                *isenders = (int *) plan->senders->array;
+
+  for (j = 0; j < num_senders; ++j) {
+    if (isenders[j] == mpirank) {
+      return j;
+    }
+  }
+  return -1;
+}
+
+/** Replace the senders or, if NULL, the receivers by the cached senders. */
+static void
+sc_notify_plan_senders (sc_notify_plan_t * plan,
+                        sc_array_t * receivers, sc_array_t * senders)
+{
+  sc_array_copy (senders != NULL ? senders : receivers, plan->senders);
+}
+
+void
+sc_notify_plan_payload (sc_notify_plan_t * plan, sc_array_t * receivers,
+                        sc_array_t * senders, sc_array_t * in_payload,
+                        sc_array_t * out_payload, int sorted)
+{
+  int                 i;
+  int                 mpiret;
+  int                 mpirank;
+  int                 num_receivers, num_senders;
+  int                 self, nreq;
+  int                *ireceivers, *isenders;
+  size_t              msg_size;
+  char               *sendbuf, *recvbuf;
+  sc_MPI_Request     *req;
+  sc_MPI_Comm         comm;
+  sc_notify_t        *notify = plan->notify;
+  sc_flopinfo_t       snap;
+
+  SC_ASSERT (receivers != NULL && receivers->elem_size == sizeof (int));
+  SC_ASSERT (senders == NULL || senders->elem_size == sizeof (int));
+
+  if (sc_notify_plan_changed (plan, receivers)) {
+    /* the receivers may be overwritten by the notify call */
+    sc_array_copy (plan->receivers, receivers);
+    sc_notify_payload (receivers, senders, in_payload, out_payload,
+                       sorted, notify);
+    sc_array_copy (plan->senders, senders != NULL ? senders : receivers);
+    plan->valid = 1;
+    ++plan->num_census;
+    return;
+  }
+
+  SC_NOTIFY_FUNC_SNAP (notify, &snap);
+  ++plan->num_reused;
+  if (in_payload != NULL) {
+    comm = sc_notify_get_comm (notify);
+    mpiret = sc_MPI_Comm_rank (comm, &mpirank);
+    SC_CHECK_MPI (mpiret);
+
+    num_receivers = (int) receivers->elem_count;
+    num_senders = (int) plan->senders->elem_count;
+    ireceivers = (int *) receivers->array;
+    isenders = (int *) plan->senders->array;
+    self = sc_notify_plan_self (plan, mpirank);
+    SC_ASSERT ((int) in_payload->elem_count == num_receivers);
+
+    msg_size = in_payload->elem_size;
+    sendbuf = in_payload->array;
+    if (out_payload != NULL) {
+      SC_ASSERT (out_payload->elem_size == msg_size);
+      sc_array_resize (out_payload, (size_t) num_senders);
+      recvbuf = out_payload->array;
+    }
+    else {
+      recvbuf = SC_ALLOC (char, num_senders * msg_size);
+    }
+
+    /* exchange the payload with the known partners */
+    sc_array_resize (plan->requests, (size_t) (num_receivers + num_senders));
+    req = (sc_MPI_Request *) plan->requests->array;
+    nreq = 0;
+    for (i = 0; i < num_senders; ++i) {
+      if (i != self) {
+        mpiret = sc_MPI_Irecv (recvbuf + i * msg_size, (int) msg_size,
+                               sc_MPI_BYTE, isenders[i], SC_TAG_NOTIFY_PLAN,
+                               comm, req + nreq++);
+        SC_CHECK_MPI (mpiret);
+      }
+    }
+    for (i = 0; i < num_receivers; ++i) {
+      if (ireceivers[i] == mpirank) {
+        SC_ASSERT (self >= 0);
+        memcpy (recvbuf + self * msg_size, sendbuf + i * msg_size, msg_size);
+      }
+      else {
+        mpiret = sc_MPI_Isend (sendbuf + i * msg_size, (int) msg_size,
+                               sc_MPI_BYTE, ireceivers[i], SC_TAG_NOTIFY_PLAN,
+                               comm, req + nreq++);
+        SC_CHECK_MPI (mpiret);
+      }
+    }
+    mpiret = sc_MPI_Waitall (nreq, req, sc_MPI_STATUSES_IGNORE);
+    SC_CHECK_MPI (mpiret);
+
+    if (out_payload == NULL) {
+      sc_array_resize (in_payload, (size_t) num_senders);
+      memcpy (in_payload->array, recvbuf, num_senders * msg_size);
+      SC_FREE (recvbuf);
+    }
+  }
+  else {
+    SC_ASSERT (out_payload == NULL);
+  }
+  sc_notify_plan_senders (plan, receivers, senders);
+  SC_NOTIFY_FUNC_SHOT (notify, &snap);
+}
+
+void
+sc_notify_plan_payloadv (sc_notify_plan_t * plan, sc_array_t * receivers,
+                         sc_array_t * senders, sc_array_t * in_payload,
+                         sc_array_t * out_payload, sc_array_t * in_offsets,
+                         sc_array_t * out_offsets, int sorted)
+{
+  int                 i;
+  int                 mpiret;
+  int                 mpirank;
+  int                 num_receivers, num_senders;
+  int                 self, nreq, bcount;
+  int                *ireceivers, *isenders;
+  int                *ioffsets, *icounts;
+  int                 total;
+  size_t              esize;
+  char               *sendbuf, *recvbuf;
+  sc_MPI_Request     *req;
+  sc_MPI_Status       status;
+  sc_MPI_Comm         comm;
+  sc_notify_t        *notify = plan->notify;
+  sc_flopinfo_t       snap;
+
+  if (in_payload == NULL) {
+    SC_ASSERT (out_payload == NULL && in_offsets == NULL
+               && out_offsets == NULL);
+    sc_notify_plan_payload (plan, receivers, senders, NULL, NULL, sorted);
+    return;
+  }
+
+  SC_ASSERT (receivers != NULL && receivers->elem_size == sizeof (int));
+  SC_ASSERT (senders == NULL || senders->elem_size == sizeof (int));
+  SC_ASSERT (in_offsets != NULL && in_offsets->elem_size == sizeof (int));
+  SC_ASSERT (in_offsets->elem_count == receivers->elem_count + 1);
+
+  if (sc_notify_plan_changed (plan, receivers)) {
+    sc_array_copy (plan->receivers, receivers);
+    sc_notify_payloadv (receivers, senders, in_payload, out_payload,
+                        in_offsets, out_offsets, sorted, notify);
+    sc_array_copy (plan->senders, senders != NULL ? senders : receivers);
+    plan->valid = 1;
+    ++plan->num_census;
+    return;
+  }
+
+  SC_NOTIFY_FUNC_SNAP (notify, &snap);
+  ++plan->num_reused;
+  comm = sc_notify_get_comm (notify);
+  mpiret = sc_MPI_Comm_rank (comm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+
+  num_receivers = (int) receivers->elem_count;
+  num_senders = (int) plan->senders->elem_count;
+  ireceivers = (int *) receivers->array;
+  isenders = (int *) plan->senders->array;
+  ioffsets = (int *) in_offsets->array;
+  self = sc_notify_plan_self (plan, mpirank);
+  esize = in_payload->elem_size;
+  sendbuf = in_payload->array;
+
+  /* post all sends before probing for the incoming message sizes */
+  sc_array_resize (plan->requests, (size_t) (num_receivers + num_senders));
+  req = (sc_MPI_Request *) plan->requests->array;
+  sc_array_resize (plan->counts, (size_t) num_senders);
+  icounts = (int *) plan->counts->array;
+  nreq = 0;
+  for (i = 0; i < num_receivers; ++i) {
+    if (ireceivers[i] == mpirank) {
+      SC_ASSERT (self >= 0);
+      icounts[self] = ioffsets[i + 1] - ioffsets[i];
+    }
+    else {
+      mpiret = sc_MPI_Isend (sendbuf + ioffsets[i] * esize,
+                             (int) ((ioffsets[i + 1] - ioffsets[i]) * esize),
+                             sc_MPI_BYTE, ireceivers[i], SC_TAG_NOTIFY_PLAN,
+                             comm, req + nreq++);
+      SC_CHECK_MPI (mpiret);
+    }
+  }
+  total = 0;
+  for (i = 0; i < num_senders; ++i) {
+    if (i != self) {
+      mpiret = sc_MPI_Probe (isenders[i], SC_TAG_NOTIFY_PLAN, comm, &status);
+      SC_CHECK_MPI (mpiret);
+      mpiret = sc_MPI_Get_count (&status, sc_MPI_BYTE, &bcount);
+      SC_CHECK_MPI (mpiret);
+      SC_ASSERT (bcount % esize == 0);
+      icounts[i] = (int) (bcount / esize);
+    }
+    total += icounts[i];
+  }
+  if (out_payload != NULL) {
+    SC_ASSERT (out_payload->elem_size == esize);
+    sc_array_resize (out_payload, (size_t) total);
+    recvbuf = out_payload->array;
+  }
+  else {
+    recvbuf = SC_ALLOC (char, total * esize);
+  }
+
+  /* receive into place and copy the message to ourselves */
+  total = 0;
+  for (i = 0; i < num_senders; ++i) {
+    if (i != self) {
+      mpiret = sc_MPI_Irecv (recvbuf + total * esize,
+                             (int) (icounts[i] * esize), sc_MPI_BYTE,
+                             isenders[i], SC_TAG_NOTIFY_PLAN, comm,
+                             req + nreq++);
+      SC_CHECK_MPI (mpiret);
+    }
+    total += icounts[i];
+  }
+  if (self >= 0) {
+    for (i = 0; i < num_receivers; ++i) {
+      if (ireceivers[i] == mpirank) {
+        int                 j, start = 0;
+
+        for (j = 0; j < self; ++j) {
+          start += icounts[j];
+        }
+        memcpy (recvbuf + start * esize, sendbuf + ioffsets[i] * esize,
+                icounts[self] * esize);
+        break;
+      }
+    }
+  }
+  mpiret = sc_MPI_Waitall (nreq, req, sc_MPI_STATUSES_IGNORE);
+  SC_CHECK_MPI (mpiret);
+
+  /* write the output offsets and payload */
+  if (out_offsets == NULL) {
+    out_offsets = in_offsets;
+  }
+  sc_array_resize (out_offsets, (size_t) (num_senders + 1));
+  ioffsets = (int *) out_offsets->array;
+  ioffsets[0] = 0;
+  for (i = 0; i < num_senders; ++i) {
+    ioffsets[i + 1] = ioffsets[i] + icounts[i];
+  }
+  if (out_payload == NULL) {
+    sc_array_resize (in_payload, (size_t) total);
+    memcpy (in_payload->array, recvbuf, total * esize);
+    SC_FREE (recvbuf);
+  }
+  sc_notify_plan_senders (plan, receivers, senders);
+  SC_NOTIFY_FUNC_SHOT (notify, &snap);
+}
+
+/*== AUTOTUNING ==*/
+
+/** The n-ary tree widths tried by \ref sc_notify_autotune. */
+static const int    sc_notify_autotune_widths[] = { 2, 4, 8, 16, 32 };
+
+/** Return true if an algorithm can be timed without further input. */
+static int
+sc_notify_autotune_candidate (sc_notify_t * notify, sc_notify_type_t type)
+{
+  switch (type) {
+  case SC_NOTIFY_ALLGATHER:
+  case SC_NOTIFY_BINARY:
+  case SC_NOTIFY_NARY:
+  case SC_NOTIFY_PEX:
+  case SC_NOTIFY_RANGES:
+    return 1;
+#ifdef SC_ENABLE_MPI
+  case SC_NOTIFY_PCX:
+  case SC_NOTIFY_RSX:
+  case SC_NOTIFY_NBX:
+    return 1;
+#endif
+  case SC_NOTIFY_NODE:
+    {
+      sc_MPI_Comm         intranode, internode;
+
+      sc_mpi_comm_get_node_comms (notify->mpicomm, &intranode, &internode);
+      return intranode != sc_MPI_COMM_NULL && internode != sc_MPI_COMM_NULL;
+    }
+  default:
+    /* the superset variant requires a user callback */
+    return 0;
+  }
+}
+
+/** Time repeated notifications with the current configuration.
+ * \return  The maximum time over all processes. */
+static double
+sc_notify_autotune_time (sc_notify_t * notify, sc_array_t * receivers,
+                         sc_array_t * in_payload, int repetitions)
+{
+  int                 r;
+  int                 mpiret;
+  double              elapsed, maxelapsed;
+  sc_array_t         *senders, *out_payload;
+
+  senders = sc_array_new (sizeof (int));
+  out_payload = in_payload == NULL ? NULL :
+    sc_array_new (in_payload->elem_size);
+
+  /* warm up once, then time each repetition from a common start */
+  elapsed = 0.;
+  for (r = -1; r < repetitions; ++r) {
+    mpiret = sc_MPI_Barrier (notify->mpicomm);
+    SC_CHECK_MPI (mpiret);
+    if (r >= 0) {
+      elapsed -= sc_MPI_Wtime ();
+    }
+    sc_notify_payload (receivers, senders, in_payload, out_payload, 1,
+                       notify);
+    if (r >= 0) {
+      elapsed += sc_MPI_Wtime ();
+    }
+  }
+  mpiret = sc_MPI_Allreduce (&elapsed, &maxelapsed, 1, sc_MPI_DOUBLE,
+                             sc_MPI_MAX, notify->mpicomm);
+  SC_CHECK_MPI (mpiret);
+
+  sc_array_destroy (senders);
+  if (out_payload != NULL) {
+    sc_array_destroy (out_payload);
+  }
+  return maxelapsed;
+}
+
+/** Look up a stored configuration for the communicator size.
+ * \param [in] filename   Tuning file, read on rank 0 only.
+ * \param [in] mpisize    The size to look for.
+ * \param [out] config    Type, three widths, and the eager threshold.
+ * \return                True if a matching entry has been found.
+ */
+static int
+sc_notify_autotune_read (const char *filename, int mpisize, long config[5])
+{
+  int                 i;
+  int                 found = 0;
+  int                 size, ntop, nint, nbot;
+  unsigned long       thresh;
+  char                line[BUFSIZ], name[BUFSIZ];
+  FILE               *file;
+
+  if ((file = fopen (filename, "r")) == NULL) {
+    return 0;
+  }
+  while (fgets (line, BUFSIZ, file) != NULL) {
+    if (sscanf (line, "%d %s %d %d %d %lu", &size, name,
+                &ntop, &nint, &nbot, &thresh) != 6 || size != mpisize) {
+      continue;
+    }
+    for (i = 0; i < SC_NOTIFY_NUM_TYPES; ++i) {
+      if (!strcmp (name, sc_notify_type_strings[i])) {
+        /* later entries take precedence */
+        config[0] = i;
+        config[1] = ntop;
+        config[2] = nint;
+        config[3] = nbot;
+        config[4] = (long) thresh;
+        found = 1;
+        break;
+      }
+    }
+  }
+  fclose (file);
+
+  return found;
+}
+
+/** Append a tuned configuration to the tuning file on rank 0. */
+static void
+sc_notify_autotune_write (const char *filename, int mpisize,
+                          const long config[5])
+{
+  FILE               *file;
+
+  if ((file = fopen (filename, "a")) == NULL) {
+    SC_LERRORF ("Could not append to notify tuning file %s\n", filename);
+    return;
+  }
+  fprintf (file, "%d %s %ld %ld %ld %lu\n", mpisize,
+           sc_notify_type_strings[config[0]], config[1], config[2],
+           config[3], (unsigned long) config[4]);
+  if (fclose (file)) {
+    SC_LERRORF ("Could not close notify tuning file %s\n", filename);
+  }
+}
+
+/** Apply a configuration of type, widths and eager threshold. */
+static void
+sc_notify_autotune_apply (sc_notify_t * notify, const long config[5])
+{
+  sc_notify_set_type (notify, (sc_notify_type_t) config[0]);
+  if (config[0] == SC_NOTIFY_NARY) {
+    sc_notify_nary_set_widths (notify, (int) config[1], (int) config[2],
+                               (int) config[3]);
+  }
+  sc_notify_set_eager_threshold (notify, (size_t) config[4]);
+}
+
+sc_notify_type_t
+sc_notify_autotune (sc_notify_t * notify, sc_array_t * receivers,
+                    size_t payload_size, int repetitions,
+                    const char *filename)
+{
+  int                 i, w;
+  int                 mpiret;
+  int                 mpisize, mpirank;
+  int                 found;
+  int                 nwidths;
+  long                config[5], best[5];
+  size_t              eager;
+  double              elapsed, best_elapsed;
+  sc_array_t         *in_payload;
+
+  SC_ASSERT (receivers != NULL && receivers->elem_size == sizeof (int));
+  SC_ASSERT (repetitions >= 1);
+
+  mpiret = sc_MPI_Comm_size (notify->mpicomm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (notify->mpicomm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+
+  /* a previous run may have stored the configuration for this size */
+  if (filename != NULL) {
+    found = mpirank == 0 ?
+      sc_notify_autotune_read (filename, mpisize, config) : 0;
+    mpiret = sc_MPI_Bcast (&found, 1, sc_MPI_INT, 0, notify->mpicomm);
+    SC_CHECK_MPI (mpiret);
+    if (found) {
+      mpiret = sc_MPI_Bcast (config, 5, sc_MPI_LONG, 0, notify->mpicomm);
+      SC_CHECK_MPI (mpiret);
+      sc_notify_autotune_apply (notify, config);
+      notify->autotuned = 1;
+      SC_GLOBAL_INFOF ("Notify autotune read %s from %s\n",
+                       sc_notify_type_strings[config[0]], filename);
+      return (sc_notify_type_t) config[0];
+    }
+  }
+
+  in_payload = NULL;
+  if (payload_size > 0) {
+    in_payload = sc_array_new_count (payload_size, receivers->elem_count);
+    memset (in_payload->array, 0, in_payload->elem_count * payload_size);
+  }
+
+  /* time every candidate with payloads sent eagerly */
+  best[0] = sc_notify_type_default;
+  best[1] = best[2] = best[3] = sc_notify_nary_ntop_default;
+  best_elapsed = -1.;
+  nwidths = (int) (sizeof (sc_notify_autotune_widths) / sizeof (int));
+  eager = SC_MAX (payload_size, sc_notify_eager_threshold_default);
+  sc_notify_set_eager_threshold (notify, eager);
+  for (i = 0; i < SC_NOTIFY_NUM_TYPES && mpisize > 1; ++i) {
+    if (!sc_notify_autotune_candidate (notify, (sc_notify_type_t) i)) {
+      continue;
+    }
+    sc_notify_set_type (notify, (sc_notify_type_t) i);
+    for (w = 0; w < (i == SC_NOTIFY_NARY ? nwidths : 1); ++w) {
+      config[0] = i;
+      config[1] = config[2] = config[3] = sc_notify_autotune_widths[w];
+      if (i == SC_NOTIFY_NARY) {
+        if (w > 0 && sc_notify_autotune_widths[w] > mpisize) {
+          break;
+        }
+        sc_notify_nary_set_widths (notify, (int) config[1], (int) config[2],
+                                   (int) config[3]);
+      }
+      elapsed = sc_notify_autotune_time (notify, receivers, in_payload,
+                                         repetitions);
+      if (i == SC_NOTIFY_NARY) {
+        SC_GLOBAL_INFOF ("Notify autotune %s width %ld time %g\n",
+                         sc_notify_type_strings[i], config[1], elapsed);
+      }
+      else {
+        SC_GLOBAL_INFOF ("Notify autotune %s time %g\n",
+                         sc_notify_type_strings[i], elapsed);
+      }
+      if (best_elapsed < 0. || elapsed < best_elapsed) {
+        best_elapsed = elapsed;
+        memcpy (best, config, sizeof (best));
+      }
+    }
+  }
+  best[4] = (long) eager;
+
+  /* check whether a separate payload exchange is faster */
+  if (in_payload != NULL && best_elapsed >= 0.) {
+    best[4] = (long) payload_size - 1;
+    sc_notify_autotune_apply (notify, best);
+    elapsed = sc_notify_autotune_time (notify, receivers, in_payload,
+                                       repetitions);
+    SC_GLOBAL_INFOF ("Notify autotune separate payload time %g\n", elapsed);
+    if (elapsed >= best_elapsed) {
+      best[4] = (long) eager;
+    }
+  }
+  if (in_payload != NULL) {
+    sc_array_destroy (in_payload);
+  }
+  sc_notify_autotune_apply (notify, best);
+  notify->autotuned = 1;
+  SC_GLOBAL_INFOF ("Notify autotune chose %s\n",
+                   sc_notify_type_strings[best[0]]);
+
+  if (filename != NULL && mpirank == 0) {
+    sc_notify_autotune_write (filename, mpisize, best);
+  }
+  return (sc_notify_type_t) best[0];
+}
+
+int
+sc_notify_is_autotuned (sc_notify_t * notify)
+{
+  return notify->autotuned;
+}
@@ -175,9 +175,13 @@ typedef enum
   SC_NOTIFY_PCX,           /**< Choose reduce_scatter algorithm (AKA personalized census). */
   SC_NOTIFY_RSX,           /**< Choose remote summation algorithm. */
   SC_NOTIFY_NBX,           /**< Choose non-blocking consensus algorithm. */
-  SC_NOTIFY_RANGES,        /**< Use the sc_ranges functionality.  Likely suboptimal. */
+  SC_NOTIFY_RANGES,        /**< Use the sc_ranges functionality with the
+                                ranges distributed over group leaders. */
   SC_NOTIFY_SUPERSET,      /**< Use a computable superset of communicators, computed by
                                 a callback function. */
+  SC_NOTIFY_NODE,          /**< Route messages through one leader per node.
+                                Requires \ref sc_mpi_comm_attach_node_comms
+                                and falls back to \ref SC_NOTIFY_PEX otherwise. */
   SC_NOTIFY_NUM_TYPES      /**< End of list marker for notify algorithms. */
 }
 sc_notify_type_t;
@@ -191,6 +195,7 @@ sc_notify_type_t;
 #define SC_NOTIFY_STR_NBX "nbx"             /**< String for the NBX variant. */
 #define SC_NOTIFY_STR_RANGES "ranges"       /**< String for the ranges variant. */
 #define SC_NOTIFY_STR_SUPERSET "superset"   /**< String for the superset variant. */
+#define SC_NOTIFY_STR_NODE "node"           /**< String for the node-aware variant. */
 
 /** Names for each notify method */
 extern const char  *sc_notify_type_strings[SC_NOTIFY_NUM_TYPES];
@@ -203,6 +208,11 @@ extern sc_notify_type_t sc_notify_type_default;
  * with the notification packet.  Initialized to 1024 (2^10) */
 extern size_t       sc_notify_eager_threshold_default;
 
+/** The default threshold for payload sizes (in bytes) that are aggregated
+ * along an n-ary tree regardless of the notify type.  Initialized to 0,
+ * which disables aggregation. */
+extern size_t       sc_notify_aggregate_threshold_default;
+
 /** @{ \name Optional, most general interface. */
 
 /** Create a notify controller that can be used in \ref sc_notify_payload
@@ -239,6 +249,27 @@ size_t              sc_notify_get_eager_threshold (sc_notify_t * notify);
 void                sc_notify_set_eager_threshold (sc_notify_t * notify,
                                                    size_t thresh);
 
+/** Get the payload size up to which \ref sc_notify_payload aggregates.
+ *
+ * \param[in] notify      The notify controller.
+ * \return                The size in bytes of the maximum aggregated
+ *                        payload size.
+ */
+size_t              sc_notify_get_aggregate_threshold (sc_notify_t * notify);
+
+/** Set the payload size up to which \ref sc_notify_payload aggregates.
+ * Payloads of at most this size are routed through the n-ary tree of
+ * \ref SC_NOTIFY_NARY with default widths, whatever the type of \a notify.
+ * Each process then sends one packed buffer per tree level instead of one
+ * message per receiver, which pays off for many tiny payloads.
+ *
+ * \param[in,out] notify      The notify controller.
+ * \param[in]     thresh      The size in bytes of the maximum aggregated
+ *                            payload size.  0 disables aggregation.
+ */
+void                sc_notify_set_aggregate_threshold (sc_notify_t * notify,
+                                                       size_t thresh);
+
 /** Get the \ref sc_statistics_t object for logging runtimes (added by
  * function name).
  *
@@ -328,6 +359,22 @@ int                 sc_notify_ranges_get_num_ranges (sc_notify_t * notify);
 void                sc_notify_ranges_set_num_ranges (sc_notify_t * notify,
                                                      int num_ranges);
 
+/** Query the group size for the \ref SC_NOTIFY_RANGES method.
+ * \param [in] notify       Must be of type \ref SC_NOTIFY_RANGES.
+ * \return                  Number of consecutive processes whose senders
+ *                          are determined by one leader process.
+ */
+int                 sc_notify_ranges_get_group_size (sc_notify_t * notify);
+
+/** Set the group size for the \ref SC_NOTIFY_RANGES method.
+ * Larger groups mean fewer messages per range and more work per leader.
+ * See \ref sc_ranges_senders for details.
+ * \param [in,out] notify   Must be of type \ref SC_NOTIFY_RANGES.
+ * \param [in] group_size   Positive group size.
+ */
+void                sc_notify_ranges_set_group_size (sc_notify_t * notify,
+                                                     int group_size);
+
 /** \cond NOTIFY_DOCUMENT_RANGES */
 /** Query the package ID for the \ref SC_NOTIFY_RANGES method.
  * \param [in] notify       Must be of type \ref SC_NOTIFY_RANGES.
@@ -460,9 +507,139 @@ void                sc_notify_payloadv (sc_array_t * receivers,
 
 /** @} */
 
+/** @{ \name Automatic selection of the algorithm. */
+
+/** Time the available algorithms on the communicator and configure the
+ * notify controller with the fastest one.
+ * This function is collective and meant to run once in a warm-up phase.
+ * We time every type of \ref sc_notify_type_t that works without further
+ * input, several tree widths for \ref SC_NOTIFY_NARY, and, if there is a
+ * payload, whether it is faster to send it separately.  The result is stored
+ * in \a notify as its type, n-ary widths, and eager threshold.
+ * The superset variant is never chosen since it requires a callback,
+ * and the node variant only if node communicators are attached.
+ * On a single process there is nothing to tune and we choose
+ * \ref sc_notify_type_default.
+ * \param [in,out] notify      The notify controller to configure.
+ * \param [in] receivers       Representative sorted and uniqued array of
+ *                             type int.  Treated read-only.
+ * \param [in] payload_size    Representative payload size in bytes per
+ *                             receiver.  May be 0 for no payload.
+ * \param [in] repetitions     Number of timed calls per candidate, >= 1.
+ * \param [in] filename        If not NULL, a text file that stores one
+ *                             configuration per line, keyed by the
+ *                             communicator size.  If it contains an entry
+ *                             for the current size, we apply it without
+ *                             timing.  Otherwise we append the result.
+ *                             The file is only accessed on rank 0.
+ * \return                     The chosen type.
+ */
+sc_notify_type_t    sc_notify_autotune (sc_notify_t * notify,
+                                        sc_array_t * receivers,
+                                        size_t payload_size,
+                                        int repetitions,
+                                        const char *filename);
+
+/** Query whether \ref sc_notify_autotune has configured the controller.
+ * \param [in] notify      The notify controller.
+ * \return                 True if autotuned, false otherwise.
+ */
+int                 sc_notify_is_autotuned (sc_notify_t * notify);
+
+/** @} */
+
+/** @{ \name Persistent notification plans. */
+
+/** Opaque object that caches the result of a notification between calls.
+ * Iterative applications often notify the same receivers repeatedly.
+ * A plan remembers the receivers and senders of the last call and skips
+ * the notification algorithm entirely if no process has changed its
+ * receivers.  In that case only the payload is exchanged point-to-point.
+ */
+typedef struct sc_notify_plan_s sc_notify_plan_t;
+
+/** Create a persistent notification plan.
+ * \param [in] notify      Notify controller used when the receivers change.
+ *                         It must stay alive for the lifetime of the plan.
+ * \return                 Plan to be destroyed by \ref sc_notify_plan_destroy.
+ */
+sc_notify_plan_t   *sc_notify_plan_new (sc_notify_t * notify);
+
+/** Destroy a persistent notification plan.
+ * \param [in,out] plan    The plan is invalid after this call.
+ */
+void                sc_notify_plan_destroy (sc_notify_plan_t * plan);
+
+/** Forget the cached communication pattern.
+ * The next call of \ref sc_notify_plan_payload or
+ * \ref sc_notify_plan_payloadv executes the notify algorithm in any case.
+ * This function is not collective, but must be called on all processes
+ * before the next use of the plan.
+ * \param [in,out] plan    Valid plan.
+ */
+void                sc_notify_plan_invalidate (sc_notify_plan_t * plan);
+
+/** Return the number of times the plan executed the notify algorithm.
+ * \param [in] plan        Valid plan.
+ * \return                 Counts calls with changed receivers.
+ */
+long                sc_notify_plan_num_census (sc_notify_plan_t * plan);
+
+/** Return the number of times the plan reused the cached senders.
+ * \param [in] plan        Valid plan.
+ * \return                 Counts calls with unchanged receivers.
+ */
+long                sc_notify_plan_num_reused (sc_notify_plan_t * plan);
+
+/** Collective call with the semantics of \ref sc_notify_payload.
+ * Each process compares its receivers with those of the previous call.
+ * The processes agree by a one-integer allreduce whether any receivers
+ * changed.  If so, we call \ref sc_notify_payload with the plan's controller
+ * and cache the result.  Otherwise we return the cached senders and
+ * exchange the payload directly with nonblocking messages.
+ * \param [in,out] plan        Valid plan.
+ * \param [in,out] receivers   See \ref sc_notify_payload.
+ * \param [in,out] senders     See \ref sc_notify_payload.
+ * \param [in,out] in_payload  See \ref sc_notify_payload.
+ * \param [in,out] out_payload See \ref sc_notify_payload.
+ * \param [in] sorted          See \ref sc_notify_payload.
+ */
+void                sc_notify_plan_payload (sc_notify_plan_t * plan,
+                                            sc_array_t * receivers,
+                                            sc_array_t * senders,
+                                            sc_array_t * in_payload,
+                                            sc_array_t * out_payload,
+                                            int sorted);
+
+/** Collective call with the semantics of \ref sc_notify_payloadv.
+ * The receivers are compared as in \ref sc_notify_plan_payload.
+ * The message sizes may change from call to call without a new census.
+ * \param [in,out] plan        Valid plan.
+ * \param [in,out] receivers   See \ref sc_notify_payloadv.
+ * \param [in,out] senders     See \ref sc_notify_payloadv.
+ * \param [in,out] in_payload  See \ref sc_notify_payloadv.
+ * \param [in,out] out_payload See \ref sc_notify_payloadv.
+ * \param [in,out] in_offsets  See \ref sc_notify_payloadv.
+ * \param [in,out] out_offsets See \ref sc_notify_payloadv.
+ * \param [in] sorted          See \ref sc_notify_payloadv.
+ */
+void                sc_notify_plan_payloadv (sc_notify_plan_t * plan,
+                                             sc_array_t * receivers,
+                                             sc_array_t * senders,
+                                             sc_array_t * in_payload,
+                                             sc_array_t * out_payload,
+                                             sc_array_t * in_offsets,
+                                             sc_array_t * out_offsets,
+                                             int sorted);
+
+/** @} */
+
 /** For the \ref SC_NOTIFY_RANGES method, the default is 25. */
 extern int          sc_notify_ranges_num_ranges_default;
 
+/** For the \ref SC_NOTIFY_RANGES method, the default group size is 32. */
+extern int          sc_notify_ranges_group_size_default;
+
 SC_EXTERN_C_END;
 
 #endif /* !SC_NOTIFY_H */
@@ -22,6 +22,7 @@
 */
 
 #include <sc_ranges.h>
+#include <sc_notify.h>
 #include <sc_statistics.h>
 
 static int
@@ -306,6 +307,142 @@ sc_ranges_decode (int num_procs, int rank,
   *num_senders = ns;
 }
 
+void
+sc_ranges_senders (int package_id, sc_MPI_Comm mpicomm, int group_size,
+                   int num_ranges, const int *ranges,
+                   int *num_senders, int *sender_ranks)
+{
+  int                 mpiret;
+  int                 i, j, k, r;
+  int                 num_procs, rank;
+  int                 leader, gfirst, glast, gsize;
+  int                 lo, hi, from;
+  int                *counts, *offsets, *lists;
+  int                *piece;
+  sc_array_t         *leaders, *froms;
+  sc_array_t         *pieces, *in_offsets;
+  sc_array_t         *recv_pieces, *out_offsets;
+  sc_MPI_Request     *requests;
+  sc_notify_t        *notify;
+
+  SC_ASSERT (group_size >= 1);
+  SC_ASSERT (num_ranges >= 0);
+
+  mpiret = sc_MPI_Comm_size (mpicomm, &num_procs);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (mpicomm, &rank);
+  SC_CHECK_MPI (mpiret);
+
+  /* cut the local ranges at the group boundaries */
+  leaders = sc_array_new (sizeof (int));
+  pieces = sc_array_new (2 * sizeof (int));
+  in_offsets = sc_array_new (sizeof (int));
+  for (i = 0; i < num_ranges; ++i) {
+    SC_ASSERT (0 <= ranges[2 * i] && ranges[2 * i] <= ranges[2 * i + 1]);
+    for (lo = ranges[2 * i]; lo <= ranges[2 * i + 1]; lo = hi + 1) {
+      leader = lo - lo % group_size;
+      hi = SC_MIN (ranges[2 * i + 1], leader + group_size - 1);
+      if (leaders->elem_count == 0 ||
+          *(int *) sc_array_index (leaders, leaders->elem_count - 1) !=
+          leader) {
+        *(int *) sc_array_push (leaders) = leader;
+        *(int *) sc_array_push (in_offsets) = (int) pieces->elem_count;
+      }
+      piece = (int *) sc_array_push (pieces);
+      piece[0] = lo;
+      piece[1] = hi;
+    }
+  }
+  *(int *) sc_array_push (in_offsets) = (int) pieces->elem_count;
+
+  /* the leaders learn about the pieces overlapping their group */
+  froms = sc_array_new (sizeof (int));
+  recv_pieces = sc_array_new (2 * sizeof (int));
+  out_offsets = sc_array_new (sizeof (int));
+  notify = sc_notify_new (mpicomm);
+  sc_notify_set_type (notify, SC_NOTIFY_NARY);
+  sc_notify_payloadv (leaders, froms, pieces, recv_pieces,
+                      in_offsets, out_offsets, 1, notify);
+  sc_notify_destroy (notify);
+  sc_array_destroy (leaders);
+  sc_array_destroy (pieces);
+  sc_array_destroy (in_offsets);
+
+  leader = rank - rank % group_size;
+  if (rank == leader) {
+    gfirst = leader;
+    glast = SC_MIN (num_procs, leader + group_size) - 1;
+    gsize = glast - gfirst + 1;
+
+    /* count, then list the senders of every group member in order */
+    lists = NULL;
+    counts = SC_ALLOC_ZERO (int, gsize);
+    offsets = SC_ALLOC (int, gsize + 1);
+    for (k = 0; k < 2; ++k) {
+      if (k == 1) {
+        offsets[0] = 0;
+        for (r = 0; r < gsize; ++r) {
+          offsets[r + 1] = offsets[r] + counts[r];
+          counts[r] = 0;
+        }
+        lists = SC_ALLOC (int, offsets[gsize]);
+      }
+      for (j = 0; j < (int) froms->elem_count; ++j) {
+        from = *(int *) sc_array_index_int (froms, j);
+        for (i = *(int *) sc_array_index_int (out_offsets, j);
+             i < *(int *) sc_array_index_int (out_offsets, j + 1); ++i) {
+          piece = (int *) sc_array_index_int (recv_pieces, i);
+          SC_ASSERT (gfirst <= piece[0] && piece[1] <= glast);
+          for (r = piece[0]; r <= piece[1]; ++r) {
+            if (r != from) {
+              if (k == 1) {
+                lists[offsets[r - gfirst] + counts[r - gfirst]] = from;
+              }
+              ++counts[r - gfirst];
+            }
+          }
+        }
+      }
+    }
+
+    /* send every other member its list and keep our own */
+    requests = SC_ALLOC (sc_MPI_Request, gsize);
+    for (r = 1; r < gsize; ++r) {
+      mpiret = sc_MPI_Isend (lists + offsets[r], counts[r],
+                             sc_MPI_INT, gfirst + r, SC_TAG_RANGES,
+                             mpicomm, requests + r - 1);
+      SC_CHECK_MPI (mpiret);
+    }
+    mpiret = sc_MPI_Waitall (gsize - 1, requests, sc_MPI_STATUSES_IGNORE);
+    SC_CHECK_MPI (mpiret);
+    *num_senders = counts[0];
+    memcpy (sender_ranks, lists, counts[0] * sizeof (int));
+    SC_FREE (requests);
+    SC_FREE (lists);
+    SC_FREE (counts);
+    SC_FREE (offsets);
+  }
+  else {
+    sc_MPI_Status       status;
+
+    SC_ASSERT (froms->elem_count == 0);
+    mpiret = sc_MPI_Probe (leader, SC_TAG_RANGES, mpicomm, &status);
+    SC_CHECK_MPI (mpiret);
+    mpiret = sc_MPI_Get_count (&status, sc_MPI_INT, num_senders);
+    SC_CHECK_MPI (mpiret);
+    mpiret = sc_MPI_Recv (sender_ranks, *num_senders, sc_MPI_INT, leader,
+                          SC_TAG_RANGES, mpicomm, sc_MPI_STATUS_IGNORE);
+    SC_CHECK_MPI (mpiret);
+  }
+  SC_GEN_LOGF (package_id, SC_LC_NORMAL, SC_LP_DEBUG,
+               "ranges senders %d group size %d\n", *num_senders,
+               group_size);
+
+  sc_array_destroy (froms);
+  sc_array_destroy (recv_pieces);
+  sc_array_destroy (out_offsets);
+}
+
 void
 sc_ranges_statistics (int package_id, int log_priority,
                       sc_MPI_Comm mpicomm, int num_procs, const int *procs,
@@ -100,6 +100,32 @@ void                sc_ranges_decode (int num_procs, int rank,
                                       int *num_receivers, int *receiver_ranks,
                                       int *num_senders, int *sender_ranks);
 
+/** Determine the senders to this process from everybody's ranges.
+ * In contrast to \ref sc_ranges_adaptive and \ref sc_ranges_decode, no
+ * process stores the ranges of all others.  The processes are split into
+ * groups of consecutive ranks.  Each range is cut at the group boundaries
+ * and the pieces are sent to the first process of the respective group
+ * by the tree-based \ref SC_NOTIFY_NARY algorithm.  The group leaders
+ * then send each member the list of its senders.  The memory and message
+ * counts of a process thus depend on the ranges touching its group only.
+ *
+ * \param [in] package_id   Registered package id or -1.
+ * \param [in] mpicomm      MPI communicator of the ranges.
+ * \param [in] group_size   Number of consecutive processes per group.
+ * \param [in] num_ranges   Number of filled ranges as returned by
+ *                          \ref sc_ranges_compute.
+ * \param [in] ranges       The local ranges from \ref sc_ranges_compute.
+ * \param [out] num_senders         Number of senders to this processor.
+ * \param [in,out] sender_ranks     Array of at least mpisize for output.
+ *                                  Filled with the ranks whose ranges
+ *                                  contain this process, in ascending
+ *                                  order and excluding this process.
+ */
+void                sc_ranges_senders (int package_id, sc_MPI_Comm mpicomm,
+                                       int group_size, int num_ranges,
+                                       const int *ranges, int *num_senders,
+                                       int *sender_ranks);
+
 /** Compute global statistical information on the ranges.
  *
  * \param [in] package_id       Registered package id or -1.
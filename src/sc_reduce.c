@@ -474,9 +474,9 @@ sc_reduce_sum (void *sendbuf, void *recvbuf,
 }
 
 static int
-sc_reduce_custom_dispatch (void *sendbuf, void *recvbuf, int sendcount,
-                           sc_MPI_Datatype sendtype, sc_reduce_t reduce_fn,
-                           int target, sc_MPI_Comm mpicomm)
+sc_reduce_custom_tree (void *sendbuf, void *recvbuf, int sendcount,
+                       sc_MPI_Datatype sendtype, sc_reduce_t reduce_fn,
+                       int target, sc_MPI_Comm mpicomm)
 {
   int                 mpiret;
   int                 mpisize;
@@ -505,6 +505,71 @@ sc_reduce_custom_dispatch (void *sendbuf, void *recvbuf, int sendcount,
   return sc_MPI_SUCCESS;
 }
 
+/** Two-level allreduce: tree within each node, tree among node leaders,
+ * and broadcast of the result within each node.
+ * Returns nonzero if it has been executed, zero if no node comms exist. */
+static int
+sc_allreduce_custom_twolevel (void *sendbuf, void *recvbuf, int sendcount,
+                              sc_MPI_Datatype sendtype,
+                              sc_reduce_t reduce_fn, sc_MPI_Comm mpicomm)
+{
+  int                 mpiret;
+  int                 intrarank;
+  size_t              datasize;
+  char               *nodedata;
+  sc_MPI_Comm         intranode, internode;
+
+  sc_mpi_comm_get_node_comms (mpicomm, &intranode, &internode);
+  if (intranode == sc_MPI_COMM_NULL || internode == sc_MPI_COMM_NULL) {
+    return 0;
+  }
+  mpiret = sc_MPI_Comm_rank (intranode, &intrarank);
+  SC_CHECK_MPI (mpiret);
+
+  /* reduce to the node leader over shared memory */
+  /* *INDENT-OFF* HORRIBLE indent bug */
+  datasize = (size_t) sendcount * sc_mpi_sizeof (sendtype);
+  /* *INDENT-ON* */
+  nodedata = SC_ALLOC (char, datasize);
+  sc_reduce_custom_tree (sendbuf, nodedata, sendcount, sendtype,
+                         reduce_fn, 0, intranode);
+
+  /* only the node leaders talk to the network */
+  if (intrarank == 0) {
+    sc_reduce_custom_tree (nodedata, recvbuf, sendcount, sendtype,
+                           reduce_fn, -1, internode);
+  }
+  SC_FREE (nodedata);
+
+  /* distribute the result within the node */
+  mpiret = sc_MPI_Bcast (recvbuf, sendcount, sendtype, 0, intranode);
+  SC_CHECK_MPI (mpiret);
+
+  return 1;
+}
+
+static int
+sc_reduce_custom_dispatch (void *sendbuf, void *recvbuf, int sendcount,
+                           sc_MPI_Datatype sendtype, sc_reduce_t reduce_fn,
+                           int target, sc_MPI_Comm mpicomm)
+{
+  int                 mpiret;
+  int                 mpisize;
+
+  if (target == -1) {
+    mpiret = sc_MPI_Comm_size (mpicomm, &mpisize);
+    SC_CHECK_MPI (mpiret);
+    if (mpisize >= SC_REDUCE_NODE_MIN &&
+        sc_allreduce_custom_twolevel (sendbuf, recvbuf, sendcount, sendtype,
+                                      reduce_fn, mpicomm)) {
+      return sc_MPI_SUCCESS;
+    }
+  }
+
+  return sc_reduce_custom_tree (sendbuf, recvbuf, sendcount, sendtype,
+                                reduce_fn, target, mpicomm);
+}
+
 int
 sc_allreduce_custom (void *sendbuf, void *recvbuf, int sendcount,
                      sc_MPI_Datatype sendtype, sc_reduce_t reduce_fn,
@@ -514,6 +579,19 @@ sc_allreduce_custom (void *sendbuf, void *recvbuf, int sendcount,
                                     sendtype, reduce_fn, -1, mpicomm);
 }
 
+int
+sc_allreduce_custom_node (void *sendbuf, void *recvbuf, int sendcount,
+                          sc_MPI_Datatype sendtype, sc_reduce_t reduce_fn,
+                          sc_MPI_Comm mpicomm)
+{
+  if (!sc_allreduce_custom_twolevel (sendbuf, recvbuf, sendcount, sendtype,
+                                     reduce_fn, mpicomm)) {
+    sc_reduce_custom_tree (sendbuf, recvbuf, sendcount, sendtype,
+                           reduce_fn, -1, mpicomm);
+  }
+  return sc_MPI_SUCCESS;
+}
+
 int
 sc_reduce_custom (void *sendbuf, void *recvbuf, int sendcount,
                   sc_MPI_Datatype sendtype, sc_reduce_t reduce_fn,
@@ -526,24 +604,29 @@ sc_reduce_custom (void *sendbuf, void *recvbuf, int sendcount,
                                     sendtype, reduce_fn, target, mpicomm);
 }
 
-static int
-sc_reduce_dispatch (void *sendbuf, void *recvbuf, int sendcount,
-                    sc_MPI_Datatype sendtype, sc_MPI_Op operation,
-                    int target, sc_MPI_Comm mpicomm)
+static sc_reduce_t
+sc_reduce_operation (sc_MPI_Op operation)
 {
-  sc_reduce_t         reduce_fn;
-
   if (operation == sc_MPI_MAX)
-    reduce_fn = sc_reduce_max;
+    return sc_reduce_max;
   else if (operation == sc_MPI_MIN)
-    reduce_fn = sc_reduce_min;
+    return sc_reduce_min;
   else if (operation == sc_MPI_SUM)
-    reduce_fn = sc_reduce_sum;
+    return sc_reduce_sum;
   else
     SC_ABORT ("Unsupported operation in sc_allreduce or sc_reduce");
 
-  return sc_reduce_custom_dispatch (sendbuf, recvbuf, sendcount,
-                                    sendtype, reduce_fn, target, mpicomm);
+  return NULL;
+}
+
+static int
+sc_reduce_dispatch (void *sendbuf, void *recvbuf, int sendcount,
+                    sc_MPI_Datatype sendtype, sc_MPI_Op operation,
+                    int target, sc_MPI_Comm mpicomm)
+{
+  return sc_reduce_custom_dispatch (sendbuf, recvbuf, sendcount, sendtype,
+                                    sc_reduce_operation (operation),
+                                    target, mpicomm);
 }
 
 int
@@ -565,3 +648,12 @@ sc_reduce (void *sendbuf, void *recvbuf, int sendcount,
   return sc_reduce_dispatch (sendbuf, recvbuf, sendcount,
                              sendtype, operation, target, mpicomm);
 }
+
+int
+sc_allreduce_node (void *sendbuf, void *recvbuf, int sendcount,
+                   sc_MPI_Datatype sendtype, sc_MPI_Op operation,
+                   sc_MPI_Comm mpicomm)
+{
+  return sc_allreduce_custom_node (sendbuf, recvbuf, sendcount, sendtype,
+                                   sc_reduce_operation (operation), mpicomm);
+}
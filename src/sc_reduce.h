@@ -30,6 +30,13 @@
  * not suffer from random or otherwise obscure influences.
  *
  * Both algorithms use a binary communication tree.
+ * If node communicators are attached to the communicator by
+ * \ref sc_mpi_comm_attach_node_comms and it has at least
+ * \ref SC_REDUCE_NODE_MIN processes, the allreduce functions switch to a
+ * two-level scheme: we reduce within each node, then only the first process
+ * of each node participates in the reduction across nodes, and the result is
+ * broadcast within each node.  The associativity is then determined by the
+ * node layout, which is still independent of the reduced data.
  * We provide implementations via a customizable reduction operator
  * as well as drop-in replacements for minimum, maximum, and sum.
  * We do not currently support user-defined MPI datatypes.
@@ -47,6 +54,12 @@
 #define SC_REDUCE_ALLTOALL_LEVEL        3
 #endif
 
+#ifndef SC_REDUCE_NODE_MIN
+/** The smallest communicator size to use the node-aware allreduce
+ * automatically if node communicators are attached. */
+#define SC_REDUCE_NODE_MIN              64
+#endif
+
 SC_EXTERN_C_BEGIN;
 
 /** Prototype for a user-defined reduce operation. */
@@ -68,6 +81,25 @@ int                 sc_allreduce_custom (void *sendbuf, void *recvbuf,
                                          sc_reduce_t reduce_fn,
                                          sc_MPI_Comm mpicomm);
 
+/** Custom allreduce operation that is aware of the node layout.
+ * We reduce within each node, reduce across the first process of each node,
+ * and broadcast the result within each node.  This function requires that
+ * \ref sc_mpi_comm_attach_node_comms has been called on \a mpicomm;
+ * otherwise it behaves like a plain binary tree allreduce.
+ * \param [in] sendbuf      Send buffer conforming to MPI specification.
+ * \param [out] recvbuf     Receive buffer conforming to MPI specification.
+ * \param [in] sendcount    Number of data items to reduce.
+ * \param [in] sendtype     Valid MPI datatype.
+ * \param [in] reduce_fn    Custom, associative reduction operator.
+ * \param [in] mpicomm      Valid MPI communicator.
+ * \return                  sc_MPI_SUCCESS if not aborting on MPI error.
+ */
+int                 sc_allreduce_custom_node (void *sendbuf, void *recvbuf,
+                                              int sendcount,
+                                              sc_MPI_Datatype sendtype,
+                                              sc_reduce_t reduce_fn,
+                                              sc_MPI_Comm mpicomm);
+
 /** Custom reduce operation with reproducible associativity.
  * \param [in] sendbuf      Send buffer conforming to MPI specification.
  * \param [out] recvbuf     Receive buffer conforming to MPI specification.
@@ -114,6 +146,24 @@ int                 sc_reduce (void *sendbuf, void *recvbuf, int sendcount,
                                sc_MPI_Datatype sendtype, sc_MPI_Op operation,
                                int target, sc_MPI_Comm mpicomm);
 
+/** Drop-in MPI_Allreduce replacement that is aware of the node layout.
+ * See \ref sc_allreduce_custom_node for the algorithm.
+ * Currently we support the operations minimum, maximum, and sum.
+ * \param [in] sendbuf      Send buffer conforming to MPI specification.
+ * \param [out] recvbuf     Receive buffer conforming to MPI specification.
+ * \param [in] sendcount    Number of data items to reduce.
+ * \param [in] sendtype     Valid MPI datatype.
+ * \param [in] operation    \ref sc_MPI_MIN, \ref sc_MPI_MAX, or \ref
+ *                          sc_MPI_SUM.  We abort otherwise.
+ * \param [in] mpicomm      Valid MPI communicator.
+ * \return                  sc_MPI_SUCCESS if not aborting on MPI error.
+ */
+int                 sc_allreduce_node (void *sendbuf, void *recvbuf,
+                                       int sendcount,
+                                       sc_MPI_Datatype sendtype,
+                                       sc_MPI_Op operation,
+                                       sc_MPI_Comm mpicomm);
+
 SC_EXTERN_C_END;
 
 #endif /* !SC_REDUCE_H */
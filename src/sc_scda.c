@@ -23,6 +23,7 @@
 
 #include <sc_scda.h>
 #include <sc_io.h>
+#include <sc_checksum.h>
 
 /* file section header data */
 #define SC_SCDA_MAGIC "scdata0" /**< magic encoding format identifier and version */
@@ -50,6 +51,23 @@
 #define SC_SCDA_PADDING_MOD_MAX (6 + SC_SCDA_PADDING_MOD) /**< maximal count of
                                                               mod padding bytes */
 #define SC_SCDA_HEADER_ROOT 0 /**< root rank for header I/O operations */
+#define SC_SCDA_ENCODE_STRING "scda encoded section" /**< user string of the
+                                                          inline section that
+                                                          starts an encoded
+                                                          file section */
+#define SC_SCDA_ENCODE_SIZE_BYTES 8 /**< byte count of a big-endian encoded
+                                         element size */
+#define SC_SCDA_INDEX_STRING "scda section index" /**< user string of the
+                                                       sections that store
+                                                       the section index */
+#define SC_SCDA_INDEX_ENTRY 128 /**< byte count of one section index record */
+#define SC_SCDA_INDEX_DIGITS 20 /**< decimal digits of the numbers of one
+                                     section index record */
+#define SC_SCDA_INDEX_POINTER "scda index " /**< prefix of the inline data
+                                                 that points to the index */
+#define SC_SCDA_ALIGN_STRING "scda alignment" /**< user string of the block
+                                                   sections that align the
+                                                   following array data */
 
 /** get a random double in the range [A,B) */
 #define SC_SCDA_RAND_RANGE(A, B, state) ((A) + sc_rand (state) * ((B) - (A)))
@@ -103,7 +121,7 @@
                                                                 *errcode,    \
                                                                 user_msg);   \
                                     if (!sc_scda_ferror_is_success (*errcode)) {\
-                                    sc_scda_file_error_cleanup (&fc->file);  \
+                                    sc_scda_file_error_cleanup (fc);         \
                                     SC_FREE (fc);                            \
                                     return NULL;}} while (0)
 
@@ -135,7 +153,7 @@
                                                   fc->mpicomm));               \
                                     sc_scda_fuzzy_sync_state (fc);             \
                                     if (!sc_scda_ferror_is_success (*errcode)) {\
-                                    sc_scda_file_error_cleanup (&fc->file);    \
+                                    sc_scda_file_error_cleanup (fc);           \
                                     SC_FREE (fc);                              \
                                     return NULL;}} while (0)
 
@@ -173,7 +191,7 @@
                                     SC_GLOBAL_LERRORF ("Count error for "    \
                                                 "collective I/O at %s:%d.\n",\
                                                 __FILE__, __LINE__);         \
-                                    sc_scda_file_error_cleanup (&fc->file);  \
+                                    sc_scda_file_error_cleanup (fc);         \
                                     SC_FREE (fc);                            \
                                     return NULL;                             \
                                     }} while (0)                             \
@@ -222,7 +240,7 @@
                                                                    *errorcode, \
                                                     "Read/write count check"); \
                                     if (*cerror) {                             \
-                                    sc_scda_file_error_cleanup (&fc->file);    \
+                                    sc_scda_file_error_cleanup (fc);           \
                                     SC_FREE (fc);                              \
                                     return NULL;}} while (0)
 
@@ -264,6 +282,50 @@ struct sc_scda_fcontext
   int                 log_level;      /**< The log level for the scda functions.
                                         The possible values are documented in
                                         \ref sc.h; cf. SC_LP_* macros. */
+  size_t              write_behind;   /**< Byte size of the staging buffer
+                                        for writing array data behind.
+                                        0 means that we write synchronously. */
+  char               *staging;        /**< The staging buffer or NULL if it
+                                        was not yet needed. */
+  sc_io_request_t    *pending;        /**< The request of the array data write
+                                        that is in progress or NULL. */
+  int                 pending_count;  /**< The number of staged bytes of the
+                                        pending request. */
+  size_t              batch_bytes;    /**< Maximal local byte count of one
+                                        collective call for array data.
+                                        0 means no limit. */
+  char                decode_type;    /**< The original type of the encoded
+                                        section that is read next or 0 if
+                                        the section is read raw. */
+  size_t              decode_size;    /**< The original block or element size
+                                        of the encoded section. */
+  size_t              encoded_size;   /**< The byte count of the compressed
+                                        block of an encoded block section. */
+  size_t              section_count;  /**< The element count of the last
+                                        raw section header read. */
+  size_t              section_size;   /**< The block or element size of the
+                                        last raw section header read. */
+  int                 write_index;    /**< True if the sections written are
+                                        recorded and the section index is
+                                        appended by \ref sc_scda_fclose. */
+  int                 index_nested;   /**< True while a writing function
+                                        calls other writing functions whose
+                                        sections are not recorded. */
+  sc_array_t         *index;          /**< For writing with write_index, the
+                                        records of the written sections. For
+                                        reading, the offsets of the known
+                                        sections or NULL before the first
+                                        call of \ref sc_scda_fseek_section. */
+  int                 index_complete; /**< For reading, true if the offsets
+                                        of all sections are known. */
+  sc_MPI_Offset       index_end;      /**< For reading, the offset after the
+                                        last known section. */
+  sc_MPI_Offset       file_size;      /**< For reading, the file size once
+                                        the section index is examined. */
+  sc_io_stripe_t      stripe;         /**< The striping hints for opening
+                                        the file. */
+  size_t              align;          /**< For writing, the byte alignment
+                                        of array data in the file or 0. */
   /* *INDENT-ON* */
 };
 
@@ -496,6 +558,25 @@ sc_scda_pad_to_mod_len (size_t input_len)
   return num_pad_bytes;
 }
 
+/** Get the byte count of the data of a raw file section including padding.
+ *
+ * \param [in]  type        The section type.
+ * \param [in]  elem_count  The element count of an array section.
+ * \param [in]  elem_size   The block size or the element size.
+ * \return                  The byte count of the section after its header.
+ */
+static sc_MPI_Offset
+sc_scda_section_data_bytes (char type, size_t elem_count, size_t elem_size)
+{
+  size_t              byte_count;
+
+  if (type == 'I') {
+    return SC_SCDA_INLINE_FIELD;
+  }
+  byte_count = (type == 'B') ? elem_size : elem_count * elem_size;
+  return (sc_MPI_Offset) (byte_count + sc_scda_pad_to_mod_len (byte_count));
+}
+
 /** Pad data to a length that is congurent to 0 modulo \ref SC_SCDA_PADDING_MOD.
  *
  * \param [in]  last_byte   Pointer to the last data byte.
@@ -671,6 +752,10 @@ sc_scda_get_pad_to_mod (const char *padded_data, size_t padded_len,
 }
 
 /** Check if the given parameters are collective.
+ *
+ * The parameters are compared by a CRC-32C checksum.  Thus the cost does
+ * not depend on their size, and a mismatch goes undetected only with a
+ * probability of 2^-32.
  *
  * This function assumes that the parameters \b len1, \b len2 and \b len3 are
  * collective.
@@ -697,9 +782,9 @@ sc_scda_check_coll_params (sc_scda_fcontext_t *fc, const char *param1,
                            const char *param3, size_t len3)
 {
   int                 mpiret;
-  int                 mismatch, collective_mismatch;
-  char               *buffer, *recv_buf = NULL;
+  char               *buffer;
   size_t              len;
+  long long           local[2], extremes[2];
 
   SC_ASSERT (fc != NULL);
   SC_ASSERT (param1 != NULL);
@@ -714,48 +799,30 @@ sc_scda_check_coll_params (sc_scda_fcontext_t *fc, const char *param1,
   /* get buffer with parameter data */
   sc_scda_merge_data_to_buf (param1, len1, param2, len2, param3, len3, buffer);
 
-  /* For the sake of simplicity, we use a Bcast followed by an Allreduce
-  * instead of one Allreduce call with a custom reduction function.
-  */
-  /* In the future we may want to use a checksum on the buffer data if the data
-  * is large.
-  */
-  if (fc->mpirank == 0) {
-    mpiret = sc_MPI_Bcast (buffer, (int) len, sc_MPI_BYTE, 0, fc->mpicomm);
-  }
-  else {
-    recv_buf = (char *) SC_ALLOC (char, len);
-    mpiret = sc_MPI_Bcast (recv_buf, (int) len, sc_MPI_BYTE, 0, fc->mpicomm);
-  }
-  SC_CHECK_MPI (mpiret);
-
-  if (fc->mpirank > 0) {
-    /* compare data */
-    mismatch = memcmp (recv_buf, buffer, len);
-
-    /* free data buffer */
-    SC_FREE (buffer);
-    SC_FREE (recv_buf);
-  }
-  else {
-    mismatch = 0;
-    SC_FREE (buffer);
-  }
+  /* We compare a checksum of the data instead of broadcasting the data.
+   * The maximum of the checksum and of its negative, i.e. the maximum and
+   * the minimum of the checksum, are found in one Allreduce and differ iff
+   * the checksum is not collective.
+   */
+  local[0] = (long long) sc_crc32c (0, buffer, len);
+  local[1] = -local[0];
+  SC_FREE (buffer);
 
-  /* synchronize comparison results */
-  mpiret = sc_MPI_Allreduce (&mismatch, &collective_mismatch, 1, sc_MPI_INT,
-                             sc_MPI_LOR, fc->mpicomm);
+  mpiret = sc_MPI_Allreduce (local, extremes, 2, sc_MPI_LONG_LONG_INT,
+                             sc_MPI_MAX, fc->mpicomm);
   SC_CHECK_MPI (mpiret);
 
-  return collective_mismatch ? SC_SCDA_FERR_ARG : SC_SCDA_FERR_SUCCESS;
+  return extremes[0] != -extremes[1] ? SC_SCDA_FERR_ARG :
+    SC_SCDA_FERR_SUCCESS;
 }
 
 /**
  * This function is for creating and reading a file.
  * The passed \b fc must have filled MPI information (cf. \ref
  * sc_scda_fill_mpi_data).
- * The function returns \ref SC_SCDA_FERR_ARG if everyn and/or seed in params
- * are not collective. Otherwise, the function returns \ref SC_SCDA_FERR_SUCCESS.
+ * The function returns \ref SC_SCDA_FERR_ARG if the parameters in params
+ * are not collective or the alignment or the stripe count is invalid.
+ * Otherwise, the function returns \ref SC_SCDA_FERR_SUCCESS.
  */
 static sc_scda_ret_t
 sc_scda_examine_params (sc_scda_params_t * params, sc_scda_fcontext_t *fc,
@@ -773,6 +840,35 @@ sc_scda_examine_params (sc_scda_params_t * params, sc_scda_fcontext_t *fc,
                                      sizeof (sc_rand_state_t),
                                      (const char *) &params->log_level, sizeof (int));
     SC_ASSERT (ret == SC_SCDA_FERR_SUCCESS || ret == SC_SCDA_FERR_ARG);
+    if (ret == SC_SCDA_FERR_SUCCESS) {
+      /* the staged and batched transfers are collective and need
+       * collective sizes */
+      ret = sc_scda_check_coll_params (fc,
+                                       (const char *) &params->write_behind,
+                                       sizeof (size_t),
+                                       (const char *) &params->batch_bytes,
+                                       sizeof (size_t),
+                                       (const char *) &params->write_index,
+                                       sizeof (int));
+      SC_ASSERT (ret == SC_SCDA_FERR_SUCCESS || ret == SC_SCDA_FERR_ARG);
+    }
+    if (ret == SC_SCDA_FERR_SUCCESS) {
+      /* the layout of the file must agree on all processes */
+      ret = sc_scda_check_coll_params (fc,
+                                       (const char *) &params->stripe_size,
+                                       sizeof (size_t),
+                                       (const char *) &params->align,
+                                       sizeof (size_t),
+                                       (const char *) &params->stripe_count,
+                                       sizeof (int));
+      SC_ASSERT (ret == SC_SCDA_FERR_SUCCESS || ret == SC_SCDA_FERR_ARG);
+    }
+    if (ret == SC_SCDA_FERR_SUCCESS &&
+        (params->align % SC_SCDA_PADDING_MOD != 0 ||
+         params->stripe_count < 0)) {
+      /* the parameters are collective and so is this error */
+      ret = SC_SCDA_FERR_ARG;
+    }
 
     if (ret == SC_SCDA_FERR_ARG) {
       /* non-collective fuzzy parameters */
@@ -793,6 +889,13 @@ sc_scda_examine_params (sc_scda_params_t * params, sc_scda_fcontext_t *fc,
     fc->fuzzy_seed = params->fuzzy_seed;
 
     fc->log_level = params->log_level;
+    fc->write_behind = params->write_behind;
+    fc->batch_bytes = params->batch_bytes;
+    fc->write_index = params->write_index;
+    fc->stripe.striping_unit = params->stripe_size;
+    fc->stripe.striping_factor = params->stripe_count;
+    fc->stripe.cb_nodes = 0;
+    fc->align = params->align;
   }
   else {
     *info = sc_MPI_INFO_NULL;
@@ -805,6 +908,18 @@ sc_scda_examine_params (sc_scda_params_t * params, sc_scda_fcontext_t *fc,
 #else
     fc->log_level = SC_LP_SILENT;
 #endif
+    /* write synchronously by default */
+    fc->write_behind = 0;
+    /* transfer array data in one collective call by default */
+    fc->batch_bytes = 0;
+    /* no section index by default */
+    fc->write_index = 0;
+    /* the file system decides on the striping by default */
+    fc->stripe.striping_unit = 0;
+    fc->stripe.striping_factor = 0;
+    fc->stripe.cb_nodes = 0;
+    /* array data is only padded to SC_SCDA_PADDING_MOD by default */
+    fc->align = 0;
   }
 
   return SC_SCDA_FERR_SUCCESS;
@@ -1171,15 +1286,28 @@ sc_scda_ferror_is_success (sc_scda_ferror_t errorcode)
 }
 
 /** Close an MPI file or its libsc-internal replacement in case of an error.
- * \param [in,out]  file    A sc_MPI_file
+ * A pending write is completed first and the staging buffer is freed.
+ * The file context itself is not freed.
+ * \param [in,out]  fc      A file context with an open file.
  * \return                  Always -1 since this function is only called
  *                          if an error already occurred.
  */
 static int
-sc_scda_file_error_cleanup (sc_MPI_File * file)
+sc_scda_file_error_cleanup (sc_scda_fcontext_t * fc)
 {
+  int                 count;
+  sc_MPI_File        *file;
+
   /* no error checking since we are called under an error condition */
-  SC_ASSERT (file != NULL);
+  SC_ASSERT (fc != NULL);
+  if (fc->pending != NULL) {
+    (void) sc_io_wait (&fc->pending, &count);
+  }
+  SC_FREE (fc->staging);
+  if (fc->index != NULL) {
+    sc_array_destroy (fc->index);
+  }
+  file = &fc->file;
   if (*file != sc_MPI_FILE_NULL) {
     /* We do not use here the libsc closing function since we do not perform
      * error checking in this function that is only called if we had already
@@ -1207,6 +1335,12 @@ sc_scda_params_init (sc_scda_params_t *params)
   params->info = sc_MPI_INFO_NULL;
   params->fuzzy_everyn = 0;
   params->fuzzy_seed = 0;
+  params->write_behind = 0;
+  params->batch_bytes = 0;
+  params->write_index = 0;
+  params->stripe_size = 0;
+  params->stripe_count = 0;
+  params->align = 0;
 #ifdef SC_ENABLE_DEBUG
   params->log_level = SC_LP_ERROR;
 #else
@@ -1244,6 +1378,25 @@ sc_scda_fopen_start_up (sc_scda_params_t *params, sc_MPI_Comm mpicomm,
   /* fill convenience MPI information */
   sc_scda_fill_mpi_data (fc, mpicomm);
 
+  /* there is no staged write yet */
+  fc->staging = NULL;
+  fc->pending = NULL;
+  fc->pending_count = 0;
+
+  /* sections are read raw until an encoded section is encountered */
+  fc->decode_type = 0;
+  fc->decode_size = 0;
+  fc->encoded_size = 0;
+  fc->section_count = 0;
+  fc->section_size = 0;
+
+  /* the section index is set up by the fopen functions */
+  fc->index_nested = 0;
+  fc->index = NULL;
+  fc->index_complete = 0;
+  fc->index_end = 0;
+  fc->file_size = 0;
+
   /* examine parameter */
   scdaret = sc_scda_examine_params (params, fc, info);
   /* It is guaranteed by sc_scda_examine_params that fuzzy error testing is
@@ -1260,6 +1413,207 @@ sc_scda_fopen_start_up (sc_scda_params_t *params, sc_MPI_Comm mpicomm,
   return fc;
 }
 
+/** Complete the pending write of staged array data if there is one.
+ *
+ * This is a collective function that must be called before any other access
+ * to a file opened for writing.
+ *
+ * \param [in,out] fc       A file context opened for writing.
+ * \param [out]    errcode  An errcode that can be interpreted by \ref
+ *                          sc_scda_ferror_string or mapped to an error class
+ *                          by \ref sc_scda_ferror_class. It is only set if
+ *                          a write was pending.
+ * \return                  \b fc on success. In case of an error the file
+ *                          is closed, \b fc is freed and NULL is returned.
+ */
+static sc_scda_fcontext_t *
+sc_scda_fwrite_complete (sc_scda_fcontext_t *fc, sc_scda_ferror_t *errcode)
+{
+  int                 mpiret;
+  int                 count;
+
+  SC_ASSERT (fc != NULL);
+  SC_ASSERT (errcode != NULL);
+
+  if (fc->pending == NULL) {
+    /* there is no write in progress */
+    return fc;
+  }
+
+  mpiret = sc_io_wait (&fc->pending, &count);
+  SC_ASSERT (fc->pending == NULL);
+  sc_scda_mpiret_to_errcode (mpiret, errcode, fc);
+  SC_SCDA_CHECK_COLL_ERR (errcode, fc, "Writing array data behind");
+  /* check for count error of the collective I/O operation */
+  SC_SCDA_CHECK_COLL_COUNT_ERR (fc->pending_count, count, fc, errcode);
+
+  return fc;
+}
+
+/** Store an element size as \ref SC_SCDA_ENCODE_SIZE_BYTES big-endian bytes.
+ *
+ * \param [in]  value      The value to store.
+ * \param [out] bytes      At least \ref SC_SCDA_ENCODE_SIZE_BYTES bytes.
+ */
+static void
+sc_scda_ulong_to_bytes (sc_scda_ulong value, char *bytes)
+{
+  int                 i;
+
+  SC_ASSERT (bytes != NULL);
+
+  for (i = SC_SCDA_ENCODE_SIZE_BYTES - 1; i >= 0; --i) {
+    bytes[i] = (char) (value & 0xff);
+    value >>= 8;
+  }
+}
+
+/** Retrieve an element size from \ref SC_SCDA_ENCODE_SIZE_BYTES bytes.
+ *
+ * \param [in]  bytes      Bytes written by \ref sc_scda_ulong_to_bytes.
+ * \return                 The stored value.
+ */
+static sc_scda_ulong
+sc_scda_bytes_to_ulong (const char *bytes)
+{
+  int                 i;
+  sc_scda_ulong       value;
+
+  SC_ASSERT (bytes != NULL);
+
+  value = 0;
+  for (i = 0; i < SC_SCDA_ENCODE_SIZE_BYTES; ++i) {
+    value = (value << 8) | (sc_scda_ulong) (unsigned char) bytes[i];
+  }
+
+  return value;
+}
+
+/** Write the inline section that starts an encoded file section.
+ *
+ * The inline section has the user string \ref SC_SCDA_ENCODE_STRING.
+ * Its data is the original section type, a space and the original block
+ * or element size in decimal digits padded by spaces and a final newline.
+ *
+ * \param [in,out] fc       A file context opened for writing.
+ * \param [in]     type     The original section type, 'B' or 'A'.
+ * \param [in]     size     The block size for 'B' and the element size
+ *                          for 'A'.
+ * \param [out]    errcode  An errcode that can be interpreted by \ref
+ *                          sc_scda_ferror_string or mapped to an error class
+ *                          by \ref sc_scda_ferror_class.
+ * \return                  As for \ref sc_scda_fwrite_inline.
+ */
+static sc_scda_fcontext_t *
+sc_scda_fwrite_encode_header (sc_scda_fcontext_t *fc, char type, size_t size,
+                              sc_scda_ferror_t *errcode)
+{
+  char                meta[SC_SCDA_INLINE_FIELD + 1];
+  sc_array_t          meta_data;
+
+  SC_ASSERT (type == 'B' || type == 'A');
+
+  snprintf (meta, SC_SCDA_INLINE_FIELD + 1, "%c %-*llu\n", type,
+            SC_SCDA_INLINE_FIELD - 3, (long long unsigned) size);
+  sc_array_init_data (&meta_data, meta, SC_SCDA_INLINE_FIELD, 1);
+
+  return sc_scda_fwrite_inline (fc, SC_SCDA_ENCODE_STRING, NULL, &meta_data,
+                                SC_SCDA_HEADER_ROOT, errcode);
+}
+
+/** Check the inline data that starts an encoded file section.
+ *
+ * \param [in]  meta       \ref SC_SCDA_INLINE_FIELD bytes of inline data.
+ * \param [out] type       The original section type on success.
+ * \param [out] size       The original block or element size on success.
+ * \return                 0 if \b meta was written by \ref
+ *                         sc_scda_fwrite_encode_header and -1 otherwise.
+ */
+static int
+sc_scda_check_encode_header (const char *meta, char *type, size_t *size)
+{
+  int                 i;
+  char                digits[SC_SCDA_INLINE_FIELD];
+  long long unsigned  read_size;
+
+  SC_ASSERT (meta != NULL);
+
+  if (!(meta[0] == 'B' || meta[0] == 'A') || meta[1] != ' ' ||
+      meta[SC_SCDA_INLINE_FIELD - 1] != '\n') {
+    return -1;
+  }
+
+  /* the size is followed by space padding */
+  sc_scda_init_nul (digits, SC_SCDA_INLINE_FIELD);
+  for (i = 2; i < SC_SCDA_INLINE_FIELD - 1 && isdigit ((unsigned char) meta[i]); ++i) {
+    digits[i - 2] = meta[i];
+  }
+  if (i == 2) {
+    return -1;
+  }
+  for (; i < SC_SCDA_INLINE_FIELD - 1; ++i) {
+    if (meta[i] != ' ') {
+      return -1;
+    }
+  }
+  if (sscanf (digits, "%llu", &read_size) != 1) {
+    return -1;
+  }
+
+  *type = meta[0];
+  *size = (size_t) read_size;
+
+  return 0;
+}
+
+/** Write an encoded block section.
+ *
+ * The block is compressed by \ref sc_io_encode on \b root and written as a
+ * raw block section after the inline section of the encoding convention.
+ * The parameters are as for \ref sc_scda_fwrite_block.
+ */
+static sc_scda_fcontext_t *
+sc_scda_fwrite_block_encode (sc_scda_fcontext_t *fc, const char *user_string,
+                             size_t *len, sc_array_t *block_data,
+                             size_t block_size, int root,
+                             sc_scda_ferror_t *errcode)
+{
+  int                 mpiret;
+  int                 invalid_block_data;
+  size_t              encoded_size;
+  sc_array_t          encoded, encoded_block;
+
+  /* compress the block on its root */
+  sc_array_init (&encoded, 1);
+  if (fc->mpirank == root) {
+    invalid_block_data = !(block_data->elem_size == block_size &&
+                           block_data->elem_count == 1);
+    sc_scda_scdaret_to_errcode (invalid_block_data ? SC_SCDA_FERR_ARG :
+                                SC_SCDA_FERR_SUCCESS, errcode, fc);
+    if (!invalid_block_data) {
+      sc_io_encode (block_data, &encoded);
+    }
+  }
+  SC_SCDA_HANDLE_NONCOLL_ERR (errcode, root, fc);
+
+  encoded_size = encoded.elem_count;
+  mpiret = sc_MPI_Bcast (&encoded_size, sizeof (size_t), sc_MPI_BYTE, root,
+                         fc->mpicomm);
+  SC_CHECK_MPI (mpiret);
+
+  fc = sc_scda_fwrite_encode_header (fc, 'B', block_size, errcode);
+  if (fc != NULL) {
+    /* the compressed block is written as a raw block */
+    sc_array_init_data (&encoded_block, encoded.array, encoded_size, 1);
+    fc = sc_scda_fwrite_block (fc, user_string, len, &encoded_block,
+                               encoded_size, root, 0, errcode);
+  }
+  sc_array_reset (&encoded);
+
+  return fc;
+}
+
+
 /** Write common section data to \b output.
  *
  * All section headers in the scda format contain a part with a
@@ -1312,6 +1666,61 @@ sc_scda_get_common_section_header (char section_char, const char* user_string,
   return invalid_user_string;
 }
 
+/** Record a section that is about to be written in the section index.
+ *
+ * The records are kept on all processes since the size of the index block
+ * is collective. The sections that the writing functions write internally
+ * for the encoding convention are not recorded. A
+ * non-compliant user string is not recorded either since the writing
+ * function fails on it.
+ *
+ * \param [in,out] fc           The file context before writing the section.
+ * \param [in]     type         The section type 'I', 'B' or 'A'.
+ * \param [in]     user_string  As passed to the writing function.
+ * \param [in]     len          As passed to the writing function.
+ * \param [in]     elem_counts  The element counts of an array section or
+ *                              NULL for the other section types.
+ * \param [in]     elem_size    The block size, the element size or 0.
+ * \param [in]     encode       As passed to the writing function.
+ */
+static void
+sc_scda_index_add (sc_scda_fcontext_t *fc, char type, const char *user_string,
+                   size_t *len, sc_array_t *elem_counts, size_t elem_size,
+                   int encode)
+{
+  const int           head = 3 + 3 * (SC_SCDA_INDEX_DIGITS + 1);
+  char                record[SC_SCDA_INDEX_ENTRY + 1];
+  size_t              user_string_len;
+  size_t              elem_count, zi;
+
+  if (!fc->write_index || fc->index_nested) {
+    return;
+  }
+  if (sc_scda_get_user_string_len (user_string, len, &user_string_len)) {
+    return;
+  }
+
+  /* invalid element counts are reported by the writing function */
+  elem_count = 0;
+  if (elem_counts != NULL &&
+      elem_counts->elem_size == sizeof (sc_scda_ulong)) {
+    for (zi = 0; zi < elem_counts->elem_count; ++zi) {
+      elem_count += (size_t) *((sc_scda_ulong *)
+                               sc_array_index (elem_counts, zi));
+    }
+  }
+
+  snprintf (record, SC_SCDA_INDEX_ENTRY + 1, "%c%c %0*llu %0*llu %0*llu ",
+            type, encode ? 'E' : '-',
+            SC_SCDA_INDEX_DIGITS, (long long unsigned) fc->accessed_bytes,
+            SC_SCDA_INDEX_DIGITS, (long long unsigned) elem_count,
+            SC_SCDA_INDEX_DIGITS, (long long unsigned) elem_size);
+  sc_scda_pad_to_fix_len_inplace (user_string, user_string_len,
+                                  &record[head], SC_SCDA_INDEX_ENTRY - head);
+  sc_scda_copy_bytes ((char *) sc_array_push (fc->index), record,
+                      SC_SCDA_INDEX_ENTRY);
+}
+
 /** Internal function to run the serial code part in \ref sc_scda_fopen_write.
  *
  * \param [in] fc           The file context as in \ref sc_scda_fopen_write
@@ -1449,8 +1858,8 @@ sc_scda_fopen_write (sc_MPI_Comm mpicomm,
   }
 
   /* open the file for writing */
-  mpiret =
-    sc_io_open (mpicomm, filename, SC_IO_WRITE_CREATE, info, &fc->file);
+  mpiret = sc_io_open_striped (mpicomm, filename, SC_IO_WRITE_CREATE, info,
+                               &fc->stripe, &fc->file);
   sc_scda_mpiret_to_errcode (mpiret, errcode, fc);
   /* We call a macro for checking an error that occurs collectively.
    * In case of an error the macro prints an error message using \ref
@@ -1496,6 +1905,11 @@ sc_scda_fopen_write (sc_MPI_Comm mpicomm,
   fc->header_before = 0;
   fc->last_type = '\0';
 
+  if (fc->write_index) {
+    /* the written sections are recorded for the section index */
+    fc->index = sc_array_new (SC_SCDA_INDEX_ENTRY);
+  }
+
   return fc;
 }
 
@@ -1615,6 +2029,12 @@ sc_scda_fwrite_inline (sc_scda_fcontext_t *fc, const char *user_string,
   SC_ASSERT (fc->mpirank != root || inline_data != NULL);
   SC_ASSERT (errcode != NULL);
 
+  /* the file is not accessed while a staged write is in progress */
+  if (sc_scda_fwrite_complete (fc, errcode) == NULL) {
+    return NULL;
+  }
+  sc_scda_index_add (fc, 'I', user_string, len, NULL, 0, 0);
+
   /* The file header section is always written and read on rank 0. */
   if (fc->mpirank == SC_SCDA_HEADER_ROOT) {
     sc_scda_fwrite_inline_header_serial (fc, user_string, len, &count_err,
@@ -1868,6 +2288,11 @@ sc_scda_fwrite_block (sc_scda_fcontext_t *fc, const char *user_string,
   SC_ASSERT (fc->mpirank != root || block_data != NULL);
   SC_ASSERT (errcode != NULL);
 
+  /* the file is not accessed while a staged write is in progress */
+  if (sc_scda_fwrite_complete (fc, errcode) == NULL) {
+    return NULL;
+  }
+
   /* check if block_size is collective */
   ret = sc_scda_check_coll_params (fc, (const char*) &block_size,
                                    sizeof (size_t), NULL, 0, NULL, 0);
@@ -1875,7 +2300,18 @@ sc_scda_fwrite_block (sc_scda_fcontext_t *fc, const char *user_string,
   SC_SCDA_CHECK_COLL_ERR (errcode, fc, "fwrite_block: block_size is not "
                           "collective");
 
-  /* TODO: respect encode parameter */
+  sc_scda_index_add (fc, 'B', user_string, len, NULL, block_size, encode);
+
+  if (encode) {
+    /* compressed data according to the scda encoding convention */
+    fc->index_nested = 1;
+    fc = sc_scda_fwrite_block_encode (fc, user_string, len, block_data,
+                                      block_size, root, errcode);
+    if (fc != NULL) {
+      fc->index_nested = 0;
+    }
+    return fc;
+  }
 
   /* section header is always written and read on rank SC_SCDA_HEADER_ROOT */
   if (fc->mpirank == SC_SCDA_HEADER_ROOT) {
@@ -2052,14 +2488,15 @@ sc_scda_get_last_byte_owner (sc_scda_fcontext_t *fc, sc_array_t *elem_counts)
  *                          according to the given partition.
  * \param [out] num_bytes   On output filled with the number of local byte
  *                          offset according to the given partition.
+ *                          It may exceed the int range.
  */
 static void
 sc_scda_get_local_partition_index (sc_scda_fcontext_t *fc,
                                    sc_array_t *elem_counts, size_t elem_size,
-                                   sc_MPI_Offset *offset, int *num_bytes)
+                                   sc_MPI_Offset *offset, size_t *num_bytes)
 {
   int                 i;
-  int                 num_local_elements;
+  size_t              num_local_elements;
 
   SC_ASSERT (fc != NULL);
   SC_ASSERT (elem_counts != NULL);
@@ -2078,8 +2515,40 @@ sc_scda_get_local_partition_index (sc_scda_fcontext_t *fc,
 
   /* compute the number of local array data bytes */
   num_local_elements =
-    (int) *((sc_scda_ulong *) sc_array_index_int (elem_counts, fc->mpirank));
-  *num_bytes = (int) elem_size * num_local_elements;
+    (size_t) *((sc_scda_ulong *) sc_array_index_int (elem_counts,
+                                                     fc->mpirank));
+  *num_bytes = elem_size * num_local_elements;
+}
+
+/** Check if the local array data of every process fits into one MPI call.
+ *
+ * The check only uses the partition and needs no communication. Hence, its
+ * result is collective.
+ *
+ * \param [in] fc           A valid file context.
+ * \param [in] elem_counts  As in \ref sc_scda_get_local_partition_index.
+ * \param [in] elem_size    The byte count of each array element.
+ * \return                  True if no process has more than INT_MAX bytes.
+ */
+static int
+sc_scda_partition_fits_int (sc_scda_fcontext_t *fc, sc_array_t *elem_counts,
+                            size_t elem_size)
+{
+  int                 i;
+  sc_scda_ulong       count;
+
+  SC_ASSERT (fc != NULL);
+  SC_ASSERT (elem_counts != NULL);
+  SC_ASSERT ((size_t) fc->mpisize == elem_counts->elem_count);
+
+  for (i = 0; i < fc->mpisize; ++i) {
+    count = *((sc_scda_ulong *) sc_array_index_int (elem_counts, i));
+    if (elem_size > 0 && count > (sc_scda_ulong) INT_MAX / elem_size) {
+      return 0;
+    }
+  }
+
+  return 1;
 }
 
 /** Collective check of array function parameters.
@@ -2134,14 +2603,16 @@ sc_scda_check_array_params (sc_scda_fcontext_t *fc, sc_array_t *array_data,
   }
 
   /* compute the global element count */
-  /* TODO: Use a checksum for the colletivness test? */
   for (si = 0; si < elem_counts->elem_count; ++si) {
     *elem_count += *((size_t *) sc_array_index (elem_counts, si));
   }
 
-  /* check if elem_count, elem_size and indirect are collective */
-  ret = sc_scda_check_coll_params (fc, (const char *) elem_count,
-                                   sizeof (size_t), (const char *) &elem_size,
+  /* check if elem_counts, elem_size and indirect are collective;
+   * the check is by checksum and thus cheap for the whole array */
+  ret = sc_scda_check_coll_params (fc, elem_counts->array,
+                                   elem_counts->elem_count *
+                                   elem_counts->elem_size,
+                                   (const char *) &elem_size,
                                    sizeof (size_t), (const char *) &indirect,
                                    sizeof (int));
   if (ret != SC_SCDA_FERR_SUCCESS) {
@@ -2330,127 +2801,549 @@ sc_scda_get_indirect_type (sc_scda_fcontext_t *fc, sc_array_t *array_data,
 }
 #endif
 
-sc_scda_fcontext_t *
-sc_scda_fwrite_array (sc_scda_fcontext_t *fc, const char *user_string,
-                      size_t *len, sc_array_t *array_data,
-                      sc_array_t *elem_counts, size_t elem_size, int indirect,
-                      int encode, sc_scda_ferror_t *errcode)
+/** Read or write the local data of a fixed-size array section in batches.
+ *
+ * Every process transfers at most \b fc->batch_bytes bytes per collective
+ * call, rounded down to whole elements but at least one element, and all
+ * processes make the same number of calls.  Indirect data is gathered into
+ * or scattered from a buffer of one batch.  Thus the temporary memory and
+ * the aggregation buffers of MPI I/O stay bounded, and the local data may
+ * exceed the int range of a single MPI call.  If \b fc->batch_bytes is 0,
+ * the local data is transferred in as few calls as possible.
+ *
+ * \param [in] fc           A file context with filled MPI data.
+ * \param [in] write        True for writing and false for reading.
+ * \param [in,out] array_data The local array data as documented for
+ *                          \ref sc_scda_fwrite_array and \ref
+ *                          sc_scda_fread_array_data.  May be NULL on
+ *                          reading to skip the local data.
+ * \param [in] indirect     True if \b array_data holds one \ref
+ *                          sc_array_t per element.
+ * \param [in] elem_size    The byte count of each array element.
+ * \param [in] offset       The absolute file offset of the local data.
+ * \param [out] short_calls The number of local calls that transferred
+ *                          fewer bytes than requested.
+ * \return                  sc_MPI_SUCCESS or the error code of the first
+ *                          failed call.  After a failure the process makes
+ *                          its remaining calls with zero bytes.
+ */
+static int
+sc_scda_array_batches (sc_scda_fcontext_t *fc, int write,
+                       sc_array_t *array_data, int indirect,
+                       size_t elem_size, sc_MPI_Offset offset,
+                       int *short_calls)
 {
-  int                 mpiret;
-  int                 count_err;
-  int                 bytes_to_write, write_count;
-  int                 count;
-  int                 last_byte_owner;
-  sc_scda_ret_t       scdaret;
-  size_t              elem_count;
-  size_t              collective_byte_count;
-  size_t              num_pad_bytes;
-  sc_MPI_Offset       offset;
-#ifndef SC_ENABLE_MPI
-  sc_array_t          contig_arr;
-#else
-  void               *base_address;
-#endif
-  const void         *local_array_data;
-  sc_MPI_Datatype     type;
+  int                 mpiret, retval;
+  int                 bytes, count;
+  long long           local_calls, num_calls, c;
+  size_t              local_count, per_call, done, n, si;
+  char               *buffer, *data;
 
   SC_ASSERT (fc != NULL);
-  SC_ASSERT (user_string != NULL);
-  SC_ASSERT (array_data != NULL);
-  SC_ASSERT (elem_counts != NULL);
-  SC_ASSERT (errcode != NULL);
+  SC_ASSERT (array_data != NULL || !write);
+  SC_ASSERT (short_calls != NULL);
+
+  /* the number of elements per call and of local calls */
+  local_count = 0;
+  per_call = 1;
+  if (array_data != NULL && elem_size > 0) {
+    local_count = array_data->elem_count;
+    per_call = (fc->batch_bytes > 0) ? fc->batch_bytes / elem_size :
+      local_count;
+    per_call = SC_MAX (SC_MIN (per_call, (size_t) INT_MAX / elem_size), 1);
+  }
+  local_calls = (long long) ((local_count + per_call - 1) / per_call);
+  mpiret = sc_MPI_Allreduce (&local_calls, &num_calls, 1,
+                             sc_MPI_LONG_LONG_INT, sc_MPI_MAX, fc->mpicomm);
+  SC_CHECK_MPI (mpiret);
 
-  /* TODO: respect encode parameter */
+  buffer = NULL;
+  if (indirect && local_count > 0) {
+    buffer = SC_ALLOC (char, SC_MIN (per_call, local_count) * elem_size);
+  }
 
-  /* check function parameters */
-  scdaret = sc_scda_check_array_params (fc, array_data, indirect, elem_counts,
-                                        elem_size, &elem_count);
-  sc_scda_scdaret_to_errcode (scdaret, errcode, fc);
-  SC_SCDA_CHECK_COLL_ERR (errcode, fc, "fwrite_array: Invalid parameters");
+  retval = sc_MPI_SUCCESS;
+  *short_calls = 0;
+  for (c = 0, done = 0; c < num_calls; ++c, done += n) {
+    n = (retval == sc_MPI_SUCCESS) ? SC_MIN (per_call, local_count - done) : 0;
+    bytes = (int) (n * elem_size);
+    data = NULL;
+    if (n > 0) {
+      data = indirect ? buffer : array_data->array + done * elem_size;
+    }
+    if (write && indirect) {
+      /* gather the elements of this batch */
+      for (si = 0; si < n; ++si) {
+        sc_scda_copy_bytes (buffer + si * elem_size, ((sc_array_t *)
+                            sc_array_index (array_data, done + si))->array,
+                            elem_size);
+      }
+    }
 
-  /* section header is always written and read on rank SC_SCDA_HEADER_ROOT */
-  if (fc->mpirank == SC_SCDA_HEADER_ROOT) {
-    sc_scda_fwrite_array_header_serial (fc, user_string, len, elem_count,
-                                        elem_size, &count_err, errcode);
+    if (write) {
+      mpiret = sc_io_write_at_all (fc->file, offset + (sc_MPI_Offset)
+                                   (done * elem_size), data, bytes,
+                                   sc_MPI_BYTE, &count);
+    }
+    else {
+      mpiret = sc_io_read_at_all (fc->file, offset + (sc_MPI_Offset)
+                                  (done * elem_size), data, bytes,
+                                  sc_MPI_BYTE, &count);
+    }
+    if (mpiret != sc_MPI_SUCCESS) {
+      retval = mpiret;
+      continue;
+    }
+    *short_calls += (count != bytes);
+
+    if (!write && indirect) {
+      /* scatter the elements of this batch */
+      for (si = 0; si < n; ++si) {
+        sc_scda_copy_bytes (((sc_array_t *)
+                             sc_array_index (array_data, done + si))->array,
+                            buffer + si * elem_size, elem_size);
+      }
+    }
   }
-  SC_SCDA_HANDLE_NONCOLL_ERR (errcode, SC_SCDA_HEADER_ROOT, fc);
-  SC_SCDA_HANDLE_NONCOLL_COUNT_ERR (errcode, &count_err, SC_SCDA_HEADER_ROOT,
-                                    fc);
 
-  /* add number of written bytes */
-  fc->accessed_bytes += SC_SCDA_COMMON_FIELD + 2 * SC_SCDA_COUNT_FIELD;
+  SC_FREE (buffer);
+  return retval;
+}
 
-  /* retrieve partition information */
-  sc_scda_get_local_partition_index (fc, elem_counts, elem_size, &offset,
-                                     &bytes_to_write);
+/** Write an encoded fixed-size array section.
+ *
+ * Every array element is compressed separately by \ref sc_io_encode.
+ * After the inline section of the encoding convention, we write an array
+ * section with the user string and the big-endian compressed byte count of
+ * each element and then a byte array section with the compressed elements.
+ * Since the compressed sizes are stored per element, the data can be read
+ * on any partition. The parameters are as for \ref sc_scda_fwrite_array.
+ */
+static sc_scda_fcontext_t *
+sc_scda_fwrite_array_encode (sc_scda_fcontext_t *fc, const char *user_string,
+                             size_t *len, sc_array_t *array_data,
+                             sc_array_t *elem_counts, size_t elem_size,
+                             int indirect, sc_scda_ferror_t *errcode)
+{
+  int                 mpiret;
+  size_t              si;
+  size_t              elem_count;
+  sc_scda_ret_t       scdaret;
+  sc_scda_ulong       local_bytes;
+  char               *elem_data;
+  sc_array_t          elem, elem_encoded, encoded, sizes, byte_counts;
+  sc_array_t         *data_arr;
 
-  /* get data type and (base) pointer to local array data */
-  if (indirect) {
-#ifndef SC_ENABLE_MPI
-    /* TODO: Put this in a separate function? */
-    size_t              si;
-    sc_array_t         *data_arr;
-    char               *data_src, *data_dest;
-
-    /* indirect addressing */
-    /* TODO: Use batches? */
-    sc_array_init_size (&contig_arr, elem_size, elem_count);
-    for (si = 0; si < array_data->elem_count; ++si) {
+  /* check the parameters before anything is written */
+  scdaret = sc_scda_check_array_params (fc, array_data, indirect, elem_counts,
+                                        elem_size, &elem_count);
+  sc_scda_scdaret_to_errcode (scdaret, errcode, fc);
+  SC_SCDA_CHECK_COLL_ERR (errcode, fc, "fwrite_array: Invalid parameters");
+
+  /* compress every local element separately */
+  sc_array_init_size (&sizes, SC_SCDA_ENCODE_SIZE_BYTES,
+                      array_data->elem_count);
+  sc_array_init (&encoded, 1);
+  sc_array_init (&elem_encoded, 1);
+  for (si = 0; si < array_data->elem_count; ++si) {
+    if (indirect) {
       data_arr = (sc_array_t *) sc_array_index (array_data, si);
       SC_ASSERT (data_arr->elem_size == elem_size
                  && data_arr->elem_count == 1);
-      data_src = (char *) sc_array_index (data_arr, 0);
-      data_dest = (char *) sc_array_index (&contig_arr, si);
-
-      sc_scda_copy_bytes (data_dest, data_src, elem_size);
+      elem_data = data_arr->array;
+    }
+    else {
+      elem_data = (char *) sc_array_index (array_data, si);
     }
-    local_array_data = (const void *) contig_arr.array;
+    sc_array_init_data (&elem, elem_data, 1, elem_size);
+    sc_io_encode (&elem, &elem_encoded);
+    sc_scda_ulong_to_bytes ((sc_scda_ulong) elem_encoded.elem_count,
+                            (char *) sc_array_index (&sizes, si));
+    sc_scda_copy_bytes ((char *) sc_array_push_count
+                        (&encoded, elem_encoded.elem_count),
+                        elem_encoded.array, elem_encoded.elem_count);
+  }
+  sc_array_reset (&elem_encoded);
+
+  /* the compressed byte counts partition the compressed data */
+  sc_array_init_size (&byte_counts, sizeof (sc_scda_ulong),
+                      (size_t) fc->mpisize);
+  local_bytes = (sc_scda_ulong) encoded.elem_count;
+  mpiret = sc_MPI_Allgather (&local_bytes, sizeof (sc_scda_ulong),
+                             sc_MPI_BYTE, byte_counts.array,
+                             sizeof (sc_scda_ulong), sc_MPI_BYTE,
+                             fc->mpicomm);
+  SC_CHECK_MPI (mpiret);
 
-    /* without MPI we can not use custom MPI data types */
-    type = sc_MPI_BYTE;
-    write_count = bytes_to_write;
-#else
-    /* get MPI datatype for potentially discontiguous data */
-    sc_scda_get_indirect_type (fc, array_data, elem_counts, &base_address,
-                               &type);
-    /* set pointer to the local base array element if there are local elements */
-    local_array_data = (const void *) base_address;
-    /* one entity of the custom MPI data type represents the local data */
-    write_count = (bytes_to_write > 0) ? 1 : 0;
-#endif
+  fc = sc_scda_fwrite_encode_header (fc, 'A', elem_size, errcode);
+  if (fc != NULL) {
+    fc = sc_scda_fwrite_array (fc, user_string, len, &sizes, elem_counts,
+                               SC_SCDA_ENCODE_SIZE_BYTES, 0, 0, errcode);
   }
-  else {
-    /* direct addressing */
-    local_array_data = (const void *) array_data->array;
-    /* we use the given contiguous byte array */
-    type = sc_MPI_BYTE;
-    write_count = bytes_to_write;
+  if (fc != NULL) {
+    fc = sc_scda_fwrite_array (fc, SC_SCDA_ENCODE_STRING, NULL, &encoded,
+                               &byte_counts, 1, 0, 0, errcode);
   }
+  sc_array_reset (&sizes);
+  sc_array_reset (&encoded);
+  sc_array_reset (&byte_counts);
 
-  /* local_array_data == NULL must be sufficient for write_count == 0 */
-  SC_ASSERT (local_array_data != NULL || write_count == 0);
-
-  /* write array data in parallel */
+  return fc;
+}
 
-  mpiret = sc_io_write_at_all (fc->file, fc->accessed_bytes + offset,
-                               local_array_data, write_count, type, &count);
-  if (indirect) {
-    /* perform clean up in the indirect case */
-#ifndef SC_ENABLE_MPI
-    /* indirect data is copied to a contiguous buffer if MPI is not available */
-    SC_ASSERT (type == sc_MPI_BYTE);
-    sc_array_reset (&contig_arr);
+/** Check if the local array bytes and padding fit into the staging buffer.
+ *
+ * Since \b elem_counts is collective, so is the result.
+ *
+ * \param [in] fc           A file context opened for writing.
+ * \param [in] elem_counts  As in the documentation of \ref
+ *                          sc_scda_fwrite_array.
+ * \param [in] elem_size    As in the documentation of \ref
+ *                          sc_scda_fwrite_array.
+ * \return                  True if the array data is written behind.
+ */
+static int
+sc_scda_fwrite_array_fits_behind (sc_scda_fcontext_t *fc,
+                                  sc_array_t *elem_counts, size_t elem_size)
+{
+  int                 i;
+  size_t              max_bytes;
+  sc_scda_ulong       count;
+
+  SC_ASSERT (fc != NULL);
+  SC_ASSERT (elem_counts != NULL);
+  SC_ASSERT ((size_t) fc->mpisize == elem_counts->elem_count);
+
+  if (fc->write_behind < SC_SCDA_PADDING_MOD_MAX) {
+    return 0;
+  }
+
+  /* the staged data and padding are written in one call */
+  max_bytes = SC_MIN (fc->write_behind, (size_t) INT_MAX) -
+    SC_SCDA_PADDING_MOD_MAX;
+  for (i = 0; i < fc->mpisize; ++i) {
+    count = *((sc_scda_ulong *) sc_array_index_int (elem_counts, i));
+    if (elem_size > 0 && count > max_bytes / elem_size) {
+      return 0;
+    }
+  }
+
+  return 1;
+}
+
+/** Copy the local array data into the staging buffer and start writing it.
+ *
+ * The padding is appended on the process that holds the last byte such that
+ * the array data and the padding are written in one collective operation.
+ * The write is completed by \ref sc_scda_fwrite_complete.
+ *
+ * \param [in,out] fc             A file context opened for writing with
+ *                                no pending write.
+ * \param [in]     array_data     As in \ref sc_scda_fwrite_array.
+ * \param [in]     elem_counts    As in \ref sc_scda_fwrite_array.
+ * \param [in]     elem_count     The global element count of the array.
+ * \param [in]     elem_size      As in \ref sc_scda_fwrite_array.
+ * \param [in]     indirect       As in \ref sc_scda_fwrite_array.
+ * \param [in]     offset         The local byte offset in the array data.
+ * \param [in]     bytes_to_write The local byte count of the array data.
+ * \param [out]    errcode        An errcode that can be interpreted by \ref
+ *                                sc_scda_ferror_string or mapped to an error
+ *                                class by \ref sc_scda_ferror_class.
+ * \return                        \b fc on success. In case of an error the
+ *                                file is closed, \b fc is freed and NULL is
+ *                                returned.
+ */
+static sc_scda_fcontext_t *
+sc_scda_fwrite_array_behind (sc_scda_fcontext_t *fc, sc_array_t *array_data,
+                             sc_array_t *elem_counts, size_t elem_count,
+                             size_t elem_size, int indirect,
+                             sc_MPI_Offset offset, int bytes_to_write,
+                             sc_scda_ferror_t *errcode)
+{
+  int                 mpiret;
+  int                 stage_count;
+  int                 last_byte_owner;
+  size_t              collective_byte_count;
+  size_t              si;
+  sc_array_t         *data_arr;
+
+  SC_ASSERT (fc != NULL);
+  SC_ASSERT (fc->pending == NULL);
+  SC_ASSERT ((size_t) bytes_to_write + SC_SCDA_PADDING_MOD_MAX <=
+             fc->write_behind);
+
+  /* the staging buffer is reused for all array sections */
+  if (fc->staging == NULL) {
+    fc->staging = SC_ALLOC (char, fc->write_behind);
+  }
+
+  /* copy the local array data */
+  if (indirect) {
+    for (si = 0; si < array_data->elem_count; ++si) {
+      data_arr = (sc_array_t *) sc_array_index (array_data, si);
+      SC_ASSERT (data_arr->elem_size == elem_size
+                 && data_arr->elem_count == 1);
+      sc_scda_copy_bytes (&fc->staging[si * elem_size], data_arr->array,
+                          elem_size);
+    }
+  }
+  else {
+    sc_scda_copy_bytes (fc->staging, array_data->array,
+                        (size_t) bytes_to_write);
+  }
+  stage_count = bytes_to_write;
+
+  /* the last local byte is the last global byte on the last byte owner */
+  collective_byte_count = elem_count * elem_size;
+  last_byte_owner = sc_scda_get_last_byte_owner (fc, elem_counts);
+  if (fc->mpirank == last_byte_owner) {
+    SC_ASSERT (collective_byte_count == 0 || bytes_to_write > 0);
+    sc_scda_pad_to_mod ((collective_byte_count > 0) ?
+                        &fc->staging[bytes_to_write - 1] : NULL,
+                        collective_byte_count, &fc->staging[bytes_to_write]);
+    stage_count += (int) sc_scda_pad_to_mod_len (collective_byte_count);
+  }
+
+  /* start writing the staged data in the background */
+  mpiret = sc_io_iwrite_at_all (fc->file, fc->accessed_bytes + offset,
+                                fc->staging, stage_count, sc_MPI_BYTE,
+                                &fc->pending);
+  sc_scda_mpiret_to_errcode (mpiret, errcode, fc);
+  SC_SCDA_CHECK_COLL_ERR (errcode, fc, "Starting to write array data behind");
+  fc->pending_count = stage_count;
+
+  return fc;
+}
+
+/** Align the data of the array section that is written next.
+ *
+ * If \b fc->align is positive and the array data would not start at a
+ * multiple of it, a block section with the user string \ref
+ * SC_SCDA_ALIGN_STRING is written first. Its block of spaces is sized such
+ * that the array data starts at the next possible multiple of \b fc->align.
+ * The block section is not recorded in the section index and skipped by
+ * \ref sc_scda_fread_section_header if \b decode is true.
+ *
+ * \param [in,out] fc       The file context before writing an array section.
+ * \param [out] errcode     An errcode that can be interpreted by \ref
+ *                          sc_scda_ferror_string or mapped to an error class
+ *                          by \ref sc_scda_ferror_class.
+ * \return                  As for \ref sc_scda_fwrite_block.
+ */
+static sc_scda_fcontext_t *
+sc_scda_fwrite_align (sc_scda_fcontext_t *fc, sc_scda_ferror_t *errcode)
+{
+  const size_t        array_header = SC_SCDA_COMMON_FIELD +
+    2 * SC_SCDA_COUNT_FIELD;
+  const size_t        block_header = SC_SCDA_COMMON_FIELD +
+    SC_SCDA_COUNT_FIELD;
+  size_t              filler, block_size;
+  sc_array_t          block;
+
+  SC_ASSERT (fc->align % SC_SCDA_PADDING_MOD == 0);
+
+  if (fc->align == 0) {
+    return fc;
+  }
+
+  /* the bytes from the current position to the aligned array data */
+  filler = (fc->align - ((size_t) fc->accessed_bytes + array_header) %
+            fc->align) % fc->align;
+  if (filler == 0) {
+    return fc;
+  }
+  while (filler < block_header + SC_SCDA_PADDING_MOD) {
+    /* the block section does not fit and we align to the next multiple */
+    filler += fc->align;
+  }
+
+  /* the block size is congruent to -7 and thus padded by 7 bytes */
+  block_size = filler - block_header - 7;
+  SC_ASSERT ((sc_MPI_Offset) filler == (sc_MPI_Offset) block_header +
+             sc_scda_section_data_bytes ('B', 0, block_size));
+
+  /* the block data is only accessed on the root */
+  sc_array_init_size (&block, block_size,
+                      fc->mpirank == SC_SCDA_HEADER_ROOT ? 1 : 0);
+  if (fc->mpirank == SC_SCDA_HEADER_ROOT) {
+    memset (block.array, ' ', block_size);
+  }
+  fc->index_nested = 1;
+  fc = sc_scda_fwrite_block (fc, SC_SCDA_ALIGN_STRING, NULL, &block,
+                             block_size, SC_SCDA_HEADER_ROOT, 0, errcode);
+  sc_array_reset (&block);
+  if (fc != NULL) {
+    fc->index_nested = 0;
+  }
+
+  return fc;
+}
+
+sc_scda_fcontext_t *
+sc_scda_fwrite_array (sc_scda_fcontext_t *fc, const char *user_string,
+                      size_t *len, sc_array_t *array_data,
+                      sc_array_t *elem_counts, size_t elem_size, int indirect,
+                      int encode, sc_scda_ferror_t *errcode)
+{
+  int                 mpiret;
+  int                 count_err;
+  int                 write_count;
+  size_t              bytes_to_write;
+  int                 count;
+  int                 batched, short_calls;
+  int                 last_byte_owner;
+  sc_scda_ret_t       scdaret;
+  size_t              elem_count;
+  size_t              collective_byte_count;
+  size_t              num_pad_bytes;
+  sc_MPI_Offset       offset;
+#ifdef SC_ENABLE_MPI
+  void               *base_address;
+#endif
+  const void         *local_array_data;
+  sc_MPI_Datatype     type;
+
+  SC_ASSERT (fc != NULL);
+  SC_ASSERT (user_string != NULL);
+  SC_ASSERT (array_data != NULL);
+  SC_ASSERT (elem_counts != NULL);
+  SC_ASSERT (errcode != NULL);
+
+  /* the file is not accessed while a staged write is in progress */
+  if (sc_scda_fwrite_complete (fc, errcode) == NULL) {
+    return NULL;
+  }
+
+  if (!encode && !fc->index_nested) {
+    /* the alignment is a property of the file, not of a section */
+    if (sc_scda_fwrite_align (fc, errcode) == NULL) {
+      return NULL;
+    }
+  }
+
+  sc_scda_index_add (fc, 'A', user_string, len, elem_counts, elem_size,
+                     encode);
+
+  if (encode) {
+    /* compressed data according to the scda encoding convention */
+    fc->index_nested = 1;
+    fc = sc_scda_fwrite_array_encode (fc, user_string, len, array_data,
+                                      elem_counts, elem_size, indirect,
+                                      errcode);
+    if (fc != NULL) {
+      fc->index_nested = 0;
+    }
+    return fc;
+  }
+
+  /* check function parameters */
+  scdaret = sc_scda_check_array_params (fc, array_data, indirect, elem_counts,
+                                        elem_size, &elem_count);
+  sc_scda_scdaret_to_errcode (scdaret, errcode, fc);
+  SC_SCDA_CHECK_COLL_ERR (errcode, fc, "fwrite_array: Invalid parameters");
+
+  /* section header is always written and read on rank SC_SCDA_HEADER_ROOT */
+  if (fc->mpirank == SC_SCDA_HEADER_ROOT) {
+    sc_scda_fwrite_array_header_serial (fc, user_string, len, elem_count,
+                                        elem_size, &count_err, errcode);
+  }
+  SC_SCDA_HANDLE_NONCOLL_ERR (errcode, SC_SCDA_HEADER_ROOT, fc);
+  SC_SCDA_HANDLE_NONCOLL_COUNT_ERR (errcode, &count_err, SC_SCDA_HEADER_ROOT,
+                                    fc);
+
+  /* add number of written bytes */
+  fc->accessed_bytes += SC_SCDA_COMMON_FIELD + 2 * SC_SCDA_COUNT_FIELD;
+
+  /* retrieve partition information */
+  sc_scda_get_local_partition_index (fc, elem_counts, elem_size, &offset,
+                                     &bytes_to_write);
+
+  if (sc_scda_fwrite_array_fits_behind (fc, elem_counts, elem_size)) {
+    /* copy the data and padding and return while they are written */
+    if (sc_scda_fwrite_array_behind (fc, array_data, elem_counts, elem_count,
+                                     elem_size, indirect, offset,
+                                     (int) bytes_to_write, errcode) == NULL) {
+      return NULL;
+    }
+
+    /* update global number of written bytes */
+    collective_byte_count = elem_count * elem_size;
+    num_pad_bytes = sc_scda_pad_to_mod_len (collective_byte_count);
+    fc->accessed_bytes += (sc_MPI_Offset) (collective_byte_count +
+                                           num_pad_bytes);
+
+    return fc;
+  }
+
+#ifdef SC_ENABLE_MPI
+  batched = fc->batch_bytes > 0;
 #else
-    /* free the custom MPI data type */
-    SC_ASSERT (type != sc_MPI_BYTE);
-    mpiret = MPI_Type_free (&type);
-    SC_CHECK_MPI (mpiret);
+  /* without MPI we can not use custom MPI data types */
+  batched = fc->batch_bytes > 0 || indirect;
 #endif
+  if (!sc_scda_partition_fits_int (fc, elem_counts, elem_size)) {
+    /* a single call transfers at most INT_MAX bytes */
+    batched = 1;
+  }
+  if (batched) {
+    /* write array data in parallel and in batches */
+    mpiret = sc_scda_array_batches (fc, 1, array_data, indirect, elem_size,
+                                    fc->accessed_bytes + offset,
+                                    &short_calls);
+    sc_scda_mpiret_to_errcode (mpiret, errcode, fc);
+    SC_SCDA_CHECK_COLL_ERR (errcode, fc, "Writing fixed-length array data");
+    /* check for count errors of the collective I/O operations */
+    SC_SCDA_CHECK_COLL_COUNT_ERR (0, short_calls, fc, errcode);
+  }
+  else {
+    /* get data type and (base) pointer to local array data */
+    if (!indirect) {
+      /* direct addressing */
+      local_array_data = (const void *) array_data->array;
+      /* we use the given contiguous byte array */
+      type = sc_MPI_BYTE;
+      SC_ASSERT (bytes_to_write <= (size_t) INT_MAX);
+      write_count = (int) bytes_to_write;
+    }
+#ifdef SC_ENABLE_MPI
+    else {
+      /* get MPI datatype for potentially discontiguous data */
+      sc_scda_get_indirect_type (fc, array_data, elem_counts, &base_address,
+                                 &type);
+      /* set pointer to the local base array element if there are local
+       * elements */
+      local_array_data = (const void *) base_address;
+      /* one entity of the custom MPI data type represents the local data */
+      write_count = (bytes_to_write > 0) ? 1 : 0;
+    }
+#else
+    else {
+      /* without MPI indirect data is always written in batches */
+      SC_ABORT_NOT_REACHED ();
+    }
+#endif
+
+    /* local_array_data == NULL must be sufficient for write_count == 0 */
+    SC_ASSERT (local_array_data != NULL || write_count == 0);
+
+    /* write array data in parallel */
+    mpiret = sc_io_write_at_all (fc->file, fc->accessed_bytes + offset,
+                                 local_array_data, write_count, type, &count);
+#ifdef SC_ENABLE_MPI
+    if (indirect) {
+      int                 typeret;
+
+      /* free the custom MPI data type */
+      SC_ASSERT (type != sc_MPI_BYTE);
+      typeret = MPI_Type_free (&type);
+      SC_CHECK_MPI (typeret);
+    }
+#endif
+    sc_scda_mpiret_to_errcode (mpiret, errcode, fc);
+    SC_SCDA_CHECK_COLL_ERR (errcode, fc, "Writing fixed-length array data");
+    /* check for count error of the collective I/O operation */
+    SC_SCDA_CHECK_COLL_COUNT_ERR (write_count, count, fc, errcode);
   }
-  sc_scda_mpiret_to_errcode (mpiret, errcode, fc);
-  SC_SCDA_CHECK_COLL_ERR (errcode, fc, "Writing fixed-length array data");
-  /* check for count error of the collective I/O operation */
-  SC_SCDA_CHECK_COLL_COUNT_ERR (write_count, count, fc, errcode);
 
   /* update global number of written bytes */
   collective_byte_count = elem_count * elem_size;
@@ -2463,10 +3356,15 @@ sc_scda_fwrite_array (sc_scda_fcontext_t *fc, const char *user_string,
   if (fc->mpirank == last_byte_owner) {
     const char         *last_byte;
 
-    /* get last local/global byte */
-    SC_ASSERT (elem_count == 0 || bytes_to_write > 0);
-    last_byte = (elem_count > 0) ?
-      &array_data->array[bytes_to_write - 1] : NULL;
+    /* get last local/global byte; indirect elements are separate arrays */
+    last_byte = NULL;
+    if (collective_byte_count > 0) {
+      SC_ASSERT (array_data->elem_count > 0);
+      last_byte = indirect ? ((sc_array_t *) sc_array_index
+                              (array_data, array_data->elem_count - 1))->array
+        : array_data->array + (array_data->elem_count - 1) * elem_size;
+      last_byte += elem_size - 1;
+    }
     /* the padding depends on the last data byte */
     sc_scda_fwrite_mod_padding_serial (fc, last_byte, collective_byte_count,
                                        &count_err, errcode);
@@ -2651,7 +3549,8 @@ sc_scda_fopen_read (sc_MPI_Comm mpicomm,
   }
 
   /* open the file in reading mode */
-  mpiret = sc_io_open (mpicomm, filename, SC_IO_READ, info, &fc->file);
+  mpiret = sc_io_open_striped (mpicomm, filename, SC_IO_READ, info,
+                               &fc->stripe, &fc->file);
   sc_scda_mpiret_to_errcode (mpiret, errcode, fc);
   /* The macro to check errcode after a collective function call.
    * More information can be found in the comments in \ref sc_scda_fopen_write
@@ -2689,6 +3588,9 @@ sc_scda_fopen_read (sc_MPI_Comm mpicomm,
   fc->header_before = 0;
   fc->last_type = '\0';
 
+  /* the section index is only written */
+  fc->write_index = 0;
+
   return fc;
 }
 
@@ -3004,11 +3906,15 @@ sc_scda_fread_array_header_serial (sc_scda_fcontext_t *fc, size_t *elem_count,
   fc->accessed_bytes += SC_SCDA_COUNT_FIELD;
 }
 
-sc_scda_fcontext_t *
-sc_scda_fread_section_header (sc_scda_fcontext_t *fc, char *user_string,
-                              size_t *len, char *type, size_t *elem_count,
-                              size_t *elem_size, int *decode,
-                              sc_scda_ferror_t *errcode)
+/** Read a section header without interpreting the encoding convention.
+ *
+ * The parameters are as for \ref sc_scda_fread_section_header except of
+ * the missing \b decode parameter.
+ */
+static sc_scda_fcontext_t *
+sc_scda_fread_section_header_raw (sc_scda_fcontext_t *fc, char *user_string,
+                                  size_t *len, char *type, size_t *elem_count,
+                                  size_t *elem_size, sc_scda_ferror_t *errcode)
 {
   int                 count_err;
   int                 mpiret;
@@ -3018,7 +3924,6 @@ sc_scda_fread_section_header (sc_scda_fcontext_t *fc, char *user_string,
   SC_ASSERT (type != NULL);
   SC_ASSERT (elem_count != NULL);
   SC_ASSERT (elem_size != NULL);
-  SC_ASSERT (decode != NULL);
   SC_ASSERT (errcode != NULL);
 
   *elem_count = 0;
@@ -3069,7 +3974,6 @@ sc_scda_fread_section_header (sc_scda_fcontext_t *fc, char *user_string,
   /* set global outputs and Bcast the counts if it is necessary */
   switch (*type) {
   /* set elem_count and elem_size according to the scda convention */
-  /* TODO: Handle decode parameter */
   case 'I':
     /* inline */
     *elem_count = 0;
@@ -3106,6 +4010,10 @@ sc_scda_fread_section_header (sc_scda_fcontext_t *fc, char *user_string,
     SC_ABORT_NOT_REACHED ();
   }
 
+  /* the counts are needed to read parts of the section */
+  fc->section_count = *elem_count;
+  fc->section_size = *elem_size;
+
   /* this is to check if the scda workflow is respected */
   fc->header_before = 1;
   fc->last_type = *type;
@@ -3113,6 +4021,92 @@ sc_scda_fread_section_header (sc_scda_fcontext_t *fc, char *user_string,
   return fc;
 }
 
+sc_scda_fcontext_t *
+sc_scda_fread_section_header (sc_scda_fcontext_t *fc, char *user_string,
+                              size_t *len, char *type, size_t *elem_count,
+                              size_t *elem_size, int *decode,
+                              sc_scda_ferror_t *errcode)
+{
+  int                 mpiret;
+  int                 invalid_encoding;
+  char                encoded_type;
+  char                meta[SC_SCDA_INLINE_FIELD];
+  size_t              decoded_size;
+  sc_MPI_Offset       inline_offset;
+  sc_array_t          meta_data;
+
+  SC_ASSERT (fc != NULL);
+  SC_ASSERT (decode != NULL);
+
+  /* a new section is read raw until we find the encoding convention */
+  fc->decode_type = 0;
+
+  fc = sc_scda_fread_section_header_raw (fc, user_string, len, type,
+                                         elem_count, elem_size, errcode);
+  if (fc == NULL) {
+    return NULL;
+  }
+
+  while (*decode && *type == 'B' && !strcmp (user_string,
+                                             SC_SCDA_ALIGN_STRING)) {
+    /* skip the block that aligns the following array data */
+    fc->accessed_bytes += sc_scda_section_data_bytes ('B', 0, *elem_size);
+    fc->header_before = 0;
+    fc = sc_scda_fread_section_header_raw (fc, user_string, len, type,
+                                           elem_count, elem_size, errcode);
+    if (fc == NULL) {
+      return NULL;
+    }
+  }
+
+  if (!*decode || *type != 'I' || strcmp (user_string, SC_SCDA_ENCODE_STRING)) {
+    /* the section is read raw */
+    *decode = 0;
+    return fc;
+  }
+
+  /* read the inline data that describes the encoded section */
+  inline_offset = fc->accessed_bytes;
+  sc_array_init_data (&meta_data, meta, SC_SCDA_INLINE_FIELD, 1);
+  fc = sc_scda_fread_inline_data (fc, &meta_data, SC_SCDA_HEADER_ROOT,
+                                  errcode);
+  if (fc == NULL) {
+    return NULL;
+  }
+  mpiret = sc_MPI_Bcast (meta, SC_SCDA_INLINE_FIELD, sc_MPI_BYTE,
+                         SC_SCDA_HEADER_ROOT, fc->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  if (sc_scda_check_encode_header (meta, &encoded_type, &decoded_size)) {
+    /* the convention is not satisfied and we read the inline section raw */
+    fc->accessed_bytes = inline_offset;
+    fc->header_before = 1;
+    fc->last_type = 'I';
+    *decode = 0;
+    return fc;
+  }
+
+  /* the next section contains the user string and the compressed data */
+  fc = sc_scda_fread_section_header_raw (fc, user_string, len, type,
+                                         elem_count, elem_size, errcode);
+  if (fc == NULL) {
+    return NULL;
+  }
+  invalid_encoding = (encoded_type == 'B') ? *type != 'B' :
+    (*type != 'A' || *elem_size != SC_SCDA_ENCODE_SIZE_BYTES);
+  sc_scda_scdaret_to_errcode (invalid_encoding ? SC_SCDA_FERR_DECODE :
+                              SC_SCDA_FERR_SUCCESS, errcode, fc);
+  SC_SCDA_CHECK_COLL_ERR (errcode, fc, "Invalid encoded file section");
+
+  /* the data reading functions decompress transparently */
+  fc->decode_type = encoded_type;
+  fc->decode_size = decoded_size;
+  fc->encoded_size = *elem_size;
+  *elem_size = decoded_size;
+  *decode = 1;
+
+  return fc;
+}
+
 /** Internal function to read the inline data.
  *
  * \param [in] fc           The file context as in \ref
@@ -3316,6 +4310,70 @@ sc_scda_fread_block_data_serial (sc_scda_fcontext_t *fc, sc_array_t *data,
   SC_SCDA_CHECK_NONCOLL_COUNT_ERR (fc->log_level, block_size, count, count_err);
 }
 
+/** Read and decompress the data of an encoded block section.
+ *
+ * The parameters are as for \ref sc_scda_fread_block_data.
+ */
+static sc_scda_fcontext_t *
+sc_scda_fread_block_decode (sc_scda_fcontext_t *fc, sc_array_t *block_data,
+                            size_t block_size, int root,
+                            sc_scda_ferror_t *errcode)
+{
+  int                 mpiret;
+  int                 skip_data;
+  int                 invalid_data;
+  size_t              original_size;
+  sc_array_t          encoded, encoded_block;
+
+  /* the remaining reading functions work on the raw section */
+  fc->decode_type = 0;
+
+  sc_scda_scdaret_to_errcode (block_size != fc->decode_size ?
+                              SC_SCDA_FERR_ARG : SC_SCDA_FERR_SUCCESS,
+                              errcode, fc);
+  SC_SCDA_CHECK_COLL_ERR (errcode, fc, "fread_block_data: block_size does "
+                          "not match the encoded section");
+
+  /* the data is skipped if it is skipped on root */
+  skip_data = block_data == NULL;
+  mpiret = sc_MPI_Bcast (&skip_data, 1, sc_MPI_INT, root, fc->mpicomm);
+  SC_CHECK_MPI (mpiret);
+
+  /* read the compressed block */
+  sc_array_init_size (&encoded, 1, (!skip_data && fc->mpirank == root) ?
+                      fc->encoded_size : 0);
+  sc_array_init_data (&encoded_block, encoded.array, fc->encoded_size, 1);
+  fc = sc_scda_fread_block_data (fc, skip_data ? NULL : &encoded_block,
+                                 fc->encoded_size, root, errcode);
+  if (fc == NULL) {
+    sc_array_reset (&encoded);
+    return NULL;
+  }
+
+  if (!skip_data) {
+    if (fc->mpirank == root) {
+      /* decompress into the user array */
+      invalid_data =
+        sc_io_decode_info (&encoded, &original_size, NULL, NULL) ||
+        original_size != block_size ||
+        (block_size > 0 && (sc_io_decode (&encoded, block_data, block_size,
+                                          NULL) ||
+                            block_data->elem_count != 1));
+      sc_scda_scdaret_to_errcode (invalid_data ? SC_SCDA_FERR_FORMAT :
+                                  SC_SCDA_FERR_SUCCESS, errcode, fc);
+      SC_SCDA_CHECK_VERBOSE_NONCOLL (fc->log_level, *errcode,
+                                     "Decompress block data");
+    }
+    sc_array_reset (&encoded);
+    SC_SCDA_HANDLE_NONCOLL_ERR (errcode, root, fc);
+  }
+  else {
+    sc_array_reset (&encoded);
+  }
+
+  return fc;
+}
+
 sc_scda_fcontext_t *
 sc_scda_fread_block_data (sc_scda_fcontext_t *fc, sc_array_t *block_data,
                           size_t block_size, int root,
@@ -3344,6 +4402,12 @@ sc_scda_fread_block_data (sc_scda_fcontext_t *fc, sc_array_t *block_data,
                               SC_SCDA_FERR_SUCCESS, errcode, fc);
   SC_SCDA_CHECK_COLL_ERR (errcode, fc, "Wrong usage of scda functions");
 
+  if (fc->decode_type == 'B') {
+    /* the section was written according to the scda encoding convention */
+    return sc_scda_fread_block_decode (fc, block_data, block_size, root,
+                                       errcode);
+  }
+
   if (block_data != NULL) {
     /* the data is not skipped */
     if (fc->mpirank == root) {
@@ -3379,24 +4443,161 @@ sc_scda_fread_block_data (sc_scda_fcontext_t *fc, sc_array_t *block_data,
   return fc;
 }
 
-sc_scda_fcontext_t *
-sc_scda_fread_array_data (sc_scda_fcontext_t *fc, sc_array_t *array_data,
-                          sc_array_t *elem_counts, size_t elem_size,
-                          int indirect, sc_scda_ferror_t *errcode)
+/** Read and decompress the data of an encoded fixed-size array section.
+ *
+ * We read the compressed sizes of the local elements, derive the partition
+ * of the compressed data from them and decompress every element separately.
+ * The parameters are as for \ref sc_scda_fread_array_data.
+ */
+static sc_scda_fcontext_t *
+sc_scda_fread_array_decode (sc_scda_fcontext_t *fc, sc_array_t *array_data,
+                            sc_array_t *elem_counts, size_t elem_size,
+                            int indirect, sc_scda_ferror_t *errcode)
 {
-  int                 wrong_usage;
-  size_t              elem_count;
-  size_t              collective_byte_count;
-  sc_MPI_Offset       offset;
-  sc_scda_ret_t       scdaret;
-  int                 bytes_to_read, read_count;
   int                 mpiret;
-  int                 count;
+  int                 invalid_data, global_invalid_data;
+  int                 skip_data;
+  char                type;
+  char                user_string[SC_SCDA_USER_STRING_BYTES + 1];
+  size_t              len;
+  size_t              si, num_elements, elem_count, byte_size;
+  size_t              pos, encoded_elem_size;
+  sc_scda_ulong       local_bytes, global_bytes;
+  sc_array_t          sizes, encoded, byte_counts;
+  sc_array_t          in, out, *out_arr;
+
+  /* the remaining reading functions work on the raw sections */
+  fc->decode_type = 0;
+
+  sc_scda_scdaret_to_errcode (elem_size != fc->decode_size ?
+                              SC_SCDA_FERR_ARG : SC_SCDA_FERR_SUCCESS,
+                              errcode, fc);
+  SC_SCDA_CHECK_COLL_ERR (errcode, fc, "fread_array_data: elem_size does "
+                          "not match the encoded section");
+
+  /* read the compressed sizes of the local elements */
+  num_elements = (size_t) *((sc_scda_ulong *)
+                            sc_array_index_int (elem_counts, fc->mpirank));
+  sc_array_init_size (&sizes, SC_SCDA_ENCODE_SIZE_BYTES, num_elements);
+  fc = sc_scda_fread_array_data (fc, &sizes, elem_counts,
+                                 SC_SCDA_ENCODE_SIZE_BYTES, 0, errcode);
+  if (fc == NULL) {
+    sc_array_reset (&sizes);
+    return NULL;
+  }
+
+  /* the local compressed byte counts partition the compressed data */
+  local_bytes = 0;
+  for (si = 0; si < num_elements; ++si) {
+    local_bytes += sc_scda_bytes_to_ulong ((const char *)
+                                           sc_array_index (&sizes, si));
+  }
+  sc_array_init_size (&byte_counts, sizeof (sc_scda_ulong),
+                      (size_t) fc->mpisize);
+  mpiret = sc_MPI_Allgather (&local_bytes, sizeof (sc_scda_ulong),
+                             sc_MPI_BYTE, byte_counts.array,
+                             sizeof (sc_scda_ulong), sc_MPI_BYTE,
+                             fc->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  global_bytes = 0;
+  for (si = 0; si < byte_counts.elem_count; ++si) {
+    global_bytes += *((sc_scda_ulong *) sc_array_index (&byte_counts, si));
+  }
+
+  /* the compressed data follows in a byte array section */
+  fc = sc_scda_fread_section_header_raw (fc, user_string, &len, &type,
+                                         &elem_count, &byte_size, errcode);
+  if (fc == NULL) {
+    sc_array_reset (&sizes);
+    sc_array_reset (&byte_counts);
+    return NULL;
+  }
+  invalid_data = !(type == 'A' && byte_size == 1 &&
+                   (sc_scda_ulong) elem_count == global_bytes &&
+                   !strcmp (user_string, SC_SCDA_ENCODE_STRING));
+  sc_scda_scdaret_to_errcode (invalid_data ? SC_SCDA_FERR_DECODE :
+                              SC_SCDA_FERR_SUCCESS, errcode, fc);
+  if (invalid_data) {
+    sc_array_reset (&sizes);
+    sc_array_reset (&byte_counts);
+  }
+  SC_SCDA_CHECK_COLL_ERR (errcode, fc, "Invalid encoded array section");
+
+  skip_data = array_data == NULL;
+  sc_array_init_size (&encoded, 1, skip_data ? 0 : (size_t) local_bytes);
+  fc = sc_scda_fread_array_data (fc, skip_data ? NULL : &encoded,
+                                 &byte_counts, 1, 0, errcode);
+  sc_array_reset (&byte_counts);
+  if (fc == NULL) {
+    sc_array_reset (&sizes);
+    sc_array_reset (&encoded);
+    return NULL;
+  }
+
+  /* decompress every local element */
+  invalid_data = 0;
+  pos = 0;
+  for (si = 0; !skip_data && !invalid_data && si < num_elements; ++si) {
+    encoded_elem_size = (size_t) sc_scda_bytes_to_ulong ((const char *)
+                                                         sc_array_index
+                                                         (&sizes, si));
+    if (encoded_elem_size == 0 || pos + encoded_elem_size > local_bytes) {
+      invalid_data = 1;
+      break;
+    }
+    sc_array_init_data (&in, encoded.array + pos, 1, encoded_elem_size);
+    pos += encoded_elem_size;
+    if (elem_size == 0) {
+      /* there is no data to decompress */
+      invalid_data = sc_io_decode_info (&in, &byte_size, NULL, NULL) ||
+        byte_size != 0;
+      continue;
+    }
+    if (indirect) {
+      out_arr = (sc_array_t *) sc_array_index (array_data, si);
+      SC_ASSERT (out_arr->elem_size == elem_size
+                 && out_arr->elem_count == 1);
+    }
+    else {
+      sc_array_init_data (&out, sc_array_index (array_data, si), elem_size,
+                          1);
+      out_arr = &out;
+    }
+    invalid_data = sc_io_decode (&in, out_arr, elem_size, NULL) ||
+      out_arr->elem_count != 1;
+  }
+  sc_array_reset (&sizes);
+  sc_array_reset (&encoded);
+
+  /* synchronize */
+  mpiret = sc_MPI_Allreduce (&invalid_data, &global_invalid_data, 1,
+                             sc_MPI_INT, sc_MPI_LOR, fc->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  sc_scda_scdaret_to_errcode (global_invalid_data ? SC_SCDA_FERR_FORMAT :
+                              SC_SCDA_FERR_SUCCESS, errcode, fc);
+  SC_SCDA_CHECK_COLL_ERR (errcode, fc, "Decompress array data");
+
+  return fc;
+}
+
+sc_scda_fcontext_t *
+sc_scda_fread_array_data (sc_scda_fcontext_t *fc, sc_array_t *array_data,
+                          sc_array_t *elem_counts, size_t elem_size,
+                          int indirect, sc_scda_ferror_t *errcode)
+{
+  int                 wrong_usage;
+  size_t              elem_count;
+  size_t              collective_byte_count;
+  sc_MPI_Offset       offset;
+  sc_scda_ret_t       scdaret;
+  int                 read_count;
+  size_t              bytes_to_read;
+  int                 mpiret;
+  int                 count;
   int                 count_err;
+  int                 batched, short_calls;
   void               *data;
-#ifndef SC_ENABLE_MPI
-  sc_array_t          conti_arr;
-#else
+#ifdef SC_ENABLE_MPI
   void               *base_address;
 #endif
   sc_MPI_Datatype     type;
@@ -3418,6 +4619,12 @@ sc_scda_fread_array_data (sc_scda_fcontext_t *fc, sc_array_t *array_data,
                               SC_SCDA_FERR_SUCCESS, errcode, fc);
   SC_SCDA_CHECK_COLL_ERR (errcode, fc, "Wrong usage of scda functions");
 
+  if (fc->decode_type == 'A') {
+    /* the section was written according to the scda encoding convention */
+    return sc_scda_fread_array_decode (fc, array_data, elem_counts,
+                                       elem_size, indirect, errcode);
+  }
+
   if (array_data != NULL) {
     /* on this rank the array data is not skipped */
     sc_scda_get_local_partition_index (fc, elem_counts, elem_size, &offset,
@@ -3434,36 +4641,59 @@ sc_scda_fread_array_data (sc_scda_fcontext_t *fc, sc_array_t *array_data,
     data = NULL;
   }
 
-  /* set used MPI data type depending on MPI status and indirect parameter */
-  if (indirect && array_data != NULL) {
 #ifdef SC_ENABLE_MPI
-    /* get MPI datatype for potentially discontiguous data */
-    sc_scda_get_indirect_type (fc, array_data, elem_counts, &base_address,
-                               &type);
-    data = base_address;
-    read_count = (bytes_to_read > 0) ? 1 : 0;
+  batched = fc->batch_bytes > 0;
 #else
-    /* TODO: batches? */
-    /* read to contiguous temporary buffer */
-    sc_array_init_size (&conti_arr, elem_size, elem_count);
-    data = (void *) conti_arr.array;
-    type = sc_MPI_BYTE;
-    read_count = bytes_to_read;
+  /* without MPI we can not use custom MPI data types */
+  batched = fc->batch_bytes > 0 || indirect;
 #endif
+  if (!sc_scda_partition_fits_int (fc, elem_counts, elem_size)) {
+    /* a single call transfers at most INT_MAX bytes */
+    batched = 1;
+  }
+  if (batched) {
+    /* collective reads in batches */
+    mpiret = sc_scda_array_batches (fc, 0, array_data, indirect, elem_size,
+                                    fc->accessed_bytes + offset,
+                                    &short_calls);
+    sc_scda_mpiret_to_errcode (mpiret, errcode, fc);
+    SC_SCDA_CHECK_COLL_ERR (errcode, fc, "Reading fixed-length array data");
+    /* check for count errors of the collective I/O operations */
+    SC_SCDA_CHECK_COLL_COUNT_ERR (0, short_calls, fc, errcode);
   }
   else {
     /* read to passed data buffer, i.e. data stays unchanged */
     type = sc_MPI_BYTE;
-    read_count = bytes_to_read;
-  }
+    SC_ASSERT (bytes_to_read <= (size_t) INT_MAX);
+    read_count = (int) bytes_to_read;
+#ifdef SC_ENABLE_MPI
+    if (indirect && array_data != NULL) {
+      /* get MPI datatype for potentially discontiguous data */
+      sc_scda_get_indirect_type (fc, array_data, elem_counts, &base_address,
+                                 &type);
+      data = base_address;
+      read_count = (bytes_to_read > 0) ? 1 : 0;
+    }
+#endif
 
-  /* collective read */
-  mpiret = sc_io_read_at_all (fc->file, fc->accessed_bytes + offset,
-                              data, read_count, type, &count);
-  sc_scda_mpiret_to_errcode (mpiret, errcode, fc);
-  SC_SCDA_CHECK_COLL_ERR (errcode, fc, "Reading fixed-length array data");
-  /* check for count error of the collective I/O operation */
-  SC_SCDA_CHECK_COLL_COUNT_ERR (read_count, count, fc, errcode);
+    /* collective read */
+    mpiret = sc_io_read_at_all (fc->file, fc->accessed_bytes + offset,
+                                data, read_count, type, &count);
+#ifdef SC_ENABLE_MPI
+    if (indirect && array_data != NULL) {
+      int                 typeret;
+
+      /* free the custom MPI data type */
+      SC_ASSERT (type != sc_MPI_BYTE);
+      typeret = MPI_Type_free (&type);
+      SC_CHECK_MPI (typeret);
+    }
+#endif
+    sc_scda_mpiret_to_errcode (mpiret, errcode, fc);
+    SC_SCDA_CHECK_COLL_ERR (errcode, fc, "Reading fixed-length array data");
+    /* check for count error of the collective I/O operation */
+    SC_SCDA_CHECK_COLL_COUNT_ERR (read_count, count, fc, errcode);
+  }
 
   /* update internal file pointer */
   collective_byte_count = elem_count * elem_size;
@@ -3483,34 +4713,794 @@ sc_scda_fread_array_data (sc_scda_fcontext_t *fc, sc_array_t *array_data,
   fc->accessed_bytes +=
     (sc_MPI_Offset) sc_scda_pad_to_mod_len (collective_byte_count);
 
-  if (indirect && array_data != NULL) {
-  /* indirect addressing and data was not skipped on this rank */
-#ifndef SC_ENABLE_MPI
-    /* data was read to a contiguous buffer */
-    size_t              si;
-    sc_array_t         *curr;
-    const char         *src;
-    char               *dest;
+  /* last function call can not be \ref sc_scda_fread_section_header anymore */
+  fc->header_before = 0;
 
-    SC_ASSERT (type == sc_MPI_BYTE);
+  return fc;
+}
 
-    /* copy contiguous data to indirect array */
-    for (si = 0; si < array_data->elem_count; ++si) {
-      src = (const char *) sc_array_index (&conti_arr, si);
-      curr = (sc_array_t *) sc_array_index (array_data, si);
-      dest = (char *) sc_array_index (curr, 0);
+/** Parse a number of \ref SC_SCDA_INDEX_DIGITS decimal digits.
+ *
+ * \param [in]  field       \ref SC_SCDA_INDEX_DIGITS bytes.
+ * \param [out] value       The number on success.
+ * \return                  0 if \b field only contains digits and -1
+ *                          otherwise.
+ */
+static int
+sc_scda_index_number (const char *field, long long unsigned *value)
+{
+  int                 i;
+  char                digits[SC_SCDA_INDEX_DIGITS + 1];
 
-      sc_scda_copy_bytes (dest, src, elem_size);
+  for (i = 0; i < SC_SCDA_INDEX_DIGITS; ++i) {
+    if (!isdigit ((unsigned char) field[i])) {
+      return -1;
     }
-    sc_array_reset (&conti_arr);
-#else
-    /* data was read using a custom MPI data type */
-    SC_ASSERT (type != sc_MPI_BYTE);
-    mpiret = MPI_Type_free (&type);
-    SC_CHECK_MPI (mpiret);
-#endif
+    digits[i] = field[i];
+  }
+  digits[SC_SCDA_INDEX_DIGITS] = '\0';
+
+  return sscanf (digits, "%llu", value) == 1 ? 0 : -1;
+}
+
+/** Append the section index to a file that is written.
+ *
+ * The records are written as a block section on \ref SC_SCDA_HEADER_ROOT.
+ * It is followed by an inline section that holds the offset of the block
+ * section and ends the file. Both sections have the user string \ref
+ * SC_SCDA_INDEX_STRING. If no section was written, there is no index.
+ *
+ * \param [in,out] fc       The file context with write_index true.
+ * \param [out] errcode     An errcode that can be interpreted by \ref
+ *                          sc_scda_ferror_string or mapped to an error class
+ *                          by \ref sc_scda_ferror_class.
+ * \return                  As for \ref sc_scda_fwrite_inline.
+ */
+static sc_scda_fcontext_t *
+sc_scda_fwrite_index (sc_scda_fcontext_t *fc, sc_scda_ferror_t *errcode)
+{
+  char                pointer[SC_SCDA_INLINE_FIELD + 1];
+  size_t              block_size;
+  sc_MPI_Offset       index_offset;
+  sc_array_t         *index, block;
+
+  SC_ASSERT (fc->index != NULL);
+
+  /* the index sections are not recorded themselves */
+  index = fc->index;
+  fc->index = NULL;
+  fc->write_index = 0;
+  if (index->elem_count == 0) {
+    sc_array_destroy (index);
+    return fc;
   }
 
+  index_offset = fc->accessed_bytes;
+  block_size = index->elem_count * SC_SCDA_INDEX_ENTRY;
+  sc_array_init_data (&block, index->array, block_size, 1);
+  fc = sc_scda_fwrite_block (fc, SC_SCDA_INDEX_STRING, NULL, &block,
+                             block_size, SC_SCDA_HEADER_ROOT, 0, errcode);
+  sc_array_destroy (index);
+  if (fc == NULL) {
+    return NULL;
+  }
+
+  snprintf (pointer, SC_SCDA_INLINE_FIELD + 1, "%s%0*llu\n",
+            SC_SCDA_INDEX_POINTER, SC_SCDA_INDEX_DIGITS,
+            (long long unsigned) index_offset);
+  sc_array_init_data (&block, pointer, SC_SCDA_INLINE_FIELD, 1);
+  return sc_scda_fwrite_inline (fc, SC_SCDA_INDEX_STRING, NULL, &block,
+                                SC_SCDA_HEADER_ROOT, errcode);
+}
+
+/** Internal function to read the inline section that ends a file with index.
+ *
+ * \param [in] fc           The file context with the file size set.
+ * \param [out] index_offset The offset of the index block section or -1 if
+ *                          the file does not end with the index sections.
+ * \param [out] count_err   A Boolean indicating if a count error occurred.
+ * \param [out] errcode     An errcode that can be interpreted by \ref
+ *                          sc_scda_ferror_string or mapped to an error class
+ *                          by \ref sc_scda_ferror_class.
+ */
+static void
+sc_scda_fread_index_pointer_serial (sc_scda_fcontext_t *fc,
+                                    long long *index_offset, int *count_err,
+                                    sc_scda_ferror_t *errcode)
+{
+  const int           pointer_bytes =
+    SC_SCDA_COMMON_FIELD + SC_SCDA_INLINE_FIELD;
+  const size_t        prefix_len = strlen (SC_SCDA_INDEX_POINTER);
+  int                 mpiret;
+  int                 count;
+  char                expected[SC_SCDA_COMMON_FIELD];
+  char                pointer[SC_SCDA_COMMON_FIELD + SC_SCDA_INLINE_FIELD];
+  const char         *data = &pointer[SC_SCDA_COMMON_FIELD];
+  long long unsigned  read_offset;
+
+  *count_err = 0;
+  *index_offset = -1;
+
+  if (fc->file_size < SC_SCDA_HEADER_BYTES + pointer_bytes) {
+    /* the file has no room for the index sections */
+    sc_scda_scdaret_to_errcode (SC_SCDA_FERR_SUCCESS, errcode, fc);
+    return;
+  }
+
+  mpiret = sc_io_read_at (fc->file, fc->file_size - pointer_bytes, pointer,
+                          pointer_bytes, sc_MPI_BYTE, &count);
+  sc_scda_mpiret_to_errcode (mpiret, errcode, fc);
+  SC_SCDA_CHECK_NONCOLL_ERR (fc->log_level, errcode, "Read index pointer");
+  SC_SCDA_CHECK_NONCOLL_COUNT_ERR (fc->log_level, pointer_bytes, count,
+                                   count_err);
+
+  /* any other last section means that there is no index */
+  (void) sc_scda_get_common_section_header ('I', SC_SCDA_INDEX_STRING, NULL,
+                                            expected);
+  if (memcmp (pointer, expected, SC_SCDA_COMMON_FIELD) ||
+      strncmp (data, SC_SCDA_INDEX_POINTER, prefix_len) ||
+      data[SC_SCDA_INLINE_FIELD - 1] != '\n' ||
+      sc_scda_index_number (&data[prefix_len], &read_offset)) {
+    return;
+  }
+  *index_offset = (long long) read_offset;
+}
+
+/** Examine a file that is read for the section index.
+ *
+ * If the file ends with the index sections, the offsets of all sections are
+ * read. Otherwise, the sections are found by \ref sc_scda_fseek_section
+ * when they are needed.
+ *
+ * \param [in,out] fc       The file context without index.
+ * \param [out] errcode     An errcode that can be interpreted by \ref
+ *                          sc_scda_ferror_string or mapped to an error class
+ *                          by \ref sc_scda_ferror_class.
+ * \return                  As for \ref sc_scda_fseek_section.
+ */
+static sc_scda_fcontext_t *
+sc_scda_fread_index (sc_scda_fcontext_t *fc, sc_scda_ferror_t *errcode)
+{
+  const int           head = 3 + 3 * (SC_SCDA_INDEX_DIGITS + 1);
+  int                 mpiret;
+  int                 count_err;
+  int                 decode;
+  int                 invalid;
+  char                type;
+  char                user_string[SC_SCDA_USER_STRING_BYTES + 1];
+  const char         *record;
+  size_t              len, elem_count, block_size;
+  size_t              zi;
+  long long           index_offset;
+  long long unsigned  offset, previous;
+  sc_array_t         *block;
+
+  SC_ASSERT (fc->index == NULL);
+
+  mpiret = sc_io_get_size (fc->file, &fc->file_size);
+  sc_scda_mpiret_to_errcode (mpiret, errcode, fc);
+  SC_SCDA_CHECK_COLL_ERR (errcode, fc, "Get file size");
+
+  /* the sections are found by scanning unless there is an index */
+  fc->index = sc_array_new (sizeof (sc_MPI_Offset));
+  fc->index_complete = 0;
+  fc->index_end = SC_SCDA_HEADER_BYTES;
+
+  if (fc->mpirank == SC_SCDA_HEADER_ROOT) {
+    sc_scda_fread_index_pointer_serial (fc, &index_offset, &count_err,
+                                        errcode);
+  }
+  SC_SCDA_HANDLE_NONCOLL_ERR (errcode, SC_SCDA_HEADER_ROOT, fc);
+  SC_SCDA_HANDLE_NONCOLL_COUNT_ERR (errcode, &count_err, SC_SCDA_HEADER_ROOT,
+                                    fc);
+  mpiret = sc_MPI_Bcast (&index_offset, 1, sc_MPI_LONG_LONG_INT,
+                         SC_SCDA_HEADER_ROOT, fc->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  if (index_offset < 0) {
+    return fc;
+  }
+
+  /* read the index block section raw */
+  invalid = index_offset < SC_SCDA_HEADER_BYTES ||
+    index_offset >= (long long) fc->file_size;
+  sc_scda_scdaret_to_errcode (invalid ? SC_SCDA_FERR_FORMAT :
+                              SC_SCDA_FERR_SUCCESS, errcode, fc);
+  SC_SCDA_CHECK_COLL_ERR (errcode, fc, "Invalid section index pointer");
+  fc->accessed_bytes = (sc_MPI_Offset) index_offset;
+  fc->header_before = 0;
+  decode = 0;
+  fc = sc_scda_fread_section_header (fc, user_string, &len, &type,
+                                     &elem_count, &block_size, &decode,
+                                     errcode);
+  if (fc == NULL) {
+    return NULL;
+  }
+  invalid = type != 'B' || strcmp (user_string, SC_SCDA_INDEX_STRING) ||
+    block_size == 0 || block_size % SC_SCDA_INDEX_ENTRY != 0 ||
+    block_size > (size_t) INT_MAX;
+  sc_scda_scdaret_to_errcode (invalid ? SC_SCDA_FERR_FORMAT :
+                              SC_SCDA_FERR_SUCCESS, errcode, fc);
+  SC_SCDA_CHECK_COLL_ERR (errcode, fc, "Invalid section index");
+
+  block = sc_array_new_count (block_size, 1);
+  fc = sc_scda_fread_block_data (fc, block, block_size, SC_SCDA_HEADER_ROOT,
+                                 errcode);
+  if (fc == NULL) {
+    sc_array_destroy (block);
+    return NULL;
+  }
+  mpiret = sc_MPI_Bcast (block->array, (int) block_size, sc_MPI_BYTE,
+                         SC_SCDA_HEADER_ROOT, fc->mpicomm);
+  SC_CHECK_MPI (mpiret);
+
+  /* the section offsets increase and precede the index */
+  invalid = 0;
+  previous = 0;
+  for (zi = 0; !invalid && zi < block_size / SC_SCDA_INDEX_ENTRY; ++zi) {
+    record = block->array + zi * SC_SCDA_INDEX_ENTRY;
+    invalid = !(record[0] == 'I' || record[0] == 'B' || record[0] == 'A') ||
+      !(record[1] == 'E' || record[1] == '-') ||
+      record[2] != ' ' || record[head - 1] != ' ' ||
+      sc_scda_index_number (&record[3], &offset) ||
+      offset < (long long unsigned) SC_SCDA_HEADER_BYTES ||
+      offset <= previous || offset >= (long long unsigned) index_offset;
+    if (!invalid) {
+      *(sc_MPI_Offset *) sc_array_push (fc->index) = (sc_MPI_Offset) offset;
+      previous = offset;
+    }
+  }
+  sc_array_destroy (block);
+  sc_scda_scdaret_to_errcode (invalid ? SC_SCDA_FERR_FORMAT :
+                              SC_SCDA_FERR_SUCCESS, errcode, fc);
+  SC_SCDA_CHECK_COLL_ERR (errcode, fc, "Invalid section index record");
+
+  fc->index_complete = 1;
+  fc->index_end = (sc_MPI_Offset) index_offset;
+
+  return fc;
+}
+
+/** Skip a file section in the search for a section without index.
+ *
+ * Only the section headers are read and the data is skipped. A section
+ * that was written encoded is skipped as a whole.
+ *
+ * \param [in,out] fc       The file context at the start of a section.
+ * \param [out] errcode     An errcode that can be interpreted by \ref
+ *                          sc_scda_ferror_string or mapped to an error class
+ *                          by \ref sc_scda_ferror_class.
+ * \return                  As for \ref sc_scda_fseek_section.
+ */
+static sc_scda_fcontext_t *
+sc_scda_fskip_section (sc_scda_fcontext_t *fc, sc_scda_ferror_t *errcode)
+{
+  int                 decode;
+  char                type;
+  char                user_string[SC_SCDA_USER_STRING_BYTES + 1];
+  size_t              len, elem_count, elem_size;
+
+  decode = 1;
+  fc = sc_scda_fread_section_header (fc, user_string, &len, &type,
+                                     &elem_count, &elem_size, &decode,
+                                     errcode);
+  if (fc == NULL) {
+    return NULL;
+  }
+
+  switch (fc->decode_type) {
+  case 'B':
+    /* the compressed block */
+    fc->accessed_bytes += sc_scda_section_data_bytes ('B', 0,
+                                                      fc->encoded_size);
+    break;
+  case 'A':
+    /* the compressed sizes and the section of the compressed elements */
+    fc->accessed_bytes +=
+      sc_scda_section_data_bytes ('A', elem_count, SC_SCDA_ENCODE_SIZE_BYTES);
+    fc = sc_scda_fread_section_header_raw (fc, user_string, &len, &type,
+                                           &elem_count, &elem_size, errcode);
+    if (fc == NULL) {
+      return NULL;
+    }
+    fc->accessed_bytes += sc_scda_section_data_bytes (type, elem_count,
+                                                      elem_size);
+    break;
+  default:
+    fc->accessed_bytes += sc_scda_section_data_bytes (type, elem_count,
+                                                      elem_size);
+  }
+
+  fc->header_before = 0;
+  fc->decode_type = 0;
+
+  return fc;
+}
+
+sc_scda_fcontext_t *
+sc_scda_fseek_section (sc_scda_fcontext_t *fc, size_t section,
+                       sc_scda_ferror_t *errcode)
+{
+  int                 out_of_range;
+  sc_scda_ret_t       ret;
+  sc_MPI_Offset       offset;
+
+  SC_ASSERT (fc != NULL);
+  SC_ASSERT (errcode != NULL);
+
+  /* check if section is collective */
+  ret = sc_scda_check_coll_params (fc, (const char *) &section,
+                                   sizeof (size_t), NULL, 0, NULL, 0);
+  sc_scda_scdaret_to_errcode (ret, errcode, fc);
+  SC_SCDA_CHECK_COLL_ERR (errcode, fc, "fseek_section: section is not "
+                          "collective");
+
+  if (fc->index == NULL) {
+    /* look for the section index on the first call */
+    fc = sc_scda_fread_index (fc, errcode);
+    if (fc == NULL) {
+      return NULL;
+    }
+  }
+
+  /* without index the sections are found once by reading their headers */
+  while (!fc->index_complete && fc->index->elem_count <= section) {
+    if (fc->index_end >= fc->file_size) {
+      fc->index_complete = 1;
+      break;
+    }
+    offset = fc->index_end;
+    fc->accessed_bytes = offset;
+    fc->header_before = 0;
+    fc = sc_scda_fskip_section (fc, errcode);
+    if (fc == NULL) {
+      return NULL;
+    }
+    *(sc_MPI_Offset *) sc_array_push (fc->index) = offset;
+    fc->index_end = fc->accessed_bytes;
+  }
+
+  out_of_range = section >= fc->index->elem_count;
+  sc_scda_scdaret_to_errcode (out_of_range ? SC_SCDA_FERR_ARG :
+                              SC_SCDA_FERR_SUCCESS, errcode, fc);
+  SC_SCDA_CHECK_COLL_ERR (errcode, fc, "fseek_section: section does not "
+                          "exist");
+
+  /* the next call must be sc_scda_fread_section_header */
+  fc->accessed_bytes = *(sc_MPI_Offset *) sc_array_index (fc->index,
+                                                          section);
+  fc->header_before = 0;
+  fc->decode_type = 0;
+
+  return fc;
+}
+
+/** Read the elements of global ranges of an array section independently.
+ *
+ * Ranges that continue the preceding range are joined. Every read call
+ * transfers whole elements, at most \b fc->batch_bytes bytes if this is
+ * positive and at most INT_MAX bytes. Indirect and encoded data is read
+ * through a buffer of one call.
+ *
+ * \param [in] fc           The file context.
+ * \param [out] array_data  As for \ref sc_scda_fread_array_ranges.
+ * \param [in] ranges       Valid ranges as for \ref
+ *                          sc_scda_fread_array_ranges.
+ * \param [in] elem_size    The positive byte count of an element.
+ * \param [in] indirect     As for \ref sc_scda_fread_array_ranges.
+ * \param [in] offset       The file offset of the possibly compressed data.
+ * \param [in] bounds       NULL for raw data. Otherwise, the entries 2 j
+ *                          and 2 j + 1 are the begin and end positions in
+ *                          the compressed data of the j-th requested
+ *                          element in the order of the ranges.
+ * \param [out] short_reads The number of reads that returned less bytes.
+ * \param [out] invalid_data True if an element is too large or can not be
+ *                          decompressed.
+ * \return                  The error code of the first failed read or
+ *                          sc_MPI_SUCCESS.
+ */
+static int
+sc_scda_fread_ranges_local (sc_scda_fcontext_t *fc, sc_array_t *array_data,
+                            sc_array_t *ranges, size_t elem_size,
+                            int indirect, sc_MPI_Offset offset,
+                            const sc_scda_ulong *bounds, int *short_reads,
+                            int *invalid_data)
+{
+  int                 mpiret;
+  int                 bytes, count;
+  size_t              ri, si, pos, first, remaining, n;
+  size_t              limit, begin, end, buffer_size;
+  const sc_scda_ulong *range;
+  char               *buffer, *data, *dest;
+  sc_array_t          in, out;
+
+  SC_ASSERT (elem_size > 0);
+
+  limit = (size_t) INT_MAX;
+  if (fc->batch_bytes > 0) {
+    limit = SC_MIN (fc->batch_bytes, limit);
+  }
+
+  *short_reads = 0;
+  *invalid_data = 0;
+  buffer = NULL;
+  buffer_size = 0;
+  pos = 0;
+  ri = 0;
+  while (ri < ranges->elem_count) {
+    /* join the ranges that continue this one */
+    range = (const sc_scda_ulong *) sc_array_index (ranges, ri);
+    first = (size_t) range[0];
+    remaining = (size_t) range[1];
+    for (++ri; ri < ranges->elem_count; ++ri) {
+      range = (const sc_scda_ulong *) sc_array_index (ranges, ri);
+      if ((size_t) range[0] != first + remaining) {
+        break;
+      }
+      remaining += (size_t) range[1];
+    }
+
+    while (remaining > 0) {
+      /* the number of elements of this read */
+      if (bounds == NULL) {
+        n = SC_MAX (SC_MIN (remaining, limit / elem_size), 1);
+        begin = first * elem_size;
+        end = begin + n * elem_size;
+      }
+      else {
+        /* the compressed elements of joined ranges are contiguous */
+        for (n = 1; n < remaining &&
+             (size_t) (bounds[2 * (pos + n) + 1] - bounds[2 * pos]) <= limit;
+             ++n);
+        begin = (size_t) bounds[2 * pos];
+        end = (size_t) bounds[2 * (pos + n - 1) + 1];
+      }
+      if (end - begin > (size_t) INT_MAX) {
+        /* a single element is too large */
+        *invalid_data = 1;
+        SC_FREE (buffer);
+        return sc_MPI_SUCCESS;
+      }
+      bytes = (int) (end - begin);
+
+      /* direct raw data is read in place */
+      if (bounds == NULL && !indirect) {
+        data = array_data->array + pos * elem_size;
+      }
+      else {
+        if (buffer_size < end - begin) {
+          buffer_size = end - begin;
+          buffer = SC_REALLOC (buffer, char, buffer_size);
+        }
+        data = buffer;
+      }
+      mpiret = sc_io_read_at (fc->file, offset + (sc_MPI_Offset) begin, data,
+                              bytes, sc_MPI_BYTE, &count);
+      if (mpiret != sc_MPI_SUCCESS || count != bytes) {
+        *short_reads = (mpiret == sc_MPI_SUCCESS);
+        SC_FREE (buffer);
+        return mpiret;
+      }
+
+      /* copy or decompress the elements of this read */
+      for (si = 0; data == buffer && si < n; ++si) {
+        if (indirect) {
+          sc_array_t         *arr;
+
+          arr = (sc_array_t *) sc_array_index (array_data, pos + si);
+          SC_ASSERT (arr->elem_size == elem_size && arr->elem_count == 1);
+          dest = arr->array;
+        }
+        else {
+          dest = array_data->array + (pos + si) * elem_size;
+        }
+        if (bounds == NULL) {
+          sc_scda_copy_bytes (dest, buffer + si * elem_size, elem_size);
+          continue;
+        }
+        sc_array_init_data (&in, buffer + (bounds[2 * (pos + si)] - begin),
+                            1, (size_t) (bounds[2 * (pos + si) + 1] -
+                                         bounds[2 * (pos + si)]));
+        sc_array_init_data (&out, dest, elem_size, 1);
+        if (in.elem_count == 0 || sc_io_decode (&in, &out, elem_size, NULL)
+            || out.elem_count != 1) {
+          *invalid_data = 1;
+          SC_FREE (buffer);
+          return sc_MPI_SUCCESS;
+        }
+      }
+
+      first += n;
+      pos += n;
+      remaining -= n;
+    }
+  }
+
+  SC_FREE (buffer);
+  return sc_MPI_SUCCESS;
+}
+
+/** Get the first element of the slice of a process in an even partition.
+ *
+ * \param [in] count        The global element count.
+ * \param [in] mpisize      The number of processes.
+ * \param [in] rank         A process in [0, \b mpisize].
+ * \return                  The first global element of \b rank's slice or
+ *                          \b count for \b rank equal to \b mpisize.
+ */
+static size_t
+sc_scda_slice_begin (size_t count, int mpisize, int rank)
+{
+  return (size_t) rank * (count / (size_t) mpisize) +
+    SC_MIN ((size_t) rank, count % (size_t) mpisize);
+}
+
+/** Get the process whose slice of an even partition holds an element.
+ *
+ * \param [in] count        The global element count.
+ * \param [in] mpisize      The number of processes.
+ * \param [in] elem         A global element in [0, \b count).
+ * \return                  The process of \ref sc_scda_slice_begin that
+ *                          holds \b elem.
+ */
+static int
+sc_scda_slice_owner (size_t count, int mpisize, size_t elem)
+{
+  size_t              base, extra;
+
+  base = count / (size_t) mpisize;
+  extra = count % (size_t) mpisize;
+  if (elem < extra * (base + 1)) {
+    return (int) (elem / (base + 1));
+  }
+  SC_ASSERT (base > 0);
+  return (int) (extra + (elem - extra * (base + 1)) / base);
+}
+
+/** Locate requested elements of an encoded array in its compressed data.
+ *
+ * The compressed sizes are read in even slices, one per process, and the
+ * byte counts of the slices are gathered. For each range, a process then
+ * reads the sizes from the start of the slice that holds its first element
+ * up to its end. Hence, a process reads O(N / P) sizes per range instead
+ * of all sizes before its ranges, where N is the global element count and
+ * P the number of processes. The function is collective.
+ *
+ * \param [in] fc           The file context before the compressed sizes.
+ * \param [in] ranges       Valid ranges as for \ref
+ *                          sc_scda_fread_array_ranges.
+ * \param [out] bounds      Two entries per requested element as for \ref
+ *                          sc_scda_fread_ranges_local.
+ * \param [out] short_reads True if a read returned less bytes.
+ * \param [out] invalid_data True if the sizes do not add up.
+ * \return                  The error code of the first failed read or
+ *                          sc_MPI_SUCCESS.
+ */
+static int
+sc_scda_fread_encoded_bounds (sc_scda_fcontext_t *fc, sc_array_t *ranges,
+                              sc_scda_ulong *bounds, int *short_reads,
+                              int *invalid_data)
+{
+  int                 mpiret, retval;
+  int                 q;
+  long long           local_sum;
+  long long          *slice_sums;
+  size_t              count, begin, end, first, ri, si, pos;
+  sc_scda_ulong       sum, size;
+  sc_scda_ulong       span[2];
+  const sc_scda_ulong *range;
+  sc_array_t          sizes, whole;
+
+  count = fc->section_count;
+
+  /* every process reads the compressed sizes of its slice */
+  begin = sc_scda_slice_begin (count, fc->mpisize, fc->mpirank);
+  end = sc_scda_slice_begin (count, fc->mpisize, fc->mpirank + 1);
+  sc_array_init_size (&sizes, SC_SCDA_ENCODE_SIZE_BYTES, end - begin);
+  sc_array_init_data (&whole, span, 2 * sizeof (sc_scda_ulong), 1);
+  span[0] = (sc_scda_ulong) begin;
+  span[1] = (sc_scda_ulong) (end - begin);
+  retval = sc_MPI_SUCCESS;
+  if (end > begin) {
+    retval = sc_scda_fread_ranges_local (fc, &sizes, &whole,
+                                         SC_SCDA_ENCODE_SIZE_BYTES, 0,
+                                         fc->accessed_bytes, NULL,
+                                         short_reads, invalid_data);
+  }
+  local_sum = 0;
+  for (si = 0; retval == sc_MPI_SUCCESS && !*short_reads &&
+       si < sizes.elem_count; ++si) {
+    local_sum += (long long)
+      sc_scda_bytes_to_ulong ((const char *) sc_array_index (&sizes, si));
+  }
+  sc_array_reset (&sizes);
+
+  /* the compressed byte counts of all slices */
+  slice_sums = SC_ALLOC (long long, fc->mpisize);
+  mpiret = sc_MPI_Allgather (&local_sum, 1, sc_MPI_LONG_LONG_INT,
+                             slice_sums, 1, sc_MPI_LONG_LONG_INT,
+                             fc->mpicomm);
+  SC_CHECK_MPI (mpiret);
+
+  /* the sizes from the start of a slice locate the ranges within it */
+  pos = 0;
+  for (ri = 0; retval == sc_MPI_SUCCESS && !*short_reads &&
+       !*invalid_data && ri < ranges->elem_count; ++ri) {
+    range = (const sc_scda_ulong *) sc_array_index (ranges, ri);
+    if (range[1] == 0) {
+      continue;
+    }
+    first = (size_t) range[0];
+    q = sc_scda_slice_owner (count, fc->mpisize, first);
+    begin = sc_scda_slice_begin (count, fc->mpisize, q);
+    span[0] = (sc_scda_ulong) begin;
+    span[1] = (sc_scda_ulong) (first - begin) + range[1];
+    sc_array_init_size (&sizes, SC_SCDA_ENCODE_SIZE_BYTES,
+                        (size_t) span[1]);
+    retval = sc_scda_fread_ranges_local (fc, &sizes, &whole,
+                                         SC_SCDA_ENCODE_SIZE_BYTES, 0,
+                                         fc->accessed_bytes, NULL,
+                                         short_reads, invalid_data);
+    if (retval == sc_MPI_SUCCESS && !*short_reads) {
+      sum = 0;
+      for (; q > 0; --q) {
+        sum += (sc_scda_ulong) slice_sums[q - 1];
+      }
+      for (si = 0; si < sizes.elem_count; ++si) {
+        size = sc_scda_bytes_to_ulong ((const char *)
+                                       sc_array_index (&sizes, si));
+        if (begin + si >= first) {
+          bounds[2 * pos] = sum;
+          bounds[2 * pos + 1] = sum + size;
+          *invalid_data = *invalid_data || bounds[2 * pos + 1] < sum;
+          ++pos;
+        }
+        sum += size;
+      }
+    }
+    sc_array_reset (&sizes);
+  }
+  SC_FREE (slice_sums);
+
+  return retval;
+}
+
+sc_scda_fcontext_t *
+sc_scda_fread_array_ranges (sc_scda_fcontext_t *fc, sc_array_t *array_data,
+                            sc_array_t *ranges, size_t elem_size,
+                            int indirect, sc_scda_ferror_t *errcode)
+{
+  int                 mpiret, retval;
+  int                 wrong_usage;
+  int                 invalid, global_invalid;
+  int                 short_reads;
+  char                type;
+  char                user_string[SC_SCDA_USER_STRING_BYTES + 1];
+  size_t              len;
+  size_t              ri, si, num_elements;
+  size_t              elem_count, byte_size;
+  sc_scda_ret_t       ret;
+  const sc_scda_ulong *range;
+  sc_scda_ulong      *bounds;
+
+  SC_ASSERT (fc != NULL);
+  SC_ASSERT (ranges != NULL);
+  SC_ASSERT (errcode != NULL);
+
+  /* check if elem_size and indirect are collective */
+  ret = sc_scda_check_coll_params (fc, (const char *) &elem_size,
+                                   sizeof (size_t), (const char *) &indirect,
+                                   sizeof (int), NULL, 0);
+  sc_scda_scdaret_to_errcode (ret, errcode, fc);
+  SC_SCDA_CHECK_COLL_ERR (errcode, fc, "fread_array_ranges: elem_size or "
+                          "indirect is not collective");
+
+  /* It is necessary that sc_scda_fread_section_header was called as last
+   * function call on fc and that it returned the array (A) section type.
+   */
+  wrong_usage = !(fc->header_before && fc->last_type == 'A');
+  sc_scda_scdaret_to_errcode (wrong_usage ? SC_SCDA_FERR_USAGE :
+                              SC_SCDA_FERR_SUCCESS, errcode, fc);
+  SC_SCDA_CHECK_COLL_ERR (errcode, fc, "Wrong usage of scda functions");
+
+  sc_scda_scdaret_to_errcode (elem_size != (fc->decode_type == 'A' ?
+                                            fc->decode_size :
+                                            fc->section_size) ?
+                              SC_SCDA_FERR_ARG : SC_SCDA_FERR_SUCCESS,
+                              errcode, fc);
+  SC_SCDA_CHECK_COLL_ERR (errcode, fc, "fread_array_ranges: elem_size does "
+                          "not match the section");
+
+  /* the local ranges must be inside of the section and fit array_data */
+  invalid = ranges->elem_size != 2 * sizeof (sc_scda_ulong);
+  num_elements = 0;
+  for (ri = 0; !invalid && ri < ranges->elem_count; ++ri) {
+    range = (const sc_scda_ulong *) sc_array_index (ranges, ri);
+    invalid = range[0] > (sc_scda_ulong) fc->section_count ||
+      range[1] > (sc_scda_ulong) fc->section_count - range[0];
+    num_elements += (size_t) range[1];
+  }
+  if (!invalid && num_elements > 0) {
+    invalid = array_data == NULL || array_data->elem_count != num_elements ||
+      array_data->elem_size != (indirect ? sizeof (sc_array_t) : elem_size);
+  }
+  mpiret = sc_MPI_Allreduce (&invalid, &global_invalid, 1, sc_MPI_INT,
+                             sc_MPI_LOR, fc->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  sc_scda_scdaret_to_errcode (global_invalid ? SC_SCDA_FERR_ARG :
+                              SC_SCDA_FERR_SUCCESS, errcode, fc);
+  SC_SCDA_CHECK_COLL_ERR (errcode, fc, "fread_array_ranges: Invalid ranges");
+
+  retval = sc_MPI_SUCCESS;
+  short_reads = 0;
+  invalid = 0;
+  if (fc->decode_type != 'A') {
+    /* read the raw elements in place */
+    if (elem_size > 0) {
+      retval = sc_scda_fread_ranges_local (fc, array_data, ranges, elem_size,
+                                           indirect, fc->accessed_bytes, NULL,
+                                           &short_reads, &invalid);
+    }
+    fc->accessed_bytes += sc_scda_section_data_bytes ('A', fc->section_count,
+                                                      elem_size);
+  }
+  else {
+    /* the compressed sizes locate the requested compressed elements */
+    fc->decode_type = 0;
+    bounds = NULL;
+    if (elem_size > 0) {
+      bounds = SC_ALLOC (sc_scda_ulong, 2 * num_elements);
+      retval = sc_scda_fread_encoded_bounds (fc, ranges, bounds,
+                                             &short_reads, &invalid);
+    }
+    fc->accessed_bytes +=
+      sc_scda_section_data_bytes ('A', fc->section_count,
+                                  SC_SCDA_ENCODE_SIZE_BYTES);
+
+    /* the compressed data follows in a byte array section */
+    fc = sc_scda_fread_section_header_raw (fc, user_string, &len, &type,
+                                           &elem_count, &byte_size, errcode);
+    if (fc == NULL) {
+      SC_FREE (bounds);
+      return NULL;
+    }
+    global_invalid = !(type == 'A' && byte_size == 1 &&
+                       !strcmp (user_string, SC_SCDA_ENCODE_STRING));
+    sc_scda_scdaret_to_errcode (global_invalid ? SC_SCDA_FERR_DECODE :
+                                SC_SCDA_FERR_SUCCESS, errcode, fc);
+    if (global_invalid) {
+      SC_FREE (bounds);
+    }
+    SC_SCDA_CHECK_COLL_ERR (errcode, fc, "Invalid encoded array section");
+
+    if (bounds != NULL) {
+      for (si = 0; !invalid && si < num_elements; ++si) {
+        invalid = bounds[2 * si + 1] > (sc_scda_ulong) elem_count;
+      }
+      if (retval == sc_MPI_SUCCESS && !short_reads && !invalid) {
+        retval = sc_scda_fread_ranges_local (fc, array_data, ranges,
+                                             elem_size, indirect,
+                                             fc->accessed_bytes, bounds,
+                                             &short_reads, &invalid);
+      }
+      SC_FREE (bounds);
+    }
+    fc->accessed_bytes += sc_scda_section_data_bytes ('A', elem_count, 1);
+  }
+
+  /* synchronize the errors of the independent reads */
+  mpiret = sc_MPI_Allreduce (&retval, &global_invalid, 1, sc_MPI_INT,
+                             sc_MPI_MAX, fc->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  sc_scda_mpiret_to_errcode (global_invalid, errcode, fc);
+  SC_SCDA_CHECK_COLL_ERR (errcode, fc, "Reading array ranges");
+  SC_SCDA_CHECK_COLL_COUNT_ERR (0, short_reads, fc, errcode);
+  mpiret = sc_MPI_Allreduce (&invalid, &global_invalid, 1, sc_MPI_INT,
+                             sc_MPI_LOR, fc->mpicomm);
+  SC_CHECK_MPI (mpiret);
+  sc_scda_scdaret_to_errcode (global_invalid ? SC_SCDA_FERR_FORMAT :
+                              SC_SCDA_FERR_SUCCESS, errcode, fc);
+  SC_SCDA_CHECK_COLL_ERR (errcode, fc, "Decompress array ranges");
+
   /* last function call can not be \ref sc_scda_fread_section_header anymore */
   fc->header_before = 0;
 
@@ -3525,6 +5515,21 @@ sc_scda_fclose (sc_scda_fcontext_t * fc, sc_scda_ferror_t * errcode)
   SC_ASSERT (fc != NULL);
   SC_ASSERT (errcode != NULL);
 
+  /* report errors of a staged write; on error fc is already freed */
+  if (sc_scda_fwrite_complete (fc, errcode) == NULL) {
+    return -1;
+  }
+  if (fc->write_index) {
+    /* append the section index; on error fc is already freed */
+    if (sc_scda_fwrite_index (fc, errcode) == NULL) {
+      return -1;
+    }
+  }
+  SC_FREE (fc->staging);
+  if (fc->index != NULL) {
+    sc_array_destroy (fc->index);
+  }
+
   mpiret = sc_io_close (&fc->file);
   sc_scda_mpiret_to_errcode (mpiret, errcode, fc);
   /* Since this function does not return NULL in case of an error, closes the
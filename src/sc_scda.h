@@ -112,14 +112,24 @@
  * The compression for writing can be enabled by passing true for \b encode to
  * one of the functions
  *
- * - \ref sc_scda_fwrite_inline,
  * - \ref sc_scda_fwrite_block,
  * - \ref sc_scda_fwrite_array and
  * - \ref sc_scda_fwrite_varray.
  *
  * The compression on writing can be decided by the user for each file section
  * separately. All parameters on the size of the data written to the file refer
- * to the uncompressed data.
+ * to the uncompressed data. Inline sections are always written raw.
+ *
+ * The data is compressed by \ref sc_io_encode. An encoded section starts with
+ * an inline section with the user string "scda encoded section". Its inline
+ * data is the original section type, a space, the original block size or
+ * element size in decimal digits, padding spaces and a newline.
+ * An encoded block is followed by a block section with the given user string
+ * and the compressed block. An encoded array is followed by an array section
+ * with the given user string that contains the compressed byte count of each
+ * element as 8-byte big-endian integer and by a byte array section with the
+ * user string "scda encoded section" that contains the separately compressed
+ * elements. Hence, encoded arrays can be read on any parallel partition.
  *
  * On reading it sufficies to pass \b decode true to the function \ref
  * sc_scda_fread_section_header. Then the file section data is decompressed
@@ -129,6 +139,41 @@
  * If \b decode is false, the data is read raw even if it was written according
  * to the compression convention.
  *
+ * ### Section index
+ *
+ * If the parameter \b write_index is true for \ref sc_scda_fopen_write,
+ * \ref sc_scda_fclose appends an index of the file sections. The index is
+ * a block section with the user string "scda section index" followed by an
+ * inline section with the same user string that ends the file. The block
+ * contains one record of 128 bytes per section in the order of writing.
+ * A record consists of the section type, 'E' for an encoded section or '-'
+ * otherwise, and a space. Then the byte offset of the section in the file,
+ * the global element count and the block or element size follow as 20
+ * decimal digits and a space each. The record ends in the user string of
+ * the section padded as in the section header. The inline data is
+ * "scda index " followed by the byte offset of the block section as 20
+ * decimal digits and a newline. An encoded section is one section in the
+ * index and its offset is the offset of its first raw section.
+ *
+ * For reading, \ref sc_scda_fseek_section positions the file context at
+ * the start of a section given by its number. It uses the index if the
+ * file ends with it. Otherwise, it reads the section headers from the
+ * start of the file once and remembers the offsets of the sections found.
+ * The index sections can be read like any other file section.
+ *
+ * ### Alignment
+ *
+ * If the parameter \b align is positive for \ref sc_scda_fopen_write, the
+ * data of array sections that are written unencoded starts at a byte offset
+ * that is a multiple of \b align. To this end, a block section with the
+ * user string "scda alignment" and a block of spaces may precede the array
+ * section. This block section is not counted as a section in the section
+ * index and by \ref sc_scda_fseek_section. It is skipped by \ref
+ * sc_scda_fread_section_header if \b decode is true and is read as a
+ * usual block section otherwise. Hence, aligned files are valid scda
+ * files. The parameters \b stripe_size and \b stripe_count pass striping
+ * hints to MPI I/O when the file is opened.
+ *
  * ### Error management
  *
  * All \b scda functions that receive a file context have an output parameter
@@ -165,7 +210,8 @@
  * The general workflow for the scda format provided by \ref sc_scda.h
  *
  * All workflows start with \ref sc_scda_fopen_write or \ref sc_scda_fopen_read
- * that creates a file context \ref sc_scda_fcontext_t that never moves backwards.
+ * that creates a file context \ref sc_scda_fcontext_t that never moves
+ * backwards except of \ref sc_scda_fseek_section.
  *
  * Then the user may call any combination of functions out of:
  *
@@ -183,9 +229,13 @@
  * - \ref sc_scda_fread_inline_data,
  * - \ref sc_scda_fread_block_data,
  * - \ref sc_scda_fread_array_data,
+ * - \ref sc_scda_fread_array_ranges,
  * - \ref sc_scda_fread_varray_sizes and
  * - \ref sc_scda_fread_varray_data.
  *
+ * Before any call of \ref sc_scda_fread_section_header the user may call
+ * \ref sc_scda_fseek_section to continue reading at another file section.
+ *
  * Finally, the file context is collectively closed and deallocated by \ref
  * sc_scda_fclose.
  *
@@ -317,6 +367,58 @@ typedef struct sc_scda_params
   int                 log_level;  /**< The log level for the scda functions.
                                        The possible values are documented in
                                        \ref sc.h; cf. SC_LP_* macros. */
+  size_t              write_behind; /**< The byte size of a staging buffer
+                                       per process for writing array data
+                                       behind. If the local bytes of an array
+                                       section fit on all processes, \ref
+                                       sc_scda_fwrite_array copies them into
+                                       this buffer, starts the write and
+                                       returns. The write is completed by the
+                                       next scda writing function or by
+                                       \ref sc_scda_fclose, which also report
+                                       its errors. 0 means that all sections
+                                       are written synchronously. */
+  size_t              batch_bytes; /**< The maximal byte count per process
+                                       of one collective call that reads or
+                                       writes fixed-size array data. Larger
+                                       local data is transferred in several
+                                       calls of whole elements. Indirect
+                                       data is then gathered or scattered
+                                       through a buffer of this size. This
+                                       bounds temporary memory. 0 means that
+                                       the local data is transferred in one
+                                       call if it has at most INT_MAX bytes
+                                       on all processes and otherwise in
+                                       calls of at most INT_MAX bytes. */
+  int                 write_index; /**< Boolean to append the section index
+                                       to a file that is written when it is
+                                       closed by \ref sc_scda_fclose. This
+                                       allows \ref sc_scda_fseek_section to
+                                       jump to any section directly. The
+                                       parameter is ignored for reading. */
+  size_t              stripe_size; /**< The byte size of the stripes of the
+                                       file system that the file is spread
+                                       over. It is passed as the MPI I/O hint
+                                       "striping_unit" unless \b info sets
+                                       it; cf. \ref sc_io_open_striped.
+                                       0 leaves it to the file system. */
+  int                 stripe_count; /**< The number of stripes, passed as
+                                       the hint "striping_factor". If it is
+                                       positive, the hint "cb_nodes" is set
+                                       to the minimum of it and the number of
+                                       processes such that one process
+                                       aggregates the collective I/O of one
+                                       stripe. 0 leaves it to the file
+                                       system. Must not be negative. */
+  size_t              align;       /**< The byte alignment of the data of
+                                       array sections that are written
+                                       unencoded. Must be a multiple of 32;
+                                       usually \b stripe_size. Then
+                                       collective writes of array data do not
+                                       straddle stripe boundaries. The
+                                       parameter is ignored for reading. 0
+                                       means that the data is only aligned
+                                       to 32 bytes as all section data. */
 }
 sc_scda_params_t; /**< type for \ref sc_scda_params */
 
@@ -513,6 +615,12 @@ sc_scda_fcontext_t *sc_scda_fwrite_block (sc_scda_fcontext_t * fc,
  *
  * \warning The API of this function will change in the next libsc version!
  *
+ * If the file was opened with a positive \ref sc_scda_params::write_behind
+ * and the local array bytes plus padding fit into it on all processes, the
+ * data is copied and written in the background.  Then \b array_data may be
+ * modified after return.  An error of the background write is reported by the
+ * next scda writing function or \ref sc_scda_fclose.
+ *
  * This function returns NULL on I/O errors.
  *
  * \param [in,out]  fc          File context previously opened by \ref
@@ -556,7 +664,7 @@ sc_scda_fcontext_t *sc_scda_fwrite_block (sc_scda_fcontext_t * fc,
  *                              \b elem_size that contains the actual array
  *                              elements.
  * \param [in]      encode      A Boolean to decide whether the file section
- *                              is written compressed. This results in two
+ *                              is written compressed. This results in three
  *                              written file sections that can be read without
  *                              the encoding interpretation by using \ref
  *                              sc_scda_fread_section_header with decode set to
@@ -844,6 +952,41 @@ sc_scda_fcontext_t *sc_scda_fread_section_header (sc_scda_fcontext_t * fc,
                                                   int *decode,
                                                   sc_scda_ferror_t * errcode);
 
+/** Move the file context to the start of a file section.
+ *
+ * This is a collective function.
+ * The sections are numbered from 0 in the order of writing, starting with
+ * the section after the file header. A section written encoded counts as
+ * one section. If the file ends with a section index (cf. the parameter
+ * \b write_index in \ref sc_scda_params), the function jumps to the
+ * section. Otherwise, the function reads the headers of all sections up to
+ * the requested one on the first request. After a successful call the next
+ * call on \b fc must be \ref sc_scda_fread_section_header, which may be
+ * followed by reading the section as usual. The context can be moved
+ * backwards and forwards.
+ *
+ * \param [in,out]  fc          File context previously opened by \ref
+ *                              sc_scda_fopen_read.
+ * \param [in]      section     The collective number of the section.
+ *                              If the file has less sections, the function
+ *                              returns NULL and \b errcode encodes \ref
+ *                              SC_SCDA_FERR_ARG.
+ * \param [out]     errcode     An errcode that can be interpreted by \ref
+ *                              sc_scda_ferror_string or mapped to an error class
+ *                              by \ref sc_scda_ferror_class. \b errcode encodes
+ *                              success if and only if the function does not
+ *                              return NULL.
+ * \return                      Return a pointer to the input
+ *                              context \b fc on success.
+ *                              The context is used to continue
+ *                              reading and eventually closing the file.
+ *                              In case of any error, attempt to close the
+ *                              file and deallocate the context \b fc.
+ */
+sc_scda_fcontext_t *sc_scda_fseek_section (sc_scda_fcontext_t * fc,
+                                           size_t section,
+                                           sc_scda_ferror_t * errcode);
+
 /** Read the data of an inline data section.
  *
  * This is a collective function.
@@ -990,6 +1133,68 @@ sc_scda_fcontext_t *sc_scda_fread_array_data (sc_scda_fcontext_t * fc,
                                               int indirect,
                                               sc_scda_ferror_t * errcode);
 
+/** Read global element ranges of a fixed-size array.
+ *
+ * This is a collective function that may be called instead of \ref
+ * sc_scda_fread_array_data. Every process reads its own list of ranges of
+ * global element indices, which may overlap between the processes. A
+ * process that does not need any data passes an empty list. Each process
+ * reads independently of the others by one call of \ref sc_io_read_at per
+ * run of ranges that continue each other, or more calls if the run exceeds
+ * the \b batch_bytes parameter or INT_MAX bytes. For an encoded section,
+ * the compressed element sizes locate the requested elements. To this end,
+ * the processes read the sizes in even slices of N / P elements, where N is
+ * the global element count and P the number of processes, and gather the
+ * byte count of each slice. Each process then reads the sizes of its ranges
+ * and those from the start of the slice of each range. Hence, a process
+ * reads O(N / P) sizes per range and memory of this size in addition to the
+ * requested elements. The padding of the section is not checked.
+ * \note
+ * All parameters except of \b array_data and \b ranges are collective.
+ *
+ * This function returns NULL on I/O errors.
+ *
+ * \param [in,out]  fc          File context previously opened by \ref
+ *                              sc_scda_fopen_read.
+ * \param [out]     array_data  If \b indirect is false, a sc_array with
+ *                              element size \b elem_size and the sum of the
+ *                              counts of \b ranges as element count. The
+ *                              elements are stored in the order of \b ranges.
+ *                              If \b indirect is true, a sc_array with the
+ *                              same element count but with sizeof
+ *                              (sc_array_t) as element size. Each array
+ *                              element is then again a sc_array with element
+ *                              count 1 and element size \b elem_size.
+ *                              May be NULL if no element is read locally.
+ * \param [in]      ranges      A sc_array with element size 2 * sizeof
+ *                              (\ref sc_scda_ulong). Each element is a pair
+ *                              of the first global index and the count of
+ *                              a range of array elements. Each range must be
+ *                              inside of the global element count retrieved
+ *                              from \ref sc_scda_fread_section_header.
+ * \param [in]      elem_size   As retrieved from \ref
+ *                              sc_scda_fread_section_header.
+ * \param [in]      indirect    A Boolean to determine whether \b array_data
+ *                              must be a sc_array of sc_arrays.
+ * \param [out]     errcode     An errcode that can be interpreted by \ref
+ *                              sc_scda_ferror_string or mapped to an error class
+ *                              by \ref sc_scda_ferror_class. \b errcode encodes
+ *                              success if and only if the function does not
+ *                              return NULL.
+ * \return                      Return a pointer to the input
+ *                              context \b fc on success.
+ *                              The context is used to continue
+ *                              reading and eventually closing the file.
+ *                              In case of any error, attempt to close the
+ *                              file and deallocate the context \b fc.
+ */
+sc_scda_fcontext_t *sc_scda_fread_array_ranges (sc_scda_fcontext_t * fc,
+                                                sc_array_t * array_data,
+                                                sc_array_t * ranges,
+                                                size_t elem_size,
+                                                int indirect,
+                                                sc_scda_ferror_t * errcode);
+
 /** Read the element sizes of a variable-size array.
  *
  * This is a collective function.
@@ -1177,6 +1382,9 @@ int                 sc_scda_ferror_string (sc_scda_ferror_t errcode,
  * \note
  * All parameters are collective.
  *
+ * If the file was opened for writing with \b write_index true, this
+ * function appends the section index before closing the file.
+ *
  * This function returns -1 on I/O errors.
  * This function always frees the file context -- also in case of an error.
  * \param [in,out]  fc        File context previously created by
@@ -29,6 +29,12 @@
 #include <hwi/include/bqc/A2_inlines.h>
 #endif
 
+#if defined(SC_SHMEM_HAVE_POSIX)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 #if defined(SC_ENABLE_MPI)
 static int          sc_shmem_keyval = MPI_KEYVAL_INVALID;
 #endif
@@ -38,6 +44,9 @@ const char         *sc_shmem_type_to_string[SC_SHMEM_NUM_TYPES] = {
 #if defined(SC_ENABLE_MPIWINSHARED)
   "window", "window_prescan",
 #endif
+#if defined(SC_SHMEM_HAVE_POSIX)
+  "posix", "posix_prescan",
+#endif
 #if defined(__bgq__)
   "bgq", "bgq_prescan",
 #endif
@@ -181,7 +190,11 @@ static sc_shmem_type_t sc_shmem_types[SC_SHMEM_NUM_TYPES] = {
   SC_SHMEM_PRESCAN,
 #if defined(SC_ENABLE_MPIWINSHARED)
   SC_SHMEM_WINDOW,
-  SC_SHMEM_WINDOW_PRESCAN
+  SC_SHMEM_WINDOW_PRESCAN,
+#endif
+#if defined(SC_SHMEM_HAVE_POSIX)
+  SC_SHMEM_POSIX,
+  SC_SHMEM_POSIX_PRESCAN,
 #endif
 #if defined(__bgq__)
     SC_SHMEM_BGQ,
@@ -305,6 +318,22 @@ sc_shmem_allgather_basic (void *sendbuf, int sendcount,
   SC_CHECK_MPI (mpiret);
 }
 
+static void
+sc_shmem_allgatherv_basic (void *sendbuf, int sendcount,
+                           sc_MPI_Datatype sendtype, void *recvbuf,
+                           size_t offset, int *recvcounts, int *displs,
+                           sc_MPI_Datatype recvtype, sc_MPI_Comm comm,
+                           sc_MPI_Comm intranode, sc_MPI_Comm internode)
+{
+  int                 mpiret;
+
+  mpiret = sc_MPI_Allgatherv (sendbuf, sendcount, sendtype,
+                              (char *) recvbuf +
+                              sc_mpi_sizeof (recvtype) * offset,
+                              recvcounts, displs, recvtype, comm);
+  SC_CHECK_MPI (mpiret);
+}
+
 static void
 sc_shmem_prefix_basic (void *sendbuf, void *recvbuf, int count,
                        sc_MPI_Datatype type, sc_MPI_Op op,
@@ -347,9 +376,10 @@ sc_shmem_prefix_prescan (void *sendbuf, void *recvbuf, int count,
   SC_FREE (sendscan);
 }
 
-/* common to SHARED and WINDOW */
+/* common to SHARED, WINDOW and POSIX */
 
-#if defined(__bgq__) || defined(SC_ENABLE_MPIWINSHARED)
+#if defined(__bgq__) || defined(SC_ENABLE_MPIWINSHARED) || \
+  defined(SC_SHMEM_HAVE_POSIX)
 
 static void
 sc_shmem_memcpy_common (void *destarray, void *srcarray, size_t bytes,
@@ -400,6 +430,113 @@ sc_shmem_allgather_common (void *sendbuf, int sendcount,
   sc_shmem_write_end (recvbuf, comm);
 }
 
+static void
+sc_shmem_allgatherv_common (void *sendbuf, int sendcount,
+                            sc_MPI_Datatype sendtype, void *recvbuf,
+                            size_t offset, int *recvcounts, int *displs,
+                            sc_MPI_Datatype recvtype, sc_MPI_Comm comm,
+                            sc_MPI_Comm intranode, sc_MPI_Comm internode)
+{
+  size_t              typesize;
+  int                 mpiret, rank, size, intrarank, intrasize;
+  int                 p, j, first, nnodes, packed, total, noffset;
+  int                *pdispls, *nodecounts, *nodedispls;
+  char               *dest, *allrecvchar = NULL;
+
+  typesize = sc_mpi_sizeof (recvtype);
+
+  mpiret = sc_MPI_Comm_rank (comm, &rank);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_size (comm, &size);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (intranode, &intrarank);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_size (intranode, &intrasize);
+  SC_CHECK_MPI (mpiret);
+
+  /* as in the allgather above, the processes of a node are consecutive */
+  SC_ASSERT (size % intrasize == 0);
+  nnodes = size / intrasize;
+  first = rank - intrarank;
+
+  /* if the nonempty blocks of each node are adjacent we gather in place */
+  packed = 1;
+  nodecounts = SC_ALLOC_ZERO (int, nnodes);
+  nodedispls = SC_ALLOC_ZERO (int, nnodes);
+  for (j = 0; j < nnodes && packed; ++j) {
+    for (p = j * intrasize; p < (j + 1) * intrasize; ++p) {
+      if (recvcounts[p] > 0) {
+        if (nodecounts[j] == 0) {
+          nodedispls[j] = displs[p];
+        }
+        else if (displs[p] != nodedispls[j] + nodecounts[j]) {
+          packed = 0;
+          break;
+        }
+        nodecounts[j] += recvcounts[p];
+      }
+    }
+  }
+
+  /* otherwise we gather into a packed temporary buffer */
+  total = 0;
+  if (!packed) {
+    for (j = 0; j < nnodes; ++j) {
+      nodedispls[j] = total;
+      nodecounts[j] = 0;
+      for (p = j * intrasize; p < (j + 1) * intrasize; ++p) {
+        SC_ASSERT (recvcounts[p] <= INT_MAX - total);
+        nodecounts[j] += recvcounts[p];
+        total += recvcounts[p];
+      }
+    }
+  }
+
+  /* displacements of the blocks relative to their node */
+  pdispls = SC_ALLOC (int, size);
+  for (j = 0; j < nnodes; ++j) {
+    noffset = 0;
+    for (p = j * intrasize; p < (j + 1) * intrasize; ++p) {
+      pdispls[p] = noffset;
+      noffset += recvcounts[p];
+    }
+  }
+
+  /* node root gathers from node and allgathers between nodes */
+  dest = NULL;
+  if (sc_shmem_write_start (recvbuf, comm)) {
+    dest = packed ? (char *) recvbuf + typesize * offset :
+      (allrecvchar = SC_ALLOC (char, typesize * total));
+  }
+  mpiret =
+    sc_MPI_Gatherv (sendbuf, sendcount, sendtype,
+                    dest == NULL ? NULL : dest +
+                    typesize * nodedispls[first / intrasize],
+                    recvcounts + first, pdispls + first, recvtype, 0,
+                    intranode);
+  SC_CHECK_MPI (mpiret);
+  if (dest != NULL) {
+    mpiret = MPI_Allgatherv (MPI_IN_PLACE, 0, MPI_DATATYPE_NULL, dest,
+                             nodecounts, nodedispls, recvtype, internode);
+    SC_CHECK_MPI (mpiret);
+    if (!packed) {
+      for (j = 0; j < nnodes; ++j) {
+        for (p = j * intrasize; p < (j + 1) * intrasize; ++p) {
+          memcpy ((char *) recvbuf + typesize * (offset + displs[p]),
+                  allrecvchar + typesize * (nodedispls[j] + pdispls[p]),
+                  typesize * recvcounts[p]);
+        }
+      }
+      SC_FREE (allrecvchar);
+    }
+  }
+  sc_shmem_write_end (recvbuf, comm);
+
+  SC_FREE (pdispls);
+  SC_FREE (nodecounts);
+  SC_FREE (nodedispls);
+}
+
 static void
 sc_shmem_prefix_common (void *sendbuf, void *recvbuf, int count,
                         sc_MPI_Datatype type, sc_MPI_Op op,
@@ -488,7 +625,7 @@ sc_shmem_prefix_common_prescan (void *sendbuf, void *recvbuf, int count,
   sc_shmem_write_end (recvbuf, comm);
 }
 
-#endif /* defined(__bgq__) || defined(SC_ENABLE_MPIWINSHARED) */
+#endif /* __bgq__ || SC_ENABLE_MPIWINSHARED || SC_SHMEM_HAVE_POSIX */
 
 #if defined(__bgq__)
 /* SHARED implementation */
@@ -671,6 +808,107 @@ sc_shmem_write_end_window (void *array, sc_MPI_Comm comm,
 
 #endif /* SC_ENABLE_MPIWINSHARED */
 
+#if defined(SC_SHMEM_HAVE_POSIX)
+/* POSIX shared memory implementation */
+
+/** Bytes in front of the array that store the size of the mapping.
+ * This is a multiple of the alignment of any element type. */
+#define SC_SHMEM_POSIX_HEADER 64
+
+/** Length of the name of a shared memory segment. */
+#define SC_SHMEM_POSIX_NAME 64
+
+static void        *
+sc_shmem_malloc_posix (int package, size_t elem_size, size_t elem_count,
+                       sc_MPI_Comm comm, sc_MPI_Comm intranode,
+                       sc_MPI_Comm internode)
+{
+  static int          sc_shmem_posix_count = 0;
+  int                 mpiret, intrarank;
+  int                 fd, opened, allopened;
+  char                name[SC_SHMEM_POSIX_NAME];
+  char               *base;
+  size_t              mapsize;
+
+  mpiret = sc_MPI_Comm_rank (intranode, &intrarank);
+  SC_CHECK_MPI (mpiret);
+  mapsize = SC_SHMEM_POSIX_HEADER + elem_size * elem_count;
+
+  /* the node root creates a segment with a name unique on the node */
+  fd = -1;
+  if (!intrarank) {
+    snprintf (name, SC_SHMEM_POSIX_NAME, "/sc_shmem_%ld_%d",
+              (long) getpid (), sc_shmem_posix_count++);
+    fd = shm_open (name, O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+    SC_CHECK_ABORT (fd >= 0, "shm_open failed");
+    SC_CHECK_ABORT (!ftruncate (fd, (off_t) mapsize), "ftruncate failed");
+  }
+  mpiret = sc_MPI_Bcast (name, SC_SHMEM_POSIX_NAME, sc_MPI_CHAR, 0,
+                         intranode);
+  SC_CHECK_MPI (mpiret);
+  if (intrarank) {
+    fd = shm_open (name, O_RDWR, 0);
+  }
+
+  /* once everybody holds the segment, its name is no longer needed */
+  opened = fd >= 0;
+  mpiret = sc_MPI_Allreduce (&opened, &allopened, 1, sc_MPI_INT, sc_MPI_MIN,
+                             intranode);
+  SC_CHECK_MPI (mpiret);
+  if (!intrarank) {
+    SC_CHECK_ABORT (!shm_unlink (name), "shm_unlink failed");
+  }
+  SC_CHECK_ABORT (allopened, "POSIX shmem requires each intranode "
+                  "communicator to reside on one shared memory node");
+
+  base = (char *) mmap (NULL, mapsize, PROT_READ | PROT_WRITE, MAP_SHARED,
+                        fd, 0);
+  SC_CHECK_ABORT (base != MAP_FAILED, "mmap failed");
+  SC_CHECK_ABORT (!close (fd), "close failed");
+  if (!intrarank) {
+    *(size_t *) base = mapsize;
+  }
+  mpiret = sc_MPI_Barrier (intranode);
+  SC_CHECK_MPI (mpiret);
+
+  return base + SC_SHMEM_POSIX_HEADER;
+}
+
+static void
+sc_shmem_free_posix (int package, void *array, sc_MPI_Comm comm,
+                     sc_MPI_Comm intranode, sc_MPI_Comm internode)
+{
+  char               *base = (char *) array - SC_SHMEM_POSIX_HEADER;
+
+  /* the segment is released when the last process unmaps it */
+  SC_CHECK_ABORT (!munmap (base, *(size_t *) base), "munmap failed");
+}
+
+static int
+sc_shmem_write_start_posix (void *array, sc_MPI_Comm comm,
+                            sc_MPI_Comm intranode, sc_MPI_Comm internode)
+{
+  int                 intrarank, mpiret;
+
+  mpiret = sc_MPI_Comm_rank (intranode, &intrarank);
+  SC_CHECK_MPI (mpiret);
+
+  return !intrarank;
+}
+
+static void
+sc_shmem_write_end_posix (void *array, sc_MPI_Comm comm,
+                          sc_MPI_Comm intranode, sc_MPI_Comm internode)
+{
+  int                 mpiret;
+
+  /* the writes of the node root are visible after the barrier */
+  mpiret = sc_MPI_Barrier (intranode);
+  SC_CHECK_MPI (mpiret);
+}
+
+#endif /* SC_SHMEM_HAVE_POSIX */
+
 void               *
 sc_shmem_malloc (int package, size_t elem_size, size_t elem_count,
                  sc_MPI_Comm comm)
@@ -700,6 +938,12 @@ sc_shmem_malloc (int package, size_t elem_size, size_t elem_count,
   case SC_SHMEM_WINDOW_PRESCAN:
     return sc_shmem_malloc_window (package, elem_size, elem_count, comm,
                                    intranode, internode);
+#endif
+#if defined(SC_SHMEM_HAVE_POSIX)
+  case SC_SHMEM_POSIX:
+  case SC_SHMEM_POSIX_PRESCAN:
+    return sc_shmem_malloc_posix (package, elem_size, elem_count, comm,
+                                  intranode, internode);
 #endif
   default:
     SC_ABORT_NOT_REACHED ();
@@ -735,6 +979,12 @@ sc_shmem_free (int package, void *array, sc_MPI_Comm comm)
   case SC_SHMEM_WINDOW_PRESCAN:
     sc_shmem_free_window (package, array, comm, intranode, internode);
     break;
+#endif
+#if defined(SC_SHMEM_HAVE_POSIX)
+  case SC_SHMEM_POSIX:
+  case SC_SHMEM_POSIX_PRESCAN:
+    sc_shmem_free_posix (package, array, comm, intranode, internode);
+    break;
 #endif
   default:
     SC_ABORT_NOT_REACHED ();
@@ -766,6 +1016,11 @@ sc_shmem_write_start (void *array, sc_MPI_Comm comm)
   case SC_SHMEM_WINDOW:
   case SC_SHMEM_WINDOW_PRESCAN:
     return sc_shmem_write_start_window (array, comm, intranode, internode);
+#endif
+#if defined(SC_SHMEM_HAVE_POSIX)
+  case SC_SHMEM_POSIX:
+  case SC_SHMEM_POSIX_PRESCAN:
+    return sc_shmem_write_start_posix (array, comm, intranode, internode);
 #endif
   default:
     SC_ABORT_NOT_REACHED ();
@@ -801,6 +1056,12 @@ sc_shmem_write_end (void *array, sc_MPI_Comm comm)
   case SC_SHMEM_WINDOW_PRESCAN:
     sc_shmem_write_end_window (array, comm, intranode, internode);
     break;
+#endif
+#if defined(SC_SHMEM_HAVE_POSIX)
+  case SC_SHMEM_POSIX:
+  case SC_SHMEM_POSIX_PRESCAN:
+    sc_shmem_write_end_posix (array, comm, intranode, internode);
+    break;
 #endif
   default:
     SC_ABORT_NOT_REACHED ();
@@ -826,7 +1087,8 @@ sc_shmem_memcpy (void *destarray, void *srcarray, size_t bytes,
     sc_shmem_memcpy_basic (destarray, srcarray, bytes, comm, intranode,
                            internode);
     break;
-#if defined(__bgq__) || defined(SC_ENABLE_MPIWINSHARED)
+#if defined(__bgq__) || defined(SC_ENABLE_MPIWINSHARED) || \
+  defined(SC_SHMEM_HAVE_POSIX)
 #if defined(__bgq__)
   case SC_SHMEM_BGQ:
   case SC_SHMEM_BGQ_PRESCAN:
@@ -834,6 +1096,10 @@ sc_shmem_memcpy (void *destarray, void *srcarray, size_t bytes,
 #if defined(SC_ENABLE_MPIWINSHARED)
   case SC_SHMEM_WINDOW:
   case SC_SHMEM_WINDOW_PRESCAN:
+#endif
+#if defined(SC_SHMEM_HAVE_POSIX)
+  case SC_SHMEM_POSIX:
+  case SC_SHMEM_POSIX_PRESCAN:
 #endif
     sc_shmem_memcpy_common (destarray, srcarray, bytes, comm, intranode,
                             internode);
@@ -865,7 +1131,8 @@ sc_shmem_allgather (void *sendbuf, int sendcount,
                               recvcount, recvtype, comm, intranode,
                               internode);
     break;
-#if defined(__bgq__) || defined(SC_ENABLE_MPIWINSHARED)
+#if defined(__bgq__) || defined(SC_ENABLE_MPIWINSHARED) || \
+  defined(SC_SHMEM_HAVE_POSIX)
 #if defined(__bgq__)
   case SC_SHMEM_BGQ:
   case SC_SHMEM_BGQ_PRESCAN:
@@ -873,6 +1140,10 @@ sc_shmem_allgather (void *sendbuf, int sendcount,
 #if defined(SC_ENABLE_MPIWINSHARED)
   case SC_SHMEM_WINDOW:
   case SC_SHMEM_WINDOW_PRESCAN:
+#endif
+#if defined(SC_SHMEM_HAVE_POSIX)
+  case SC_SHMEM_POSIX:
+  case SC_SHMEM_POSIX_PRESCAN:
 #endif
     sc_shmem_allgather_common (sendbuf, sendcount, sendtype, recvbuf,
                                recvcount, recvtype, comm, intranode,
@@ -884,6 +1155,151 @@ sc_shmem_allgather (void *sendbuf, int sendcount,
   }
 }
 
+/** Allgatherv into a shmem array starting \a offset items after its
+ * beginning, which the node-shared types need to identify the array. */
+static void
+sc_shmem_allgatherv_offset (void *sendbuf, int sendcount,
+                            sc_MPI_Datatype sendtype, void *recvbuf,
+                            size_t offset, int *recvcounts, int *displs,
+                            sc_MPI_Datatype recvtype, sc_MPI_Comm comm)
+{
+  sc_shmem_type_t     type;
+  sc_MPI_Comm         intranode = sc_MPI_COMM_NULL, internode =
+    sc_MPI_COMM_NULL;
+
+  type = sc_shmem_get_type_default (comm);
+  sc_mpi_comm_get_node_comms (comm, &intranode, &internode);
+  if (intranode == sc_MPI_COMM_NULL || internode == sc_MPI_COMM_NULL) {
+    type = SC_SHMEM_BASIC;
+  }
+  switch (type) {
+  case SC_SHMEM_BASIC:
+  case SC_SHMEM_PRESCAN:
+    sc_shmem_allgatherv_basic (sendbuf, sendcount, sendtype, recvbuf,
+                               offset, recvcounts, displs, recvtype, comm,
+                               intranode, internode);
+    break;
+#if defined(__bgq__) || defined(SC_ENABLE_MPIWINSHARED) || \
+  defined(SC_SHMEM_HAVE_POSIX)
+#if defined(__bgq__)
+  case SC_SHMEM_BGQ:
+  case SC_SHMEM_BGQ_PRESCAN:
+#endif
+#if defined(SC_ENABLE_MPIWINSHARED)
+  case SC_SHMEM_WINDOW:
+  case SC_SHMEM_WINDOW_PRESCAN:
+#endif
+#if defined(SC_SHMEM_HAVE_POSIX)
+  case SC_SHMEM_POSIX:
+  case SC_SHMEM_POSIX_PRESCAN:
+#endif
+    sc_shmem_allgatherv_common (sendbuf, sendcount, sendtype, recvbuf,
+                                offset, recvcounts, displs, recvtype, comm,
+                                intranode, internode);
+    break;
+#endif
+  default:
+    SC_ABORT_NOT_REACHED ();
+  }
+}
+
+void
+sc_shmem_allgatherv (void *sendbuf, int sendcount,
+                     sc_MPI_Datatype sendtype, void *recvbuf,
+                     int *recvcounts, int *displs,
+                     sc_MPI_Datatype recvtype, sc_MPI_Comm comm)
+{
+  sc_shmem_allgatherv_offset (sendbuf, sendcount, sendtype, recvbuf, 0,
+                              recvcounts, displs, recvtype, comm);
+}
+
+void
+sc_shmem_allgather_long (void *sendbuf, size_t sendcount,
+                         sc_MPI_Datatype sendtype, void *recvbuf,
+                         size_t recvcount, sc_MPI_Datatype recvtype,
+                         sc_MPI_Comm comm)
+{
+  int                 mpiret, size, p;
+  size_t             *recvcounts, *displs;
+
+  mpiret = sc_MPI_Comm_size (comm, &size);
+  SC_CHECK_MPI (mpiret);
+
+  recvcounts = SC_ALLOC (size_t, size);
+  displs = SC_ALLOC (size_t, size);
+  for (p = 0; p < size; ++p) {
+    recvcounts[p] = recvcount;
+    displs[p] = p * recvcount;
+  }
+  sc_shmem_allgatherv_long (sendbuf, sendcount, sendtype, recvbuf,
+                            recvcounts, displs, recvtype, comm);
+  SC_FREE (recvcounts);
+  SC_FREE (displs);
+}
+
+void
+sc_shmem_allgatherv_long (void *sendbuf, size_t sendcount,
+                          sc_MPI_Datatype sendtype, void *recvbuf,
+                          size_t *recvcounts, size_t *displs,
+                          sc_MPI_Datatype recvtype, sc_MPI_Comm comm)
+{
+  int                 mpiret, rank, size, p, lo, hi;
+  int                *icounts, *idispls;
+  size_t              typesize, base, end, offset, chunk;
+
+  typesize = sc_mpi_sizeof (recvtype);
+  SC_ASSERT (typesize == sc_mpi_sizeof (sendtype));
+
+  mpiret = sc_MPI_Comm_rank (comm, &rank);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_size (comm, &size);
+  SC_CHECK_MPI (mpiret);
+  SC_ASSERT (sendcount == recvcounts[rank]);
+
+  icounts = SC_ALLOC_ZERO (int, size);
+  idispls = SC_ALLOC_ZERO (int, size);
+  for (lo = 0; lo < size; lo = hi) {
+    base = displs[lo];
+    if (recvcounts[lo] > (size_t) INT_MAX) {
+      /* a huge block is sent in pieces by its process alone */
+      hi = lo + 1;
+      for (offset = 0; offset < recvcounts[lo]; offset += chunk) {
+        chunk = SC_MIN (recvcounts[lo] - offset, (size_t) INT_MAX);
+        icounts[lo] = (int) chunk;
+        sc_shmem_allgatherv_offset ((char *) sendbuf + typesize * offset,
+                                    rank == lo ? (int) chunk : 0, sendtype,
+                                    recvbuf, base + offset,
+                                    icounts, idispls, recvtype, comm);
+      }
+      icounts[lo] = 0;
+      continue;
+    }
+
+    /* group the following blocks that are addressable relative to base */
+    for (hi = lo; hi < size; ++hi) {
+      if (recvcounts[hi] == 0) {
+        continue;
+      }
+      end = displs[hi] + recvcounts[hi];
+      if (displs[hi] < base || end - base > (size_t) INT_MAX) {
+        break;
+      }
+      icounts[hi] = (int) recvcounts[hi];
+      idispls[hi] = (int) (displs[hi] - base);
+    }
+    SC_ASSERT (hi > lo);
+    sc_shmem_allgatherv_offset (sendbuf, lo <= rank && rank < hi ?
+                                (int) sendcount : 0, sendtype,
+                                recvbuf, base, icounts, idispls, recvtype,
+                                comm);
+    for (p = lo; p < hi; ++p) {
+      icounts[p] = idispls[p] = 0;
+    }
+  }
+  SC_FREE (icounts);
+  SC_FREE (idispls);
+}
+
 void
 sc_shmem_prefix (void *sendbuf, void *recvbuf, int count,
                  sc_MPI_Datatype dtype, sc_MPI_Op op, sc_MPI_Comm comm)
@@ -906,23 +1322,31 @@ sc_shmem_prefix (void *sendbuf, void *recvbuf, int count,
     sc_shmem_prefix_prescan (sendbuf, recvbuf, count, dtype, op, comm,
                              intranode, internode);
     break;
-#if defined(__bgq__) || defined(SC_ENABLE_MPIWINSHARED)
+#if defined(__bgq__) || defined(SC_ENABLE_MPIWINSHARED) || \
+  defined(SC_SHMEM_HAVE_POSIX)
 #if defined(__bgq__)
   case SC_SHMEM_BGQ:
 #endif
 #if defined(SC_ENABLE_MPIWINSHARED)
   case SC_SHMEM_WINDOW:
+#endif
+#if defined(SC_SHMEM_HAVE_POSIX)
+  case SC_SHMEM_POSIX:
 #endif
     sc_shmem_prefix_common (sendbuf, recvbuf, count, dtype, op, comm,
                             intranode, internode);
     break;
 #endif
-#if defined(__bgq__) || defined(SC_ENABLE_MPIWINSHARED)
+#if defined(__bgq__) || defined(SC_ENABLE_MPIWINSHARED) || \
+  defined(SC_SHMEM_HAVE_POSIX)
 #if defined(__bgq__)
   case SC_SHMEM_BGQ_PRESCAN:
 #endif
 #if defined(SC_ENABLE_MPIWINSHARED)
   case SC_SHMEM_WINDOW_PRESCAN:
+#endif
+#if defined(SC_SHMEM_HAVE_POSIX)
+  case SC_SHMEM_POSIX_PRESCAN:
 #endif
     sc_shmem_prefix_common_prescan (sendbuf, recvbuf, count, dtype, op,
                                     comm, intranode, internode);
@@ -932,3 +1356,124 @@ sc_shmem_prefix (void *sendbuf, void *recvbuf, int count,
     SC_ABORT_NOT_REACHED ();
   }
 }
+
+sc_shmem_array_t   *
+sc_shmem_array_new (size_t elem_size, size_t elem_count, sc_MPI_Comm mpicomm)
+{
+  sc_shmem_array_t   *sa;
+
+  SC_ASSERT (elem_size > 0);
+
+  sa = SC_ALLOC_ZERO (sc_shmem_array_t, 1);
+  sa->elem_size = elem_size;
+  sa->mpicomm = mpicomm;
+  sc_shmem_array_resize (sa, elem_count);
+
+  return sa;
+}
+
+void
+sc_shmem_array_destroy (sc_shmem_array_t * sa)
+{
+  if (sa->array != NULL) {
+    sc_shmem_free (sc_package_id, sa->array, sa->mpicomm);
+  }
+  SC_FREE (sa);
+}
+
+void
+sc_shmem_array_resize (sc_shmem_array_t * sa, size_t new_count)
+{
+  size_t              roundup;
+  char               *newarray;
+
+  roundup = new_count ? (size_t) SC_ROUNDUP2_64 (new_count) : 0;
+  if (new_count <= sa->elem_alloc && roundup >= sa->elem_alloc) {
+    /* the current storage fits */
+    sa->elem_count = new_count;
+    return;
+  }
+
+  /* reallocate the storage and preserve the leading elements */
+  newarray = NULL;
+  if (roundup > 0) {
+    newarray = (char *) sc_shmem_malloc (sc_package_id, sa->elem_size,
+                                         roundup, sa->mpicomm);
+    if (sa->elem_count > 0 && new_count > 0) {
+      sc_shmem_memcpy (newarray, sa->array,
+                       SC_MIN (sa->elem_count, new_count) * sa->elem_size,
+                       sa->mpicomm);
+    }
+  }
+  if (sa->array != NULL) {
+    sc_shmem_free (sc_package_id, sa->array, sa->mpicomm);
+  }
+  sa->array = newarray;
+  sa->elem_alloc = roundup;
+  sa->elem_count = new_count;
+}
+
+int
+sc_shmem_array_write_start (sc_shmem_array_t * sa)
+{
+  if (sa->array == NULL) {
+    return 0;
+  }
+  return sc_shmem_write_start (sa->array, sa->mpicomm);
+}
+
+void
+sc_shmem_array_write_end (sc_shmem_array_t * sa)
+{
+  if (sa->array != NULL) {
+    sc_shmem_write_end (sa->array, sa->mpicomm);
+  }
+}
+
+void
+sc_shmem_array_allgather (sc_shmem_array_t * sa, void *sendbuf, size_t count)
+{
+  int                 mpiret, mpisize;
+  size_t              bytes = count * sa->elem_size;
+
+  SC_ASSERT (bytes <= (size_t) INT_MAX);
+
+  mpiret = sc_MPI_Comm_size (sa->mpicomm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+
+  /* the gathered data replaces the contents in place if it fits */
+  sa->elem_count = 0;
+  sc_shmem_array_resize (sa, (size_t) mpisize * count);
+  if (sa->array != NULL) {
+    sc_shmem_allgather (sendbuf, (int) bytes, sc_MPI_BYTE,
+                        sa->array, (int) bytes, sc_MPI_BYTE, sa->mpicomm);
+  }
+}
+
+size_t
+sc_shmem_array_node_memory_used (sc_shmem_array_t * sa)
+{
+  int                 mpiret, intrasize;
+  size_t              bytes = sa->elem_alloc * sa->elem_size;
+  sc_shmem_type_t     type;
+  sc_MPI_Comm         intranode = sc_MPI_COMM_NULL, internode =
+    sc_MPI_COMM_NULL;
+
+  sc_mpi_comm_get_node_comms (sa->mpicomm, &intranode, &internode);
+  if (intranode == sc_MPI_COMM_NULL || internode == sc_MPI_COMM_NULL) {
+    return bytes;
+  }
+  type = sc_shmem_get_type_default (sa->mpicomm);
+  if (type != SC_SHMEM_BASIC && type != SC_SHMEM_PRESCAN) {
+    return bytes;
+  }
+
+  /* every process of the node keeps a private copy */
+  mpiret = sc_MPI_Comm_size (intranode, &intrasize);
+  SC_CHECK_MPI (mpiret);
+  return (size_t) intrasize * bytes;
+}
+
+/* definitions for inline functions */
+
+void               *sc_shmem_array_index (sc_shmem_array_t * sa, size_t iz);
@@ -33,6 +33,12 @@ SC_EXTERN_C_BEGIN;
 /* sc_shmem: an interface for arrays that are redundant on each mpi
  * process */
 
+#if defined(SC_ENABLE_MPI) && defined(SC_HAVE_SYS_MMAN_H) && \
+  defined(SC_HAVE_SHM_OPEN)
+/** POSIX shared memory segments can back shmem arrays. */
+#define SC_SHMEM_HAVE_POSIX 1
+#endif
+
 typedef enum
 {
   SC_SHMEM_BASIC = 0,      /**< use allgathers, then sum to simulate scan */
@@ -41,6 +47,11 @@ typedef enum
   SC_SHMEM_WINDOW,         /**< MPI_Win (requires MPI 3) */
   SC_SHMEM_WINDOW_PRESCAN, /**< mpi_scan, then MPI_Win (requires MPI 3) */
 #endif
+#if defined(SC_SHMEM_HAVE_POSIX)
+  SC_SHMEM_POSIX,          /**< shm_open and mmap on the intranode
+                                communicator; works without MPI 3 */
+  SC_SHMEM_POSIX_PRESCAN,  /**< mpi_scan, then shm_open and mmap */
+#endif
 #if defined(__bgq__)
   SC_SHMEM_BGQ,            /**< raw pointer passing: only works for
                                 shared-heap environments */
@@ -144,6 +155,52 @@ void                sc_shmem_allgather (void *sendbuf, int sendcount,
                                         sc_MPI_Datatype recvtype,
                                         sc_MPI_Comm comm);
 
+/** Fill a shmem array with an allgatherv.
+ *
+ * The blocks of the processes on a node should be adjacent in \a recvbuf
+ * for the node-shared types to gather in place without a temporary buffer.
+ *
+ * \param[in] sendbuf         the source from this process
+ * \param[in] sendcount       the number of items to send
+ * \param[in] sendtype        the type of items to send
+ * \param[in,out] recvbuf     the destination shmem array
+ * \param[in] recvcounts      the number of items from each process
+ * \param[in] displs          the offsets in items of each block in \a recvbuf
+ * \param[in] recvtype        the type of items to receive
+ * \param[in] comm            the mpi communicator
+ */
+void                sc_shmem_allgatherv (void *sendbuf, int sendcount,
+                                         sc_MPI_Datatype sendtype,
+                                         void *recvbuf, int *recvcounts,
+                                         int *displs,
+                                         sc_MPI_Datatype recvtype,
+                                         sc_MPI_Comm comm);
+
+/** Fill a shmem array with an allgather of 64-bit counts.
+ * The parameters are those of \ref sc_shmem_allgather.
+ * The send and receive types must be of the same size.
+ * The data is split into as few calls with int counts as possible.
+ */
+void                sc_shmem_allgather_long (void *sendbuf, size_t sendcount,
+                                             sc_MPI_Datatype sendtype,
+                                             void *recvbuf, size_t recvcount,
+                                             sc_MPI_Datatype recvtype,
+                                             sc_MPI_Comm comm);
+
+/** Fill a shmem array with an allgatherv of 64-bit counts and offsets.
+ * The parameters are those of \ref sc_shmem_allgatherv.
+ * The send and receive types must be of the same size.
+ * The blocks are grouped into as few calls with int counts as possible.
+ */
+void                sc_shmem_allgatherv_long (void *sendbuf,
+                                              size_t sendcount,
+                                              sc_MPI_Datatype sendtype,
+                                              void *recvbuf,
+                                              size_t *recvcounts,
+                                              size_t *displs,
+                                              sc_MPI_Datatype recvtype,
+                                              sc_MPI_Comm comm);
+
 /** Fill a shmem array with an allgather of the prefix op over all processes.
  *
  * The return array will be
@@ -163,6 +220,97 @@ void                sc_shmem_allgather (void *sendbuf, int sendcount,
 void                sc_shmem_prefix (void *sendbuf, void *recvbuf,
                                      int count, sc_MPI_Datatype type,
                                      sc_MPI_Op op, sc_MPI_Comm comm);
+
+/** A replicated array that is stored once per shared memory node.
+ * The interface mirrors \ref sc_array_t.  The storage is allocated with
+ * \ref sc_shmem_malloc and follows the shmem type of the communicator.
+ * The data is read-only except between \ref sc_shmem_array_write_start and
+ * \ref sc_shmem_array_write_end.  All functions that change the array are
+ * collective over its communicator.
+ */
+typedef struct sc_shmem_array
+{
+  /* interface variables */
+  size_t              elem_size;        /**< size of a single element */
+  size_t              elem_count;       /**< number of valid elements */
+  sc_MPI_Comm         mpicomm;          /**< communicator sharing the array */
+
+  /* implementation variables */
+  size_t              elem_alloc;       /**< number of allocated elements */
+  char               *array;            /**< shared data or NULL if empty */
+}
+sc_shmem_array_t;
+
+/** Create a new shared array.
+ * \param [in] elem_size   Size of one array element in bytes.
+ * \param [in] elem_count  Initial number of array elements.
+ * \param [in] mpicomm     The communicator sharing the array.
+ *                         It must stay valid for the lifetime of the array.
+ * \return                 The array with uninitialized elements.
+ */
+sc_shmem_array_t   *sc_shmem_array_new (size_t elem_size, size_t elem_count,
+                                        sc_MPI_Comm mpicomm);
+
+/** Destroy a shared array.
+ * \param [in,out] sa      This array is invalid after the call.
+ */
+void                sc_shmem_array_destroy (sc_shmem_array_t * sa);
+
+/** Change the number of elements of a shared array.
+ * The storage is only reallocated if the new count exceeds the allocated
+ * count or is less than half of it.  The leading elements are preserved.
+ * \param [in,out] sa       Valid shared array.
+ * \param [in] new_count    New number of elements, equal on all processes.
+ */
+void                sc_shmem_array_resize (sc_shmem_array_t * sa,
+                                           size_t new_count);
+
+/** Start a write window for a shared array.
+ * \param [in] sa           Valid shared array.
+ * \return                  True if this process shall write the data.
+ *                          False for all processes if the array is empty.
+ */
+int                 sc_shmem_array_write_start (sc_shmem_array_t * sa);
+
+/** End a write window for a shared array.
+ * \param [in] sa           Valid shared array.
+ */
+void                sc_shmem_array_write_end (sc_shmem_array_t * sa);
+
+/** Fill a shared array with one block of elements from every process.
+ * The array is resized to the number of processes times \a count and its
+ * storage is reused whenever it is large enough.
+ * \param [in,out] sa       Valid shared array.
+ * \param [in] sendbuf      This process's \a count elements.
+ * \param [in] count        Number of elements, equal on all processes.
+ */
+void                sc_shmem_array_allgather (sc_shmem_array_t * sa,
+                                              void *sendbuf, size_t count);
+
+/** Calculate the memory used by a shared array on one node.
+ * Data stored in node-shared memory is counted once per node, while data
+ * replicated on each process is counted once per process of the node.
+ * Without node communicators attached, the count refers to this process.
+ * The array's own metadata is allocated with \ref SC_ALLOC and is thus
+ * included in \ref sc_memory_status.
+ * \param [in] sa           Valid shared array.
+ * \return                  Data bytes allocated on this process's node.
+ */
+size_t              sc_shmem_array_node_memory_used (sc_shmem_array_t * sa);
+
+/** Returns a pointer to a shared array element for reading.
+ * \param [in] sa   Valid shared array.
+ * \param [in] iz   Needs to be in [0]..[elem_count-1].
+ * \return          Pointer to the indexed array element.
+ */
+inline void        *
+sc_shmem_array_index (sc_shmem_array_t * sa, size_t iz)
+{
+  SC_ASSERT (iz < sa->elem_count);
+
+  return (void *) (sa->array + sa->elem_size * iz);
+}
+
 SC_EXTERN_C_END;
 
 #endif /* SC_SHMEM_H */
@@ -30,7 +30,7 @@ main (int argc, char **argv)
   int                 mpiret;
   int                 mpisize;
   int                 mpirank;
-  int                 i;
+  int                 i, j;
   int                *idata;
   double              elapsed_alltoall = 0.;
   double              elapsed_recursive;
@@ -39,6 +39,13 @@ main (int argc, char **argv)
   double             *ddata2;
   double              elapsed_allgather;
   double              elapsed_replacement;
+  double              elapsed_allgatherv;
+  double              elapsed_bruck;
+  double              elapsed_node;
+  int                *counts, *displs;
+  int                *sizes, *offsets;
+  int                 total;
+  long               *lsend, *ldata1, *ldata2;
 
   mpiret = sc_MPI_Init (&argc, &argv);
   SC_CHECK_MPI (mpiret);
@@ -114,15 +121,99 @@ main (int argc, char **argv)
   }
   SC_ASSERT (ddata1[mpirank] == dsend); /* exact match wanted */
 
+  /* node-aware allgather with all processes and one process per node */
+  for (j = 0; j < 2; ++j) {
+    sc_mpi_comm_attach_node_comms (mpicomm, j ? 1 : 0);
+    memset (ddata2, 0, mpisize * sizeof (double));
+    dsend = M_PI + mpirank;
+    mpiret = sc_allgather_node (&dsend, 1, sc_MPI_DOUBLE,
+                                ddata2, 1, sc_MPI_DOUBLE, mpicomm);
+    SC_CHECK_MPI (mpiret);
+    for (i = 0; i < mpisize; ++i) {
+      SC_CHECK_ABORT (ddata2[i] == M_PI + i,    /* exact match wanted */
+                      "Allgather node mismatch");
+    }
+    sc_mpi_comm_detach_node_comms (mpicomm);
+  }
+
   SC_FREE (ddata1);
   SC_FREE (ddata2);
 
+  SC_GLOBAL_INFO ("Testing allgatherv and replacements\n");
+
+  /* varying counts with one empty process and a gap between processes */
+  counts = SC_ALLOC (int, mpisize);
+  displs = SC_ALLOC (int, mpisize);
+  sizes = SC_ALLOC (int, mpisize);
+  offsets = SC_ALLOC (int, mpisize);
+  total = 0;
+  for (i = 0; i < mpisize; ++i) {
+    counts[i] = (i + 1) % 4;
+    displs[i] = total;
+    sizes[i] = counts[i] * (int) sizeof (long);
+    offsets[i] = displs[i] * (int) sizeof (long);
+    total += counts[i] + 1;
+  }
+  lsend = SC_ALLOC (long, counts[mpirank]);
+  for (i = 0; i < counts[mpirank]; ++i) {
+    lsend[i] = 1000 * mpirank + i;
+  }
+  ldata1 = SC_ALLOC (long, total);
+  ldata2 = SC_ALLOC (long, total);
+  memset (ldata1, 0, total * sizeof (long));
+
+  elapsed_allgatherv = -sc_MPI_Wtime ();
+  mpiret = sc_MPI_Allgatherv (lsend, counts[mpirank], sc_MPI_LONG, ldata1,
+                              counts, displs, sc_MPI_LONG, mpicomm);
+  SC_CHECK_MPI (mpiret);
+  elapsed_allgatherv += sc_MPI_Wtime ();
+
+  memset (ldata2, 0, total * sizeof (long));
+  mpiret = sc_allgatherv (lsend, counts[mpirank], sc_MPI_LONG, ldata2,
+                          counts, displs, sc_MPI_LONG, mpicomm);
+  SC_CHECK_MPI (mpiret);
+  SC_CHECK_ABORT (!memcmp (ldata1, ldata2, total * sizeof (long)),
+                  "Allgatherv replacement mismatch");
+
+  memset (ldata2, 0, total * sizeof (long));
+  elapsed_bruck = -sc_MPI_Wtime ();
+  sc_allgatherv_bruck (mpicomm, (char *) lsend, (char *) ldata2,
+                       sizes, offsets);
+  elapsed_bruck += sc_MPI_Wtime ();
+  SC_CHECK_ABORT (!memcmp (ldata1, ldata2, total * sizeof (long)),
+                  "Allgatherv Bruck mismatch");
+
+  /* test with both one process and all processes per node */
+  elapsed_node = 0.;
+  for (j = 0; j < 2; ++j) {
+    sc_mpi_comm_attach_node_comms (mpicomm, j ? 1 : 0);
+    memset (ldata2, 0, total * sizeof (long));
+    elapsed_node -= sc_MPI_Wtime ();
+    sc_allgatherv_node (mpicomm, (char *) lsend, (char *) ldata2,
+                        sizes, offsets);
+    elapsed_node += sc_MPI_Wtime ();
+    SC_CHECK_ABORT (!memcmp (ldata1, ldata2, total * sizeof (long)),
+                    "Allgatherv node mismatch");
+    sc_mpi_comm_detach_node_comms (mpicomm);
+  }
+
+  SC_FREE (lsend);
+  SC_FREE (ldata1);
+  SC_FREE (ldata2);
+  SC_FREE (counts);
+  SC_FREE (displs);
+  SC_FREE (sizes);
+  SC_FREE (offsets);
+
   SC_GLOBAL_STATISTICSF ("Timings with threshold %d on %d cores\n",
                          SC_ALLGATHER_ALLTOALL_MAX, mpisize);
   SC_GLOBAL_STATISTICSF ("   alltoall %g\n", elapsed_alltoall);
   SC_GLOBAL_STATISTICSF ("   recursive %g\n", elapsed_recursive);
   SC_GLOBAL_STATISTICSF ("   allgather %g\n", elapsed_allgather);
   SC_GLOBAL_STATISTICSF ("   replacement %g\n", elapsed_replacement);
+  SC_GLOBAL_STATISTICSF ("   allgatherv %g\n", elapsed_allgatherv);
+  SC_GLOBAL_STATISTICSF ("   bruck %g\n", elapsed_bruck);
+  SC_GLOBAL_STATISTICSF ("   node %g\n", elapsed_node);
 
   sc_finalize ();
 
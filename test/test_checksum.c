@@ -0,0 +1,261 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+#include <sc_checksum.h>
+#include <sc_containers.h>
+#ifdef SC_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef SC_ENABLE_PTHREAD
+#include <pthread.h>
+#endif
+
+/** Bitwise CRC-32C as the reference of the table and hardware versions. */
+static uint32_t
+test_crc32c_bitwise (const unsigned char *p, size_t len)
+{
+  int                 k;
+  uint32_t            crc = 0xFFFFFFFFU;
+
+  while (len-- > 0) {
+    crc ^= *p++;
+    for (k = 0; k < 8; ++k) {
+      crc = (crc & 1) ? (crc >> 1) ^ 0x82F63B78U : crc >> 1;
+    }
+  }
+  return ~crc;
+}
+
+/** Bytewise Adler-32 as the reference of the blocked versions. */
+static uint32_t
+test_adler32_bytewise (const unsigned char *p, size_t len)
+{
+  uint32_t            s1 = 1, s2 = 0;
+
+  while (len-- > 0) {
+    s1 = (s1 + *p++) % 65521;
+    s2 = (s2 + s1) % 65521;
+  }
+  return s1 | (s2 << 16);
+}
+
+/** Check the checksums of known strings. */
+static void
+test_vectors (void)
+{
+  const char         *digits = "123456789";
+
+  SC_CHECK_ABORT (sc_adler32 (0, NULL, 0) == 1, "Adler-32 initial");
+  SC_CHECK_ABORT (sc_crc32c (1, NULL, 0) == 0, "CRC-32C initial");
+  SC_CHECK_ABORT (sc_adler32 (1, "Wikipedia", 9) == 0x11E60398U,
+                  "Adler-32 of Wikipedia");
+  SC_CHECK_ABORT (sc_crc32c (0, digits, 9) == 0xE3069283U,
+                  "CRC-32C check value");
+  SC_CHECK_ABORT (sc_crc32c (sc_crc32c (0, digits, 4), digits + 4, 5) ==
+                  0xE3069283U, "CRC-32C update");
+}
+
+/** Compare the fast paths against the references for many lengths and
+ * alignments, and the combination of pieces against the whole. */
+static void
+test_data (const unsigned char *data, size_t size)
+{
+  int                 simd;
+  size_t              off, len, split;
+  uint32_t            adler, crc, a1, a2, c1, c2;
+
+  for (len = 0; len <= size; len = len < 300 ? len + 1 : len * 3 + 1) {
+    for (off = 0; off < 8 && off + len <= size; off += 3) {
+      adler = test_adler32_bytewise (data + off, len);
+      crc = test_crc32c_bitwise (data + off, len);
+#ifdef SC_HAVE_ZLIB
+      SC_CHECK_ABORT (adler == (uint32_t)
+                      adler32 (1, (const Bytef *) data + off, (uInt) len),
+                      "Adler-32 against zlib");
+#endif
+      for (simd = 0; simd <= 1; ++simd) {
+        sc_checksum_simd = simd;
+        SC_CHECK_ABORT (sc_adler32 (1, data + off, len) == adler,
+                        "Adler-32 against reference");
+        SC_CHECK_ABORT (sc_crc32c (0, data + off, len) == crc,
+                        "CRC-32C against reference");
+      }
+      for (split = 0; split <= len; split += len / 5 + 1) {
+        a1 = sc_adler32 (1, data + off, split);
+        a2 = sc_adler32 (1, data + off + split, len - split);
+        SC_CHECK_ABORT (sc_adler32_combine (a1, a2, len - split) == adler,
+                        "Adler-32 combine");
+        c1 = sc_crc32c (0, data + off, split);
+        c2 = sc_crc32c (0, data + off + split, len - split);
+        SC_CHECK_ABORT (sc_crc32c_combine (c1, c2, len - split) == crc,
+                        "CRC-32C combine");
+      }
+    }
+  }
+}
+
+#ifdef SC_ENABLE_PTHREAD
+
+/** Combine and checksum in a thread; the result is 0 on success. */
+static void        *
+test_thread (void *arg)
+{
+  const char         *digits = "123456789";
+  int                *result = (int *) arg;
+
+  *result = sc_crc32c_combine (sc_crc32c (0, digits, 4),
+                               sc_crc32c (0, digits + 4, 5), 5) !=
+    0xE3069283U;
+  return NULL;
+}
+
+/** Use the lazily initialized tables from several threads at once. */
+static void
+test_threads (void)
+{
+  int                 i, pth;
+  int                 results[8];
+  pthread_t           threads[8];
+
+  for (i = 0; i < 8; ++i) {
+    pth = pthread_create (&threads[i], NULL, test_thread, &results[i]);
+    SC_CHECK_ABORT (pth == 0, "Thread create");
+  }
+  for (i = 0; i < 8; ++i) {
+    pth = pthread_join (threads[i], NULL);
+    SC_CHECK_ABORT (pth == 0 && results[i] == 0, "CRC-32C in threads");
+  }
+}
+
+#endif /* SC_ENABLE_PTHREAD */
+
+/** Combine with runs of zeros of 2^29 bytes and more without allocating
+ * them.  The CRC of a run of twice a length is checked against two
+ * combines of the length, starting from lengths small enough to trust. */
+static void
+test_long_combine (void)
+{
+  int                 i;
+  size_t              len;
+  uint32_t            hello, zeros, once, twice;
+  char                block[4096];
+
+  /* the CRC of 2^28 zero bytes by doubling from a block of zeros */
+  memset (block, 0, sizeof (block));
+  zeros = sc_crc32c (0, block, sizeof (block));
+  for (len = sizeof (block); len < ((size_t) 1 << 28); len *= 2) {
+    zeros = sc_crc32c_combine (zeros, zeros, len);
+  }
+  hello = sc_crc32c (0, "hello", 5);
+  SC_CHECK_ABORT (sc_crc32c_combine (hello, sc_crc32c_combine
+                                     (zeros, zeros, len), 2 * len) ==
+                  0x25114817U, "CRC-32C with 512 MiB of zeros");
+
+  for (i = 0; i < 16 && len <= SIZE_MAX / 4; ++i, len *= 2) {
+    once = sc_crc32c_combine (hello, sc_crc32c_combine (zeros, zeros, len),
+                              2 * len);
+    twice = sc_crc32c_combine (sc_crc32c_combine (hello, zeros, len),
+                               zeros, len);
+    SC_CHECK_ABORT (once == twice, "CRC-32C combine of long runs");
+    zeros = sc_crc32c_combine (zeros, zeros, len);
+  }
+}
+
+/** Checksum a buffer distributed unevenly over the processes. */
+static void
+test_allreduce (const unsigned char *data, size_t size, sc_MPI_Comm mpicomm)
+{
+  int                 mpiret;
+  int                 mpisize, mpirank;
+  size_t              begin, end;
+
+  mpiret = sc_MPI_Comm_size (mpicomm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (mpicomm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+
+  /* the first process holds no data, the others quadratically more */
+  if (mpisize == 1) {
+    begin = 0;
+    end = size;
+  }
+  else {
+    begin = size * SC_SQR (SC_MAX (mpirank - 1, 0)) / SC_SQR (mpisize - 1);
+    end = size * SC_SQR (mpirank) / SC_SQR (mpisize - 1);
+  }
+  SC_CHECK_ABORT (sc_adler32_allreduce
+                  (sc_adler32 (1, data + begin, end - begin), end - begin,
+                   mpicomm) == sc_adler32 (1, data, size),
+                  "Adler-32 allreduce");
+  SC_CHECK_ABORT (sc_crc32c_allreduce
+                  (sc_crc32c (0, data + begin, end - begin), end - begin,
+                   mpicomm) == sc_crc32c (0, data, size),
+                  "CRC-32C allreduce");
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+  size_t              iz, size;
+  unsigned long       lcg;
+  unsigned char      *data;
+  sc_array_t          view;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_DEFAULT);
+
+#ifdef SC_ENABLE_PTHREAD
+  /* first, before any other function initializes the tables */
+  test_threads ();
+#endif
+  test_vectors ();
+  test_long_combine ();
+
+  /* random bytes, then all ones to stress the deferred modulo */
+  size = 100000;
+  data = SC_ALLOC (unsigned char, size);
+  for (iz = 0, lcg = 1; iz < size; ++iz) {
+    lcg = lcg * 1103515245 + 12345;
+    data[iz] = (unsigned char) (lcg >> 16);
+  }
+  test_data (data, size);
+  test_allreduce (data, size, sc_MPI_COMM_WORLD);
+  memset (data, 0xFF, size);
+  test_data (data, size);
+  test_allreduce (data, size, sc_MPI_COMM_WORLD);
+
+  /* the array checksum is the Adler-32 of its bytes */
+  sc_array_init_data (&view, data, 4, size / 4);
+  SC_CHECK_ABORT (sc_array_checksum (&view) == sc_adler32 (1, data, size),
+                  "Array checksum");
+  SC_FREE (data);
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
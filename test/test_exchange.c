@@ -0,0 +1,171 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+#include <sc_exchange.h>
+#include <sc_notify.h>
+
+/* the number of items sent by a rank to each of its receivers */
+#define NUM_ITEMS(rank) ((rank) % 3 + 1)
+
+static long
+item_value (int from, int to, int k, int round)
+{
+  return 1000L * from + 10L * to + k + round;
+}
+
+/** Exchange from views into one array and from separate arrays. */
+static void
+test_exchange (sc_MPI_Comm mpicomm, sc_array_t * receivers,
+               sc_array_t * senders, sc_exchange_type_t type, int contiguous)
+{
+  int                 i, k, r;
+  int                 mpiret;
+  int                 mpirank;
+  int                 num_receivers, num_senders;
+  int                 from, to, offset;
+  sc_array_t         *sendbufs, *recvbufs;
+  sc_array_t         *senddata, *recvdata;
+  sc_array_t         *a;
+  sc_exchange_t      *exc;
+
+  mpiret = sc_MPI_Comm_rank (mpicomm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+  num_receivers = (int) receivers->elem_count;
+  num_senders = (int) senders->elem_count;
+
+  exc = sc_exchange_new (mpicomm, receivers, senders, type);
+  SC_GLOBAL_INFOF ("Exchange type %d contiguous %d\n",
+                   (int) sc_exchange_get_type (exc), contiguous);
+
+  /* prepare the message buffers */
+  senddata = sc_array_new_count (sizeof (long),
+                                 num_receivers * NUM_ITEMS (mpirank));
+  sendbufs = sc_array_new_count (sizeof (sc_array_t), num_receivers);
+  for (i = 0; i < num_receivers; ++i) {
+    a = (sc_array_t *) sc_array_index_int (sendbufs, i);
+    if (contiguous) {
+      sc_array_init_view (a, senddata, i * NUM_ITEMS (mpirank),
+                          NUM_ITEMS (mpirank));
+    }
+    else {
+      sc_array_init_count (a, sizeof (long), NUM_ITEMS (mpirank));
+    }
+  }
+  offset = 0;
+  for (i = 0; i < num_senders; ++i) {
+    offset += NUM_ITEMS (*(int *) sc_array_index_int (senders, i));
+  }
+  recvdata = sc_array_new_count (sizeof (long), offset);
+  recvbufs = sc_array_new_count (sizeof (sc_array_t), num_senders);
+  offset = 0;
+  for (i = 0; i < num_senders; ++i) {
+    from = *(int *) sc_array_index_int (senders, i);
+    a = (sc_array_t *) sc_array_index_int (recvbufs, i);
+    if (contiguous) {
+      sc_array_init_view (a, recvdata, offset, NUM_ITEMS (from));
+    }
+    else {
+      sc_array_init_count (a, sizeof (long), NUM_ITEMS (from));
+    }
+    offset += NUM_ITEMS (from);
+  }
+
+  /* execute repeatedly with changing data */
+  for (r = 0; r < 3; ++r) {
+    for (i = 0; i < num_receivers; ++i) {
+      to = *(int *) sc_array_index_int (receivers, i);
+      a = (sc_array_t *) sc_array_index_int (sendbufs, i);
+      for (k = 0; k < NUM_ITEMS (mpirank); ++k) {
+        *(long *) sc_array_index_int (a, k) = item_value (mpirank, to, k, r);
+      }
+    }
+    sc_exchange_execute (exc, sendbufs, recvbufs);
+    for (i = 0; i < num_senders; ++i) {
+      from = *(int *) sc_array_index_int (senders, i);
+      a = (sc_array_t *) sc_array_index_int (recvbufs, i);
+      for (k = 0; k < NUM_ITEMS (from); ++k) {
+        SC_CHECK_ABORTF (*(long *) sc_array_index_int (a, k) ==
+                         item_value (from, mpirank, k, r),
+                         "Exchange mismatch from %d item %d", from, k);
+      }
+    }
+  }
+
+  for (i = 0; i < num_receivers; ++i) {
+    sc_array_reset ((sc_array_t *) sc_array_index_int (sendbufs, i));
+  }
+  for (i = 0; i < num_senders; ++i) {
+    sc_array_reset ((sc_array_t *) sc_array_index_int (recvbufs, i));
+  }
+  sc_array_destroy (sendbufs);
+  sc_array_destroy (recvbufs);
+  sc_array_destroy (senddata);
+  sc_array_destroy (recvdata);
+  sc_exchange_destroy (exc);
+}
+
+int
+main (int argc, char **argv)
+{
+  int                 i, j;
+  int                 mpiret;
+  int                 mpisize, mpirank;
+  int                 num_receivers;
+  sc_array_t         *receivers, *senders;
+  sc_MPI_Comm         mpicomm;
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+  mpicomm = sc_MPI_COMM_WORLD;
+  mpiret = sc_MPI_Comm_size (mpicomm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (mpicomm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+
+  sc_init (mpicomm, 1, 1, NULL, SC_LP_DEFAULT);
+
+  /* a sparse pattern that includes messages to ourselves */
+  num_receivers = SC_MIN (mpirank % 4 + 1, mpisize);
+  receivers = sc_array_new_count (sizeof (int), num_receivers);
+  for (i = 0; i < num_receivers; ++i) {
+    *(int *) sc_array_index_int (receivers, i) = (mpirank + i) % mpisize;
+  }
+  sc_array_sort (receivers, sc_int_compare);
+  senders = sc_array_new (sizeof (int));
+  sc_notify_ext (receivers, senders, NULL, NULL, mpicomm);
+
+  for (j = 0; j < SC_EXCHANGE_NUM_TYPES; ++j) {
+    test_exchange (mpicomm, receivers, senders, (sc_exchange_type_t) j, 1);
+    test_exchange (mpicomm, receivers, senders, (sc_exchange_type_t) j, 0);
+  }
+
+  sc_array_destroy (receivers);
+  sc_array_destroy (senders);
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
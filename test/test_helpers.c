@@ -28,6 +28,7 @@
 */
 
 #include <sc_io.h>
+#include <sc_random.h>
 
 #define SC_TEST_TOOLONG 123456789012345678901234567890123456789
 #define SC_TEST_LONG    1234567890123456789
@@ -312,6 +313,281 @@ test_encode_decode (void)
   return num_failed_tests;
 }
 
+static int
+single_raw_test (sc_array_t *src, sc_io_codec_t codec, int itest)
+{
+  int                 num_failed_tests = 0;
+  char                fc;
+  size_t              sz, original_size;
+  sc_array_t          dest, comp, view;
+
+  sz = src->elem_size * src->elem_count;
+  sc_array_init (&dest, 1);
+  sc_array_init (&comp, src->elem_size);
+  sc_io_encode_raw (src, &dest, codec, -1);
+
+  /* verify original data size and codec */
+  if (sc_io_decode_raw_info (&dest, &original_size, &fc, NULL) ||
+      original_size != sz || fc != "nzl"[codec]) {
+    SC_LERRORF ("raw decode info error on test %d codec %d\n",
+                itest, (int) codec);
+    ++num_failed_tests;
+    goto error_raw_test;
+  }
+
+  /* decode into a new array */
+  if (sc_io_decode_raw (&dest, &comp, 0, NULL) ||
+      comp.elem_count != src->elem_count ||
+      (sz > 0 && memcmp (src->array, comp.array, sz))) {
+    SC_LERRORF ("raw decode error on test %d codec %d\n",
+                itest, (int) codec);
+    ++num_failed_tests;
+    goto error_raw_test;
+  }
+
+  /* a truncated input must be rejected */
+  if (sz > 0) {
+    sc_array_init_view (&view, &dest, 0, dest.elem_count - 1);
+    if (!sc_io_decode_raw (&view, &comp, 0, NULL)) {
+      SC_LERRORF ("raw decode truncation on test %d codec %d\n",
+                  itest, (int) codec);
+      ++num_failed_tests;
+      goto error_raw_test;
+    }
+  }
+
+  /* encode and decode in place */
+  sc_array_reset (&dest);
+  sc_array_init_count (&dest, 1, sz);
+  if (sz > 0) {
+    memcpy (dest.array, src->array, sz);
+  }
+  sc_io_encode_raw (&dest, NULL, codec, -1);
+  if (sc_io_decode_raw (&dest, NULL, sz, NULL) || dest.elem_count != sz ||
+      (sz > 0 && memcmp (src->array, dest.array, sz))) {
+    SC_LERRORF ("raw decode in place error on test %d codec %d\n",
+                itest, (int) codec);
+    ++num_failed_tests;
+    goto error_raw_test;
+  }
+
+error_raw_test:
+  sc_array_reset (&comp);
+  sc_array_reset (&dest);
+  return num_failed_tests;
+}
+
+static int
+test_encode_decode_raw (void)
+{
+  int                 num_failed_tests = 0;
+  int                 c, i, j;
+  size_t              slen;
+  const size_t        sizes[5] = { 0, 11, 4321, 60000, 600000 };
+  sc_array_t          src;
+  sc_rand_state_t     state = 1;
+
+  for (i = 0; i < 5; ++i) {
+    /* compressible data of multiple chunks for the largest size */
+    slen = sizes[i];
+    sc_array_init_count (&src, sizeof (int), slen);
+    for (j = 0; j < (int) slen; ++j) {
+      *(int *) sc_array_index_int (&src, j) = (j / 7) % 1000 + 3 * i;
+    }
+    for (c = 0; c < SC_IO_CODEC_LAST; ++c) {
+      num_failed_tests += single_raw_test (&src, (sc_io_codec_t) c, i);
+    }
+
+    /* hardly compressible data */
+    for (j = 0; j < (int) slen; ++j) {
+      *(int *) sc_array_index_int (&src, j) =
+        (int) (sc_rand (&state) * INT_MAX);
+    }
+    for (c = 0; c < SC_IO_CODEC_LAST; ++c) {
+      num_failed_tests += single_raw_test (&src, (sc_io_codec_t) c, 5 + i);
+    }
+    sc_array_reset (&src);
+  }
+
+  return num_failed_tests;
+}
+
+/** Write VTK compressed data to a temporary file and read it back. */
+static void
+vtk_compressed_contents (sc_array_t *src, sc_array_t *contents)
+{
+  int                 retval;
+  long                length;
+  FILE               *file;
+
+  file = tmpfile ();
+  SC_CHECK_ABORT (file != NULL, "Open temporary file");
+  retval = sc_vtk_write_compressed (file, src->array,
+                                    src->elem_count * src->elem_size);
+  SC_CHECK_ABORT (retval == 0, "Write VTK compressed");
+  length = ftell (file);
+  SC_CHECK_ABORT (length >= 0 && !fseek (file, 0, SEEK_SET), "Rewind");
+  sc_array_resize (contents, (size_t) length);
+  sc_fread (contents->array, 1, (size_t) length, file, "Read VTK");
+  sc_fflush_fsync_fclose (file);
+}
+
+static int
+test_encode_threads (void)
+{
+  int                 num_failed_tests = 0;
+  int                 c, j, t;
+  const int           nthreads[2] = { 2, 5 };
+  const size_t        slen = 600000;
+  sc_array_t          src, view, serial, threaded;
+
+  sc_array_init_count (&src, sizeof (int), slen);
+  for (j = 0; j < (int) slen; ++j) {
+    *(int *) sc_array_index_int (&src, j) = (j / 7) % 1000 + (j % 13) * j;
+  }
+  sc_array_init (&serial, 1);
+  sc_array_init (&threaded, 1);
+  if (sc_have_zlib ()) {
+    vtk_compressed_contents (&src, &serial);
+  }
+
+  for (t = 0; t < 2; ++t) {
+    sc_io_compress_threads = nthreads[t];
+
+    /* chunked compression must decode to the original */
+    for (c = 0; c < SC_IO_CODEC_LAST; ++c) {
+      num_failed_tests += single_raw_test (&src, (sc_io_codec_t) c, 10 + t);
+    }
+    sc_array_init_view (&view, &src, 0, slen);
+    num_failed_tests += single_code_test (&view, 10 + t);
+
+    /* VTK output does not depend on the number of threads */
+    if (sc_have_zlib ()) {
+      vtk_compressed_contents (&src, &threaded);
+      if (threaded.elem_count != serial.elem_count ||
+          memcmp (threaded.array, serial.array, serial.elem_count)) {
+        SC_LERRORF ("VTK output differs with %d threads\n", nthreads[t]);
+        ++num_failed_tests;
+      }
+    }
+  }
+  sc_io_compress_threads = 1;
+
+  sc_array_reset (&threaded);
+  sc_array_reset (&serial);
+  sc_array_reset (&src);
+  return num_failed_tests;
+}
+
+/** Write VTK base 64 data to a temporary file and read it back. */
+static void
+vtk_binary_contents (sc_array_t *src, sc_array_t *contents)
+{
+  int                 retval;
+  long                length;
+  FILE               *file;
+
+  file = tmpfile ();
+  SC_CHECK_ABORT (file != NULL, "Open temporary file");
+  retval = sc_vtk_write_binary (file, src->array,
+                                src->elem_count * src->elem_size);
+  SC_CHECK_ABORT (retval == 0, "Write VTK binary");
+  length = ftell (file);
+  SC_CHECK_ABORT (length >= 0 && !fseek (file, 0, SEEK_SET), "Rewind");
+  sc_array_resize (contents, (size_t) length);
+  sc_fread (contents->array, 1, (size_t) length, file, "Read VTK");
+  sc_fflush_fsync_fclose (file);
+}
+
+/** Compare the SIMD base 64 code with the scalar one. */
+static int
+test_base64_simd (void)
+{
+  int                 num_failed_tests = 0;
+  int                 i, j, v, r[2];
+  const size_t        lens[6] = { 0, 1, 17, 57, 1000, 100003 };
+  const size_t        corrupt[4] = { 20, 45, 76, 100 };
+  sc_rand_state_t     state = 7;
+  sc_array_t          src, view, code[2], plain[2];
+
+  sc_array_init_count (&src, 1, lens[5] + 3);
+  for (j = 0; j < (int) src.elem_count; ++j) {
+    *(char *) sc_array_index_int (&src, j) = (char) (sc_rand (&state) * 256);
+  }
+  for (i = 0; i < 2; ++i) {
+    sc_array_init (&code[i], 1);
+    sc_array_init (&plain[i], 1);
+  }
+
+  /* encoded bytes are identical for all lengths and alignments */
+  for (i = 0; i < 6; ++i) {
+    for (j = 0; j < 4; ++j) {
+      sc_array_init_view (&view, &src, (size_t) j, lens[i]);
+      for (v = 0; v < 2; ++v) {
+        sc_io_base64_simd = v;
+        sc_io_encode_zlib (&view, &code[v], 0, '=');
+      }
+      if (code[0].elem_count != code[1].elem_count ||
+          memcmp (code[0].array, code[1].array, code[0].elem_count)) {
+        SC_LERRORF ("SIMD encoding differs for length %d\n", (int) lens[i]);
+        ++num_failed_tests;
+        continue;
+      }
+      r[0] = sc_io_decode (&code[0], &plain[0], 0, NULL);
+      if (r[0] || plain[0].elem_count != lens[i] ||
+          memcmp (plain[0].array, view.array, lens[i])) {
+        SC_LERRORF ("SIMD decoding failed for length %d\n", (int) lens[i]);
+        ++num_failed_tests;
+      }
+    }
+    sc_array_init_view (&view, &src, 1, lens[i]);
+    for (v = 0; v < 2; ++v) {
+      sc_io_base64_simd = v;
+      vtk_binary_contents (&view, &code[v]);
+    }
+    if (code[0].elem_count != code[1].elem_count ||
+        memcmp (code[0].array, code[1].array, code[0].elem_count)) {
+      SC_LERRORF ("SIMD VTK output differs for length %d\n", (int) lens[i]);
+      ++num_failed_tests;
+    }
+  }
+
+  /* the decoders agree on every byte value in every vector position */
+  sc_array_init_view (&view, &src, 0, lens[4]);
+  sc_io_base64_simd = 0;
+  sc_io_encode_zlib (&view, &code[0], 0, '=');
+  sc_array_resize (&code[1], code[0].elem_count);
+  sc_set_log_defaults (NULL, NULL, SC_LP_SILENT);
+  for (i = 0; i < 4; ++i) {
+    for (j = 1; j < 256; ++j) {
+      memcpy (code[1].array, code[0].array, code[0].elem_count);
+      code[1].array[corrupt[i]] = (char) j;
+      for (v = 0; v < 2; ++v) {
+        sc_io_base64_simd = v;
+        r[v] = sc_io_decode (&code[1], &plain[v], 0, NULL);
+      }
+      if (r[0] != r[1] || (r[0] == 0 &&
+                           (plain[0].elem_count != plain[1].elem_count ||
+                            memcmp (plain[0].array, plain[1].array,
+                                    plain[0].elem_count)))) {
+        ++num_failed_tests;
+      }
+    }
+  }
+  sc_set_log_defaults (NULL, NULL, SC_LP_DEFAULT);
+  if (num_failed_tests) {
+    SC_LERROR ("SIMD decoding differs from scalar code\n");
+  }
+  sc_io_base64_simd = 1;
+
+  for (i = 0; i < 2; ++i) {
+    sc_array_reset (&code[i]);
+    sc_array_reset (&plain[i]);
+  }
+  sc_array_reset (&src);
+  return num_failed_tests;
+}
+
 int
 main (int argc, char **argv)
 {
@@ -344,6 +620,9 @@ main (int argc, char **argv)
 
   /* test encode and decode functions */
   num_failed_tests += test_encode_decode ();
+  num_failed_tests += test_encode_decode_raw ();
+  num_failed_tests += test_encode_threads ();
+  num_failed_tests += test_base64_simd ();
 
   /* clean up and exit */
   sc_finalize ();
@@ -0,0 +1,186 @@
+/*
+  This file is part of the SC Library.
+  The SC Library provides support for parallel scientific applications.
+
+  Copyright (C) 2010 The University of Texas System
+  Additional copyright (C) 2011 individual authors
+
+  The SC Library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  The SC Library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with the SC Library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  02110-1301, USA.
+*/
+
+#include <sc_inflate.h>
+#include <sc_puff.h>
+#ifdef SC_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+/* a short text deflated with the fixed code */
+static const char   test_text[] =
+  "sc_inflate sc_inflate sc_inflate decodes deflate\n";
+static const unsigned char test_fixed[] = {
+  0x2b, 0x4e, 0x8e, 0xcf, 0xcc, 0x4b, 0xcb, 0x49, 0x2c, 0x49, 0x55, 0x28,
+  0xc6, 0xca, 0x4c, 0x49, 0x4d, 0xce, 0x4f, 0x49, 0x2d, 0x06, 0xd2, 0x60,
+  0x3e, 0x17, 0x00
+};
+
+/** Decode a stream that is followed by other data. */
+static void
+test_fixed_code (void)
+{
+  int                 retval;
+  size_t              srclen;
+  char                src[sizeof (test_fixed) + 4];
+  char                dest[sizeof (test_text)];
+
+  memcpy (src, test_fixed, sizeof (test_fixed));
+  memset (src + sizeof (test_fixed), 0xFF, 4);
+  srclen = sizeof (src);
+  retval = sc_inflate (dest, sizeof (test_text) - 1, src, &srclen);
+  SC_CHECK_ABORT (retval == 0 && srclen == sizeof (test_fixed) &&
+                  !memcmp (dest, test_text, sizeof (test_text) - 1),
+                  "Inflate fixed code");
+
+  /* the output size must match exactly */
+  srclen = sizeof (src);
+  retval = sc_inflate (dest, sizeof (test_text) - 2, src, &srclen);
+  SC_CHECK_ABORT (retval != 0, "Inflate output too small");
+  srclen = sizeof (src);
+  retval = sc_inflate (dest, sizeof (test_text), src, &srclen);
+  SC_CHECK_ABORT (retval != 0, "Inflate output too large");
+
+  /* a truncated stream fails */
+  srclen = sizeof (test_fixed) - 1;
+  retval = sc_inflate (dest, sizeof (test_text) - 1, src, &srclen);
+  SC_CHECK_ABORT (retval != 0, "Inflate truncated");
+}
+
+#ifdef SC_HAVE_ZLIB
+
+/** Compress with zlib and compare the decoders on the result. */
+static void
+test_zlib (const char *data, size_t size, int level, int strategy)
+{
+  int                 zrv, retval, k;
+  size_t              srclen, bound;
+  unsigned long       plen, slen;
+  char               *comp, *dest;
+  z_stream            strm;
+
+  memset (&strm, 0, sizeof (z_stream));
+  zrv = deflateInit2 (&strm, level, Z_DEFLATED, -15, 8, strategy);
+  SC_CHECK_ABORT (zrv == Z_OK, "Deflate init");
+  bound = (size_t) deflateBound (&strm, (uLong) size);
+  comp = SC_ALLOC (char, bound);
+  dest = SC_ALLOC (char, size + 1);
+  strm.next_in = (Bytef *) data;
+  strm.avail_in = (uInt) size;
+  strm.next_out = (Bytef *) comp;
+  strm.avail_out = (uInt) bound;
+  zrv = deflate (&strm, Z_FINISH);
+  SC_CHECK_ABORT (zrv == Z_STREAM_END, "Deflate");
+  srclen = bound - strm.avail_out;
+  deflateEnd (&strm);
+
+  /* both decoders reproduce the data */
+  bound = srclen;
+  retval = sc_inflate (dest, size, comp, &srclen);
+  SC_CHECK_ABORT (retval == 0 && srclen == bound &&
+                  (size == 0 || !memcmp (dest, data, size)), "Inflate");
+  if (size <= 70000) {
+    plen = (unsigned long) size;
+    slen = (unsigned long) srclen;
+    retval = sc_puff ((unsigned char *) dest, &plen,
+                      (const unsigned char *) comp, &slen);
+    SC_CHECK_ABORT (retval == 0 && plen == size && slen == srclen &&
+                    (size == 0 || !memcmp (dest, data, size)), "Puff");
+  }
+
+  /* corrupt data must not make the decoder misbehave */
+  srclen = bound - 1;
+  retval = sc_inflate (dest, size, comp, &srclen);
+  SC_CHECK_ABORT (retval != 0, "Inflate truncated");
+  for (k = 0; k < 8 && bound > 0; ++k) {
+    comp[(k * 7919) % bound] ^= (char) (1 << k);
+    srclen = bound;
+    (void) sc_inflate (dest, size, comp, &srclen);
+  }
+
+  SC_FREE (comp);
+  SC_FREE (dest);
+}
+
+#endif /* SC_HAVE_ZLIB */
+
+int
+main (int argc, char **argv)
+{
+  int                 mpiret;
+#ifdef SC_HAVE_ZLIB
+  int                 level, s;
+  const int           strategies[5] = {
+    Z_DEFAULT_STRATEGY, Z_FILTERED, Z_HUFFMAN_ONLY, Z_RLE, Z_FIXED
+  };
+  size_t              iz, size;
+  unsigned long       lcg;
+  double              x;
+  char               *data;
+#endif
+
+  mpiret = sc_MPI_Init (&argc, &argv);
+  SC_CHECK_MPI (mpiret);
+  sc_init (sc_MPI_COMM_WORLD, 1, 1, NULL, SC_LP_DEFAULT);
+
+  test_fixed_code ();
+
+#ifdef SC_HAVE_ZLIB
+  /* text, noise, runs and smooth doubles, longer than the window */
+  size = 300000;
+  data = SC_ALLOC (char, size);
+  for (iz = 0, lcg = 1; iz < size; ++iz) {
+    lcg = lcg * 1103515245 + 12345;
+    if (iz < size / 4) {
+      data[iz] = test_text[(lcg >> 16) % 11 ? iz % 49 : (lcg >> 20) % 49];
+    }
+    else if (iz < size / 2) {
+      data[iz] = (char) (lcg >> 16);
+    }
+    else if (iz < 3 * size / 4) {
+      data[iz] = (char) ((lcg >> 16) % 97 ? iz / 1000 : 0);
+    }
+    else {
+      x = 1. + .5 * (iz / sizeof (double));
+      memcpy (data + iz, &x, SC_MIN (sizeof (double), size - iz));
+      iz += SC_MIN (sizeof (double), size - iz) - 1;
+    }
+  }
+  for (s = 0; s < 5; ++s) {
+    for (level = 0; level <= 9; level += 3) {
+      test_zlib (data, 0, level, strategies[s]);
+      test_zlib (data, 1, level, strategies[s]);
+      test_zlib (data, 70000, level, strategies[s]);
+      test_zlib (data, size, level, strategies[s]);
+    }
+  }
+  SC_FREE (data);
+#endif
+
+  sc_finalize ();
+
+  mpiret = sc_MPI_Finalize ();
+  SC_CHECK_MPI (mpiret);
+
+  return 0;
+}
@@ -106,6 +106,72 @@ test_file (const char *filename)
   return test_return (0, buffer);
 }
 
+/** Write and read back a file collectively with nonblocking calls. */
+static int
+test_async (sc_MPI_Comm mpicomm, const char *filename)
+{
+  int                 i;
+  int                 mpiret;
+  int                 mpirank;
+  int                 errcode;
+  int                 flag, ocount;
+  const int           count = 1000;
+  int                *data, *back;
+  sc_MPI_File         file;
+  sc_MPI_Offset       offset;
+  sc_io_request_t    *request;
+
+  mpiret = sc_MPI_Comm_rank (mpicomm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+  data = SC_ALLOC (int, count);
+  back = SC_ALLOC (int, count);
+  for (i = 0; i < count; ++i) {
+    data[i] = count * mpirank + i;
+  }
+  offset = (sc_MPI_Offset) mpirank * count * sizeof (int);
+
+  /* write and poll for completion */
+  errcode = sc_io_open (mpicomm, filename, SC_IO_WRITE_CREATE,
+                        sc_MPI_INFO_NULL, &file);
+  SC_CHECK_ABORT (errcode == sc_MPI_SUCCESS, "Open for writing");
+  errcode = sc_io_iwrite_at_all (file, offset, data,
+                                 count * (int) sizeof (int), sc_MPI_BYTE,
+                                 &request);
+  SC_CHECK_ABORT (errcode == sc_MPI_SUCCESS && request != NULL,
+                  "Start writing");
+  do {
+    errcode = sc_io_test (&request, &flag, &ocount);
+  }
+  while (!flag);
+  SC_CHECK_ABORT (errcode == sc_MPI_SUCCESS && request == NULL, "Write");
+  SC_CHECK_ABORT (ocount == count * (int) sizeof (int), "Write count");
+  errcode = sc_io_close (&file);
+  SC_CHECK_ABORT (errcode == sc_MPI_SUCCESS, "Close after writing");
+
+  /* read and wait for completion */
+  errcode = sc_io_open (mpicomm, filename, SC_IO_READ,
+                        sc_MPI_INFO_NULL, &file);
+  SC_CHECK_ABORT (errcode == sc_MPI_SUCCESS, "Open for reading");
+  errcode = sc_io_iread_at_all (file, offset, back,
+                                count * (int) sizeof (int), sc_MPI_BYTE,
+                                &request);
+  SC_CHECK_ABORT (errcode == sc_MPI_SUCCESS && request != NULL,
+                  "Start reading");
+  errcode = sc_io_wait (&request, &ocount);
+  SC_CHECK_ABORT (errcode == sc_MPI_SUCCESS && request == NULL, "Read");
+  SC_CHECK_ABORT (ocount == count * (int) sizeof (int), "Read count");
+  errcode = sc_io_close (&file);
+  SC_CHECK_ABORT (errcode == sc_MPI_SUCCESS, "Close after reading");
+
+  errcode = memcmp (data, back, count * sizeof (int)) ? -1 : 0;
+  if (errcode) {
+    SC_LERRORF ("Content error reading file %s\n", filename);
+  }
+  SC_FREE (data);
+  SC_FREE (back);
+  return errcode;
+}
+
 int
 main (int argc, char **argv)
 {
@@ -148,6 +214,10 @@ main (int argc, char **argv)
     snprintf (filename, BUFSIZ, "%s.%06d", filepref, mpirank);
     retloc = test_file (filename);
 
+    /* run the collective nonblocking test on a shared file */
+    snprintf (filename, BUFSIZ, "%s.async", filepref);
+    retloc |= test_async (mpicomm, filename);
+
     /* the test function is not collective; synchronize error value */
     mpiret = sc_MPI_Allreduce (&retloc, &retval, 1, sc_MPI_INT,
                                sc_MPI_LOR, mpicomm);
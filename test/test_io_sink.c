@@ -62,6 +62,264 @@ the_test (const char *filename)
   }
 }
 
+#ifdef SC_HAVE_ZLIB
+
+/** Write two streams of data in pieces of varying size. */
+static void
+stream_write (sc_io_sink_t * sink, sc_array_t * data)
+{
+  int                 retval;
+  int                 k;
+  size_t              pos, piece, bytes_in;
+
+  for (k = 0; k < 2; ++k) {
+    /* this begins the stream even without data */
+    retval = sc_io_sink_write (sink, data->array, 0);
+    SC_CHECK_ABORT (retval == 0, "Stream begin");
+    for (pos = 0, piece = 1; pos < data->elem_count; piece *= 7) {
+      piece = SC_MIN (piece, data->elem_count - pos);
+      retval = sc_io_sink_write (sink, data->array + pos, piece);
+      SC_CHECK_ABORT (retval == 0, "Stream write");
+      pos += piece;
+    }
+    retval = sc_io_sink_complete (sink, &bytes_in, NULL);
+    SC_CHECK_ABORT (retval == 0 && bytes_in == data->elem_count,
+                    "Stream complete");
+  }
+}
+
+/** Read two streams back and skip over part of the second one. */
+static void
+stream_read (sc_io_source_t * source, sc_array_t * data)
+{
+  int                 retval;
+  int                 k;
+  size_t              half = data->elem_count / 2, bytes_out;
+  sc_array_t         *back;
+
+  back = sc_array_new_count (1, data->elem_count + 1);
+  for (k = 0; k < 2; ++k) {
+    retval = sc_io_source_read (source, k ? NULL : back->array, half, NULL);
+    SC_CHECK_ABORT (retval == 0, "Stream read");
+    if (data->elem_count > 0) {
+      retval = sc_io_source_complete (source, NULL, NULL);
+      SC_CHECK_ABORT (retval == SC_IO_ERROR_AGAIN, "Stream incomplete");
+    }
+    retval = sc_io_source_read (source, back->array + half,
+                                data->elem_count + 1 - half, &bytes_out);
+    SC_CHECK_ABORT (retval == 0 && bytes_out == data->elem_count - half,
+                    "Stream read end");
+    SC_CHECK_ABORT (!memcmp (back->array + (k ? half : 0),
+                             data->array + (k ? half : 0),
+                             data->elem_count - (k ? half : 0)),
+                    "Stream data");
+    retval = sc_io_source_complete (source, NULL, NULL);
+    SC_CHECK_ABORT (retval == 0, "Stream complete");
+  }
+  sc_array_destroy (back);
+}
+
+/** Encode and decode through a buffer and through a file. */
+static void
+test_stream (sc_io_encode_t encode, size_t size)
+{
+  int                 retval;
+  size_t              iz;
+  unsigned long       lcg;
+  FILE               *file;
+  sc_array_t         *data, *buffer, *ref;
+  sc_io_sink_t       *sink;
+  sc_io_source_t     *source;
+
+  /* the output exceeds the window of the stream */
+  data = sc_array_new_count (1, size);
+  for (iz = 0, lcg = 1; iz < size; ++iz) {
+    lcg = lcg * 1103515245 + 12345;
+    data->array[iz] = (char) (iz % 4 ? iz % 251 : lcg >> 16);
+  }
+
+  buffer = sc_array_new (1);
+  sink = sc_io_sink_new (SC_IO_TYPE_BUFFER, SC_IO_MODE_WRITE, encode,
+                         buffer);
+  SC_CHECK_ABORT (sink != NULL, "Stream sink create");
+  stream_write (sink, data);
+  retval = sc_io_sink_destroy (sink);
+  SC_CHECK_ABORT (retval == 0, "Stream sink destroy");
+  if (encode == SC_IO_ENCODE_BASE64) {
+    /* each stream matches the encoding in one piece */
+    ref = sc_array_new (1);
+    sc_io_encode (data, ref);
+    SC_CHECK_ABORT (2 * ref->elem_count == buffer->elem_count &&
+                    !memcmp (buffer->array, ref->array, ref->elem_count),
+                    "Stream matches sc_io_encode");
+    sc_array_destroy (ref);
+  }
+  source = sc_io_source_new (SC_IO_TYPE_BUFFER, encode, buffer);
+  SC_CHECK_ABORT (source != NULL, "Stream source create");
+  stream_read (source, data);
+  retval = sc_io_source_destroy (source);
+  SC_CHECK_ABORT (retval == 0, "Stream source destroy");
+  SC_GLOBAL_INFOF ("Stream encoding %d size %lld buffer %lld\n",
+                   (int) encode, (long long) size,
+                   (long long) buffer->elem_count);
+  sc_array_destroy (buffer);
+
+  /* a file requires going back to write the header */
+  file = tmpfile ();
+  SC_CHECK_ABORT (file != NULL, "Open temporary file");
+  sink = sc_io_sink_new (SC_IO_TYPE_FILEFILE, SC_IO_MODE_WRITE, encode,
+                         file);
+  SC_CHECK_ABORT (sink != NULL, "Stream file sink create");
+  stream_write (sink, data);
+  retval = sc_io_sink_destroy (sink);
+  SC_CHECK_ABORT (retval == 0, "Stream file sink destroy");
+  rewind (file);
+  source = sc_io_source_new (SC_IO_TYPE_FILEFILE, encode, file);
+  SC_CHECK_ABORT (source != NULL, "Stream file source create");
+  stream_read (source, data);
+  retval = sc_io_source_destroy (source);
+  SC_CHECK_ABORT (retval == 0, "Stream file source destroy");
+  fclose (file);
+
+  sc_array_destroy (data);
+}
+
+#endif /* SC_HAVE_ZLIB */
+
+/** Write many small pieces singly and in vectors with varying buffers. */
+static void
+test_writev (size_t combine, int use_file)
+{
+  int                 retval;
+  int                 i, k;
+  size_t              iz, bytes_in, bytes_out;
+  sc_io_iovec_t       iov[5];
+  sc_array_t         *data, *buffer;
+  sc_io_sink_t       *sink;
+
+  data = sc_array_new_count (1, 40000);
+  for (iz = 0; iz < data->elem_count; ++iz) {
+    data->array[iz] = (char) (iz % 239);
+  }
+
+  buffer = sc_array_new (1);
+  if (use_file) {
+    sink = sc_io_sink_new (SC_IO_TYPE_FILENAME, SC_IO_MODE_WRITE,
+                           SC_IO_ENCODE_NONE, "sc_test_io_sink_writev.dat");
+  }
+  else {
+    sink = sc_io_sink_new (SC_IO_TYPE_BUFFER, SC_IO_MODE_WRITE,
+                           SC_IO_ENCODE_NONE, buffer);
+  }
+  SC_CHECK_ABORT (sink != NULL, "Writev sink create");
+  retval = sc_io_sink_buffer (sink, combine);
+  SC_CHECK_ABORT (retval == 0, "Writev buffer size");
+
+  /* alternate single writes and vectors of pieces up to 3000 bytes */
+  for (iz = 0, k = 0; iz < data->elem_count; ++k) {
+    if (k % 2) {
+      for (i = 0; i < 5 && iz < data->elem_count; ++i) {
+        iov[i].data = data->array + iz;
+        iov[i].bytes = SC_MIN ((size_t) (i * i * k % 3001),
+                               data->elem_count - iz);
+        iz += iov[i].bytes;
+      }
+      retval = sc_io_sink_writev (sink, iov, i);
+    }
+    else {
+      retval = sc_io_sink_write (sink, data->array + iz,
+                                 SC_MIN ((size_t) (k % 17),
+                                         data->elem_count - iz));
+      iz += SC_MIN ((size_t) (k % 17), data->elem_count - iz);
+    }
+    SC_CHECK_ABORT (retval == 0, "Writev write");
+  }
+  retval = sc_io_sink_complete (sink, &bytes_in, &bytes_out);
+  SC_CHECK_ABORT (retval == 0 && bytes_in == data->elem_count &&
+                  bytes_out == data->elem_count, "Writev complete");
+  retval = sc_io_sink_destroy (sink);
+  SC_CHECK_ABORT (retval == 0, "Writev sink destroy");
+
+  if (use_file) {
+    retval = sc_io_file_load ("sc_test_io_sink_writev.dat", buffer);
+    SC_CHECK_ABORT (retval == 0, "Writev load");
+    retval = remove ("sc_test_io_sink_writev.dat");
+    SC_CHECK_ABORT (retval == 0, "Writev remove");
+  }
+  SC_CHECK_ABORT (buffer->elem_count == data->elem_count &&
+                  !memcmp (buffer->array, data->array, data->elem_count),
+                  "Writev data");
+  sc_array_destroy (buffer);
+  sc_array_destroy (data);
+}
+
+/** Map a file into memory and read it through a source. */
+static void
+test_map (size_t size)
+{
+  const char         *filename = "sc_test_io_sink_map.dat";
+  int                 retval;
+  size_t              iz, bytes_out;
+  sc_array_t         *data, *back, view;
+  sc_io_source_t     *source;
+#ifdef SC_HAVE_ZLIB
+  sc_io_sink_t       *sink;
+#endif
+
+  data = sc_array_new_count (1, size);
+  for (iz = 0; iz < size; ++iz) {
+    data->array[iz] = (char) (iz % 253);
+  }
+  retval = sc_io_file_save (filename, data);
+  SC_CHECK_ABORT (retval == 0, "Map save");
+
+  /* the view shows the file contents */
+  retval = sc_io_file_map (filename, &view);
+  SC_CHECK_ABORT (retval == 0 && view.elem_count == size &&
+                  (size == 0 || !memcmp (view.array, data->array, size)),
+                  "Map view");
+  retval = sc_io_file_unmap (&view);
+  SC_CHECK_ABORT (retval == 0 && view.elem_count == 0, "Map unmap");
+
+  /* a mapped source reads like a buffer */
+  back = sc_array_new_count (1, size + 1);
+  source = sc_io_source_new (SC_IO_TYPE_MMAP, SC_IO_ENCODE_NONE, filename);
+  SC_CHECK_ABORT (source != NULL, "Map source create");
+  retval = sc_io_source_read (source, back->array, size / 3, NULL);
+  SC_CHECK_ABORT (retval == 0, "Map read");
+  retval = sc_io_source_read (source, back->array + size / 3,
+                              size + 1 - size / 3, &bytes_out);
+  SC_CHECK_ABORT (retval == 0 && bytes_out == size - size / 3,
+                  "Map read end");
+  SC_CHECK_ABORT (size == 0 || !memcmp (back->array, data->array, size),
+                  "Map data");
+  retval = sc_io_source_destroy (source);
+  SC_CHECK_ABORT (retval == 0, "Map source destroy");
+  sc_array_destroy (back);
+
+#ifdef SC_HAVE_ZLIB
+  /* an encoded file is decoded from the mapping */
+  sink = sc_io_sink_new (SC_IO_TYPE_FILENAME, SC_IO_MODE_WRITE,
+                         SC_IO_ENCODE_ZLIB, filename);
+  SC_CHECK_ABORT (sink != NULL, "Map sink create");
+  stream_write (sink, data);
+  retval = sc_io_sink_destroy (sink);
+  SC_CHECK_ABORT (retval == 0, "Map sink destroy");
+  source = sc_io_source_new (SC_IO_TYPE_MMAP, SC_IO_ENCODE_ZLIB, filename);
+  SC_CHECK_ABORT (source != NULL, "Map stream source create");
+  stream_read (source, data);
+  retval = sc_io_source_destroy (source);
+  SC_CHECK_ABORT (retval == 0, "Map stream source destroy");
+#endif
+
+  SC_CHECK_ABORT (sc_io_sink_new (SC_IO_TYPE_MMAP, SC_IO_MODE_WRITE,
+                                  SC_IO_ENCODE_NONE, filename) == NULL,
+                  "Map sink unsupported");
+  retval = remove (filename);
+  SC_CHECK_ABORT (retval == 0, "Map remove");
+  sc_array_destroy (data);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -85,6 +343,20 @@ main (int argc, char **argv)
 
   if (sc_is_root ()) {
     the_test (filename);
+#ifdef SC_HAVE_ZLIB
+    test_stream (SC_IO_ENCODE_ZLIB, 0);
+    test_stream (SC_IO_ENCODE_ZLIB, 1000000);
+    test_stream (SC_IO_ENCODE_BASE64, 0);
+    test_stream (SC_IO_ENCODE_BASE64, 57 * 5 - 9);
+    test_stream (SC_IO_ENCODE_BASE64, 1000000);
+#endif
+    test_map (0);
+    test_map (100000);
+    test_writev (0, 0);
+    test_writev (100, 0);
+    test_writev (SC_IO_SINK_BUFFER, 0);
+    test_writev (100, 1);
+    test_writev (SC_IO_SINK_BUFFER, 1);
   }
 
   sc_options_destroy (opt);
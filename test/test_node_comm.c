@@ -75,6 +75,14 @@ test_shmem (int count, sc_MPI_Comm comm, sc_shmem_type_t type)
     return 1;
   }
 
+  sc_shmem_allgather_long (myval, (size_t) count, sc_MPI_LONG,
+                           recv_shmem, (size_t) count, sc_MPI_LONG, comm);
+  check = memcmp (recv_self, recv_shmem, count * sizeof (long int) * size);
+  if (check) {
+    SC_GLOBAL_LERROR ("sc_shmem_allgather_long mismatch\n");
+    return 1;
+  }
+
   copy_shmem = SC_SHMEM_ALLOC (long int, (size_t) count * size, comm);
   sc_shmem_memcpy (copy_shmem, recv_shmem,
                    (size_t) count * sizeof (long int) * size, comm);
@@ -102,6 +110,132 @@ test_shmem (int count, sc_MPI_Comm comm, sc_shmem_type_t type)
   return 0;
 }
 
+int
+test_shmem_allgatherv (int count, sc_MPI_Comm comm, sc_shmem_type_t type)
+{
+  int                 i, p, size, rank, mpiret, total;
+  int                *counts, *displs;
+  long int           *myval, *recv_self, *recv_shmem;
+  size_t             *lcounts, *ldispls;
+
+  sc_shmem_set_type (comm, type);
+
+  mpiret = sc_MPI_Comm_size (comm, &size);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (comm, &rank);
+  SC_CHECK_MPI (mpiret);
+
+  /* varying counts in reverse order of the processes */
+  counts = SC_ALLOC (int, size);
+  displs = SC_ALLOC (int, size);
+  lcounts = SC_ALLOC (size_t, size);
+  ldispls = SC_ALLOC (size_t, size);
+  total = 0;
+  for (p = size - 1; p >= 0; p--) {
+    counts[p] = count * (p % 3);
+    displs[p] = total;
+    lcounts[p] = (size_t) counts[p];
+    ldispls[p] = (size_t) total;
+    total += counts[p];
+  }
+  myval = SC_ALLOC (long int, counts[rank] + 1);
+  for (i = 0; i < counts[rank]; i++) {
+    myval[i] = random ();
+  }
+  recv_self = SC_ALLOC (long int, total + 1);
+  mpiret = sc_MPI_Allgatherv (myval, counts[rank], sc_MPI_LONG,
+                              recv_self, counts, displs, sc_MPI_LONG, comm);
+  SC_CHECK_MPI (mpiret);
+
+  recv_shmem = SC_SHMEM_ALLOC (long int, (size_t) total + 1, comm);
+  sc_shmem_allgatherv (myval, counts[rank], sc_MPI_LONG,
+                       recv_shmem, counts, displs, sc_MPI_LONG, comm);
+  if (memcmp (recv_self, recv_shmem, total * sizeof (long int))) {
+    SC_GLOBAL_LERROR ("sc_shmem_allgatherv mismatch\n");
+    return 1;
+  }
+  SC_SHMEM_FREE (recv_shmem, comm);
+
+  recv_shmem = SC_SHMEM_ALLOC (long int, (size_t) total + 1, comm);
+  sc_shmem_allgatherv_long (myval, lcounts[rank], sc_MPI_LONG,
+                            recv_shmem, lcounts, ldispls, sc_MPI_LONG, comm);
+  if (memcmp (recv_self, recv_shmem, total * sizeof (long int))) {
+    SC_GLOBAL_LERROR ("sc_shmem_allgatherv_long mismatch\n");
+    return 1;
+  }
+  SC_SHMEM_FREE (recv_shmem, comm);
+
+  SC_FREE (counts);
+  SC_FREE (displs);
+  SC_FREE (lcounts);
+  SC_FREE (ldispls);
+  SC_FREE (recv_self);
+  SC_FREE (myval);
+  return 0;
+}
+
+int
+test_shmem_array (int count, sc_MPI_Comm comm, sc_shmem_type_t type)
+{
+  int                 i, size, rank, mpiret;
+  long int           *myval, *recv_self;
+  char               *data;
+  size_t              zz;
+  sc_shmem_array_t   *sa;
+
+  sc_shmem_set_type (comm, type);
+
+  mpiret = sc_MPI_Comm_size (comm, &size);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (comm, &rank);
+  SC_CHECK_MPI (mpiret);
+
+  myval = SC_ALLOC (long int, count);
+  for (i = 0; i < count; i++) {
+    myval[i] = random ();
+  }
+  recv_self = SC_ALLOC (long int, count * size);
+  mpiret = sc_MPI_Allgather (myval, count, sc_MPI_LONG,
+                             recv_self, count, sc_MPI_LONG, comm);
+  SC_CHECK_MPI (mpiret);
+
+  /* gather into storage that is large enough and must be reused */
+  sa = sc_shmem_array_new (sizeof (long int), (size_t) count * size, comm);
+  data = sa->array;
+  sc_shmem_array_allgather (sa, myval, count);
+  if (sa->array != data || sa->elem_count != (size_t) count * size ||
+      memcmp (recv_self, sc_shmem_array_index (sa, 0),
+              count * sizeof (long int) * size)) {
+    SC_GLOBAL_LERROR ("sc_shmem_array_allgather mismatch\n");
+    return 1;
+  }
+
+  /* grow the array and write its tail */
+  sc_shmem_array_resize (sa, (size_t) count * size + 100);
+  if (sc_shmem_array_write_start (sa)) {
+    for (zz = (size_t) count * size; zz < sa->elem_count; ++zz) {
+      *(long int *) sc_shmem_array_index (sa, zz) = (long int) zz;
+    }
+  }
+  sc_shmem_array_write_end (sa);
+  if (memcmp (recv_self, sc_shmem_array_index (sa, 0),
+              count * sizeof (long int) * size) ||
+      *(long int *) sc_shmem_array_index (sa, sa->elem_count - 1) !=
+      (long int) sa->elem_count - 1) {
+    SC_GLOBAL_LERROR ("sc_shmem_array_resize mismatch\n");
+    return 2;
+  }
+  SC_GLOBAL_INFOF ("sc_shmem_array uses %lu bytes per node\n",
+                   (unsigned long) sc_shmem_array_node_memory_used (sa));
+
+  sc_shmem_array_resize (sa, 0);
+  sc_shmem_array_destroy (sa);
+
+  SC_FREE (recv_self);
+  SC_FREE (myval);
+  return 0;
+}
+
 int
 main (int argc, char **argv)
 {
@@ -133,6 +267,9 @@ main (int argc, char **argv)
 
       SC_GLOBAL_PRODUCTIONF ("  count = %d\n", count);
       retval += test_shmem (count, mpicomm, (sc_shmem_type_t) itype);
+      retval += test_shmem_array (count, mpicomm, (sc_shmem_type_t) itype);
+      retval +=
+        test_shmem_allgatherv (count, mpicomm, (sc_shmem_type_t) itype);
       if (retval != retvalin) {
         SC_GLOBAL_PRODUCTION ("    unsuccessful\n");
       }
@@ -102,6 +102,234 @@ compute_superset_trivial (sc_array_t * receivers,
   }
 }
 
+/** Check a persistent plan with unchanged and changed receivers */
+static void
+test_plan (sc_MPI_Comm mpicomm, int *receivers, int num_receivers,
+           int *senders, int num_senders)
+{
+  int                 i, k, r;
+  int                 mpiret;
+  int                 mpisize, mpirank;
+  int                *off;
+  sc_array_t         *rec, *pay, *inoff, *outpay, *outoff;
+  sc_notify_t        *notify;
+  sc_notify_plan_t   *plan;
+
+  mpiret = sc_MPI_Comm_size (mpicomm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (mpicomm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+
+  notify = sc_notify_new (mpicomm);
+  plan = sc_notify_plan_new (notify);
+  rec = sc_array_new (sizeof (int));
+  pay = sc_array_new (sizeof (int));
+
+  /* the second call reuses the senders of the first */
+  for (r = 0; r < 2; ++r) {
+    sc_array_resize (rec, (size_t) num_receivers);
+    sc_array_resize (pay, (size_t) num_receivers);
+    for (i = 0; i < num_receivers; ++i) {
+      *(int *) sc_array_index_int (rec, i) = receivers[i];
+      *(int *) sc_array_index_int (pay, i) = 2 * mpirank + 3 + r;
+    }
+    sc_notify_plan_payload (plan, rec, NULL, pay, NULL, 1);
+    SC_CHECK_ABORT ((int) rec->elem_count == num_senders,
+                    "Mismatch plan sender count");
+    for (i = 0; i < num_senders; ++i) {
+      SC_CHECK_ABORTF (*(int *) sc_array_index_int (rec, i) == senders[i],
+                       "Mismatch plan sender %d", i);
+      SC_CHECK_ABORTF (*(int *) sc_array_index_int (pay, i) ==
+                       2 * senders[i] + 3 + r, "Mismatch plan payload %d", i);
+    }
+  }
+
+  /* variable size messages with unchanged receivers */
+  sc_array_resize (rec, (size_t) num_receivers);
+  inoff = sc_array_new_count (sizeof (int), num_receivers + 1);
+  outpay = sc_array_new (sizeof (int));
+  outoff = sc_array_new (sizeof (int));
+  sc_array_resize (pay, (size_t) (num_receivers * mpirank));
+  *(int *) sc_array_index (inoff, 0) = 0;
+  for (i = 0; i < num_receivers; ++i) {
+    *(int *) sc_array_index_int (rec, i) = receivers[i];
+    *(int *) sc_array_index_int (inoff, i + 1) = mpirank * (i + 1);
+    for (k = 0; k < mpirank; ++k) {
+      *(int *) sc_array_index_int (pay, mpirank * i + k) = 3 * mpirank + 5;
+    }
+  }
+  sc_notify_plan_payloadv (plan, rec, NULL, pay, outpay, inoff, outoff, 1);
+  off = (int *) outoff->array;
+  SC_CHECK_ABORT ((int) rec->elem_count == num_senders,
+                  "Mismatch plan payloadv sender count");
+  for (i = 0; i < num_senders; ++i) {
+    SC_CHECK_ABORTF (off[i + 1] - off[i] == senders[i],
+                     "Mismatch plan payloadv size %d", i);
+    for (k = 0; k < senders[i]; ++k) {
+      SC_CHECK_ABORTF (*(int *) sc_array_index_int (outpay, off[i] + k) ==
+                       3 * senders[i] + 5, "Mismatch plan payloadv %d", i);
+    }
+  }
+  sc_array_destroy (inoff);
+  sc_array_destroy (outpay);
+  sc_array_destroy (outoff);
+
+  /* a changed pattern triggers a new census that is reused afterwards */
+  for (r = 0; r < 2; ++r) {
+    sc_array_resize (rec, 1);
+    sc_array_resize (pay, 1);
+    *(int *) sc_array_index (rec, 0) = (mpirank + 1) % mpisize;
+    *(int *) sc_array_index (pay, 0) = mpirank;
+    sc_notify_plan_payload (plan, rec, NULL, pay, NULL, 1);
+    SC_CHECK_ABORT (rec->elem_count == 1, "Mismatch plan changed count");
+    SC_CHECK_ABORT (*(int *) sc_array_index (rec, 0) ==
+                    (mpirank + mpisize - 1) % mpisize,
+                    "Mismatch plan changed sender");
+    SC_CHECK_ABORT (*(int *) sc_array_index (pay, 0) ==
+                    (mpirank + mpisize - 1) % mpisize,
+                    "Mismatch plan changed payload");
+  }
+  SC_CHECK_ABORT (sc_notify_plan_num_census (plan) == 2,
+                  "Mismatch plan census count");
+  SC_CHECK_ABORT (sc_notify_plan_num_reused (plan) == 3,
+                  "Mismatch plan reuse count");
+
+  sc_array_destroy (rec);
+  sc_array_destroy (pay);
+  sc_notify_plan_destroy (plan);
+  sc_notify_destroy (notify);
+}
+
+/** Check that autotuning picks a working and reproducible configuration */
+static void
+test_autotune (sc_MPI_Comm mpicomm, int *receivers, int num_receivers,
+               int *senders, int num_senders)
+{
+  int                 i;
+  int                 mpiret;
+  int                 mpirank;
+  const char         *filename = "sc_test_notify_autotune.txt";
+  sc_array_t         *rec, *snd;
+  sc_notify_t        *notify, *notify2;
+  sc_notify_type_t    type;
+
+  mpiret = sc_MPI_Comm_rank (mpicomm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+  if (mpirank == 0) {
+    remove (filename);
+  }
+
+  rec = sc_array_new_data (receivers, sizeof (int), num_receivers);
+  snd = sc_array_new (sizeof (int));
+  notify = sc_notify_new (mpicomm);
+  type = sc_notify_autotune (notify, rec, sizeof (int), 2, filename);
+  SC_CHECK_ABORT (sc_notify_is_autotuned (notify), "Autotune flag");
+  SC_CHECK_ABORT (type == sc_notify_get_type (notify), "Autotune type");
+
+  sc_notify_payload (rec, snd, NULL, NULL, 1, notify);
+  SC_CHECK_ABORT ((int) snd->elem_count == num_senders,
+                  "Mismatch autotune sender count");
+  for (i = 0; i < num_senders; ++i) {
+    SC_CHECK_ABORTF (*(int *) sc_array_index_int (snd, i) == senders[i],
+                     "Mismatch autotune sender %d", i);
+  }
+
+  /* the second controller reads the stored configuration */
+  notify2 = sc_notify_new (mpicomm);
+  SC_CHECK_ABORT (sc_notify_autotune (notify2, rec, sizeof (int), 2,
+                                      filename) == type,
+                  "Mismatch autotune file");
+  SC_CHECK_ABORT (sc_notify_get_eager_threshold (notify) ==
+                  sc_notify_get_eager_threshold (notify2),
+                  "Mismatch autotune threshold");
+
+  sc_notify_destroy (notify2);
+  sc_notify_destroy (notify);
+  sc_array_destroy (snd);
+  sc_array_destroy (rec);
+
+  mpiret = sc_MPI_Barrier (mpicomm);
+  SC_CHECK_MPI (mpiret);
+  if (mpirank == 0) {
+    remove (filename);
+  }
+}
+
+/** Compare tiny payloads sent per peer and aggregated along a tree */
+static void
+test_aggregate (sc_MPI_Comm mpicomm)
+{
+  int                 i, j, d;
+  int                 mpiret;
+  int                 mpisize, mpirank;
+  int                 density, from;
+  const int           densities[3] = { 1, 8, 64 };
+  const char         *names[3] = { "pex", "nbx", "aggregated" };
+  double              elapsed;
+  sc_array_t         *rec, *snd, *pay;
+  sc_notify_t        *notify;
+
+  mpiret = sc_MPI_Comm_size (mpicomm, &mpisize);
+  SC_CHECK_MPI (mpiret);
+  mpiret = sc_MPI_Comm_rank (mpicomm, &mpirank);
+  SC_CHECK_MPI (mpiret);
+
+  for (d = 0; d < 3; ++d) {
+    /* every process sends 8 bytes to the next density processes */
+    density = SC_MIN (densities[d], mpisize);
+    for (j = 0; j < 3; ++j) {
+#if !defined SC_ENABLE_MPI || MPI_VERSION < 3
+      if (j == 1) {
+        continue;
+      }
+#endif
+      notify = sc_notify_new (mpicomm);
+      sc_notify_set_type (notify, j == 1 ? SC_NOTIFY_NBX : SC_NOTIFY_PEX);
+      if (j == 2) {
+        sc_notify_set_aggregate_threshold (notify, sizeof (long));
+      }
+      rec = sc_array_new_count (sizeof (int), density);
+      snd = sc_array_new (sizeof (int));
+      pay = sc_array_new_count (sizeof (long), density);
+      for (i = 0; i < density; ++i) {
+        *(int *) sc_array_index_int (rec, i) = (mpirank + i) % mpisize;
+      }
+      sc_array_sort (rec, sc_int_compare);
+      for (i = 0; i < density; ++i) {
+        *(long *) sc_array_index_int (pay, i) =
+          1000L * mpirank + *(int *) sc_array_index_int (rec, i);
+      }
+
+      mpiret = sc_MPI_Barrier (mpicomm);
+      SC_CHECK_MPI (mpiret);
+      elapsed = -sc_MPI_Wtime ();
+      sc_notify_payload (rec, snd, pay, NULL, 1, notify);
+      elapsed += sc_MPI_Wtime ();
+      SC_GLOBAL_STATISTICSF ("Density %d %s %g\n", density, names[j],
+                             elapsed);
+
+      /* we hear from the previous density processes in ascending order */
+      SC_CHECK_ABORT ((int) snd->elem_count == density,
+                      "Mismatch aggregate sender count");
+      for (i = 0; i < density; ++i) {
+        from = *(int *) sc_array_index_int (snd, i);
+        SC_CHECK_ABORTF ((mpirank - from + mpisize) % mpisize < density,
+                         "Mismatch aggregate sender %d", i);
+        SC_CHECK_ABORTF (i == 0 || from > *(int *) sc_array_index_int
+                         (snd, i - 1), "Mismatch aggregate order %d", i);
+        SC_CHECK_ABORTF (*(long *) sc_array_index_int (pay, i) ==
+                         1000L * from + mpirank,
+                         "Mismatch aggregate payload %d", i);
+      }
+
+      sc_array_destroy (rec);
+      sc_array_destroy (snd);
+      sc_array_destroy (pay);
+      sc_notify_destroy (notify);
+    }
+  }
+}
+
 int
 main (int argc, char **argv)
 {
@@ -225,10 +453,20 @@ main (int argc, char **argv)
                        nbot);
       sc_notify_nary_set_widths (notify, ntop, nint, nbot);
     }
+    if (j == SC_NOTIFY_RANGES) {
+      /* use more than one group whenever the size allows */
+      sc_notify_ranges_set_group_size (notify, 3);
+    }
     if (j == SC_NOTIFY_SUPERSET) {
       sc_notify_superset_set_callback (notify, compute_superset_trivial,
                                        NULL);
     }
+    if (j == SC_NOTIFY_NODE) {
+      /* use more than one node for even sizes and otherwise put all
+         processes on one node, which sends more messages within the
+         node than between nodes */
+      sc_mpi_comm_attach_node_comms (mpicomm, mpisize % 2 ? mpisize : 2);
+    }
     rec2 = sc_array_new_data (receivers, sizeof (int), num_receivers);
     snd2 = sc_array_new (sizeof (int));
     mpiret = sc_MPI_Barrier (mpicomm);
@@ -290,6 +528,9 @@ main (int argc, char **argv)
     sc_stats_set1 (stats + 3 * j + 2, elapsed_paylv, namep[j][1]);
 
     sc_notify_destroy (notify);
+    if (j == SC_NOTIFY_NODE) {
+      sc_mpi_comm_detach_node_comms (mpicomm);
+    }
 
     SC_CHECK_ABORT (num_senders1 == num_senders2, "Mismatch 12 sender count");
     SC_CHECK_ABORT (num_senders1 == num_senders4, "Mismatch 14 sender count");
@@ -322,6 +563,15 @@ main (int argc, char **argv)
     sc_array_destroy (outoff5);
   }
 
+  SC_GLOBAL_INFO ("Testing sc_notify_plan\n");
+  test_plan (mpicomm, receivers, num_receivers, senders1, num_senders1);
+
+  SC_GLOBAL_INFO ("Testing sc_notify_autotune\n");
+  test_autotune (mpicomm, receivers, num_receivers, senders1, num_senders1);
+
+  SC_GLOBAL_INFO ("Testing sc_notify_payload aggregation\n");
+  test_aggregate (mpicomm);
+
   SC_FREE (receivers);
   SC_FREE (senders1);
   SC_FREE (senders3);
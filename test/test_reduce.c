@@ -101,6 +101,21 @@ main (int argc, char **argv)
     }
   }
 
+  /* test node-aware allreduce with one and several processes per node */
+  for (j = 0; j < 2; ++j) {
+    sc_mpi_comm_attach_node_comms (mpicomm, j ? 1 : 0);
+    lvalue = (long) mpirank;
+    sc_allreduce_node (&lvalue, &lresult, 1, sc_MPI_LONG, sc_MPI_SUM,
+                       mpicomm);
+    SC_CHECK_ABORT (lresult == ((long) (mpisize - 1)) * mpisize / 2,
+                    "Allreduce node mismatch");
+    ivalue = mpirank;
+    sc_allreduce_node (&ivalue, &iresult, 1, sc_MPI_INT, sc_MPI_MAX,
+                       mpicomm);
+    SC_CHECK_ABORT (iresult == mpisize - 1, "Allreduce node mismatch");
+    sc_mpi_comm_detach_node_comms (mpicomm);
+  }
+
   sc_finalize ();
 
   mpiret = sc_MPI_Finalize ();
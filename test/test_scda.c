@@ -27,6 +27,11 @@
 #ifdef SC_ENABLE_FILE_CHECKS
 #define SC_SCDA_FILE_EXT "scd"
 #define SC_SCDA_TEST_FILE "sc_test_scda." SC_SCDA_FILE_EXT
+#define SC_SCDA_BEHIND_FILE "sc_test_scda_behind." SC_SCDA_FILE_EXT
+#define SC_SCDA_ENCODE_FILE "sc_test_scda_encode." SC_SCDA_FILE_EXT
+#define SC_SCDA_BATCH_FILE "sc_test_scda_batch." SC_SCDA_FILE_EXT
+#define SC_SCDA_INDEX_FILE "sc_test_scda_index." SC_SCDA_FILE_EXT
+#define SC_SCDA_RANGE_FILE "sc_test_scda_range." SC_SCDA_FILE_EXT
 
 #define SC_SCDA_GLOBAL_ARRAY_COUNT 12
 #define SC_SCDA_ARRAY_SIZE 3
@@ -483,6 +488,614 @@ test_scda_read_indirect_fixed_size_array (sc_scda_fcontext_t *fc, int mpirank,
   sc_array_reset (&array_data);
   sc_array_reset (&elem_counts);
 }
+
+/** Write array sections behind, interleaved with a block, and read them. */
+static void
+test_scda_write_behind (sc_MPI_Comm mpicomm, const char *filename,
+                        sc_scda_params_t *params, int mpirank, int mpisize)
+{
+  sc_scda_fcontext_t *fc;
+  sc_scda_params_t    behind_params;
+  sc_scda_ferror_t    errcode;
+  char                read_user_string[SC_SCDA_USER_STRING_BYTES + 1];
+  char                section_type;
+  char                read_data[SC_SCDA_INLINE_FIELD];
+  int                 decode;
+  size_t              len;
+  size_t              elem_count, elem_size;
+  const char         *block_data = "Block between staged arrays";
+  const size_t        block_size = strlen (block_data);
+  sc_array_t          data;
+
+  /* the staging buffer holds all local array bytes and the padding */
+  behind_params = *params;
+  behind_params.write_behind = 128;
+
+  fc = sc_scda_fopen_write (mpicomm, filename, "Write behind test", NULL,
+                            &behind_params, &errcode);
+  SC_CHECK_ABORT (sc_scda_ferror_is_success (errcode),
+                  "scda_fopen_write with write behind failed");
+
+  /* the data arrays are freed while the writes may still be in progress */
+  test_scda_write_fixed_size_array (fc, mpirank, mpisize);
+
+  /* this completes the pending write of the second array */
+  sc_array_init_data (&data, (void *) block_data, block_size, 1);
+  fc = sc_scda_fwrite_block (fc, "Block section", NULL, &data, block_size,
+                             0, 0, &errcode);
+  SC_CHECK_ABORT (sc_scda_ferror_is_success (errcode),
+                  "scda_fwrite_block after write behind failed");
+
+  /* the pending write is completed on closing the file */
+  test_scda_write_indirect_fixed_size_array (fc, mpirank, mpisize);
+  sc_scda_fclose (fc, &errcode);
+  SC_CHECK_ABORT (sc_scda_ferror_is_success (errcode),
+                  "scda_fclose after write behind failed");
+
+  fc = sc_scda_fopen_read (mpicomm, filename, read_user_string, &len, params,
+                           &errcode);
+  SC_CHECK_ABORT (sc_scda_ferror_is_success (errcode),
+                  "scda_fopen_read after write behind failed");
+
+  test_scda_read_fixed_size_array (fc, mpirank, mpisize);
+
+  fc =
+    sc_scda_fread_section_header (fc, read_user_string, &len, &section_type,
+                                  &elem_count, &elem_size, &decode, &errcode);
+  SC_CHECK_ABORT (sc_scda_ferror_is_success (errcode)
+                  && section_type == 'B' && elem_size == block_size,
+                  "sc_scda_fread_section_header after write behind failed");
+  sc_array_init_data (&data, read_data, block_size, 1);
+  fc = sc_scda_fread_block_data (fc, &data, block_size, 0, &errcode);
+  SC_CHECK_ABORT (sc_scda_ferror_is_success (errcode),
+                  "sc_scda_fread_block_data after write behind failed");
+  SC_CHECK_ABORT (mpirank != 0 || !strncmp (read_data, block_data,
+                                            block_size),
+                  "block data mismatch after write behind");
+
+  test_scda_read_indirect_fixed_size_array (fc, mpirank, mpisize);
+
+  sc_scda_fclose (fc, &errcode);
+  SC_CHECK_ABORT (sc_scda_ferror_is_success (errcode),
+                  "scda_fclose after read failed");
+}
+
+/** Write and read array sections in batches of two elements per call. */
+static void
+test_scda_batches (sc_MPI_Comm mpicomm, const char *filename,
+                   sc_scda_params_t *params, int mpirank, int mpisize)
+{
+  int                 k;
+  sc_scda_fcontext_t *fc;
+  sc_scda_params_t    batch_params;
+  sc_scda_ferror_t    errcode;
+  char                read_user_string[SC_SCDA_USER_STRING_BYTES + 1];
+  size_t              len;
+
+  batch_params = *params;
+  batch_params.batch_bytes = 2 * SC_SCDA_ARRAY_SIZE + 1;
+
+  fc = sc_scda_fopen_write (mpicomm, filename, "Batch test", NULL,
+                            &batch_params, &errcode);
+  SC_CHECK_ABORT (sc_scda_ferror_is_success (errcode),
+                  "scda_fopen_write with batches failed");
+  test_scda_write_fixed_size_array (fc, mpirank, mpisize);
+  test_scda_write_indirect_fixed_size_array (fc, mpirank, mpisize);
+  sc_scda_fclose (fc, &errcode);
+  SC_CHECK_ABORT (sc_scda_ferror_is_success (errcode),
+                  "scda_fclose after batched write failed");
+
+  /* the file format does not depend on the batches */
+  for (k = 0; k < 2; ++k) {
+    fc = sc_scda_fopen_read (mpicomm, filename, read_user_string, &len,
+                             k ? params : &batch_params, &errcode);
+    SC_CHECK_ABORT (sc_scda_ferror_is_success (errcode),
+                    "scda_fopen_read after batched write failed");
+    test_scda_read_fixed_size_array (fc, mpirank, mpisize);
+    test_scda_read_indirect_fixed_size_array (fc, mpirank, mpisize);
+    sc_scda_fclose (fc, &errcode);
+    SC_CHECK_ABORT (sc_scda_ferror_is_success (errcode),
+                    "scda_fclose after batched read failed");
+  }
+}
+
+/** Set the partition of \a global_count elements for writing or reading.
+ * For \a shifted false the elements are distributed evenly.  Otherwise, the
+ * first process is empty and the last process gets the remainder.
+ */
+static void
+test_scda_set_partition (sc_array_t *elem_counts, size_t global_count,
+                         int mpisize, int shifted)
+{
+  int                 i;
+  int                 num_procs;
+
+  num_procs = (shifted && mpisize > 1) ? mpisize - 1 : mpisize;
+  for (i = 0; i < mpisize; ++i) {
+    *((sc_scda_ulong *) sc_array_index_int (elem_counts, i)) =
+      (shifted && mpisize > 1 && i == 0) ? 0 : global_count / num_procs;
+  }
+  *((sc_scda_ulong *) sc_array_index_int (elem_counts, mpisize - 1)) +=
+    global_count % num_procs;
+}
+
+/** Return a smooth data value of an element; it compresses well. */
+static double
+test_scda_encode_value (size_t global_index, int k)
+{
+  return (double) (global_index / 4) + .25 * k;
+}
+
+/** Write encoded sections and read them decoded and raw. */
+static void
+test_scda_encode (sc_MPI_Comm mpicomm, const char *filename,
+                  sc_scda_params_t *params, int mpirank, int mpisize)
+{
+  const size_t        global_count = 100;
+  const size_t        elem_size = 8 * sizeof (double);
+  const size_t        block_size = 1000;
+  int                 k, shifted, indirect;
+  int                 decode;
+  char                section_type;
+  char                read_user_string[SC_SCDA_USER_STRING_BYTES + 1];
+  char                block[1000], read_block[1000];
+  size_t              len;
+  size_t              si, first, num_local;
+  size_t              elem_count, read_elem_size;
+  double             *value;
+  sc_scda_fcontext_t *fc;
+  sc_scda_ferror_t    errcode;
+  sc_array_t          elem_counts, data, block_data;
+  sc_array_t         *curr;
+
+  for (si = 0; si < block_size; ++si) {
+    block[si] = (char) ('a' + si / 100);
+  }
+  sc_array_init_size (&elem_counts, sizeof (sc_scda_ulong),
+                      (size_t) mpisize);
+
+  /* write an encoded block and the same array directly and indirectly */
+  fc = sc_scda_fopen_write (mpicomm, filename, "Encoding test", NULL, params,
+                            &errcode);
+  SC_CHECK_ABORT (sc_scda_ferror_is_success (errcode),
+                  "scda_fopen_write for encoding failed");
+  sc_array_init_data (&block_data, block, block_size, 1);
+  fc = sc_scda_fwrite_block (fc, "Encoded block", NULL, &block_data,
+                             block_size, mpisize - 1, 1, &errcode);
+  SC_CHECK_ABORT (sc_scda_ferror_is_success (errcode),
+                  "scda_fwrite_block encoded failed");
+  test_scda_set_partition (&elem_counts, global_count, mpisize, 0);
+  num_local = (size_t) *((sc_scda_ulong *)
+                         sc_array_index_int (&elem_counts, mpirank));
+  first = (size_t) mpirank * (global_count / mpisize);
+  for (indirect = 0; indirect < 2; ++indirect) {
+    sc_array_init_size (&data, indirect ? sizeof (sc_array_t) : elem_size,
+                        num_local);
+    for (si = 0; si < num_local; ++si) {
+      if (indirect) {
+        curr = (sc_array_t *) sc_array_index (&data, si);
+        sc_array_init_size (curr, elem_size, 1);
+        value = (double *) curr->array;
+      }
+      else {
+        value = (double *) sc_array_index (&data, si);
+      }
+      for (k = 0; k < 8; ++k) {
+        value[k] = test_scda_encode_value (first + si, k);
+      }
+    }
+    fc = sc_scda_fwrite_array (fc, "Encoded array", NULL, &data,
+                               &elem_counts, elem_size, indirect, 1,
+                               &errcode);
+    SC_CHECK_ABORT (sc_scda_ferror_is_success (errcode),
+                    "scda_fwrite_array encoded failed");
+    if (indirect) {
+      for (si = 0; si < num_local; ++si) {
+        sc_array_reset ((sc_array_t *) sc_array_index (&data, si));
+      }
+    }
+    sc_array_reset (&data);
+  }
+  sc_scda_fclose (fc, &errcode);
+  SC_CHECK_ABORT (sc_scda_ferror_is_success (errcode),
+                  "scda_fclose after encoding failed");
+
+  /* read decoded on two partitions */
+  for (shifted = 0; shifted < 2; ++shifted) {
+    fc = sc_scda_fopen_read (mpicomm, filename, read_user_string, &len,
+                             params, &errcode);
+    SC_CHECK_ABORT (sc_scda_ferror_is_success (errcode),
+                    "scda_fopen_read for decoding failed");
+
+    decode = 1;
+    fc = sc_scda_fread_section_header (fc, read_user_string, &len,
+                                       &section_type, &elem_count,
+                                       &read_elem_size, &decode, &errcode);
+    SC_CHECK_ABORT (sc_scda_ferror_is_success (errcode) && decode &&
+                    section_type == 'B' && read_elem_size == block_size &&
+                    !strcmp (read_user_string, "Encoded block"),
+                    "Identifying encoded block section");
+    sc_array_init_data (&block_data, read_block, block_size, 1);
+    fc = sc_scda_fread_block_data (fc, &block_data, block_size, 0, &errcode);
+    SC_CHECK_ABORT (sc_scda_ferror_is_success (errcode),
+                    "sc_scda_fread_block_data decoding failed");
+    SC_CHECK_ABORT (mpirank != 0 || !memcmp (read_block, block, block_size),
+                    "decoded block data mismatch");
+
+    /* read the direct array indirectly and the other way around */
+    test_scda_set_partition (&elem_counts, global_count, mpisize, shifted);
+    num_local = (size_t) *((sc_scda_ulong *)
+                           sc_array_index_int (&elem_counts, mpirank));
+    first = 0;
+    for (k = 0; k < mpirank; ++k) {
+      first += (size_t) *((sc_scda_ulong *)
+                          sc_array_index_int (&elem_counts, k));
+    }
+    for (indirect = 1; indirect >= 0; --indirect) {
+      decode = 1;
+      fc = sc_scda_fread_section_header (fc, read_user_string, &len,
+                                         &section_type, &elem_count,
+                                         &read_elem_size, &decode, &errcode);
+      SC_CHECK_ABORT (sc_scda_ferror_is_success (errcode) && decode &&
+                      section_type == 'A' && elem_count == global_count &&
+                      read_elem_size == elem_size,
+                      "Identifying encoded array section");
+      sc_array_init_size (&data, indirect ? sizeof (sc_array_t) : elem_size,
+                          num_local);
+      for (si = 0; indirect && si < num_local; ++si) {
+        sc_array_init_size ((sc_array_t *) sc_array_index (&data, si),
+                            elem_size, 1);
+      }
+      fc = sc_scda_fread_array_data (fc, &data, &elem_counts, elem_size,
+                                     indirect, &errcode);
+      SC_CHECK_ABORT (sc_scda_ferror_is_success (errcode),
+                      "sc_scda_fread_array_data decoding failed");
+      for (si = 0; si < num_local; ++si) {
+        curr = indirect ? (sc_array_t *) sc_array_index (&data, si) : NULL;
+        value = indirect ? (double *) curr->array :
+          (double *) sc_array_index (&data, si);
+        for (k = 0; k < 8; ++k) {
+          SC_CHECK_ABORT (value[k] == test_scda_encode_value (first + si, k),
+                          "decoded array data mismatch");
+        }
+        if (indirect) {
+          sc_array_reset (curr);
+        }
+      }
+      sc_array_reset (&data);
+    }
+    sc_scda_fclose (fc, &errcode);
+    SC_CHECK_ABORT (sc_scda_ferror_is_success (errcode),
+                    "scda_fclose after decoding failed");
+  }
+
+  /* without decoding the convention is visible */
+  fc = sc_scda_fopen_read (mpicomm, filename, read_user_string, &len, params,
+                           &errcode);
+  SC_CHECK_ABORT (sc_scda_ferror_is_success (errcode),
+                  "scda_fopen_read for raw reading failed");
+  decode = 0;
+  fc = sc_scda_fread_section_header (fc, read_user_string, &len,
+                                     &section_type, &elem_count,
+                                     &read_elem_size, &decode, &errcode);
+  SC_CHECK_ABORT (sc_scda_ferror_is_success (errcode) && !decode &&
+                  section_type == 'I', "Identifying raw inline section");
+  sc_scda_fclose (fc, &errcode);
+  SC_CHECK_ABORT (sc_scda_ferror_is_success (errcode),
+                  "scda_fclose after raw reading failed");
+
+  sc_array_reset (&elem_counts);
+}
+
+/** Find the byte offset of a section header in a file on one process.
+ * \return The offset of the first occurrence of \a header or -1.
+ */
+static long
+test_scda_find_header (const char *filename, const char *header)
+{
+  int                 c;
+  long                offset;
+  size_t              matched, len;
+  FILE               *file;
+
+  file = fopen (filename, "rb");
+  SC_CHECK_ABORT (file != NULL, "Open file to find header");
+  len = strlen (header);
+  offset = 0;
+  matched = 0;
+  while (matched < len && (c = fgetc (file)) != EOF) {
+    ++offset;
+    /* the header string does not repeat its first character */
+    matched = (c == header[matched]) ? matched + 1 : (c == header[0]);
+  }
+  fclose (file);
+
+  return matched == len ? offset - (long) len : -1;
+}
+
+/** Write five sections and read them in a different order by seeking.
+ * The file is written with and without section index and with and without
+ * aligning the array data.  The first data byte of every section is the
+ * section number.
+ */
+static void
+test_scda_index (sc_MPI_Comm mpicomm, const char *filename,
+                 sc_scda_params_t *params, int mpirank, int mpisize)
+{
+  const size_t        global_count = 13;
+  const size_t        block_size = 100;
+  const size_t        order[6] = { 4, 0, 3, 1, 2, 2 };
+  const size_t        align = 256;
+  const char          types[5] = { 'I', 'B', 'A', 'A', 'B' };
+  int                 i, k, decode;
+  int                 data_rank;
+  char                section_type;
+  char                user_string[SC_SCDA_USER_STRING_BYTES + 1];
+  char                read_user_string[SC_SCDA_USER_STRING_BYTES + 1];
+  char                block[100];
+  size_t              len, si, first, num_local, section;
+  size_t              elem_count, elem_size;
+  long                offset;
+  sc_scda_fcontext_t *fc;
+  sc_scda_params_t    index_params;
+  sc_scda_ferror_t    errcode;
+  sc_array_t          elem_counts, read_counts, data;
+
+  /* write on a partition with an empty first process */
+  sc_array_init_size (&elem_counts, sizeof (sc_scda_ulong),
+                      (size_t) mpisize);
+  test_scda_set_partition (&elem_counts, global_count, mpisize, 1);
+  num_local = (size_t) *((sc_scda_ulong *)
+                         sc_array_index_int (&elem_counts, mpirank));
+  first = 0;
+  for (i = 0; i < mpirank; ++i) {
+    first += (size_t) *((sc_scda_ulong *)
+                        sc_array_index_int (&elem_counts, i));
+  }
+
+  /* read arrays completely on the last process */
+  sc_array_init_size (&read_counts, sizeof (sc_scda_ulong),
+                      (size_t) mpisize);
+  for (i = 0; i < mpisize; ++i) {
+    *((sc_scda_ulong *) sc_array_index_int (&read_counts, i)) =
+      (i == mpisize - 1) ? global_count : 0;
+  }
+
+  for (k = 0; k < 4; ++k) {
+    index_params = *params;
+    index_params.write_index = k & 1;
+    if (k & 2) {
+      /* the striping hints do not change the file */
+      index_params.stripe_size = align;
+      index_params.stripe_count = 2;
+      index_params.align = align;
+    }
+    fc = sc_scda_fopen_write (mpicomm, filename, "Index test", NULL,
+                              &index_params, &errcode);
+    SC_CHECK_ABORT (sc_scda_ferror_is_success (errcode),
+                    "scda_fopen_write for index failed");
+    for (section = 0; section < 5; ++section) {
+      snprintf (user_string, SC_SCDA_USER_STRING_BYTES + 1, "Section %d",
+                (int) section);
+      memset (block, (int) section, block_size);
+      if (types[section] == 'A') {
+        sc_array_init_size (&data, 1, num_local);
+        for (si = 0; si < num_local; ++si) {
+          *(char *) sc_array_index (&data, si) =
+            (first + si == 0) ? (char) section : 'a';
+        }
+        fc = sc_scda_fwrite_array (fc, user_string, NULL, &data,
+                                   &elem_counts, 1, 0, section == 3,
+                                   &errcode);
+        sc_array_reset (&data);
+      }
+      else if (types[section] == 'B') {
+        sc_array_init_data (&data, block, block_size, 1);
+        fc = sc_scda_fwrite_block (fc, user_string, NULL, &data,
+                                   block_size, 0, section == 1, &errcode);
+      }
+      else {
+        sc_array_init_data (&data, block, SC_SCDA_INLINE_FIELD, 1);
+        fc = sc_scda_fwrite_inline (fc, user_string, NULL, &data, 0,
+                                    &errcode);
+      }
+      SC_CHECK_ABORT (sc_scda_ferror_is_success (errcode),
+                      "scda_fwrite for index failed");
+    }
+    sc_scda_fclose (fc, &errcode);
+    SC_CHECK_ABORT (sc_scda_ferror_is_success (errcode),
+                    "scda_fclose with index failed");
+
+    if ((k & 2) && mpirank == 0) {
+      /* the data of the unencoded array follows its header of 128 bytes */
+      offset = test_scda_find_header (filename, "A Section 2");
+      SC_CHECK_ABORT (offset > 0 && (offset + 128) % (long) align == 0,
+                      "Aligned array data");
+    }
+
+    fc = sc_scda_fopen_read (mpicomm, filename, read_user_string, &len,
+                             params, &errcode);
+    SC_CHECK_ABORT (sc_scda_ferror_is_success (errcode),
+                    "scda_fopen_read for index failed");
+    for (i = 0; i < 6; ++i) {
+      section = order[i];
+      fc = sc_scda_fseek_section (fc, section, &errcode);
+      SC_CHECK_ABORT (sc_scda_ferror_is_success (errcode),
+                      "scda_fseek_section failed");
+      decode = 1;
+      fc = sc_scda_fread_section_header (fc, read_user_string, &len,
+                                         &section_type, &elem_count,
+                                         &elem_size, &decode, &errcode);
+      snprintf (user_string, SC_SCDA_USER_STRING_BYTES + 1, "Section %d",
+                (int) section);
+      SC_CHECK_ABORT (sc_scda_ferror_is_success (errcode) &&
+                      section_type == types[section] &&
+                      decode == (section == 1 || section == 3) &&
+                      !strcmp (read_user_string, user_string),
+                      "Identifying section after seeking");
+
+      memset (block, -1, block_size);
+      data_rank = 0;
+      if (section_type == 'A') {
+        data_rank = mpisize - 1;
+        sc_array_init_size (&data, 1, mpirank == data_rank ?
+                            global_count : 0);
+        fc = sc_scda_fread_array_data (fc, &data, &read_counts, 1, 0,
+                                       &errcode);
+        if (mpirank == data_rank) {
+          block[0] = data.array[0];
+        }
+        sc_array_reset (&data);
+      }
+      else if (section_type == 'B') {
+        sc_array_init_data (&data, block, block_size, 1);
+        fc = sc_scda_fread_block_data (fc, &data, block_size, 0, &errcode);
+      }
+      else {
+        sc_array_init_data (&data, block, SC_SCDA_INLINE_FIELD, 1);
+        fc = sc_scda_fread_inline_data (fc, &data, 0, &errcode);
+      }
+      SC_CHECK_ABORT (sc_scda_ferror_is_success (errcode),
+                      "scda_fread after seeking failed");
+      SC_CHECK_ABORT (mpirank != data_rank || block[0] == (char) section,
+                      "Section data after seeking");
+    }
+
+    /* there is no sixth section */
+    fc = sc_scda_fseek_section (fc, 5, &errcode);
+    SC_CHECK_ABORT (fc == NULL && errcode.scdaret == SC_SCDA_FERR_ARG,
+                    "scda_fseek_section error detection failed");
+  }
+
+  sc_array_reset (&elem_counts);
+  sc_array_reset (&read_counts);
+}
+
+/** Read ranges of raw and encoded arrays on the even processes. */
+static void
+test_scda_ranges (sc_MPI_Comm mpicomm, const char *filename,
+                  sc_scda_params_t *params, int mpirank, int mpisize)
+{
+  const size_t        global_count = 50;
+  int                 encode, batched, indirect, decode;
+  char                section_type;
+  char                read_user_string[SC_SCDA_USER_STRING_BYTES + 1];
+  size_t              len, si, num_local, first, num_ranges;
+  size_t              elem_count, elem_size;
+  sc_scda_ulong       ranges_data[4][2];
+  int32_t             value;
+  sc_scda_fcontext_t *fc;
+  sc_scda_params_t    range_params;
+  sc_scda_ferror_t    errcode;
+  sc_array_t          elem_counts, data, ranges;
+  sc_array_t         *curr;
+
+  /* every element is its global index */
+  sc_array_init_size (&elem_counts, sizeof (sc_scda_ulong),
+                      (size_t) mpisize);
+  test_scda_set_partition (&elem_counts, global_count, mpisize, 0);
+  num_local = (size_t) *((sc_scda_ulong *)
+                         sc_array_index_int (&elem_counts, mpirank));
+  first = (size_t) mpirank * (global_count / mpisize);
+  sc_array_init_size (&data, sizeof (int32_t), num_local);
+  for (si = 0; si < num_local; ++si) {
+    *(int32_t *) sc_array_index (&data, si) = (int32_t) (first + si);
+  }
+  fc = sc_scda_fopen_write (mpicomm, filename, "Range test", NULL, params,
+                            &errcode);
+  SC_CHECK_ABORT (sc_scda_ferror_is_success (errcode),
+                  "scda_fopen_write for ranges failed");
+  for (encode = 0; encode < 2; ++encode) {
+    fc = sc_scda_fwrite_array (fc, "Range array", NULL, &data, &elem_counts,
+                               sizeof (int32_t), 0, encode, &errcode);
+    SC_CHECK_ABORT (sc_scda_ferror_is_success (errcode),
+                    "scda_fwrite_array for ranges failed");
+  }
+  sc_scda_fclose (fc, &errcode);
+  SC_CHECK_ABORT (sc_scda_ferror_is_success (errcode),
+                  "scda_fclose for ranges failed");
+  sc_array_reset (&data);
+
+  /* two ranges that are joined, an overlapping one and a single element */
+  num_ranges = (mpirank % 2 == 0) ? 4 : 0;
+  ranges_data[0][0] = (sc_scda_ulong) (3 * mpirank) % 40;
+  ranges_data[0][1] = 5;
+  ranges_data[1][0] = ranges_data[0][0] + 5;
+  ranges_data[1][1] = 2;
+  ranges_data[2][0] = 38;
+  ranges_data[2][1] = 12;
+  ranges_data[3][0] = 0;
+  ranges_data[3][1] = 1;
+  sc_array_init_data (&ranges, ranges_data, 2 * sizeof (sc_scda_ulong),
+                      num_ranges);
+  num_local = num_ranges > 0 ? 20 : 0;
+
+  for (batched = 0; batched < 2; ++batched) {
+    range_params = *params;
+    range_params.batch_bytes = batched ? 9 : 0;
+    fc = sc_scda_fopen_read (mpicomm, filename, read_user_string, &len,
+                             &range_params, &errcode);
+    SC_CHECK_ABORT (sc_scda_ferror_is_success (errcode),
+                    "scda_fopen_read for ranges failed");
+    for (indirect = 0; indirect < 2; ++indirect) {
+      decode = 1;
+      fc = sc_scda_fread_section_header (fc, read_user_string, &len,
+                                         &section_type, &elem_count,
+                                         &elem_size, &decode, &errcode);
+      SC_CHECK_ABORT (sc_scda_ferror_is_success (errcode) &&
+                      section_type == 'A' && elem_count == global_count &&
+                      elem_size == sizeof (int32_t) && decode == indirect,
+                      "Identifying array section for ranges");
+      sc_array_init_size (&data, indirect ? sizeof (sc_array_t) :
+                          sizeof (int32_t), num_local);
+      for (si = 0; indirect && si < num_local; ++si) {
+        sc_array_init_size ((sc_array_t *) sc_array_index (&data, si),
+                            sizeof (int32_t), 1);
+      }
+      fc = sc_scda_fread_array_ranges (fc, &data, &ranges, sizeof (int32_t),
+                                       indirect, &errcode);
+      SC_CHECK_ABORT (sc_scda_ferror_is_success (errcode),
+                      "scda_fread_array_ranges failed");
+      for (si = 0; si < num_local; ++si) {
+        curr = indirect ? (sc_array_t *) sc_array_index (&data, si) : NULL;
+        memcpy (&value, indirect ? curr->array : sc_array_index (&data, si),
+                sizeof (int32_t));
+        SC_CHECK_ABORT ((size_t) value ==
+                        (si < 7 ? (size_t) ranges_data[0][0] + si :
+                         si < 19 ? 38 + si - 7 : 0), "Range data mismatch");
+        if (indirect) {
+          sc_array_reset (curr);
+        }
+      }
+      sc_array_reset (&data);
+    }
+    sc_scda_fclose (fc, &errcode);
+    SC_CHECK_ABORT (sc_scda_ferror_is_success (errcode),
+                    "scda_fclose after ranges failed");
+  }
+
+  /* a range beyond the array is an error on all processes */
+  fc = sc_scda_fopen_read (mpicomm, filename, read_user_string, &len, params,
+                           &errcode);
+  SC_CHECK_ABORT (sc_scda_ferror_is_success (errcode),
+                  "scda_fopen_read for ranges failed");
+  decode = 0;
+  fc = sc_scda_fread_section_header (fc, read_user_string, &len,
+                                     &section_type, &elem_count, &elem_size,
+                                     &decode, &errcode);
+  SC_CHECK_ABORT (sc_scda_ferror_is_success (errcode),
+                  "Identifying array section for ranges");
+  ranges_data[0][0] = (mpirank == mpisize - 1) ? global_count : 0;
+  ranges_data[0][1] = 1;
+  sc_array_init_data (&ranges, ranges_data, 2 * sizeof (sc_scda_ulong), 1);
+  sc_array_init_size (&data, sizeof (int32_t), 1);
+  fc = sc_scda_fread_array_ranges (fc, &data, &ranges, sizeof (int32_t), 0,
+                                   &errcode);
+  SC_CHECK_ABORT (fc == NULL && errcode.scdaret == SC_SCDA_FERR_ARG,
+                  "scda_fread_array_ranges error detection failed");
+  sc_array_reset (&data);
+  sc_array_reset (&elem_counts);
+}
 #endif /* SC_ENABLE_FILE_CHECKS */
 
 int
@@ -798,6 +1411,26 @@ main (int argc, char **argv)
   test_scda_skip_through_file (mpicomm, filename, &scda_params, mpirank,
                                mpisize);
 
+  /* write array sections behind and read them back */
+  test_scda_write_behind (mpicomm, SC_SCDA_BEHIND_FILE, &scda_params,
+                          mpirank, mpisize);
+
+  /* write and read array sections in several collective calls */
+  test_scda_batches (mpicomm, SC_SCDA_BATCH_FILE, &scda_params, mpirank,
+                     mpisize);
+
+  /* write compressed sections and read them on different partitions */
+  test_scda_encode (mpicomm, SC_SCDA_ENCODE_FILE, &scda_params, mpirank,
+                    mpisize);
+
+  /* read sections in random order with and without section index */
+  test_scda_index (mpicomm, SC_SCDA_INDEX_FILE, &scda_params, mpirank,
+                   mpisize);
+
+  /* read global element ranges on a subset of the processes */
+  test_scda_ranges (mpicomm, SC_SCDA_RANGE_FILE, &scda_params, mpirank,
+                    mpisize);
+
   sc_options_destroy (opt);
 
 #else